@@ -171,15 +171,30 @@ def main():
     skip_tasks = ['cocos2d']
     tasks = [x for x in tasks if x not in skip_tasks]
     print('Building targets: %s' % ' '.join(tasks))
-  for what in tasks:
+  for i, what in enumerate(tasks):
     for old, new in legacy_prefixes.items():
       if what.startswith(old):
-        what = what.replace(old, new)
+        tasks[i] = what.replace(old, new)
+
+  # Build all of the requested system libraries together, so that their
+  # objects compile in one pool of parallel jobs. The loop below then only
+  # verifies that they are in the cache.
+  libraries = [SYSTEM_LIBRARIES[what] for what in tasks if what in SYSTEM_LIBRARIES]
+  if len(libraries) > 1:
+    if force:
+      for library in libraries:
+        library.erase()
+    start_time = time.time()
+    system_libs.build_libraries(libraries)
+    time_taken = time.time() - start_time
+    logger.info('built %d system libraries in %s(%.2fs)' % (len(libraries), ('%02d:%02d mins ' % (time_taken // 60, time_taken % 60) if time_taken >= 60 else ''), time_taken))
+
+  for what in tasks:
     logger.info('building and verifying ' + what)
     start_time = time.time()
     if what in SYSTEM_LIBRARIES:
       library = SYSTEM_LIBRARIES[what]
-      if force:
+      if force and len(libraries) == 1:
         library.erase()
       library.get_path()
     elif what == 'sysroot':
@@ -46,6 +46,8 @@ from tools.shared import do_replace, strip_prefix
 from tools.response_file import substitute_response_files
 from tools.minimal_runtime_shell import generate_minimal_runtime_html
 import tools.line_endings
+from tools import compile_cache
+from tools import incremental_link
 from tools import js_manipulation
 from tools import wasm2c
 from tools import webassembly
@@ -1799,7 +1801,6 @@ def phase_linker_setup(options, state, newargs, settings_map):
     state.forced_stdlibs.append('libwasmfs')
     settings.FILESYSTEM = 0
     settings.SYSCALLS_REQUIRE_FILESYSTEM = 0
-    # settings.JS_LIBRARIES.append((0, 'library_wasmfs.js')) TODO: populate with library_wasmfs.js later
 
   # Explicitly drop linking in a malloc implementation if program is not using any dynamic allocation calls.
   if not settings.USES_DYNAMIC_ALLOC:
@@ -1814,6 +1815,27 @@ def phase_linker_setup(options, state, newargs, settings_map):
   if settings.DEMANGLE_SUPPORT:
     settings.EXPORTED_FUNCTIONS += ['___cxa_demangle']
 
+  if settings.WASM_STRING_CONVERSION:
+    if settings.MINIMAL_RUNTIME:
+      exit_with_error('WASM_STRING_CONVERSION is not compatible with MINIMAL_RUNTIME')
+    settings.EXPORTED_FUNCTIONS += ['__emscripten_utf_scratch', '__emscripten_utf8_decode', '__emscripten_utf8_encode']
+
+  if settings.SNAPSHOT:
+    if settings.MINIMAL_RUNTIME or settings.STANDALONE_WASM:
+      exit_with_error('SNAPSHOT is not compatible with MINIMAL_RUNTIME or STANDALONE_WASM')
+    if settings.USE_PTHREADS or settings.RELOCATABLE or settings.IMPORTED_MEMORY or settings.ASYNCIFY_LAZY_LOAD_CODE or settings.MEMORY64:
+      exit_with_error('SNAPSHOT needs memory to be defined in the wasm, so it is not compatible with pthreads, dynamic linking, IMPORTED_MEMORY, ASYNCIFY_LAZY_LOAD_CODE or MEMORY64')
+    if settings.WASM != 1 or settings.SINGLE_FILE or settings.SPLIT_MODULE:
+      exit_with_error('SNAPSHOT needs the wasm to be emitted as a separate file, so it is not compatible with WASM=0, WASM=2, SINGLE_FILE or SPLIT_MODULE')
+    if settings.EMBIND:
+      exit_with_error('SNAPSHOT is not compatible with embind, which registers its bindings in JS from global constructors')
+    if settings.MEMFS_HEAP_STORAGE:
+      exit_with_error('SNAPSHOT is not compatible with MEMFS_HEAP_STORAGE, which would allocate file contents on top of the snapshotted files while restoring them')
+    if not settings.ENVIRONMENT_MAY_BE_NODE or settings.EXPORT_ES6:
+      exit_with_error('SNAPSHOT takes the snapshot by running the program in node, so ENVIRONMENT must include node, and EXPORT_ES6 cannot be used')
+    settings.DEFAULT_LIBRARY_FUNCS_TO_INCLUDE += ['$Snapshot']
+    settings.EXPORTED_FUNCTIONS += ['__emscripten_snapshot_state', '_sbrk', '_emscripten_stack_get_base', '_emscripten_stack_get_end']
+
   if settings.FULL_ES3:
     settings.FULL_ES2 = 1
     settings.MAX_WEBGL_VERSION = max(2, settings.MAX_WEBGL_VERSION)
@@ -1832,6 +1854,9 @@ def phase_linker_setup(options, state, newargs, settings_map):
   if settings.SIDE_MODULE and settings.GLOBAL_BASE != -1:
     exit_with_error('Cannot set GLOBAL_BASE when building SIDE_MODULE')
 
+  if settings.PRELINK_SIDE_MODULE and not settings.SIDE_MODULE:
+    exit_with_error('PRELINK_SIDE_MODULE requires SIDE_MODULE')
+
   # When building a side module we currently have to assume that any undefined
   # symbols that exist at link time will be satisfied by the main module or JS.
   if settings.SIDE_MODULE:
@@ -1900,11 +1925,11 @@ def phase_linker_setup(options, state, newargs, settings_map):
     settings.EXPORTED_FUNCTIONS += [
       '___emscripten_init_main_thread',
       '__emscripten_call_on_thread',
-      '__emscripten_main_thread_futex',
       '__emscripten_thread_init',
       '__emscripten_thread_exit',
       '_emscripten_current_thread_process_queued_calls',
       '__emscripten_allow_main_runtime_queued_calls',
+      '_emscripten_futex_wait',
       '_emscripten_futex_wake',
       '_emscripten_get_global_libc',
       '_emscripten_main_browser_thread_id',
@@ -1921,6 +1946,11 @@ def phase_linker_setup(options, state, newargs, settings_map):
     settings.DEFAULT_LIBRARY_FUNCS_TO_INCLUDE += [
       '$exitOnMainThread',
     ]
+    if settings.PTHREAD_REUSE_CACHE:
+      settings.EXPORTED_FUNCTIONS += [
+        '__emscripten_thread_free_data',
+        '__emscripten_thread_reuse_cache_size',
+      ]
     # Some of these symbols are using by worker.js but otherwise unreferenced.
     # Because emitDCEGraph only considered the main js file, and not worker.js
     # we have explicitly mark these symbols as user-exported so that they will
@@ -1935,6 +1965,10 @@ def phase_linker_setup(options, state, newargs, settings_map):
   else:
     settings.JS_LIBRARIES.append((0, 'library_pthread_stub.js'))
 
+  if settings.MEMFS_HEAP_STORAGE:
+    # MEMFS allocates and frees file storage in the heap.
+    settings.EXPORTED_FUNCTIONS += ['_malloc', '_realloc', '_free']
+
   if settings.FORCE_FILESYSTEM and not settings.MINIMAL_RUNTIME:
     # when the filesystem is forced, we export by default methods that filesystem usage
     # may need, including filesystem usage from standalone file packager output (i.e.
@@ -2009,6 +2043,12 @@ def phase_linker_setup(options, state, newargs, settings_map):
   elif settings.PROXY_TO_PTHREAD:
     exit_with_error('-s PROXY_TO_PTHREAD=1 requires -s USE_PTHREADS to work!')
 
+  if settings.MAIN_THREAD_ASYNC_WAIT:
+    if not settings.USE_PTHREADS:
+      exit_with_error('-s MAIN_THREAD_ASYNC_WAIT requires -s USE_PTHREADS')
+    if not settings.ASYNCIFY:
+      exit_with_error('-s MAIN_THREAD_ASYNC_WAIT requires -s ASYNCIFY')
+
   def check_memory_setting(setting):
     if settings[setting] % webassembly.WASM_PAGE_SIZE != 0:
       exit_with_error(f'{setting} must be a multiple of WebAssembly page size (64KiB), was {settings[setting]}')
@@ -2294,6 +2334,9 @@ def phase_linker_setup(options, state, newargs, settings_map):
     # see what it itself calls)
     if settings.USE_PTHREADS:
       settings.ASYNCIFY_IMPORTS += ['__call_main']
+    # the main browser thread suspends in futex waits and sleeps
+    if settings.MAIN_THREAD_ASYNC_WAIT:
+      settings.ASYNCIFY_IMPORTS += ['_emscripten_main_thread_wait_async']
     # add the default imports
     settings.ASYNCIFY_IMPORTS += DEFAULT_ASYNCIFY_IMPORTS
 
@@ -2478,7 +2521,6 @@ def phase_compile_inputs(options, state, newargs, input_files):
       cmd = get_clang_command(input_file)
     if not state.has_dash_c:
       cmd += ['-c']
-    cmd += ['-o', output_file]
     if state.mode == Mode.COMPILE_AND_LINK and '-gsplit-dwarf' in newargs:
       # When running in COMPILE_AND_LINK mode we compile to temporary location
       # but we want the `.dwo` file to be generated in the current working directory,
@@ -2487,7 +2529,12 @@ def phase_compile_inputs(options, state, newargs, input_files):
       # driver to perform linking which would be big change.
       cmd += ['-Xclang', '-split-dwarf-file', '-Xclang', unsuffixed_basename(input_file) + '.dwo']
       cmd += ['-Xclang', '-split-dwarf-output', '-Xclang', unsuffixed_basename(input_file) + '.dwo']
-    shared.check_call(cmd)
+    if get_file_suffix(input_file) in SOURCE_ENDINGS:
+      # Reuses the object file from an earlier identical compilation, if the
+      # compile cache is enabled.
+      compile_cache.compile(cmd, output_file)
+    else:
+      shared.check_call(cmd + ['-o', output_file])
     if output_file not in ('-', os.devnull):
       assert os.path.exists(output_file)
 
@@ -2569,7 +2616,26 @@ def phase_post_link(options, state, in_wasm, wasm_target, target):
   else:
     memfile = shared.replace_or_append_suffix(target, '.mem')
 
-  phase_emscript(options, in_wasm, wasm_target, memfile)
+  start_time = time.time()
+  incremental = None
+  if settings.INCREMENTAL_LINK and final_js:
+    reason = incremental_link.get_unsupported_reason(options)
+    if reason:
+      logger.debug(f'INCREMENTAL_LINK is ignored with {reason}')
+    else:
+      js_outputs = [state.js_target]
+      if options.oformat == OFormat.HTML:
+        js_outputs.append(target)
+      if settings.USE_PTHREADS:
+        js_outputs.append(os.path.join(os.path.dirname(os.path.abspath(target)), settings.PTHREAD_WORKER_FILE))
+      incremental = incremental_link.IncrementalLink(options, target, wasm_target, js_outputs)
+      if phase_incremental_post_link(incremental, options, target, in_wasm, wasm_target):
+        logger.debug('incremental link: post-link took %.2f seconds' % (time.time() - start_time))
+        ToolchainProfiler.record_counter('incremental links', 1)
+        return
+      incremental.invalidate()
+
+  metadata = phase_emscript(options, in_wasm, wasm_target, memfile)
 
   phase_source_transforms(options, target)
 
@@ -2584,6 +2650,43 @@ def phase_post_link(options, state, in_wasm, wasm_target, target):
   if options.oformat != OFormat.WASM:
     phase_final_emitting(options, state, target, wasm_target, memfile)
 
+  if incremental:
+    incremental.save(metadata)
+    logger.debug('full link: post-link took %.2f seconds' % (time.time() - start_time))
+    ToolchainProfiler.record_counter('full links', 1)
+
+
+@ToolchainProfiler.profile_block('incremental post_link')
+def phase_incremental_post_link(incremental, options, target, in_wasm, wasm_target):
+  """Updates just the wasm output when only the code of functions changed since
+  the previous link, whose JS outputs are then still correct. Returns False if
+  a full post-link is needed instead."""
+  global final_js
+
+  metadata = incremental.get_previous_metadata(in_wasm)
+  if metadata is None:
+    return False
+
+  _, modify_wasm = emscripten.get_finalize_args(wasm_target, None)
+  if modify_wasm:
+    # The input may be the output, and must stay as it is if we fall back to a
+    # full post-link.
+    finalized = in_temp(unsuffixed_basename(target) + '.finalized.wasm')
+    new_metadata = emscripten.finalize_wasm(in_wasm, finalized, None, DEBUG)
+    if json.loads(json.dumps(new_metadata)) != metadata:
+      logger.debug('incremental link: finalize metadata changed')
+      return False
+    move_file(finalized, wasm_target)
+  elif in_wasm != wasm_target:
+    safe_copy(in_wasm, wasm_target)
+
+  logger.debug('incremental link: keeping the JS from the previous link')
+  # The binaryen phase depends on settings that come from the metadata.
+  emscripten.update_settings_glue(metadata, DEBUG)
+  final_js = None
+  phase_binaryen(target, options, wasm_target)
+  return True
+
 
 @ToolchainProfiler.profile_block('emscript')
 def phase_emscript(options, in_wasm, wasm_target, memfile):
@@ -2597,8 +2700,9 @@ def phase_emscript(options, in_wasm, wasm_target, memfile):
   if embed_memfile():
     settings.SUPPORT_BASE64_EMBEDDING = 1
 
-  emscripten.run(in_wasm, wasm_target, final_js, memfile)
+  metadata = emscripten.run(in_wasm, wasm_target, final_js, memfile)
   save_intermediate('original')
+  return metadata
 
 
 @ToolchainProfiler.profile_block('source transforms')
@@ -2726,6 +2830,9 @@ def phase_final_emitting(options, state, target, wasm_target, memfile):
   # The JS is now final. Move it to its final location
   move_file(final_js, js_target)
 
+  if settings.SNAPSHOT:
+    building.take_snapshot(js_target, wasm_target)
+
   if not settings.SINGLE_FILE:
     generated_text_files_with_native_eols += [js_target]
 
@@ -3159,6 +3266,9 @@ def phase_binaryen(target, options, wasm_target):
     diagnostics.warning('deprecated', 'We hope to remove support for EMIT_EMSCRIPTEN_METADATA. See https://github.com/emscripten-core/emscripten/issues/12231')
     webassembly.add_emscripten_metadata(wasm_target)
 
+  if settings.PRELINK_SIDE_MODULE:
+    webassembly.add_prelink_section(wasm_target)
+
   if final_js:
     if settings.SUPPORT_BIG_ENDIAN:
       final_js = building.little_endian_heap(final_js)
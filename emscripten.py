@@ -11,6 +11,7 @@ headers, for the libc implementation in JS).
 
 from tools.toolchain_profiler import ToolchainProfiler
 
+import copy
 import os
 import json
 import subprocess
@@ -25,6 +26,7 @@ from tools import diagnostics
 from tools import shared
 from tools import utils
 from tools import gen_struct_info
+from tools import js_compiler_cache
 from tools import webassembly
 from tools.utils import exit_with_error, path_from_root
 from tools.shared import WINDOWS, asmjs_mangle
@@ -168,17 +170,29 @@ def compile_settings():
     logger.info('logging stderr in js compiler phase into %s' % stderr_file)
     stderr_file = open(stderr_file, 'w')
 
-  # Save settings to a file to work around v8 issue 1579
-  with shared.configuration.get_temp_files().get_file('.txt') as settings_file:
-    with open(settings_file, 'w') as s:
-      json.dump(settings.dict(), s, sort_keys=True)
-
-    # Call js compiler
-    env = os.environ.copy()
-    env['EMCC_BUILD_DIR'] = os.getcwd()
-    out = shared.run_js_tool(path_from_root('src/compiler.js'),
-                             [settings_file], stdout=subprocess.PIPE, stderr=stderr_file,
-                             cwd=path_from_root('src'), env=env)
+  settings_json = json.dumps(settings.dict(), sort_keys=True)
+  cache_key = js_compiler_cache.get_key(settings_json)
+  out = None
+  if cache_key:
+    out = js_compiler_cache.lookup(cache_key)
+
+  if out is None:
+    temp_files = shared.configuration.get_temp_files()
+    # Save settings to a file to work around v8 issue 1579
+    with temp_files.get_file('.txt') as settings_file, temp_files.get_file('.json') as deps_file:
+      with open(settings_file, 'w') as s:
+        s.write(settings_json)
+
+      # Call js compiler
+      env = os.environ.copy()
+      env['EMCC_BUILD_DIR'] = os.getcwd()
+      if cache_key:
+        env.update(js_compiler_cache.get_env(deps_file))
+      out = shared.run_js_tool(path_from_root('src/compiler.js'),
+                               [settings_file], stdout=subprocess.PIPE, stderr=stderr_file,
+                               cwd=path_from_root('src'), env=env)
+      if cache_key:
+        js_compiler_cache.store(cache_key, deps_file, out)
   assert '//FORWARDED_DATA:' in out, 'Did not receive forwarded data in pre output - process failed?'
   glue, forwarded_data = out.split('//FORWARDED_DATA:')
   return glue, forwarded_data
@@ -293,6 +307,8 @@ def emscript(in_wasm, out_wasm, outfile_js, memfile, DEBUG):
     settings.WASM_BINARY_FILE = shared.JS.escape_for_js_string(os.path.basename(out_wasm))
 
   metadata = finalize_wasm(in_wasm, out_wasm, memfile, DEBUG)
+  # Returned for -s INCREMENTAL_LINK. Copied as the code below modifies it.
+  finalize_metadata = copy.deepcopy(metadata)
 
   update_settings_glue(metadata, DEBUG)
 
@@ -302,7 +318,7 @@ def emscript(in_wasm, out_wasm, outfile_js, memfile, DEBUG):
     if metadata['emJsFuncs']:
       exit_with_error('EM_JS is not supported in side modules')
     logger.debug('emscript: skipping remaining js glue generation')
-    return
+    return finalize_metadata
 
   if DEBUG:
     logger.debug('emscript: js compiler glue')
@@ -333,7 +349,7 @@ def emscript(in_wasm, out_wasm, outfile_js, memfile, DEBUG):
 
   if not outfile_js:
     logger.debug('emscript: skipping remaining js glue generation')
-    return
+    return finalize_metadata
 
   if settings.MINIMAL_RUNTIME:
     # In MINIMAL_RUNTIME, atinit exists in the postamble part
@@ -371,6 +387,8 @@ def emscript(in_wasm, out_wasm, outfile_js, memfile, DEBUG):
     out.write(normalize_line_endings(post))
     module = None
 
+  return finalize_metadata
+
 
 def remove_trailing_zeros(memfile):
   mem_data = utils.read_binary(memfile)
@@ -380,8 +398,9 @@ def remove_trailing_zeros(memfile):
   utils.write_binary(memfile, mem_data[:end])
 
 
-def finalize_wasm(infile, outfile, memfile, DEBUG):
-  building.save_intermediate(infile, 'base.wasm')
+def get_finalize_args(outfile, memfile):
+  """Returns the arguments for wasm-emscripten-finalize, and whether it needs to
+  modify the wasm."""
   # tell binaryen to look at the features section, and if there isn't one, to use MVP
   # (which matches what llvm+lld has given us)
   args = ['--minimize-wasm-changes']
@@ -394,8 +413,6 @@ def finalize_wasm(infile, outfile, memfile, DEBUG):
     # later processing later anyhow)
     modify_wasm = True
   if settings.GENERATE_SOURCE_MAP:
-    building.emit_wasm_source_map(infile, infile + '.map', outfile)
-    building.save_intermediate(infile + '.map', 'base_wasm.map')
     args += ['--output-source-map-url=' + settings.SOURCE_MAP_BASE + os.path.basename(outfile) + '.map']
     modify_wasm = True
   if settings.DEBUG_LEVEL >= 2 or settings.ASYNCIFY_ADD or settings.ASYNCIFY_ADVISE or settings.ASYNCIFY_ONLY or settings.ASYNCIFY_REMOVE or settings.EMIT_SYMBOL_MAP or settings.PROFILING_FUNCS:
@@ -435,6 +452,15 @@ def finalize_wasm(infile, outfile, memfile, DEBUG):
 
   if settings.DEBUG_LEVEL >= 3:
     args.append('--dwarf')
+  return args, modify_wasm
+
+
+def finalize_wasm(infile, outfile, memfile, DEBUG):
+  building.save_intermediate(infile, 'base.wasm')
+  if settings.GENERATE_SOURCE_MAP:
+    building.emit_wasm_source_map(infile, infile + '.map', outfile)
+    building.save_intermediate(infile + '.map', 'base_wasm.map')
+  args, modify_wasm = get_finalize_args(outfile, memfile)
   stdout = building.run_binaryen_command('wasm-emscripten-finalize',
                                          infile=infile,
                                          outfile=outfile if modify_wasm else None,
@@ -835,4 +861,4 @@ def generate_struct_info():
 def run(in_wasm, out_wasm, outfile_js, memfile):
   generate_struct_info()
 
-  emscript(in_wasm, out_wasm, outfile_js, memfile, shared.DEBUG)
+  return emscript(in_wasm, out_wasm, outfile_js, memfile, shared.DEBUG)
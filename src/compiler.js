@@ -15,6 +15,7 @@ print = (x) => {
 };
 
 printErr = (x) => {
+  compilerCache.clean = false;
   process['stderr'].write(x + '\n');
 };
 
@@ -31,7 +32,117 @@ function find(filename) {
 
 read = (filename) => {
   var absolute = find(filename);
-  return nodeFS.readFileSync(absolute).toString();
+  var data = nodeFS.readFileSync(absolute);
+  if (compilerCache.dir) {
+    compilerCache.filesRead[absolute] = compilerCache.hash(data);
+  }
+  return data.toString();
+};
+
+// Caching of our output, which emcc enables when JS_COMPILER_CACHE_SIZE is set
+// (see tools/js_compiler_cache.py). emcc looks up the whole output by the
+// settings, and reuses it as long as none of the files we read have changed.
+// When that fails, the preprocessed JS library files are still reused from
+// here, so that a change in one library does not mean preprocessing all of
+// them again.
+compilerCache = {
+  dir: process.env['EMCC_JS_COMPILER_CACHE'],
+  // Absolute paths of all files read so far, mapped to hashes of their
+  // contents. Written to EMCC_JS_COMPILER_DEPS for emcc.
+  filesRead: {},
+  // Output that came with diagnostics is not cached, so that they are shown
+  // again next time.
+  clean: true,
+  // A hash of the settings passed in by emcc.
+  settingsKey: '',
+  // A hash of everything that library preprocessing depends on besides the
+  // library itself: the settings, the compiler code and the library list.
+  libraryBaseKey: null,
+
+  hash(data) {
+    return require('crypto').createHash('sha256').update(data).digest('hex');
+  },
+
+  getLibraryBaseKey() {
+    if (!this.libraryBaseKey) {
+      var files = Object.keys(this.filesRead).sort().map((f) => [f, this.filesRead[f]]);
+      this.libraryBaseKey = this.hash(JSON.stringify([this.settingsKey, files, LibraryManager.libraries]));
+    }
+    return this.libraryBaseKey;
+  },
+
+  // Returns processMacros(preprocess(src, filename)), from the cache if
+  // possible.
+  preprocessLibrary(src, filename) {
+    if (!this.dir) {
+      return processMacros(preprocess(src, filename));
+    }
+    var key = this.hash(this.getLibraryBaseKey() + '\0' + filename + '\0' + src);
+    var entryPath = nodePath.join(this.dir, 'libraries', key + '.json');
+    var entry = null;
+    try {
+      entry = JSON.parse(nodeFS.readFileSync(entryPath).toString());
+    } catch (e) {
+      // Not cached yet.
+    }
+    // Files included by the library must not have changed either.
+    if (entry && Object.keys(entry.deps).every((f) => {
+      try {
+        return this.hash(nodeFS.readFileSync(f)) === entry.deps[f];
+      } catch (e) {
+        return false;
+      }
+    })) {
+      Object.assign(this.filesRead, entry.deps);
+      var now = new Date();
+      try {
+        nodeFS.utimesSync(entryPath, now, now);
+      } catch (e) {
+        // Only used to find the least recently used entries.
+      }
+      return entry.processed;
+    }
+
+    // Macros can have side effects, such as defining helpers for later macros
+    // or registering startup code. Only cache libraries whose preprocessing
+    // did none of that, and printed nothing.
+    var filesBefore = this.filesRead;
+    var globalsBefore = Object.keys(global).length;
+    var atCodeBefore = ATINITS.length + ATMAINS.length + ATEXITS.length;
+    var cleanBefore = this.clean;
+    this.filesRead = {};
+    this.clean = true;
+    var processed;
+    try {
+      processed = processMacros(preprocess(src, filename));
+    } finally {
+      var deps = this.filesRead;
+      var clean = this.clean;
+      this.filesRead = Object.assign(filesBefore, deps);
+      this.clean = cleanBefore && clean;
+    }
+    if (clean && Object.keys(global).length == globalsBefore &&
+        ATINITS.length + ATMAINS.length + ATEXITS.length == atCodeBefore) {
+      try {
+        nodeFS.mkdirSync(nodePath.dirname(entryPath), { recursive: true });
+        // Other processes may read the entry while we write it.
+        var tempPath = entryPath + '.' + process.pid + '.tmp';
+        nodeFS.writeFileSync(tempPath, JSON.stringify({ deps: deps, processed: processed }));
+        nodeFS.renameSync(tempPath, entryPath);
+      } catch (e) {
+        // The cache is only an optimization.
+      }
+    }
+    return processed;
+  },
+
+  // Tells emcc which files the output depends on, if it can be cached.
+  writeDeps() {
+    var depsFile = process.env['EMCC_JS_COMPILER_DEPS'];
+    if (this.dir && depsFile && this.clean && !abortExecution) {
+      nodeFS.writeFileSync(depsFile, JSON.stringify(this.filesRead));
+    }
+  },
 };
 
 function load(f) {
@@ -49,7 +160,12 @@ var arguments_ = process['argv'].slice(2);
 var settingsFile = arguments_[0];
 
 if (settingsFile) {
-  var settings = JSON.parse(read(settingsFile));
+  // Not read with read(): this is a temporary file, and emcc already keys its
+  // cache on the settings. The preprocessed libraries are keyed on them
+  // through settingsKey.
+  var settingsJSON = nodeFS.readFileSync(settingsFile).toString();
+  compilerCache.settingsKey = compilerCache.hash(settingsJSON);
+  var settings = JSON.parse(settingsJSON);
   for (var key in settings) {
     var value = settings[key];
     if (value[0] == '@') {
@@ -97,6 +213,8 @@ B = new Benchmarker();
 try {
   JSify();
 
+  compilerCache.writeDeps();
+
   B.print('glue');
 } catch(err) {
   if (err.toString().includes('Aborting compilation due to previous errors')) {
@@ -897,14 +897,22 @@ var LibraryEmbind = {
     });
   },
 
-  $runDestructors: function(destructors) {
-    while (destructors.length) {
+  // Runs, in reverse order, the destructors that were pushed after the first
+  // 'base' entries of the stack (all of them if 'base' is not given).
+  $runDestructors: function(destructors, base) {
+    base = base || 0;
+    while (destructors.length > base) {
         var ptr = destructors.pop();
         var del = destructors.pop();
         del(ptr);
     }
   },
 
+  // The stack of destructors that is shared by all invokers. Each call pushes
+  // the destructors for its arguments and runs them before returning, so calls
+  // don't need an array of their own.
+  $destructorStack: [],
+
   // Function implementation of operator new, per
   // http://www.ecma-international.org/publications/files/ECMA-ST/Ecma-262.pdf
   // 13.2.2
@@ -945,6 +953,8 @@ var LibraryEmbind = {
     '$makeLegalFunctionName', '$new_', '$runDestructors', '$throwBindingError',
   #if ASYNCIFY
     '$Asyncify',
+  #else
+    '$destructorStack',
   #endif
   ],
   $craftInvokerFunction: function(humanName, argTypes, classType, cppInvokerFunc, cppTargetFunc) {
@@ -988,26 +998,21 @@ var LibraryEmbind = {
     var expectedArgCount = argCount - 2;
     var argsWired = new Array(expectedArgCount);
     var invokerFuncArgs = [];
+#if ASYNCIFY
     var destructors = [];
-    return function() {
-      if (arguments.length !== expectedArgCount) {
-        throwBindingError('function ' + humanName + ' called with ' +
-          arguments.length + ' arguments, expected ' + expectedArgCount +
-          ' args!');
-      }
-#if EMSCRIPTEN_TRACING
-      Module.emscripten_trace_enter_context('embind::' + humanName);
+#else
+    var destructors = destructorStack;
 #endif
-      destructors.length = 0;
+    function invoke(self, args, destructorsBase) {
       var thisWired;
       invokerFuncArgs.length = isClassMethodFunc ? 2 : 1;
       invokerFuncArgs[0] = cppTargetFunc;
       if (isClassMethodFunc) {
-        thisWired = argTypes[1].toWireType(destructors, this);
+        thisWired = argTypes[1].toWireType(destructors, self);
         invokerFuncArgs[1] = thisWired;
       }
       for (var i = 0; i < expectedArgCount; ++i) {
-        argsWired[i] = argTypes[i + 2].toWireType(destructors, arguments[i]);
+        argsWired[i] = argTypes[i + 2].toWireType(destructors, args[i]);
         invokerFuncArgs.push(argsWired[i]);
       }
 
@@ -1015,7 +1020,11 @@ var LibraryEmbind = {
 
       function onDone(rv) {
         if (needsDestructorStack) {
+#if ASYNCIFY
           runDestructors(destructors);
+#else
+          runDestructors(destructors, destructorsBase);
+#endif
         } else {
           for (var i = isClassMethodFunc ? 1 : 2; i < argTypes.length; i++) {
             var param = i === 1 ? thisWired : argsWired[i - 2];
@@ -1041,6 +1050,31 @@ var LibraryEmbind = {
 #endif
 
       return onDone(rv);
+    }
+
+    return function() {
+      if (arguments.length !== expectedArgCount) {
+        throwBindingError('function ' + humanName + ' called with ' +
+          arguments.length + ' arguments, expected ' + expectedArgCount +
+          ' args!');
+      }
+#if EMSCRIPTEN_TRACING
+      Module.emscripten_trace_enter_context('embind::' + humanName);
+#endif
+#if ASYNCIFY
+      destructors.length = 0;
+      return invoke(this, arguments);
+#else
+      var destructorsBase = destructors.length;
+      try {
+        return invoke(this, arguments, destructorsBase);
+      } catch (e) {
+        // Don't leave the destructors of a failed call on the shared stack,
+        // where they would pile up or be run by an unrelated outer call.
+        runDestructors(destructors, destructorsBase);
+        throw e;
+      }
+#endif
     };
 #else
     var argsList = "";
@@ -1060,15 +1094,25 @@ var LibraryEmbind = {
     invokerFnBody += "Module.emscripten_trace_enter_context('embind::" + humanName + "');\n";
 #endif
 
+    var dtorStack = needsDestructorStack ? "destructors" : "null";
+    var args1 = ["throwBindingError", "invoker", "fn", "runDestructors", "retType", "classParam"];
+    var args2 = [throwBindingError, cppInvokerFunc, cppTargetFunc, runDestructors, argTypes[0], argTypes[1]];
+
     if (needsDestructorStack) {
+#if ASYNCIFY
+        // The destructors may only run after other calls have started.
         invokerFnBody +=
             "var destructors = [];\n";
+#else
+        invokerFnBody +=
+            "var destructors = destructorStack;\n" +
+            "var destructorsBase = destructors.length;\n" +
+            "try {\n";
+        args1.push("destructorStack");
+        args2.push(destructorStack);
+#endif
     }
 
-    var dtorStack = needsDestructorStack ? "destructors" : "null";
-    var args1 = ["throwBindingError", "invoker", "fn", "runDestructors", "retType", "classParam"];
-    var args2 = [throwBindingError, cppInvokerFunc, cppTargetFunc, runDestructors, argTypes[0], argTypes[1]];
-
 #if EMSCRIPTEN_TRACING
     args1.push("Module");
     args2.push(Module);
@@ -1098,7 +1142,11 @@ var LibraryEmbind = {
 #endif
 
     if (needsDestructorStack) {
+#if ASYNCIFY
         invokerFnBody += "runDestructors(destructors);\n";
+#else
+        invokerFnBody += "runDestructors(destructors, destructorsBase);\n";
+#endif
     } else {
         for (var i = isClassMethodFunc?1:2; i < argTypes.length; ++i) { // Skip return value at index 0 - it's not deleted here. Also skip class type if not a method.
             var paramName = (i === 1 ? "thisWired" : ("arg"+(i - 2)+"Wired"));
@@ -1127,6 +1175,18 @@ var LibraryEmbind = {
     invokerFnBody += "return Asyncify.currData ? Asyncify.whenDone().then(onDone) : onDone(" + (returns ? "rv" : "") +");\n"
 #endif
 
+#if !ASYNCIFY
+    if (needsDestructorStack) {
+        // Don't leave the destructors of a failed call on the shared stack,
+        // where they would pile up or be run by an unrelated outer call.
+        invokerFnBody +=
+            "} catch (e) {\n" +
+            "runDestructors(destructors, destructorsBase);\n" +
+            "throw e;\n" +
+            "}\n";
+    }
+#endif
+
     invokerFnBody += "}\n";
 
     args1.push(invokerFnBody);
@@ -1407,6 +1467,118 @@ var LibraryEmbind = {
     });
   },
 
+  $flatViewRegistrations: {},
+
+  _embind_register_flat_view__deps: ['$flatViewRegistrations', '$readLatin1String'],
+  _embind_register_flat_view: function(rawType, name, stride) {
+    flatViewRegistrations[rawType] = {
+        name: readLatin1String(name),
+        stride: stride,
+        fields: [],
+    };
+  },
+
+  _embind_register_flat_view_field__deps: ['$flatViewRegistrations', '$readLatin1String'],
+  _embind_register_flat_view_field: function(rawType, fieldName, dataTypeIndex, offset) {
+    flatViewRegistrations[rawType].fields.push({
+        fieldName: readLatin1String(fieldName),
+        dataTypeIndex: dataTypeIndex,
+        offset: offset,
+    });
+  },
+
+  // Returns the property descriptor for a field of the given type (an index
+  // into typeMapping in _embind_register_memory_view) at 'offset' bytes into
+  // the element that the 'ptr' property of 'this' points to.
+  $getFlatViewFieldDescriptor: function(dataTypeIndex, offset) {
+    switch (dataTypeIndex) {
+        case 0: return {
+            get: function() { return HEAP8[this.ptr + offset]; },
+            set: function(v) { HEAP8[this.ptr + offset] = v; },
+        };
+        case 1: return {
+            get: function() { return HEAPU8[this.ptr + offset]; },
+            set: function(v) { HEAPU8[this.ptr + offset] = v; },
+        };
+        case 2: return {
+            get: function() { return HEAP16[(this.ptr + offset) >> 1]; },
+            set: function(v) { HEAP16[(this.ptr + offset) >> 1] = v; },
+        };
+        case 3: return {
+            get: function() { return HEAPU16[(this.ptr + offset) >> 1]; },
+            set: function(v) { HEAPU16[(this.ptr + offset) >> 1] = v; },
+        };
+        case 4: return {
+            get: function() { return HEAP32[(this.ptr + offset) >> 2]; },
+            set: function(v) { HEAP32[(this.ptr + offset) >> 2] = v; },
+        };
+        case 5: return {
+            get: function() { return HEAPU32[(this.ptr + offset) >> 2]; },
+            set: function(v) { HEAPU32[(this.ptr + offset) >> 2] = v; },
+        };
+        case 6: return {
+            get: function() { return HEAPF32[(this.ptr + offset) >> 2]; },
+            set: function(v) { HEAPF32[(this.ptr + offset) >> 2] = v; },
+        };
+        case 7: return {
+            get: function() { return HEAPF64[(this.ptr + offset) >> 3]; },
+            set: function(v) { HEAPF64[(this.ptr + offset) >> 3] = v; },
+        };
+    }
+  },
+
+  // A flat view gives JS access to the fields of the elements of a C++ array
+  // in place, without copying them into objects like value_object does. get(i)
+  // returns the element object of the view, moved to index i, so iterating
+  // over the view does not allocate.
+  _embind_finalize_flat_view__deps: [
+    '$flatViewRegistrations', '$createNamedFunction', '$exposePublicSymbol',
+    '$getFlatViewFieldDescriptor', '$registerType', '$throwBindingError'],
+  _embind_finalize_flat_view: function(rawType) {
+    var reg = flatViewRegistrations[rawType];
+    delete flatViewRegistrations[rawType];
+
+    var name = reg.name;
+    var stride = reg.stride;
+
+    function Element() {
+        this.ptr = 0;
+    }
+    reg.fields.forEach(function(field) {
+        Object.defineProperty(Element.prototype, field.fieldName,
+                              getFlatViewFieldDescriptor(field.dataTypeIndex, field.offset));
+    });
+
+    var View = createNamedFunction(name, function(ptr, length) {
+        this.ptr = ptr;
+        this['length'] = length;
+        this.element = new Element();
+    });
+    View.prototype['get'] = function(i) {
+        if (!(i >= 0 && i < this['length'])) {
+            throwBindingError('Index ' + i + ' out of range for ' + name + ' of length ' + this['length']);
+        }
+        var element = this.element;
+        element.ptr = this.ptr + i * stride;
+        return element;
+    };
+    exposePublicSymbol(name, View);
+
+    function decodeFlatArray(handle) {
+        handle = handle >> 2;
+        var size = HEAPU32[handle]; // in elements
+        var data = HEAPU32[handle + 1];
+        return new View(data, size);
+    }
+
+    registerType(rawType, {
+        name: name,
+        'fromWireType': decodeFlatArray,
+        'argPackAdvance': 8,
+        'readValueFromPointer': decodeFlatArray,
+    });
+  },
+
   $genericPointerToWireType__deps: ['$throwBindingError', '$upcastPointer'],
   $genericPointerToWireType: function(destructors, handle) {
     var ptr;
@@ -1595,11 +1767,17 @@ var LibraryEmbind = {
         }
     } else {
         this['toWireType'] = genericPointerToWireType;
-        // Here we must leave this.destructorFunction undefined, since whether genericPointerToWireType returns
+        if (!isSmartPointer) {
+            // genericPointerToWireType only pushes destructors for smart pointers.
+            this.destructorFunction = null;
+        }
+        // Otherwise we must leave this.destructorFunction undefined, since whether genericPointerToWireType returns
         // a pointer that needs to be freed up is runtime-dependent, and cannot be evaluated at registration time.
-        // TODO: Create an alternative mechanism that allows removing the use of var destructors = []; array in
-        //       craftInvokerFunction altogether.
     }
+#if EMBIND_HANDLE_CACHE
+    // The handles that were returned for raw pointers of this type, by pointer.
+    this.handleCache = new Map();
+#endif
   },
 
   $RegisteredPointer_getPointee: function(ptr) {
@@ -1623,7 +1801,11 @@ var LibraryEmbind = {
 
   $RegisteredPointer_fromWireType__deps: [
     '$downcastPointer', '$registeredPointers',
-    '$getInheritedInstance', '$makeClassHandle'],
+    '$getInheritedInstance', '$makeClassHandle',
+#if EMBIND_HANDLE_CACHE
+    '$getCachedClassHandle',
+#endif
+  ],
   $RegisteredPointer_fromWireType: function(ptr) {
     // ptr is a raw pointer (or a raw smartpointer)
 
@@ -1659,10 +1841,14 @@ var LibraryEmbind = {
                 smartPtr: ptr,
             });
         } else {
+#if EMBIND_HANDLE_CACHE
+            return getCachedClassHandle(this, ptr);
+#else
             return makeClassHandle(this.registeredClass.instancePrototype, {
                 ptrType: this,
                 ptr: ptr,
             });
+#endif
         }
     }
 
@@ -1693,13 +1879,45 @@ var LibraryEmbind = {
             smartPtr: ptr,
         });
     } else {
+#if EMBIND_HANDLE_CACHE
+        return getCachedClassHandle(toType, dp);
+#else
         return makeClassHandle(toType.registeredClass.instancePrototype, {
             ptrType: toType,
             ptr: dp,
         });
+#endif
     }
   },
 
+#if EMBIND_HANDLE_CACHE
+  // Returns the handle that was last returned for the raw pointer 'ptr' of type
+  // 'ptrType', unless it has been deleted or garbage collected since, in which
+  // case a new handle takes its place. Where WeakRef is available the cache
+  // holds its handles weakly, so that it doesn't keep alive handles JS has
+  // dropped without deleting them.
+  $getCachedClassHandle__deps: ['$makeClassHandle', '$lookupCachedClassHandle'],
+  $getCachedClassHandle: function(ptrType, ptr) {
+    var handle = lookupCachedClassHandle(ptrType, ptr);
+    if (handle === undefined || !handle.$$.ptr) {
+        handle = makeClassHandle(ptrType.registeredClass.instancePrototype, {
+            ptrType: ptrType,
+            ptr: ptr,
+        });
+        ptrType.handleCache.set(ptr, typeof WeakRef === 'undefined' ? handle : new WeakRef(handle));
+    }
+    return handle;
+  },
+
+  $lookupCachedClassHandle: function(ptrType, ptr) {
+    var entry = ptrType.handleCache.get(ptr);
+    if (entry === undefined || typeof WeakRef === 'undefined') {
+        return entry;
+    }
+    return entry.deref();
+  },
+#endif
+
   $runDestructor: function($$) {
     if ($$.smartPtr) {
         $$.smartPtrType.rawDestructor($$.smartPtr);
@@ -1845,7 +2063,11 @@ var LibraryEmbind = {
   },
 
   $ClassHandle_delete__deps: ['$releaseClassHandle', '$throwBindingError',
-                              '$detachFinalizer', '$throwInstanceAlreadyDeleted'],
+                              '$detachFinalizer', '$throwInstanceAlreadyDeleted',
+#if EMBIND_HANDLE_CACHE
+                              '$lookupCachedClassHandle',
+#endif
+  ],
   $ClassHandle_delete: function() {
     if (!this.$$.ptr) {
         throwInstanceAlreadyDeleted(this);
@@ -1859,6 +2081,11 @@ var LibraryEmbind = {
     releaseClassHandle(this.$$);
 
     if (!this.$$.preservePointerOnDelete) {
+#if EMBIND_HANDLE_CACHE
+        if (lookupCachedClassHandle(this.$$.ptrType, this.$$.ptr) === this) {
+            this.$$.ptrType.handleCache.delete(this.$$.ptr);
+        }
+#endif
         this.$$.smartPtr = undefined;
         this.$$.ptr = undefined;
     }
@@ -12,7 +12,7 @@ function headlessCanvas() {
       switch (which) {
         case 'webgl':
         case 'experimental-webgl': {
-          return {
+          var ctx = {
             /* ClearBufferMask */
             DEPTH_BUFFER_BIT               : 0x00000100,
             STENCIL_BUFFER_BIT             : 0x00000400,
@@ -526,8 +526,8 @@ function headlessCanvas() {
             texImage2D: function(){},
             compressedTexImage2D: function(){},
             useProgram: function(){},
-            getUniformLocation: function() {
-              return null;
+            getUniformLocation: function(program, name) {
+              return { name: name };
             },
             getActiveUniform: function(program, index) {
               return {
@@ -537,8 +537,11 @@ function headlessCanvas() {
               };
             },
             clear: function(){},
+            uniform1f: function(){},
             uniform4fv: function(){},
             uniform1i: function(){},
+            uniformMatrix3fv: function(){},
+            uniformMatrix4fv: function(){},
             getAttribLocation: function() { return 1 },
             vertexAttribPointer: function(){},
             enableVertexAttribArray: function(){},
@@ -576,8 +579,23 @@ function headlessCanvas() {
             scissor: function(){},
             colorMask: function(){},
             lineWidth: function(){},
+            vertexAttrib4f: function(){},
             vertexAttrib4fv: function(){},
+            flush: function(){},
+            finish: function(){},
           };
+          // Count the calls to each function, so that tests can check how much work reaches WebGL.
+          ctx.calls = {};
+          Object.keys(ctx).forEach(function(name) {
+            var func = ctx[name];
+            if (typeof func !== 'function') return;
+            ctx.calls[name] = 0;
+            ctx[name] = function() {
+              ctx.calls[name]++;
+              return func.apply(this, arguments);
+            };
+          });
+          return ctx;
         }
         case '2d': {
           return {
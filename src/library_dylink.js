@@ -119,9 +119,75 @@ var LibraryDylink = {
 #endif
   },
 
-  // Applies relocations to exported things.
-  $relocateExports__deps: ['$updateGOT'],
-  $relocateExports: function(exports, memoryBase, replace) {
+  // Updates the GOT from the exports of a prelinked side module, whose GOT
+  // exports are listed in its prelink section (see getPrelinkMetadata). The
+  // table is grown once for all the functions that need a table entry.
+  $updatePrelinkedGOT__deps: ['$GOT', '$reserveTableSlots'],
+  $updatePrelinkedGOT: function(exports, gotExports) {
+#if DYLINK_DEBUG
+    err("updatePrelinkedGOT: adding " + gotExports.length + " symbols");
+#endif
+    var PRELINK_FUNC = 0x1;
+    var PRELINK_REPLACE = 0x2;
+    var entries = [];
+    var funcs = [];
+    var newFuncs = 0;
+    for (var i = 0; i < gotExports.length; i++) {
+      var gotExport = gotExports[i];
+      var entry = GOT[gotExport.symName];
+      if (!entry) {
+        entry = GOT[gotExport.symName] = new WebAssembly.Global({'value': 'i32', 'mutable': true});
+      }
+      if (!(gotExport.flags & PRELINK_REPLACE) && entry.value != 0) {
+        continue;
+      }
+      var value = exports[gotExport.name];
+      if (gotExport.flags & PRELINK_FUNC) {
+        entries.push(entry);
+        funcs.push(value);
+        if (!functionsInTableMap.has(value)) {
+          newFuncs++;
+        }
+      } else {
+        entry.value = value;
+      }
+    }
+    reserveTableSlots(newFuncs);
+    for (var i = 0; i < funcs.length; i++) {
+      entries[i].value = addFunctionWasm(funcs[i]);
+    }
+#if DYLINK_DEBUG
+    err("done updatePrelinkedGOT: " + newFuncs + " new table entries");
+#endif
+  },
+
+  // Makes sure that the next `count` functions added to the table do not have
+  // to grow it, by growing it once for all of them.
+  $reserveTableSlots: function(count) {
+    var needed = count - freeTableIndexes.length;
+    if (needed <= 0) {
+      return;
+    }
+    var base = wasmTable.length;
+    try {
+      wasmTable.grow(needed);
+    } catch (err) {
+      if (!(err instanceof RangeError)) {
+        throw err;
+      }
+      throw 'Unable to grow wasm table. Set ALLOW_TABLE_GROWTH.';
+    }
+    // getEmptyTableSlot pops from the end, so push in reverse to use the new
+    // slots in order.
+    for (var i = wasmTable.length - 1; i >= base; i--) {
+      freeTableIndexes.push(i);
+    }
+  },
+
+  // Applies relocations to exported things. `prelink` is the prelink metadata
+  // of the module the exports come from, if it has any.
+  $relocateExports__deps: ['$updateGOT', '$updatePrelinkedGOT'],
+  $relocateExports: function(exports, memoryBase, replace, prelink) {
     var relocated = {};
 
     for (var e in exports) {
@@ -143,16 +209,25 @@ var LibraryDylink = {
       }
       relocated[e] = value;
     }
-    updateGOT(relocated, replace);
+    if (prelink) {
+      updatePrelinkedGOT(relocated, prelink.gotExports);
+    } else {
+      updateGOT(relocated, replace);
+    }
     return relocated;
   },
 
+  // Resolves the GOT entries that are still undefined from the main module.
+  // By default the whole GOT is checked; prelinked side modules pass the
+  // names of their own GOT imports.
   $reportUndefinedSymbols__deps: ['$GOT', '$resolveGlobalSymbol'],
-  $reportUndefinedSymbols: function() {
+  $reportUndefinedSymbols: function(symNames) {
 #if DYLINK_DEBUG
     err('reportUndefinedSymbols');
 #endif
-    for (var symName in GOT) {
+    symNames = symNames || Object.keys(GOT);
+    for (var i = 0; i < symNames.length; i++) {
+      var symName = symNames[i];
       if (GOT[symName].value == 0) {
         var value = resolveGlobalSymbol(symName, true)
 #if ASSERTIONS
@@ -196,6 +271,8 @@ var LibraryDylink = {
     loadedLibsByName: {},
     // handle  -> dso; Used by dlsym
     loadedLibsByHandle: {},
+    // layout hash -> prelink metadata; Used by getPrelinkMetadata
+    prelinkedLayouts: {},
   },
 
   $dlSetError: ['___dl_seterr',
@@ -367,6 +444,105 @@ var LibraryDylink = {
     return customSection;
   },
 
+  // Returns the metadata in the prelink section that emcc adds to side modules
+  // built with -s PRELINK_SIDE_MODULE (see add_prelink_section in
+  // tools/webassembly.py), or null if there is no such section:
+  // { imports, gotImports, gotExports, values }
+  // The metadata is shared by all the modules with the same layout, and
+  // `values` holds what their imports resolved to, so that they are only
+  // resolved once.
+  $getPrelinkMetadata__deps: ['$LDSO'],
+  $getPrelinkMetadata: function(binary) {
+    var offset = 0;
+
+    function getU8() {
+      return binary[offset++];
+    }
+
+    function getLEB() {
+      var ret = 0;
+      var mul = 1;
+      while (1) {
+        var byte = binary[offset++];
+        ret += ((byte & 0x7f) * mul);
+        mul *= 0x80;
+        if (!(byte & 0x80)) break;
+      }
+      return ret;
+    }
+
+    function getString() {
+      var len = getLEB();
+      offset += len;
+      return UTF8ArrayToString(binary, offset - len, len);
+    }
+
+    var name = 'emscripten.prelink';
+    if (binary instanceof WebAssembly.Module) {
+      var prelinkSection = WebAssembly.Module.customSections(binary, name);
+      if (prelinkSection.length === 0) {
+        return null;
+      }
+      binary = new Uint8Array(prelinkSection[0]);
+    } else {
+      // The prelink section is the last one, so skip over the others, without
+      // looking into anything but the names of custom sections.
+      offset = 8;
+      var found = false;
+      while (offset < binary.length) {
+        var id = getU8();
+        var sectionSize = getLEB();
+        var sectionEnd = offset + sectionSize;
+        if (id === 0 && getString() === name) {
+          found = true;
+          break;
+        }
+        offset = sectionEnd;
+      }
+      if (!found) {
+        return null;
+      }
+    }
+
+    var version = getLEB();
+    if (version !== 1) {
+#if ASSERTIONS
+      err('unsupported prelink section version: ' + version);
+#endif
+      return null;
+    }
+    var layout = getString();
+    var prelink = LDSO.prelinkedLayouts[layout];
+    if (prelink) {
+#if DYLINK_DEBUG
+      err('getPrelinkMetadata: known layout ' + layout);
+#endif
+      return prelink;
+    }
+
+    prelink = { imports: [], gotImports: [], gotExports: [], values: [] };
+    var count = getLEB();
+    while (count--) {
+      var moduleName = getString();
+      var field = getString();
+      prelink.imports.push({ module: moduleName, field: field });
+      if (moduleName === 'GOT.mem' || moduleName === 'GOT.func') {
+        prelink.gotImports.push(field);
+      }
+    }
+    count = getLEB();
+    while (count--) {
+      var exportName = getString();
+      var symName = getString();
+      prelink.gotExports.push({ name: exportName, symName: symName, flags: getLEB() });
+    }
+#if DYLINK_DEBUG
+    err('getPrelinkMetadata: new layout ' + layout + ': ' + prelink.imports.length + ' imports, ' + prelink.gotExports.length + ' GOT exports');
+#endif
+    LDSO.prelinkedLayouts[layout] = prelink;
+    return prelink;
+  },
+
   // Module.symbols <- libModule.symbols (flags.global handler)
   $mergeLibSymbols__deps: ['$asmjsMangle'],
   $mergeLibSymbols: function(exports, libName) {
@@ -405,9 +581,10 @@ var LibraryDylink = {
 
   // Loads a side module from binary data or compiled Module. Returns the module's exports or a
   // promise that resolves to its exports if the loadAsync flag is set.
-  $loadWebAssemblyModule__deps: ['$loadDynamicLibrary', '$createInvokeFunction', '$getMemory', '$relocateExports', '$resolveGlobalSymbol', '$GOTHandler', '$getDylinkMetadata', '$alignMemory'],
+  $loadWebAssemblyModule__deps: ['$loadDynamicLibrary', '$createInvokeFunction', '$getMemory', '$relocateExports', '$resolveGlobalSymbol', '$GOT', '$GOTHandler', '$getDylinkMetadata', '$getPrelinkMetadata', '$reportUndefinedSymbols', '$alignMemory'],
   $loadWebAssemblyModule: function(binary, flags) {
     var metadata = getDylinkMetadata(binary);
+    var prelink = getPrelinkMetadata(binary);
 #if ASSERTIONS
     var originalTable = wasmTable;
 #endif
@@ -466,6 +643,15 @@ var LibraryDylink = {
         return resolved;
       }
 
+      // Returns a stub function that will resolve the symbol when first called.
+      function createStub(sym) {
+        var resolved;
+        return function() {
+          if (!resolved) resolved = resolveSymbol(sym, true);
+          return resolved.apply(null, arguments);
+        };
+      }
+
       // TODO kill ↓↓↓ (except "symbols local to this module", it will likely be
       // not needed if we require that if A wants symbols from B it has to link
       // to B explicitly: similarly to -Wl,--no-undefined)
@@ -490,25 +676,58 @@ var LibraryDylink = {
             // No stub needed, symbol already exists in symbol table
             return asmLibraryArg[prop];
           }
-          // Return a stub function that will resolve the symbol
-          // when first called.
           if (!(prop in stubs)) {
-            var resolved;
-            stubs[prop] = function() {
-              if (!resolved) resolved = resolveSymbol(prop, true);
-              return resolved.apply(null, arguments);
-            };
+            stubs[prop] = createStub(prop);
           }
           return stubs[prop];
         }
       };
-      var proxy = new Proxy({}, proxyHandler);
-      var info = {
-        'GOT.mem': new Proxy({}, GOTHandler),
-        'GOT.func': new Proxy({}, GOTHandler),
-        'env': proxy,
-        {{{ WASI_MODULE_NAME }}}: proxy,
-      };
+
+      // Prelinked modules list their imports, so they can be bound without a
+      // proxy. Only symbols that were not found, and the symbols local to
+      // this module, are resolved again by the next module with this layout.
+      // This relies on symbols in asmLibraryArg and GOT entries never being
+      // replaced once they exist.
+      function getPrelinkedImports() {
+        var imports = {};
+        var values = prelink.values;
+        for (var i = 0; i < prelink.imports.length; i++) {
+          var imp = prelink.imports[i];
+          var value = values[i];
+          if (value === undefined) {
+            if (imp.module === 'GOT.mem' || imp.module === 'GOT.func') {
+              value = values[i] = GOTHandler['get'](GOT, imp.field);
+            } else if (imp.field === '__memory_base') {
+              value = memoryBase;
+            } else if (imp.field === '__table_base') {
+              value = tableBase;
+            } else if (imp.field in asmLibraryArg) {
+              value = values[i] = asmLibraryArg[imp.field];
+            } else {
+              value = createStub(imp.field);
+            }
+          }
+          var moduleImports = imports[imp.module];
+          if (!moduleImports) {
+            moduleImports = imports[imp.module] = {};
+          }
+          moduleImports[imp.field] = value;
+        }
+        return imports;
+      }
+
+      var info;
+      if (prelink) {
+        info = getPrelinkedImports();
+      } else {
+        var proxy = new Proxy({}, proxyHandler);
+        info = {
+          'GOT.mem': new Proxy({}, GOTHandler),
+          'GOT.func': new Proxy({}, GOTHandler),
+          'env': proxy,
+          {{{ WASI_MODULE_NAME }}}: proxy,
+        };
+      }
 
       function postInstantiation(instance) {
 #if ASSERTIONS
@@ -527,9 +746,9 @@ var LibraryDylink = {
             functionsInTableMap.set(item, tableBase + i);
           }
         }
-        moduleExports = relocateExports(instance.exports, memoryBase);
+        moduleExports = relocateExports(instance.exports, memoryBase, false, prelink);
         if (!flags.allowUndefined) {
-          reportUndefinedSymbols();
+          reportUndefinedSymbols(prelink ? prelink.gotImports : undefined);
         }
 #if STACK_OVERFLOW_CHECK >= 2
         moduleExports['__set_stack_limits']({{{ STACK_BASE }}} , {{{ STACK_MAX }}});
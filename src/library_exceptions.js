@@ -360,6 +360,14 @@ var LibraryExceptions = {
     ___cxa_rethrow();
   },
 
+  // Used by the native __cxa_find_matching_catch_N functions in
+  // libc++abi (cxa_exception_emscripten.cpp).
+  _emscripten_get_exception_last__deps: ['$exceptionLast'],
+  _emscripten_get_exception_last__sig: 'i',
+  _emscripten_get_exception_last: function() {
+    return exceptionLast;
+  },
+
   // Finds a suitable catch clause for when an exception is thrown.
   // In normal compilers, this functionality is handled by the C++
   // 'personality' routine. This is passed a fairly complex structure
@@ -368,7 +376,9 @@ var LibraryExceptions = {
   // catch clause, and some of it is about unwinding. We already handle
   // unwinding using 'if' blocks around each function, so the remaining
   // functionality boils down to picking a suitable 'catch' block.
-  // We'll do that here, instead, to keep things simpler.
+  // libc++abi does that natively for landing pads with up to 7 catch
+  // clauses (see cxa_exception_emscripten.cpp), and caches the results of
+  // matching class types. Landing pads with more clauses end up here.
   __cxa_find_matching_catch__deps: ['$exceptionLast', '$ExceptionInfo', '$CatchInfo', '__resumeException', '__cxa_can_catch'],
   __cxa_find_matching_catch: function() {
     var thrown = exceptionLast;
@@ -4,6 +4,19 @@
  * SPDX-License-Identifier: MIT
  */
 
+{{{ (function() {
+  // Helper functions for code generation
+  global.glemu = {
+    // With GL_BATCH_IMMEDIATE_MODE, draws the glBegin/glEnd blocks that are still held back. This
+    // must happen before any of the state that they are drawn with changes.
+    flushBatch: function() {
+      if (!GL_BATCH_IMMEDIATE_MODE) return '';
+      return 'if (GLImmediate.batchVertexCounter) GLImmediate.flushBatch();';
+    },
+  };
+  return null;
+})(); }}}
+
 var LibraryGLEmulation = {
   // GL emulation: provides misc. functionality not present in OpenGL ES 2.0 or WebGL
   $GLEmulation__deps: ['$GLImmediateSetup', 'glEnable', 'glDisable', 'glIsEnabled', 'glGetBooleanv', 'glGetIntegerv', 'glGetString', 'glCreateShader', 'glShaderSource', 'glCompileShader', 'glAttachShader', 'glDetachShader', 'glUseProgram', 'glDeleteProgram', 'glBindAttribLocation', 'glLinkProgram', 'glBindBuffer', 'glGetFloatv', 'glHint', 'glEnableVertexAttribArray', 'glDisableVertexAttribArray', 'glVertexAttribPointer', 'glActiveTexture', '$stringToNewUTF8'],
@@ -87,6 +100,26 @@ var LibraryGLEmulation = {
     // GL_POINTS support.
     pointSize: 1.0,
 
+    // The fixed-function state that selects the emulation shader, packed into bits so that
+    // GLImmediate.getRenderer does not have to gather it on every draw. It is kept up to date
+    // as that state changes:
+    //   bits 0-2:   alpha test function - GL_NEVER, or 7 when alpha testing is disabled
+    //   bits 3-10:  GL_LIGHT0 to GL_LIGHT7
+    //   bit  11:    GL_LIGHTING
+    //   bits 12-17: GL_CLIP_PLANE0 to GL_CLIP_PLANE5
+    //   bits 18-19: fog mode, or 0 when fog is disabled
+    ffpStateKey: 0x7,
+    LIGHTS_STATE_MASK: 0xFF << 3,
+
+    // Version numbers of the data behind the uniforms of the emulation shaders. Like the matrix
+    // versions in GLImmediate, they let each renderer upload only the uniforms that changed since
+    // it last drew.
+    fogVersion: 0,
+    clipPlaneVersion: 0,
+    lightingVersion: 0,
+    alphaTestVersion: 0,
+    pointSizeVersion: 0,
+
     // VAO support
     vaos: [],
     currentVao: null,
@@ -94,6 +127,29 @@ var LibraryGLEmulation = {
 
     hasRunInit: false,
 
+    updateFogStateKey: function() {
+      var fogParam = 0;
+      if (GLEmulation.fogEnabled) {
+        switch (GLEmulation.fogMode) {
+          case 0x801: // GL_EXP2
+            fogParam = 1;
+            break;
+          case 0x2601: // GL_LINEAR
+            fogParam = 2;
+            break;
+          default: // default to GL_EXP
+            fogParam = 3;
+            break;
+        }
+      }
+      GLEmulation.ffpStateKey = (GLEmulation.ffpStateKey & ~(0x3 << 18)) | (fogParam << 18);
+    },
+
+    updateAlphaTestStateKey: function() {
+      var alphaParam = GLEmulation.alphaTestEnabled ? (GLEmulation.alphaTestFunc - 0x200) : 0x7;
+      GLEmulation.ffpStateKey = (GLEmulation.ffpStateKey & ~0x7) | alphaParam;
+    },
+
     // Find a token in a shader source string
     findToken: function(source, token) {
       function isIdentChar(ch) {
@@ -193,39 +249,41 @@ var LibraryGLEmulation = {
 
       var glEnable = _glEnable;
       _glEnable = _emscripten_glEnable = function _glEnable(cap) {
+        {{{ glemu.flushBatch() }}}
         // Clean up the renderer on any change to the rendering state. The optimization of
         // skipping renderer setup is aimed at the case of multiple glDraw* right after each other
         if (GLImmediate.lastRenderer) GLImmediate.lastRenderer.cleanup();
+        // Fog, clip planes, lights and alpha testing are part of the FFP shader state, see ffpStateKey.
         if (cap == 0xB60 /* GL_FOG */) {
           if (GLEmulation.fogEnabled != true) {
-            GLImmediate.currentRenderer = null; // Fog parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.fogEnabled = true;
+            GLEmulation.updateFogStateKey();
           }
           return;
         } else if ((cap >= 0x3000) && (cap < 0x3006)  /* GL_CLIP_PLANE0 to GL_CLIP_PLANE5 */) {
           var clipPlaneId = cap - 0x3000;
           if (GLEmulation.clipPlaneEnabled[clipPlaneId] != true) {
-            GLImmediate.currentRenderer = null; // clip plane parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.clipPlaneEnabled[clipPlaneId] = true;
+            GLEmulation.ffpStateKey |= 1 << (12 + clipPlaneId);
           }
           return;
         } else if ((cap >= 0x4000) && (cap < 0x4008)  /* GL_LIGHT0 to GL_LIGHT7 */) {
           var lightId = cap - 0x4000;
           if (GLEmulation.lightEnabled[lightId] != true) {
-            GLImmediate.currentRenderer = null; // light parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.lightEnabled[lightId] = true;
+            GLEmulation.ffpStateKey |= 1 << (3 + lightId);
           }
           return;
         } else if (cap == 0xB50 /* GL_LIGHTING */) {
           if (GLEmulation.lightingEnabled != true) {
-            GLImmediate.currentRenderer = null; // light parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.lightingEnabled = true;
+            GLEmulation.ffpStateKey |= 1 << 11;
           }
           return;
         } else if (cap == 0xBC0 /* GL_ALPHA_TEST */) {
           if (GLEmulation.alphaTestEnabled != true) {
-            GLImmediate.currentRenderer = null; // alpha testing is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.alphaTestEnabled = true;
+            GLEmulation.updateAlphaTestStateKey();
           }
           return;
         } else if (cap == 0xDE1 /* GL_TEXTURE_2D */) {
@@ -245,37 +303,38 @@ var LibraryGLEmulation = {
 
       var glDisable = _glDisable;
       _glDisable = _emscripten_glDisable = function _glDisable(cap) {
+        {{{ glemu.flushBatch() }}}
         if (GLImmediate.lastRenderer) GLImmediate.lastRenderer.cleanup();
         if (cap == 0xB60 /* GL_FOG */) {
           if (GLEmulation.fogEnabled != false) {
-            GLImmediate.currentRenderer = null; // Fog parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.fogEnabled = false;
+            GLEmulation.updateFogStateKey();
           }
           return;
         } else if ((cap >= 0x3000) && (cap < 0x3006)  /* GL_CLIP_PLANE0 to GL_CLIP_PLANE5 */) {
           var clipPlaneId = cap - 0x3000;
           if (GLEmulation.clipPlaneEnabled[clipPlaneId] != false) {
-            GLImmediate.currentRenderer = null; // clip plane parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.clipPlaneEnabled[clipPlaneId] = false;
+            GLEmulation.ffpStateKey &= ~(1 << (12 + clipPlaneId));
           }
           return;
         } else if ((cap >= 0x4000) && (cap < 0x4008)  /* GL_LIGHT0 to GL_LIGHT7 */) {
           var lightId = cap - 0x4000;
           if (GLEmulation.lightEnabled[lightId] != false) {
-            GLImmediate.currentRenderer = null; // light parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.lightEnabled[lightId] = false;
+            GLEmulation.ffpStateKey &= ~(1 << (3 + lightId));
           }
           return;
         } else if (cap == 0xB50 /* GL_LIGHTING */) {
           if (GLEmulation.lightingEnabled != false) {
-            GLImmediate.currentRenderer = null; // light parameter is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.lightingEnabled = false;
+            GLEmulation.ffpStateKey &= ~(1 << 11);
           }
           return;
         } else if (cap == 0xBC0 /* GL_ALPHA_TEST */) {
           if (GLEmulation.alphaTestEnabled != false) {
-            GLImmediate.currentRenderer = null; // alpha testing is part of the FFP shader state, we must re-lookup the renderer to use.
             GLEmulation.alphaTestEnabled = false;
+            GLEmulation.updateAlphaTestStateKey();
           }
           return;
         } else if (cap == 0xDE1 /* GL_TEXTURE_2D */) {
@@ -603,6 +662,7 @@ var LibraryGLEmulation = {
 
       var glUseProgram = _glUseProgram;
       _glUseProgram = _emscripten_glUseProgram = function _glUseProgram(program) {
+        {{{ glemu.flushBatch() }}}
 #if GL_DEBUG
         if (GL.debug) {
           err('[using program with shaders]');
@@ -653,6 +713,7 @@ var LibraryGLEmulation = {
 
       var glBindBuffer = _glBindBuffer;
       _glBindBuffer = _emscripten_glBindBuffer = function _glBindBuffer(target, buffer) {
+        {{{ glemu.flushBatch() }}}
         glBindBuffer(target, buffer);
         if (target == GLctx.ARRAY_BUFFER) {
           if (GLEmulation.currentVao) {
@@ -2027,12 +2088,27 @@ var LibraryGLEmulation = {
     clientAttributes: [], // raw data, including possible unneeded ones
     liveClientAttributes: [], // the ones actually alive in the current computation, sorted
     currentRenderer: null, // Caches the currently active FFP emulation renderer, so that it does not have to be re-looked up unless relevant state changes.
+    renderersByKey: {}, // The renderers used since the current program or texture environment changed, by their attribute and FFP state keys.
+    enabledAttributesKey: 0, // Bit mask of liveClientAttributes.
     modifiedClientAttributes: false,
     clientActiveTexture: 0,
     clientColor: null,
     usedTexUnitList: [],
     fixedFunctionProgram: null,
 
+#if GL_BATCH_IMMEDIATE_MODE
+    // glBegin/glEnd blocks that were held back to be drawn together with the following ones. Their
+    // vertices are at the start of tempData, and they all have the same mode and layout.
+    batchVertexCounter: 0, // Number of floats of vertex data in the held back blocks, 0 if there are none.
+    batchMode: -1,
+    batchClientAttributes: null,
+    batchEnabledClientAttributes: null,
+    batchFlushScheduled: false,
+    beginVertexCounter: 0, // Where the vertex data of the current glBegin/glEnd block starts.
+    // Number of vertices per primitive of the modes whose blocks can be drawn together.
+    batchPrimitiveSizes: [1 /*GL_POINTS*/, 2 /*GL_LINES*/, 0, 0, 3 /*GL_TRIANGLES*/, 0, 0, 4 /*GL_QUADS*/],
+#endif
+
     setClientAttribute: function setClientAttribute(name, size, type, stride, pointer) {
       var attrib = GLImmediate.clientAttributes[name];
       if (!attrib) {
@@ -2088,63 +2164,43 @@ var LibraryGLEmulation = {
     },
 
     getRenderer: function getRenderer() {
-      // If no FFP state has changed that would have forced to re-evaluate which FFP emulation shader to use,
-      // we have the currently used renderer in cache, and can immediately return that.
-      if (GLImmediate.currentRenderer) {
-        return GLImmediate.currentRenderer;
+      var attributesKey = GLImmediate.enabledAttributesKey;
+      var stateKey = GLEmulation.ffpStateKey;
+      // The enabled lights only matter when lighting is enabled.
+      if (!GLEmulation.lightingEnabled) stateKey &= ~GLEmulation.LIGHTS_STATE_MASK;
+      // By drawing mode:
+      stateKey = (stateKey << 1) | (GLImmediate.mode == GLctx.POINTS ? 1 : 0);
+
+      // If the attributes and the FFP state are the same as for the last draw, we have the currently
+      // used renderer in cache, and can immediately return that.
+      var renderer = GLImmediate.currentRenderer;
+      if (renderer) {
+        if (renderer.attributesKey === attributesKey && renderer.stateKey === stateKey) {
+          return renderer;
+        }
+      } else {
+        // State that is not part of the keys above changed (the current program or the texture
+        // environment), so the renderers that were found for them so far may not apply anymore.
+        GLImmediate.renderersByKey = {};
+      }
+      // Renderers that were used since that state last changed are found by the two keys alone.
+      // attributesKey has at most 31 bits and stateKey 21, so they fit together in a double.
+      var key = attributesKey * 0x200000 + stateKey;
+      renderer = GLImmediate.renderersByKey[key];
+      if (renderer) {
+        GLImmediate.currentRenderer = renderer;
+        return renderer;
       }
-      // return a renderer object given the liveClientAttributes
+
+      // Otherwise look it up by the full state.
       // we maintain a cache of renderers, optimized to not generate garbage
-      var attributes = GLImmediate.liveClientAttributes;
       var cacheMap = GLImmediate.rendererCache;
       var keyView = cacheMap.getStaticKeyView().reset();
 
       // By attrib state:
-      var enabledAttributesKey = 0;
-      for (var i = 0; i < attributes.length; i++) {
-        enabledAttributesKey |= 1 << attributes[i].name;
-      }
-
-      // To prevent using more than 31 bits add another level to the maptree
-      // and reset the enabledAttributesKey for the next glemulation state bits
-      keyView.next(enabledAttributesKey);
-      enabledAttributesKey = 0;
-
-      // By fog state:
-      var fogParam = 0;
-      if (GLEmulation.fogEnabled) {
-        switch (GLEmulation.fogMode) {
-          case 0x801: // GL_EXP2
-            fogParam = 1;
-            break;
-          case 0x2601: // GL_LINEAR
-            fogParam = 2;
-            break;
-          default: // default to GL_EXP
-            fogParam = 3;
-            break;
-        }
-      }
-      enabledAttributesKey = (enabledAttributesKey << 2) | fogParam;
-
-      // By clip plane mode
-      for (var clipPlaneId = 0; clipPlaneId < GLEmulation.MAX_CLIP_PLANES; clipPlaneId++) {
-        enabledAttributesKey = (enabledAttributesKey << 1) | GLEmulation.clipPlaneEnabled[clipPlaneId];
-      }
-
-      // By lighting mode and enabled lights
-      enabledAttributesKey = (enabledAttributesKey << 1) | GLEmulation.lightingEnabled;
-      for (var lightId = 0; lightId < GLEmulation.MAX_LIGHTS; lightId++) {
-        enabledAttributesKey = (enabledAttributesKey << 1) | (GLEmulation.lightingEnabled ? GLEmulation.lightEnabled[lightId] : 0);
-      }
-
-      // By alpha testing mode
-      enabledAttributesKey = (enabledAttributesKey << 3) | (GLEmulation.alphaTestEnabled ? (GLEmulation.alphaTestFunc - 0x200) : 0x7);
-
-      // By drawing mode:
-      enabledAttributesKey = (enabledAttributesKey << 1) | (GLImmediate.mode == GLctx.POINTS ? 1 : 0);
-
-      keyView.next(enabledAttributesKey);
+      keyView.next(attributesKey);
+      // By fog, clip plane, lighting and alpha testing mode, and drawing mode:
+      keyView.next(stateKey);
 
 #if !GL_FFP_ONLY
       // By cur program:
@@ -2157,16 +2213,17 @@ var LibraryGLEmulation = {
 #endif
 
       // If we don't already have it, create it.
-      var renderer = keyView.get();
+      renderer = keyView.get();
       if (!renderer) {
 #if GL_DEBUG
-        err('generating renderer for ' + JSON.stringify(attributes));
+        err('generating renderer for ' + JSON.stringify(GLImmediate.liveClientAttributes));
 #endif
         renderer = GLImmediate.createRenderer();
-        GLImmediate.currentRenderer = renderer;
+        renderer.attributesKey = attributesKey;
+        renderer.stateKey = stateKey;
         keyView.set(renderer);
-        return renderer;
       }
+      GLImmediate.renderersByKey[key] = renderer;
       GLImmediate.currentRenderer = renderer; // Cache the currently used renderer, so later lookups without state changes can get this fast.
       return renderer;
     },
@@ -2446,6 +2503,12 @@ var LibraryGLEmulation = {
           // Stores an array that remembers which matrix uniforms are up-to-date in this FFP renderer, so they don't need to be resubmitted
           // each time we render with this program.
           this.textureMatrixVersion = [ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 ];
+          // Likewise for the other uniforms, see the version numbers in GLEmulation.
+          this.fogVersion = -1;
+          this.clipPlaneVersion = -1;
+          this.lightingVersion = -1;
+          this.alphaTestVersion = -1;
+          this.pointSizeVersion = -1;
 
           this.positionLocation = GLctx.getAttribLocation(this.program, 'a_position');
 
@@ -2691,20 +2754,23 @@ var LibraryGLEmulation = {
             GLctx.vertexAttrib4fv(this.colorLocation, GLImmediate.clientColor);
           }
 #endif
-          if (this.hasFog) {
+          if (this.hasFog && this.fogVersion != GLEmulation.fogVersion) {
+            this.fogVersion = GLEmulation.fogVersion;
             if (this.fogColorLocation) GLctx.uniform4fv(this.fogColorLocation, GLEmulation.fogColor);
             if (this.fogEndLocation) GLctx.uniform1f(this.fogEndLocation, GLEmulation.fogEnd);
             if (this.fogScaleLocation) GLctx.uniform1f(this.fogScaleLocation, 1/(GLEmulation.fogEnd - GLEmulation.fogStart));
             if (this.fogDensityLocation) GLctx.uniform1f(this.fogDensityLocation, GLEmulation.fogDensity);
           }
 
-          if (this.hasClipPlane) {
+          if (this.hasClipPlane && this.clipPlaneVersion != GLEmulation.clipPlaneVersion) {
+            this.clipPlaneVersion = GLEmulation.clipPlaneVersion;
             for (var clipPlaneId = 0; clipPlaneId < GLEmulation.MAX_CLIP_PLANES; clipPlaneId++) {
               if (this.clipPlaneEquationLocation[clipPlaneId]) GLctx.uniform4fv(this.clipPlaneEquationLocation[clipPlaneId], GLEmulation.clipPlaneEquation[clipPlaneId]);
             }
           }
 
-          if (this.hasLighting) {
+          if (this.hasLighting && this.lightingVersion != GLEmulation.lightingVersion) {
+            this.lightingVersion = GLEmulation.lightingVersion;
             if (this.lightModelAmbientLocation) GLctx.uniform4fv(this.lightModelAmbientLocation, GLEmulation.lightModelAmbient);
             if (this.materialAmbientLocation) GLctx.uniform4fv(this.materialAmbientLocation, GLEmulation.materialAmbient);
             if (this.materialDiffuseLocation) GLctx.uniform4fv(this.materialDiffuseLocation, GLEmulation.materialDiffuse);
@@ -2719,12 +2785,14 @@ var LibraryGLEmulation = {
             }
           }
 
-          if (this.hasAlphaTest) {
+          if (this.hasAlphaTest && this.alphaTestVersion != GLEmulation.alphaTestVersion) {
+            this.alphaTestVersion = GLEmulation.alphaTestVersion;
             if (this.alphaTestRefLocation) GLctx.uniform1f(this.alphaTestRefLocation, GLEmulation.alphaTestRef);
           }
 
           if (GLImmediate.mode == GLctx.POINTS) {
-            if (this.pointSizeLocation) {
+            if (this.pointSizeLocation && this.pointSizeVersion != GLEmulation.pointSizeVersion) {
+              this.pointSizeVersion = GLEmulation.pointSizeVersion;
               GLctx.uniform1f(this.pointSizeLocation, GLEmulation.pointSize);
             }
           }
@@ -2787,6 +2855,7 @@ var LibraryGLEmulation = {
 
       var glActiveTexture = _glActiveTexture;
       _glActiveTexture = _emscripten_glActiveTexture = function _glActiveTexture(texture) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_activeTexture(texture);
         glActiveTexture(texture);
       };
@@ -2794,6 +2863,7 @@ var LibraryGLEmulation = {
 
       var glEnable = _glEnable;
       _glEnable = _emscripten_glEnable = function _glEnable(cap) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_enable(cap);
         glEnable(cap);
       };
@@ -2801,6 +2871,7 @@ var LibraryGLEmulation = {
 
       var glDisable = _glDisable;
       _glDisable = _emscripten_glDisable = function _glDisable(cap) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_disable(cap);
         glDisable(cap);
       };
@@ -2808,6 +2879,7 @@ var LibraryGLEmulation = {
 
       var glTexEnvf = (typeof(_glTexEnvf) != 'undefined') ? _glTexEnvf : function(){};
       _glTexEnvf = _emscripten_glTexEnvf = function _glTexEnvf(target, pname, param) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvf(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvf(target, pname, param);
@@ -2816,6 +2888,7 @@ var LibraryGLEmulation = {
 
       var glTexEnvi = (typeof(_glTexEnvi) != 'undefined') ? _glTexEnvi : function(){};
       _glTexEnvi = _emscripten_glTexEnvi = function _glTexEnvi(target, pname, param) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvi(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvi(target, pname, param);
@@ -2824,6 +2897,7 @@ var LibraryGLEmulation = {
 
       var glTexEnvfv = (typeof(_glTexEnvfv) != 'undefined') ? _glTexEnvfv : function(){};
       _glTexEnvfv = _emscripten_glTexEnvfv = function _glTexEnvfv(target, pname, param) {
+        {{{ glemu.flushBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvfv(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvfv(target, pname, param);
@@ -2870,7 +2944,7 @@ var LibraryGLEmulation = {
       // User can override the maximum number of texture units that we emulate. Using fewer texture units increases runtime performance
       // slightly, so it is advantageous to choose as small value as needed.
       // Limit to a maximum of 28 to not overflow the state bits used for renderer caching (31 bits = 3 attributes + 28 texture units).
-      GLImmediate.MAX_TEXTURES = Math.max(Module['GL_MAX_TEXTURE_IMAGE_UNITS'] || GLctx.getParameter(GLctx.MAX_TEXTURE_IMAGE_UNITS), 28);
+      GLImmediate.MAX_TEXTURES = Math.min(Module['GL_MAX_TEXTURE_IMAGE_UNITS'] || GLctx.getParameter(GLctx.MAX_TEXTURE_IMAGE_UNITS), 28);
 
       GLImmediate.TexEnvJIT.init(GLctx, GLImmediate.MAX_TEXTURES);
 
@@ -2907,6 +2981,10 @@ var LibraryGLEmulation = {
       GL.generateTempBuffers(true, GL.currentContext);
 
       GLImmediate.clientColor = new Float32Array([1, 1, 1, 1]);
+
+#if GL_BATCH_IMMEDIATE_MODE
+      GLImmediate.hookContextForBatching(GLctx);
+#endif
     },
 
     // Prepares and analyzes client attributes.
@@ -2949,10 +3027,12 @@ var LibraryGLEmulation = {
       var maxStride = 0;
       var attributes = GLImmediate.liveClientAttributes;
       attributes.length = 0;
+      var attributesKey = 0;
       for (var i = 0; i < 3+GLImmediate.MAX_TEXTURES; i++) {
         if (GLImmediate.enabledClientAttributes[i]) {
           var attr = GLImmediate.clientAttributes[i];
           attributes.push(attr);
+          attributesKey |= 1 << i;
           clientStartPointer = Math.min(clientStartPointer, attr.pointer);
           attr.sizeBytes = attr.size * GL.byteSizeByType[attr.type - GL.byteSizeByTypeRoot];
           bytes += attr.sizeBytes;
@@ -2960,6 +3040,7 @@ var LibraryGLEmulation = {
           maxStride = Math.max(maxStride, attr.stride);
         }
       }
+      GLImmediate.enabledAttributesKey = attributesKey;
 
       if ((minStride != maxStride || maxStride < bytes) && !beginEnd) {
         // We are in cases (1) or (3): slow path, shuffle the data around into a single interleaved vertex buffer.
@@ -3025,6 +3106,112 @@ var LibraryGLEmulation = {
       }
     },
 
+    // Draws the vertices of glBegin/glEnd blocks, which are at the start of tempData.
+    drawBeginEnd: function drawBeginEnd() {
+      GLImmediate.prepareClientAttributes(GLImmediate.rendererComponents[GLImmediate.VERTEX], true);
+      GLImmediate.firstVertex = 0;
+      GLImmediate.lastVertex = GLImmediate.vertexCounter / (GLImmediate.stride >> 2);
+      GLImmediate.flush();
+    },
+
+#if GL_BATCH_IMMEDIATE_MODE
+    // Makes every call to the WebGL context first draw the held back glBegin/glEnd blocks. The
+    // emulated GL functions that change state without calling into WebGL do so themselves.
+    hookContextForBatching: function hookContextForBatching(ctx) {
+      function hook(func) {
+        return function() {
+          if (GLImmediate.batchVertexCounter) GLImmediate.flushBatch();
+          return func.apply(ctx, arguments);
+        };
+      }
+      for (var name in ctx) {
+        if (typeof ctx[name] == 'function') ctx[name] = hook(ctx[name]);
+      }
+    },
+
+    // Whether the current glBegin/glEnd block has the same vertex layout as the held back ones.
+    hasBatchLayout: function hasBatchLayout() {
+      for (var i = 0; i < GLImmediate.NUM_ATTRIBUTES; i++) {
+        var enabled = !!GLImmediate.enabledClientAttributes[i];
+        if (enabled != !!GLImmediate.batchEnabledClientAttributes[i]) return false;
+        if (enabled) {
+          var attr = GLImmediate.clientAttributes[i];
+          var batchAttr = GLImmediate.batchClientAttributes[i];
+          if (attr.size != batchAttr.size || attr.type != batchAttr.type || attr.pointer != batchAttr.pointer) return false;
+        }
+      }
+      return true;
+    },
+
+    // Called by glEnd. Holds back the block that just ended, to be drawn together with the blocks that
+    // follow it, and returns whether it did. Otherwise the block is moved to the start of tempData, to
+    // be drawn right away.
+    batchBeginEnd: function batchBeginEnd() {
+      var start = GLImmediate.beginVertexCounter;
+      var primitiveSize = GLImmediate.batchPrimitiveSizes[GLImmediate.mode];
+      // Only blocks of whole primitives can be drawn together. Blocks that are drawn from a bound
+      // array buffer are left alone.
+      var canBatch = primitiveSize && GLImmediate.rendererComponents[GLImmediate.VERTEX] % primitiveSize == 0 &&
+                     !GLctx.currentArrayBufferBinding;
+      if (GLImmediate.batchVertexCounter) {
+        // All state changes since the held back blocks ended have drawn them, so if there still are
+        // some, this block only needs to have been written right after them and to have their layout.
+        if (canBatch && start == GLImmediate.batchVertexCounter && GLImmediate.mode == GLImmediate.batchMode &&
+            GLImmediate.hasBatchLayout()) {
+          GLImmediate.batchVertexCounter = GLImmediate.vertexCounter;
+          return true;
+        }
+        GLImmediate.flushBatch();
+      }
+      if (start) {
+        GLImmediate.tempData.copyWithin(0, start, GLImmediate.vertexCounter);
+        GLImmediate.vertexCounter -= start;
+      }
+      if (!canBatch || !GLImmediate.vertexCounter) return false;
+      GLImmediate.batchVertexCounter = GLImmediate.vertexCounter;
+      GLImmediate.batchMode = GLImmediate.mode;
+      GLImmediate.batchClientAttributes = GLImmediate.clientAttributes;
+      GLImmediate.batchEnabledClientAttributes = GLImmediate.enabledClientAttributes;
+      // Draw the blocks once the current event handler returns, if nothing else did before.
+      if (!GLImmediate.batchFlushScheduled) {
+        GLImmediate.batchFlushScheduled = true;
+        Promise.resolve().then(function() {
+          GLImmediate.batchFlushScheduled = false;
+          if (GLImmediate.batchVertexCounter) GLImmediate.flushBatch();
+        });
+      }
+      return true;
+    },
+
+    // Draws the held back glBegin/glEnd blocks with a single draw call.
+    flushBatch: function flushBatch() {
+      // Save the state of the current glBegin/glEnd block or client arrays, and draw with the one of the
+      // held back blocks.
+      var mode = GLImmediate.mode;
+      var clientAttributes = GLImmediate.clientAttributes;
+      var enabledClientAttributes = GLImmediate.enabledClientAttributes;
+      var vertexCounter = GLImmediate.vertexCounter;
+      var vertexData = GLImmediate.vertexData;
+      GLImmediate.mode = GLImmediate.batchMode;
+      GLImmediate.clientAttributes = GLImmediate.batchClientAttributes;
+      GLImmediate.enabledClientAttributes = GLImmediate.batchEnabledClientAttributes;
+      GLImmediate.vertexCounter = GLImmediate.batchVertexCounter;
+      GLImmediate.vertexData = GLImmediate.tempData;
+      // This draws through the WebGL context, so mark the blocks as drawn first.
+      GLImmediate.batchVertexCounter = 0;
+      GLImmediate.batchClientAttributes = GLImmediate.batchEnabledClientAttributes = null;
+      GLImmediate.modifiedClientAttributes = true;
+      GLImmediate.drawBeginEnd();
+
+      GLImmediate.mode = mode;
+      GLImmediate.clientAttributes = clientAttributes;
+      GLImmediate.enabledClientAttributes = enabledClientAttributes;
+      GLImmediate.vertexCounter = vertexCounter;
+      GLImmediate.vertexData = vertexData;
+      GLImmediate.modifiedClientAttributes = true;
+    },
+#endif
+
     flush: function flush(numProvidedIndexes, startIndex, ptr) {
 #if ASSERTIONS
       assert(numProvidedIndexes >= 0 || !numProvidedIndexes);
@@ -3115,6 +3302,13 @@ var LibraryGLEmulation = {
 
   glBegin__deps: ['$GLImmediateSetup'],
   glBegin: function(mode) {
+#if GL_BATCH_IMMEDIATE_MODE
+    // Only blocks of the same mode can be drawn together. Leave room for the vertices of this block.
+    if (GLImmediate.batchVertexCounter &&
+        (mode != GLImmediate.batchMode || (GLImmediate.batchVertexCounter << 2) > (GL.MAX_TEMP_BUFFER_SIZE >> 3))) {
+      GLImmediate.flushBatch();
+    }
+#endif
     // Push the old state:
     GLImmediate.enabledClientAttributes_preBegin = GLImmediate.enabledClientAttributes;
     GLImmediate.enabledClientAttributes = [];
@@ -3127,6 +3321,10 @@ var LibraryGLEmulation = {
 
     GLImmediate.mode = mode;
     GLImmediate.vertexCounter = 0;
+#if GL_BATCH_IMMEDIATE_MODE
+    // Write the vertices after the ones of the held back blocks.
+    GLImmediate.vertexCounter = GLImmediate.beginVertexCounter = GLImmediate.batchVertexCounter;
+#endif
     var components = GLImmediate.rendererComponents = [];
     for (var i = 0; i < GLImmediate.NUM_ATTRIBUTES; i++) {
       components[i] = 0;
@@ -3136,17 +3334,20 @@ var LibraryGLEmulation = {
   },
 
   glEnd: function() {
-    GLImmediate.prepareClientAttributes(GLImmediate.rendererComponents[GLImmediate.VERTEX], true);
-    GLImmediate.firstVertex = 0;
-    GLImmediate.lastVertex = GLImmediate.vertexCounter / (GLImmediate.stride >> 2);
-    GLImmediate.flush();
+#if GL_BATCH_IMMEDIATE_MODE
+    if (!GLImmediate.batchBeginEnd()) {
+      GLImmediate.drawBeginEnd();
+      GLImmediate.disableBeginEndClientAttributes();
+    }
+#else
+    GLImmediate.drawBeginEnd();
     GLImmediate.disableBeginEndClientAttributes();
+#endif
     GLImmediate.mode = -1;
 
     // Pop the old state:
     GLImmediate.enabledClientAttributes = GLImmediate.enabledClientAttributes_preBegin;
     GLImmediate.clientAttributes = GLImmediate.clientAttributes_preBegin;
-    GLImmediate.currentRenderer = null; // The set of active client attributes changed, we must re-lookup the renderer to use.
     GLImmediate.modifiedClientAttributes = true;
   },
 
@@ -3246,6 +3447,7 @@ var LibraryGLEmulation = {
       GLImmediate.vertexCounter++;
       GLImmediate.addRendererComponent(GLImmediate.COLOR, 4, GLctx.UNSIGNED_BYTE);
     } else {
+      {{{ glemu.flushBatch() }}}
       GLImmediate.clientColor[0] = r;
       GLImmediate.clientColor[1] = g;
       GLImmediate.clientColor[2] = b;
@@ -3315,26 +3517,33 @@ var LibraryGLEmulation = {
   },
 
   glFogf: function(pname, param) { // partial support, TODO
+    {{{ glemu.flushBatch() }}}
     switch (pname) {
       case 0xB63: // GL_FOG_START
-        GLEmulation.fogStart = param; break;
+        GLEmulation.fogStart = param;
+        GLEmulation.fogVersion = (GLEmulation.fogVersion + 1)|0;
+        break;
       case 0xB64: // GL_FOG_END
-        GLEmulation.fogEnd = param; break;
+        GLEmulation.fogEnd = param;
+        GLEmulation.fogVersion = (GLEmulation.fogVersion + 1)|0;
+        break;
       case 0xB62: // GL_FOG_DENSITY
-        GLEmulation.fogDensity = param; break;
+        GLEmulation.fogDensity = param;
+        GLEmulation.fogVersion = (GLEmulation.fogVersion + 1)|0;
+        break;
       case 0xB65: // GL_FOG_MODE
         switch (param) {
           case 0x801: // GL_EXP2
           case 0x2601: // GL_LINEAR
             if (GLEmulation.fogMode != param) {
-              GLImmediate.currentRenderer = null; // Fog mode is part of the FFP shader state, we must re-lookup the renderer to use.
               GLEmulation.fogMode = param;
+              GLEmulation.updateFogStateKey(); // Fog mode is part of the FFP shader state.
             }
             break;
           default: // default to GL_EXP
             if (GLEmulation.fogMode != 0x800 /* GL_EXP */) {
-              GLImmediate.currentRenderer = null; // Fog mode is part of the FFP shader state, we must re-lookup the renderer to use.
               GLEmulation.fogMode = 0x800 /* GL_EXP */;
+              GLEmulation.updateFogStateKey(); // Fog mode is part of the FFP shader state.
             }
             break;
         }
@@ -3349,10 +3558,12 @@ var LibraryGLEmulation = {
   glFogfv: function(pname, param) { // partial support, TODO
     switch (pname) {
       case 0xB66: // GL_FOG_COLOR
+        {{{ glemu.flushBatch() }}}
         GLEmulation.fogColor[0] = {{{ makeGetValue('param', '0', 'float') }}};
         GLEmulation.fogColor[1] = {{{ makeGetValue('param', '4', 'float') }}};
         GLEmulation.fogColor[2] = {{{ makeGetValue('param', '8', 'float') }}};
         GLEmulation.fogColor[3] = {{{ makeGetValue('param', '12', 'float') }}};
+        GLEmulation.fogVersion = (GLEmulation.fogVersion + 1)|0;
         break;
       case 0xB63: // GL_FOG_START
       case 0xB64: // GL_FOG_END
@@ -3363,10 +3574,12 @@ var LibraryGLEmulation = {
   glFogiv: function(pname, param) {
     switch (pname) {
       case 0xB66: // GL_FOG_COLOR
+        {{{ glemu.flushBatch() }}}
         GLEmulation.fogColor[0] = ({{{ makeGetValue('param', '0', 'i32') }}}/2147483647)/2.0+0.5;
         GLEmulation.fogColor[1] = ({{{ makeGetValue('param', '4', 'i32') }}}/2147483647)/2.0+0.5;
         GLEmulation.fogColor[2] = ({{{ makeGetValue('param', '8', 'i32') }}}/2147483647)/2.0+0.5;
         GLEmulation.fogColor[3] = ({{{ makeGetValue('param', '12', 'i32') }}}/2147483647)/2.0+0.5;
+        GLEmulation.fogVersion = (GLEmulation.fogVersion + 1)|0;
         break;
       default:
         _glFogf(pname, {{{ makeGetValue('param', '0', 'i32') }}}); break;
@@ -3376,12 +3589,15 @@ var LibraryGLEmulation = {
   glFogxv: 'glFogiv',
 
   glPointSize: function(size) {
+    {{{ glemu.flushBatch() }}}
     GLEmulation.pointSize = size;
+    GLEmulation.pointSizeVersion = (GLEmulation.pointSizeVersion + 1)|0;
   },
 
   glPolygonMode: function(){}, // TODO
 
   glAlphaFunc: function(func, ref) {
+    {{{ glemu.flushBatch() }}}
     switch(func) {
       case 0x200: // GL_NEVER
       case 0x201: // GL_LESS
@@ -3392,9 +3608,10 @@ var LibraryGLEmulation = {
       case 0x206: // GL_GEQUAL
       case 0x207: // GL_ALWAYS
         GLEmulation.alphaTestRef = ref;
+        GLEmulation.alphaTestVersion = (GLEmulation.alphaTestVersion + 1)|0;
         if (GLEmulation.alphaTestFunc != func) {
           GLEmulation.alphaTestFunc = func;
-          GLImmediate.currentRenderer = null; // alpha test mode is part of the FFP shader state, we must re-lookup the renderer to use.
+          GLEmulation.updateAlphaTestStateKey(); // alpha test mode is part of the FFP shader state.
         }
         break;
       default: // invalid value provided
@@ -3435,6 +3652,7 @@ var LibraryGLEmulation = {
   // ClientState/gl*Pointer
 
   glEnableClientState: function(cap) {
+    {{{ glemu.flushBatch() }}}
     var attrib = GLEmulation.getAttributeFromCapability(cap);
     if (attrib === null) {
 #if ASSERTIONS
@@ -3445,7 +3663,6 @@ var LibraryGLEmulation = {
     if (!GLImmediate.enabledClientAttributes[attrib]) {
       GLImmediate.enabledClientAttributes[attrib] = true;
       GLImmediate.totalEnabledClientAttributes++;
-      GLImmediate.currentRenderer = null; // Will need to change current renderer, since the set of active vertex pointers changed.
 #if GL_FFP_ONLY
       // In GL_FFP_ONLY mode, attributes are bound to the same index in each FFP emulation shader, so we can immediately apply the change here.
       GL.enableVertexAttribArray(attrib);
@@ -3455,6 +3672,7 @@ var LibraryGLEmulation = {
     }
   },
   glDisableClientState: function(cap) {
+    {{{ glemu.flushBatch() }}}
     var attrib = GLEmulation.getAttributeFromCapability(cap);
     if (attrib === null) {
 #if ASSERTIONS
@@ -3465,7 +3683,6 @@ var LibraryGLEmulation = {
     if (GLImmediate.enabledClientAttributes[attrib]) {
       GLImmediate.enabledClientAttributes[attrib] = false;
       GLImmediate.totalEnabledClientAttributes--;
-      GLImmediate.currentRenderer = null; // Will need to change current renderer, since the set of active vertex pointers changed.
 #if GL_FFP_ONLY
       // In GL_FFP_ONLY mode, attributes are bound to the same index in each FFP emulation shader, so we can immediately apply the change here.
       GL.disableVertexAttribArray(attrib);
@@ -3477,6 +3694,7 @@ var LibraryGLEmulation = {
 
   glVertexPointer__deps: ['$GLEmulation'], // if any pointers are used, glVertexPointer must be, and if it is, then we need emulation
   glVertexPointer: function(size, type, stride, pointer) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.setClientAttribute(GLImmediate.VERTEX, size, type, stride, pointer);
 #if GL_FFP_ONLY
     if (GLctx.currentArrayBufferBinding) {
@@ -3485,6 +3703,7 @@ var LibraryGLEmulation = {
 #endif
   },
   glTexCoordPointer: function(size, type, stride, pointer) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.setClientAttribute(GLImmediate.TEXTURE0 + GLImmediate.clientActiveTexture, size, type, stride, pointer);
 #if GL_FFP_ONLY
     if (GLctx.currentArrayBufferBinding) {
@@ -3494,6 +3713,7 @@ var LibraryGLEmulation = {
 #endif
   },
   glNormalPointer: function(type, stride, pointer) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.setClientAttribute(GLImmediate.NORMAL, 3, type, stride, pointer);
 #if GL_FFP_ONLY
     if (GLctx.currentArrayBufferBinding) {
@@ -3502,6 +3722,7 @@ var LibraryGLEmulation = {
 #endif
   },
   glColorPointer: function(size, type, stride, pointer) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.setClientAttribute(GLImmediate.COLOR, size, type, stride, pointer);
 #if GL_FFP_ONLY
     if (GLctx.currentArrayBufferBinding) {
@@ -3519,6 +3740,7 @@ var LibraryGLEmulation = {
   // attributes enabled, and we use webgl-friendly modes (no GL_QUADS), then no need
   // for emulation
   glDrawArrays: function(mode, first, count) {
+    {{{ glemu.flushBatch() }}}
     if (GLImmediate.totalEnabledClientAttributes == 0 && mode <= 6) {
       GLctx.drawArrays(mode, first, count);
       return;
@@ -3535,6 +3757,7 @@ var LibraryGLEmulation = {
   },
 
   glDrawElements: function(mode, count, type, indices, start, end) { // start, end are given if we come from glDrawRangeElements
+    {{{ glemu.flushBatch() }}}
     if (GLImmediate.totalEnabledClientAttributes == 0 && mode <= 6 && GLctx.currentElementArrayBufferBinding) {
       GLctx.drawElements(mode, count, type, indices);
       return;
@@ -3590,6 +3813,7 @@ var LibraryGLEmulation = {
   emulGlBindVertexArray__deps: ['glBindBuffer', 'glEnableVertexAttribArray', 'glVertexAttribPointer', 'glEnableClientState'],
   emulGlBindVertexArray__sig: 'vi',
   emulGlBindVertexArray: function(vao) {
+    {{{ glemu.flushBatch() }}}
     // undo vao-related things, wipe the slate clean, both for vao of 0 or an actual vao
     GLEmulation.currentVao = null; // make sure the commands we run here are not recorded
     if (GLImmediate.lastRenderer) GLImmediate.lastRenderer.cleanup();
@@ -3637,6 +3861,7 @@ var LibraryGLEmulation = {
   },
 
   glPushMatrix: function() {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixStack[GLImmediate.currentMatrix].push(
@@ -3648,6 +3873,7 @@ var LibraryGLEmulation = {
       GL.recordError(0x504/*GL_STACK_UNDERFLOW*/);
       return;
     }
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrix[GLImmediate.currentMatrix] = GLImmediate.matrixStack[GLImmediate.currentMatrix].pop();
@@ -3655,12 +3881,14 @@ var LibraryGLEmulation = {
 
   glLoadIdentity__deps: ['$GL', '$GLImmediateSetup'],
   glLoadIdentity: function() {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.identity(GLImmediate.matrix[GLImmediate.currentMatrix]);
   },
 
   glLoadMatrixd: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F64', 'matrix', 'matrix+' + (16*8)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3670,12 +3898,14 @@ var LibraryGLEmulation = {
 #if GL_DEBUG
     if (GL.debug) err('glLoadMatrixf receiving: ' + Array.prototype.slice.call(HEAPF32.subarray(matrix >> 2, (matrix >> 2) + 16)));
 #endif
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F32', 'matrix', 'matrix+' + (16*4)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
   },
 
   glLoadTransposeMatrixd: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F64', 'matrix', 'matrix+' + (16*8)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3683,6 +3913,7 @@ var LibraryGLEmulation = {
   },
 
   glLoadTransposeMatrixf: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F32', 'matrix', 'matrix+' + (16*4)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3690,6 +3921,7 @@ var LibraryGLEmulation = {
   },
 
   glMultMatrixd: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3697,6 +3929,7 @@ var LibraryGLEmulation = {
   },
 
   glMultMatrixf: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3704,6 +3937,7 @@ var LibraryGLEmulation = {
   },
 
   glMultTransposeMatrixd: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     var colMajor = GLImmediate.matrixLib.mat4.create();
@@ -3713,6 +3947,7 @@ var LibraryGLEmulation = {
   },
 
   glMultTransposeMatrixf: function(matrix) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     var colMajor = GLImmediate.matrixLib.mat4.create();
@@ -3722,6 +3957,7 @@ var LibraryGLEmulation = {
   },
 
   glFrustum: function(left, right, bottom, top_, nearVal, farVal) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3730,6 +3966,7 @@ var LibraryGLEmulation = {
   glFrustumf: 'glFrustum',
 
   glOrtho: function(left, right, bottom, top_, nearVal, farVal) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3738,6 +3975,7 @@ var LibraryGLEmulation = {
   glOrthof: 'glOrtho',
 
   glScaled: function(x, y, z) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.scale(GLImmediate.matrix[GLImmediate.currentMatrix], [x, y, z]);
@@ -3745,6 +3983,7 @@ var LibraryGLEmulation = {
   glScalef: 'glScaled',
 
   glTranslated: function(x, y, z) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.translate(GLImmediate.matrix[GLImmediate.currentMatrix], [x, y, z]);
@@ -3752,6 +3991,7 @@ var LibraryGLEmulation = {
   glTranslatef: 'glTranslated',
 
   glRotated: function(angle, x, y, z) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.rotate(GLImmediate.matrix[GLImmediate.currentMatrix], angle*Math.PI/180, [x, y, z]);
@@ -3765,6 +4005,7 @@ var LibraryGLEmulation = {
 
   glClipPlane: function(pname, param) {
     if ((pname >= 0x3000) && (pname < 0x3006)  /* GL_CLIP_PLANE0 to GL_CLIP_PLANE5 */) {
+      {{{ glemu.flushBatch() }}}
       var clipPlaneId = pname - 0x3000;
 
       GLEmulation.clipPlaneEquation[clipPlaneId][0] = {{{ makeGetValue('param', '0', 'double') }}};
@@ -3777,11 +4018,13 @@ var LibraryGLEmulation = {
       GLImmediate.matrixLib.mat4.inverse(tmpMV);
       GLImmediate.matrixLib.mat4.transpose(tmpMV);
       GLImmediate.matrixLib.mat4.multiplyVec4(tmpMV, GLEmulation.clipPlaneEquation[clipPlaneId]);
+      GLEmulation.clipPlaneVersion = (GLEmulation.clipPlaneVersion + 1)|0;
     }
   },
 
   glLightfv: function(light, pname, param) {
     if ((light >= 0x4000) && (light < 0x4008)  /* GL_LIGHT0 to GL_LIGHT7 */) {
+      {{{ glemu.flushBatch() }}}
       var lightId = light - 0x4000;
 
       if (pname == 0x1200) { // GL_AMBIENT
@@ -3810,6 +4053,7 @@ var LibraryGLEmulation = {
       } else {
         throw 'glLightfv: TODO: ' + pname;
       }
+      GLEmulation.lightingVersion = (GLEmulation.lightingVersion + 1)|0;
     }
   },
 
@@ -3823,10 +4067,12 @@ var LibraryGLEmulation = {
 
   glLightModelfv: function(pname, param) { // TODO: GL_LIGHT_MODEL_LOCAL_VIEWER
     if (pname == 0x0B53) { // GL_LIGHT_MODEL_AMBIENT
+      {{{ glemu.flushBatch() }}}
       GLEmulation.lightModelAmbient[0] = {{{ makeGetValue('param', '0', 'float') }}};
       GLEmulation.lightModelAmbient[1] = {{{ makeGetValue('param', '4', 'float') }}};
       GLEmulation.lightModelAmbient[2] = {{{ makeGetValue('param', '8', 'float') }}};
       GLEmulation.lightModelAmbient[3] = {{{ makeGetValue('param', '12', 'float') }}};
+      GLEmulation.lightingVersion = (GLEmulation.lightingVersion + 1)|0;
     } else {
       throw 'glLightModelfv: TODO: ' + pname;
     }
@@ -3834,6 +4080,7 @@ var LibraryGLEmulation = {
 
   glMaterialfv: function(face, pname, param) {
     if ((face != 0x0404) && (face != 0x0408)) { throw 'glMaterialfv: TODO' + face; } // only GL_FRONT and GL_FRONT_AND_BACK supported
+    {{{ glemu.flushBatch() }}}
 
     if (pname == 0x1200) { // GL_AMBIENT
       GLEmulation.materialAmbient[0] = {{{ makeGetValue('param', '0', 'float') }}};
@@ -3855,6 +4102,7 @@ var LibraryGLEmulation = {
     } else {
       throw 'glMaterialfv: TODO: ' + pname;
     }
+    GLEmulation.lightingVersion = (GLEmulation.lightingVersion + 1)|0;
   },
 
   glTexGeni: function() { throw 'glTexGeni: TODO' },
@@ -3889,6 +4137,7 @@ var LibraryGLEmulation = {
   // GLU
 
   gluPerspective: function(fov, aspect, near, far) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrix[GLImmediate.currentMatrix] =
@@ -3897,6 +4146,7 @@ var LibraryGLEmulation = {
   },
 
   gluLookAt: function(ex, ey, ez, cx, cy, cz, ux, uy, uz) {
+    {{{ glemu.flushBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.lookAt(GLImmediate.matrix[GLImmediate.currentMatrix], [ex, ey, ez],
@@ -19,18 +19,170 @@ mergeInto(LibraryManager.library, {
         return MiniLZ4;
       })();
       LZ4.CHUNK_SIZE = LZ4.codec.CHUNK_SIZE;
+#if LZ4_WORKERS
+      LZ4.startWorkers();
+#endif
+    },
+
+    // Decompressed chunks are kept in a least-recently-used cache of up to
+    // LZ4_CACHE_SIZE bytes per package. Entries are kept in a doubly linked
+    // list, most recently used first.
+    createCache: function() {
+      return {
+        entries: {}, // chunk index => entry
+        head: null,
+        tail: null,
+        count: 0,
+        capacity: Math.max(Math.floor({{{ LZ4_CACHE_SIZE }}} / LZ4.CHUNK_SIZE), 1),
+#if LZ4_WORKERS
+        pending: {}, // chunk index => true while a worker is decompressing it
+#endif
+      };
+    },
+    unlinkEntry: function(cache, entry) {
+      if (entry.prev) entry.prev.next = entry.next; else cache.head = entry.next;
+      if (entry.next) entry.next.prev = entry.prev; else cache.tail = entry.prev;
+      entry.prev = entry.next = null;
+    },
+    linkEntry: function(cache, entry) {
+      entry.next = cache.head;
+      if (cache.head) cache.head.prev = entry; else cache.tail = entry;
+      cache.head = entry;
+    },
+    getCachedChunk: function(cache, chunkIndex) {
+      var entry = cache.entries[chunkIndex];
+      if (!entry) return null;
+      if (cache.head !== entry) {
+        LZ4.unlinkEntry(cache, entry);
+        LZ4.linkEntry(cache, entry);
+      }
+      return entry.data;
+    },
+    // Adds a chunk to the cache, evicting the least recently used one if the
+    // cache is full. If |data| is null, returns a buffer to decompress into,
+    // reusing the evicted chunk's storage where possible.
+    addCachedChunk: function(cache, chunkIndex, data) {
+      var reuse = null;
+      if (cache.count >= cache.capacity) {
+        var victim = cache.tail;
+        LZ4.unlinkEntry(cache, victim);
+        delete cache.entries[victim.index];
+        if (victim.data.length === LZ4.CHUNK_SIZE && victim.data.byteOffset === 0 && victim.data.buffer.byteLength === LZ4.CHUNK_SIZE) {
+          reuse = victim.data;
+        }
+      } else {
+        cache.count++;
+      }
+      var entry = { index: chunkIndex, data: data || reuse || new Uint8Array(LZ4.CHUNK_SIZE), prev: null, next: null };
+      cache.entries[chunkIndex] = entry;
+      LZ4.linkEntry(cache, entry);
+      return entry.data;
+    },
+
+#if LZ4_WORKERS
+    // With LZ4_WORKERS, a pool of workers decompresses chunks ahead of use:
+    // the start of the package when it is loaded, and the chunks after each
+    // cache miss, as reads tend to be sequential. Results land in the cache
+    // when the main thread next returns to the event loop; a read that gets
+    // there first decompresses synchronously as usual.
+    READAHEAD_CHUNKS: 64,
+    workers: null,
+    nextWorker: 0,
+    requests: {},
+    nextRequest: 0,
+    startWorkers: function() {
+      if (typeof Worker === 'undefined' && !ENVIRONMENT_IS_NODE) return;
+      // The codec source is embedded as a string, so that the optimizer cannot
+      // rename anything in it.
+      var source = 'function assert(condition, text) { if (!condition) throw new Error(text); }\n' +
+        {{{ JSON.stringify(read('../third_party/mini-lz4.js')) }}} + ';\n' +
+        'function decompress(d) {\n' +
+        '  var out = new Uint8Array(d.sizes.length * MiniLZ4.CHUNK_SIZE);\n' +
+        '  for (var i = 0, pos = 0; i < d.sizes.length; pos += d.sizes[i++]) {\n' +
+        '    var input = d.compressed.subarray(pos, pos + d.sizes[i]);\n' +
+        '    var output = out.subarray(i * MiniLZ4.CHUNK_SIZE);\n' +
+        '    if (d.successes[i]) MiniLZ4.uncompress(input, output); else output.set(input);\n' +
+        '  }\n' +
+        '  return { id: d.id, out: out };\n' +
+        '}\n' +
+        'if (typeof self === "undefined") {\n' +
+        '  var port = require("worker_threads").parentPort;\n' +
+        '  port.on("message", function(d) { var r = decompress(d); port.postMessage(r, [r.out.buffer]); });\n' +
+        '} else {\n' +
+        '  onmessage = function(e) { var r = decompress(e.data); postMessage(r, [r.out.buffer]); };\n' +
+        '}\n';
+      LZ4.workers = [];
+      for (var i = 0; i < {{{ LZ4_WORKERS }}}; i++) {
+        var worker;
+        if (ENVIRONMENT_IS_NODE) {
+          worker = new (require('worker_threads').Worker)(source, { eval: true });
+          worker.on('message', LZ4.onWorkerMessage);
+          // Idle decompression workers should not keep node alive.
+          worker.unref();
+        } else {
+          worker = new Worker(URL.createObjectURL(new Blob([source], { type: 'application/javascript' })));
+          worker.onmessage = function(e) { LZ4.onWorkerMessage(e.data); };
+        }
+        LZ4.workers.push(worker);
+      }
+    },
+    // Asks the workers to decompress up to |count| chunks from |first| on,
+    // skipping those that are cached, in flight, or stored uncompressed.
+    prefetch: function(compressedData, first, count) {
+      if (!LZ4.workers || !LZ4.workers.length) return;
+      var cache = compressedData.cache;
+      var end = Math.min(first + count, compressedData['successes'].length);
+      // Don't prefetch more than half the cache, so prefetching cannot evict
+      // the chunks currently being read.
+      end = Math.min(end, first + Math.ceil(cache.capacity / 2));
+      var batch = Math.max(Math.ceil((end - first) / LZ4.workers.length), 1);
+      var start = -1;
+      for (var i = first; i <= end; i++) {
+        var wanted = i < end && compressedData['successes'][i] && !cache.entries[i] && !cache.pending[i];
+        if (wanted && start < 0) start = i;
+        if (start >= 0 && (!wanted || i - start === batch)) {
+          LZ4.requestChunks(compressedData, start, i);
+          start = wanted ? i : -1;
+        }
+      }
+    },
+    requestChunks: function(compressedData, start, end) {
+      var offsets = compressedData['offsets'];
+      var sizes = compressedData['sizes'];
+      var id = LZ4.nextRequest++;
+      LZ4.requests[id] = { compressedData: compressedData, start: start };
+      for (var i = start; i < end; i++) compressedData.cache.pending[i] = true;
+      var worker = LZ4.workers[LZ4.nextWorker++ % LZ4.workers.length];
+      worker.postMessage({
+        'id': id,
+        'compressed': compressedData['data'].slice(offsets[start], offsets[end - 1] + sizes[end - 1]),
+        'sizes': sizes.slice(start, end),
+        'successes': compressedData['successes'].slice(start, end),
+      });
     },
+    onWorkerMessage: function(result) {
+      var request = LZ4.requests[result['id']];
+      delete LZ4.requests[result['id']];
+      var cache = request.compressedData.cache;
+      var out = result['out'];
+      var count = out.length / LZ4.CHUNK_SIZE;
+      for (var i = 0; i < count; i++) {
+        var chunkIndex = request.start + i;
+        delete cache.pending[chunkIndex];
+        if (!cache.entries[chunkIndex]) {
+          LZ4.addCachedChunk(cache, chunkIndex, out.subarray(i * LZ4.CHUNK_SIZE, (i + 1) * LZ4.CHUNK_SIZE));
+        }
+      }
+    },
+#endif
     loadPackage: function (pack, preloadPlugin) {
       LZ4.init();
       var compressedData = pack['compressedData'];
       if (!compressedData) compressedData = LZ4.codec.compressPackage(pack['data']);
-      assert(compressedData['cachedIndexes'].length === compressedData['cachedChunks'].length);
-      for (var i = 0; i < compressedData['cachedIndexes'].length; i++) {
-        compressedData['cachedIndexes'][i] = -1;
-        compressedData['cachedChunks'][i] = compressedData['data'].subarray(compressedData['cachedOffset'] + i*LZ4.CHUNK_SIZE,
-                                                                      compressedData['cachedOffset'] + (i+1)*LZ4.CHUNK_SIZE);
-        assert(compressedData['cachedChunks'][i].length === LZ4.CHUNK_SIZE);
-      }
+      compressedData.cache = LZ4.createCache();
+#if LZ4_WORKERS
+      LZ4.prefetch(compressedData, 0, compressedData.cache.capacity);
+#endif
       pack['metadata'].files.forEach(function(file) {
         var dir = PATH.dirname(file.filename);
         var name = PATH.basename(file.filename);
@@ -155,15 +307,13 @@ mergeInto(LibraryManager.library, {
           var compressedSize = compressedData['sizes'][chunkIndex];
           var currChunk;
           if (compressedData['successes'][chunkIndex]) {
-            var found = compressedData['cachedIndexes'].indexOf(chunkIndex);
-            if (found >= 0) {
-              currChunk = compressedData['cachedChunks'][found];
-            } else {
+            currChunk = LZ4.getCachedChunk(compressedData.cache, chunkIndex);
+            if (!currChunk) {
               // decompress the chunk
-              compressedData['cachedIndexes'].pop();
-              compressedData['cachedIndexes'].unshift(chunkIndex);
-              currChunk = compressedData['cachedChunks'].pop();
-              compressedData['cachedChunks'].unshift(currChunk);
+              currChunk = LZ4.addCachedChunk(compressedData.cache, chunkIndex, null);
+#if LZ4_WORKERS
+              LZ4.prefetch(compressedData, chunkIndex + 1, LZ4.READAHEAD_CHUNKS);
+#endif
               if (compressedData['debug']) {
                 out('decompressing chunk ' + chunkIndex);
                 Module['decompressedChunks'] = (Module['decompressedChunks'] || 0) + 1;
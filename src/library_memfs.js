@@ -116,9 +116,20 @@ mergeInto(LibraryManager.library, {
       var CAPACITY_DOUBLING_MAX = 1024 * 1024;
       newCapacity = Math.max(newCapacity, (prevCapacity * (prevCapacity < CAPACITY_DOUBLING_MAX ? 2.0 : 1.125)) >>> 0);
       if (prevCapacity != 0) newCapacity = Math.max(newCapacity, 256); // At minimum allocate 256b for each file when expanding.
-      var oldContents = node.contents;
-      node.contents = new Uint8Array(newCapacity); // Allocate new storage.
-      if (node.usedBytes > 0) node.contents.set(oldContents.subarray(0, node.usedBytes), 0); // Copy old data over to the new storage.
+#if MEMFS_HEAP_STORAGE
+      // Files removed while still open stay out of the heap, as nothing would
+      // free them once they are closed.
+      if (!node.removed) {
+        if (!MEMFS.moveToHeap(node, newCapacity)) {
+          throw new FS.ErrnoError({{{ cDefine('ENOMEM') }}});
+        }
+        return;
+      }
+#endif
+      var newContents = new Uint8Array(newCapacity); // Allocate new storage.
+      // Copy the old data over before replacing it, as heap storage is freed when replaced.
+      if (node.usedBytes > 0) newContents.set(node.contents.subarray(0, node.usedBytes), 0);
+      node.contents = newContents;
     },
 
     // Performs an exact resize of the backing file storage to the given size, if the size is not exactly this, the storage is fully reallocated.
@@ -130,16 +141,130 @@ mergeInto(LibraryManager.library, {
       if (newSize == 0) {
         node.contents = null; // Fully decommit when requesting a resize to zero.
         node.usedBytes = 0;
+#if MEMFS_HEAP_STORAGE
+      } else if (node.heapStorage && newSize < node.usedBytes) {
+        // Shrink in place, clearing the tail so that growing again reads zeros.
+        HEAPU8.fill(0, node.heapStorage.ptr + newSize, node.heapStorage.ptr + node.usedBytes);
+        node.usedBytes = newSize;
+      } else if (!node.removed && newSize > node.usedBytes) {
+        MEMFS.expandFileStorage(node, newSize); // Heap storage is zero-filled past the end.
+        node.usedBytes = newSize;
+#endif
       } else {
-        var oldContents = node.contents;
-        node.contents = new Uint8Array(newSize); // Allocate new storage.
-        if (oldContents) {
-          node.contents.set(oldContents.subarray(0, Math.min(newSize, node.usedBytes))); // Copy old data over to the new storage.
+        var newContents = new Uint8Array(newSize); // Allocate new storage.
+        if (node.contents) {
+          newContents.set(node.contents.subarray(0, Math.min(newSize, node.usedBytes))); // Copy old data over to the new storage.
         }
+        node.contents = newContents;
         node.usedBytes = newSize;
       }
     },
 
+    // Moves the contents of a file into the heap, with room for at least |size|
+    // bytes, so that mmap() can alias them instead of copying. node.contents
+    // becomes a view of the heap storage until the file is next reallocated
+    // (by growing or truncating it), which moves it back into a JS array.
+    // With MEMFS_HEAP_STORAGE all files live in the heap and are reallocated
+    // here. Returns the storage, or null if there is not enough memory or the
+    // file has been removed, as nothing would free the storage of a removed
+    // file.
+    moveToHeap: function(node, size) {
+      var storage = node.heapStorage;
+      if (storage && storage.capacity >= size) return storage;
+      if (node.removed) return null;
+      size = Math.max(size, node.usedBytes);
+      var ptr;
+      var zeroFrom;
+      if (storage && !storage.mappings) {
+        // Nothing else points into the storage, so it can be resized in place.
+        ptr = _realloc(storage.ptr, size);
+        if (!ptr) return null;
+#if CAN_ADDRESS_2GB
+        ptr >>>= 0;
+#endif
+        zeroFrom = storage.capacity;
+        storage.ptr = ptr;
+        storage.capacity = size;
+        storage.view = null;
+      } else {
+        ptr = _malloc(size);
+        if (!ptr) return null;
+#if CAN_ADDRESS_2GB
+        ptr >>>= 0;
+#endif
+        if (storage) {
+          HEAPU8.copyWithin(ptr, storage.ptr, storage.ptr + node.usedBytes);
+        } else {
+          HEAPU8.set(MEMFS.getFileDataAsTypedArray(node), ptr);
+        }
+        zeroFrom = node.usedBytes;
+        storage = { ptr: ptr, capacity: size, mappings: 0, detached: false, view: null };
+        MEMFS.setHeapStorage(node, storage);
+      }
+      // Heap storage is kept zeroed past the end of the file, so that growing
+      // the file reads zeros.
+      HEAPU8.fill(0, ptr + zeroFrom, ptr + size);
+      return storage;
+    },
+
+    setHeapStorage: function(node, storage) {
+      var prev = node.heapStorage;
+      node.heapStorage = storage;
+      if (prev) {
+        prev.detached = true;
+        MEMFS.freeHeapStorage(prev);
+      }
+      if (!storage) {
+        Object.defineProperties(node, {
+          contents: { value: null, writable: true, enumerable: true, configurable: true }
+        });
+        return;
+      }
+      Object.defineProperties(node, {
+        contents: {
+          get: function() {
+            // Views of the heap must be recreated after memory growth.
+            if (!storage.view || storage.view.buffer !== HEAPU8.buffer) {
+              storage.view = HEAPU8.subarray(storage.ptr, storage.ptr + storage.capacity);
+            }
+            return storage.view;
+          },
+          set: function(value) {
+            if (value && value.buffer === HEAPU8.buffer &&
+                value.byteOffset >= storage.ptr && value.byteOffset < storage.ptr + storage.capacity) {
+              // Keep data that would otherwise be freed along with the storage.
+              value = value.slice();
+            }
+            MEMFS.setHeapStorage(node, null);
+            node.contents = value;
+          },
+          enumerable: true,
+          configurable: true
+        }
+      });
+    },
+
+    // Heap storage is freed once the file no longer uses it and no mapping
+    // aliases it.
+    freeHeapStorage: function(storage) {
+      if (storage.detached && !storage.mappings) {
+        _free(storage.ptr);
+      }
+    },
+
+    // Called when a file is removed from its directory, so that its heap
+    // storage can be freed. Streams that are still open on it get a copy of
+    // the data.
+    releaseHeapStorage: function(node) {
+      if (!node) return;
+      // Files that have no heap storage yet are marked too, so that they are
+      // not given any later.
+      node.removed = true;
+      if (!node.heapStorage) return;
+      var open = FS.streams.some(function(stream) { return stream && stream.node === node; });
+      node.contents = open ? MEMFS.getFileDataAsTypedArray(node).slice() : null;
+    },
+
     node_ops: {
       getattr: function(node) {
         var attr = {};
@@ -200,6 +325,11 @@ mergeInto(LibraryManager.library, {
             }
           }
         }
+        // a file that is overwritten is removed
+        var replaced = new_dir.contents[new_name];
+        if (replaced && replaced !== old_node) {
+          MEMFS.releaseHeapStorage(replaced);
+        }
         // do the internal rewiring
         delete old_node.parent.contents[old_node.name];
         old_node.parent.timestamp = Date.now()
@@ -209,6 +339,7 @@ mergeInto(LibraryManager.library, {
         old_node.parent = new_dir;
       },
       unlink: function(parent, name) {
+        MEMFS.releaseHeapStorage(parent.contents[name]);
         delete parent.contents[name];
         parent.timestamp = Date.now();
       },
@@ -250,7 +381,9 @@ mergeInto(LibraryManager.library, {
 #if ASSERTIONS
         assert(size >= 0);
 #endif
-        if (size > 8 && contents.subarray) { // non-trivial, and typed array
+        if (contents.buffer === buffer.buffer) { // both in the heap: a plain memmove
+          HEAPU8.copyWithin(buffer.byteOffset + offset, contents.byteOffset + position, contents.byteOffset + position + size);
+        } else if (size > 8 && contents.subarray) { // non-trivial, and typed array
           buffer.set(contents.subarray(position, position + size), offset);
         } else {
           for (var i = 0; i < size; i++) buffer[offset + i] = contents[position + i];
@@ -283,6 +416,26 @@ mergeInto(LibraryManager.library, {
         var node = stream.node;
         node.timestamp = Date.now();
 
+#if MEMFS_HEAP_STORAGE
+        // File data lives in the heap, so it is never shared with the caller's
+        // buffer, and a write from the heap is a plain memmove. Growing the
+        // file can grow memory, so note where the source is before that.
+        var fromHeap = buffer.buffer === HEAPU8.buffer;
+        var src = buffer.byteOffset + offset;
+        MEMFS.expandFileStorage(node, position + length);
+        var storage = node.heapStorage;
+        if (fromHeap && storage) {
+          HEAPU8.copyWithin(storage.ptr + position, src, src + length);
+        } else if (fromHeap) {
+          node.contents.set(HEAPU8.subarray(src, src + length), position);
+        } else if (buffer.subarray) {
+          node.contents.set(buffer.subarray(offset, offset + length), position);
+        } else {
+          node.contents.set(buffer.slice(offset, offset + length), position);
+        }
+        node.usedBytes = Math.max(node.usedBytes, position + length);
+        return length;
+#else
         if (buffer.subarray && (!node.contents || node.contents.subarray)) { // This write is from a typed array to a typed array?
           if (canOwn) {
 #if ASSERTIONS
@@ -313,6 +466,7 @@ mergeInto(LibraryManager.library, {
         }
         node.usedBytes = Math.max(node.usedBytes, position + length);
         return length;
+#endif
       },
 
       llseek: function(stream, offset, whence) {
@@ -341,6 +495,44 @@ mergeInto(LibraryManager.library, {
         if (!FS.isFile(stream.node.mode)) {
           throw new FS.ErrnoError({{{ cDefine('ENODEV') }}});
         }
+        // Read-only mappings, private or shared, alias the file's storage in
+        // the heap. Moving the file there costs one copy, after which any
+        // number of mappings of it are free, and unmapping them needs no copy
+        // back. A MAP_PRIVATE mapping may see later writes to the file, which
+        // POSIX allows. Writable MAP_SHARED mappings of a file that is already
+        // in the heap alias it too.
+        var node = stream.node;
+        var writable = prot & {{{ cDefine('PROT_WRITE') }}};
+        // Files that were removed while open are copied instead.
+        if (!node.removed && (!writable || (!(flags & {{{ cDefine('MAP_PRIVATE') }}}) && node.heapStorage))) {
+          var storage = MEMFS.moveToHeap(node, position + length);
+          if (!storage) {
+            throw new FS.ErrnoError({{{ cDefine('ENOMEM') }}});
+          }
+          // The mapping keeps the storage alive even after the file moves off
+          // it, by growing or truncating.
+          storage.mappings++;
+          var mapped = storage.ptr + position;
+          // Once the file has moved off the storage, writes through the
+          // mapping no longer reach it, so they are copied back like those of
+          // a mapping that was never aliased.
+          var sync = function() {
+            if (writable && storage.detached) {
+              MEMFS.stream_ops.write({ node: node }, HEAPU8, mapped, length, position, false);
+            }
+          };
+          return {
+            ptr: mapped,
+            allocated: false,
+            aliased: true,
+            sync: sync,
+            release: function() {
+              sync();
+              storage.mappings--;
+              MEMFS.freeHeapStorage(storage);
+            }
+          };
+        }
         var ptr;
         var allocated;
         var contents = stream.node.contents;
@@ -11,7 +11,16 @@ var LibraryOpenAL = {
   // ** INTERNALS 
   // ************************************************************************
 
-  $AL__deps: ['$Browser'],
+  $AL__deps: ['$Browser',
+#if OPENAL_MIXER
+    'malloc', 'free',
+    'emscripten_al_mixer_create', 'emscripten_al_mixer_destroy',
+    'emscripten_al_mixer_play', 'emscripten_al_mixer_stop',
+    'emscripten_al_mixer_set_voice_rate', 'emscripten_al_mixer_set_voice_loop',
+    'emscripten_al_mixer_set_voice_gains', 'emscripten_al_mixer_render',
+    'emscripten_al_mixer_read', 'emscripten_al_mixer_get_time',
+#endif
+  ],
   $AL: {
     // ------------------------------------------------------
     // -- Constants 
@@ -19,6 +28,10 @@ var LibraryOpenAL = {
 
     QUEUE_INTERVAL: 25,
     QUEUE_LOOKAHEAD: 100.0 / 1000.0,
+#if OPENAL_MIXER
+    // Frames that the output node of a context plays per callback.
+    MIXER_BUFFER_SIZE: 1024,
+#endif
 
     DEVICE_NAME: 'Emscripten OpenAL',
     CAPTURE_DEVICE_NAME: 'Emscripten OpenAL capture',
@@ -86,6 +99,15 @@ var LibraryOpenAL = {
     // -- Mixing Logic
     // ------------------------------------------------------
 
+    // The time that sources are scheduled against.
+    getCurrentTime: function(ctx) {
+#if OPENAL_MIXER
+      return _emscripten_al_mixer_get_time(ctx.mixer);
+#else
+      return ctx.audioCtx.currentTime;
+#endif
+    },
+
     scheduleContextAudio: function(ctx) {
       // If we are animating using the requestAnimationFrame method, then the main loop does not run when in the background.
       // To give a perfect glitch-free audio stop when switching from foreground to background, we need to avoid updating
@@ -113,6 +135,9 @@ var LibraryOpenAL = {
       if (src.state !== 0x1012 /* AL_PLAYING */) {
         return;
       }
+#if OPENAL_MIXER
+      AL.updateMixerSourceGains(src);
+#endif
 
       var currentTime = AL.updateSourceTime(src);
 
@@ -151,7 +176,11 @@ var LibraryOpenAL = {
             break;
           }
         } else {
+#if OPENAL_MIXER
+          var audioSrc = AL.createMixerVoice(src);
+#else
           var audioSrc = src.context.audioCtx.createBufferSource();
+#endif
           audioSrc.buffer = buf.audioBuf;
           audioSrc.playbackRate.value = src.playbackRate;
           if (buf.audioBuf._loopStart || buf.audioBuf._loopEnd) {
@@ -183,10 +212,10 @@ var LibraryOpenAL = {
 
           if (typeof(audioSrc.start) !== 'undefined') {
             // Sample the current time as late as possible to mitigate drift
-            startTime = Math.max(startTime, src.context.audioCtx.currentTime);
+            startTime = Math.max(startTime, AL.getCurrentTime(src.context));
             audioSrc.start(startTime, startOffset);
           } else if (typeof(audioSrc.noteOn) !== 'undefined') {
-            startTime = Math.max(startTime, src.context.audioCtx.currentTime);
+            startTime = Math.max(startTime, AL.getCurrentTime(src.context));
             audioSrc.noteOn(startTime);
 #if OPENAL_DEBUG
             if (offset > 0.0) {
@@ -214,7 +243,7 @@ var LibraryOpenAL = {
 
     // Advance the state of a source forward to the current time
     updateSourceTime: function(src) {
-      var currentTime = src.context.audioCtx.currentTime;
+      var currentTime = AL.getCurrentTime(src.context);
       if (src.state !== 0x1012 /* AL_PLAYING */) {
         return currentTime;
       }
@@ -411,6 +440,12 @@ var LibraryOpenAL = {
         if (src.panner) {
           return;
         }
+#if OPENAL_MIXER
+        src.panner = AL.createMixerPanner();
+
+        AL.updateSourceGlobal(src);
+        AL.updateSourceSpace(src);
+#else
         src.panner = src.context.audioCtx.createPanner();
 
         AL.updateSourceGlobal(src);
@@ -419,14 +454,17 @@ var LibraryOpenAL = {
         src.panner.connect(src.context.gain);
         src.gain.disconnect();
         src.gain.connect(src.panner);
+#endif
       } else {
         if (!src.panner) {
           return;
         }
 
+#if !OPENAL_MIXER
         src.panner.disconnect();
         src.gain.disconnect();
         src.gain.connect(src.context.gain);
+#endif
         src.panner = null;
       }
     },
@@ -734,6 +772,287 @@ var LibraryOpenAL = {
       }
     },
 
+    createBuffer: function(channels, length, sampleRate) {
+#if OPENAL_MIXER
+      return AL.createMixerBuffer(channels, length, sampleRate);
+#else
+      return AL.currentCtx.audioCtx.createBuffer(channels, length, sampleRate);
+#endif
+    },
+
+#if OPENAL_MIXER
+    // ------------------------------------------------------
+    // -- Software Mixer
+    // ------------------------------------------------------
+
+    // With OPENAL_MIXER, sources are not played through Web Audio nodes of
+    // their own. Their buffers are mixed in wasm (see system/lib/al_mixer.c),
+    // and each context plays the result through a single output node. The
+    // objects below stand in for the nodes that the rest of this file uses.
+
+    // An AudioBuffer whose samples are kept in wasm memory, where the mixer
+    // reads them.
+    createMixerBuffer: function(channels, length, sampleRate) {
+      var ptr = _malloc(channels * length * 4);
+      if (!ptr) {
+        throw 'out of memory';
+      }
+      return {
+        _ptr: ptr,
+        numberOfChannels: channels,
+        length: length,
+        sampleRate: sampleRate,
+        duration: length / sampleRate,
+        getChannelData: function(channel) {
+          var start = (ptr >> 2) + channel * length;
+          return HEAPF32.subarray(start, start + length);
+        }
+      };
+    },
+
+    // The parameters of a PannerNode, which updateMixerSourceGains applies.
+    createMixerPanner: function() {
+      return {
+        refDistance: 1.0,
+        maxDistance: 10000.0,
+        rolloffFactor: 1.0,
+        coneInnerAngle: 360.0,
+        coneOuterAngle: 360.0,
+        coneOuterGain: 0.0,
+        distanceModel: 'inverse',
+        panningModel: 'equalpower',
+        position: [0.0, 0.0, 0.0],
+        orientation: [1.0, 0.0, 0.0],
+        setPosition: function(x, y, z) {
+          this.position[0] = x;
+          this.position[1] = y;
+          this.position[2] = z;
+        },
+        setOrientation: function(x, y, z) {
+          this.orientation[0] = x;
+          this.orientation[1] = y;
+          this.orientation[2] = z;
+        }
+      };
+    },
+
+    // An AudioBufferSourceNode, which plays its buffer on a voice of the mixer.
+    createMixerVoice: function(src) {
+      var ctx = src.context;
+      var voice = {
+        buffer: null,
+        loopStart: 0.0,
+        loopEnd: 0.0,
+        _handle: 0,
+        _loop: false,
+        get loop() {
+          return this._loop;
+        },
+        set loop(val) {
+          this._loop = val;
+          if (this._handle) {
+            _emscripten_al_mixer_set_voice_loop(ctx.mixer, this._handle, val);
+          }
+        },
+        playbackRate: {
+          _value: 1.0,
+          get value() {
+            return this._value;
+          },
+          set value(val) {
+            this._value = val;
+            if (voice._handle) {
+              _emscripten_al_mixer_set_voice_rate(ctx.mixer, voice._handle, val * voice.buffer.sampleRate / ctx.audioCtx.sampleRate);
+            }
+          }
+        },
+        connect: function() {},
+        start: function(when, offset) {
+          var buf = this.buffer;
+          var rate = ctx.audioCtx.sampleRate;
+          this._handle = _emscripten_al_mixer_play(ctx.mixer, buf._ptr, buf.length, buf.numberOfChannels,
+            when * rate, (offset || 0.0) * buf.sampleRate, this.playbackRate.value * buf.sampleRate / rate,
+            this._loop, this.loopStart * buf.sampleRate, this.loopEnd * buf.sampleRate);
+          var gains = src.mixerGains;
+          _emscripten_al_mixer_set_voice_gains(ctx.mixer, this._handle, gains[0], gains[1], gains[2], gains[3]);
+        },
+        stop: function() {
+          _emscripten_al_mixer_stop(ctx.mixer, this._handle);
+          this._handle = 0;
+        }
+      };
+      return voice;
+    },
+
+    // Computes how much of each channel of a source goes to the left and
+    // right outputs, the way its GainNode and an equal-power PannerNode would
+    // (see the Web Audio spec), and updates the voices that play it.
+    updateMixerSourceGains: function(src) {
+      var stereo = false;
+      for (var i = 0; i < src.bufQueue.length; i++) {
+        if (src.bufQueue[i].id !== 0) {
+          stereo = src.bufQueue[i].channels === 2;
+          break;
+        }
+      }
+
+      var gain = src.gain.gain.value;
+      var azimuth = 0.0;
+      var panner = src.panner;
+      if (panner) {
+        var listener = src.context.listener;
+        var sX = panner.position[0] - listener.position[0];
+        var sY = panner.position[1] - listener.position[1];
+        var sZ = panner.position[2] - listener.position[2];
+        var distance = Math.sqrt(sX * sX + sY * sY + sZ * sZ);
+
+        var refDistance = panner.refDistance;
+        var maxDistance = panner.maxDistance;
+        var rolloffFactor = panner.rolloffFactor;
+        switch (panner.distanceModel) {
+        case 'linear':
+          if (maxDistance > refDistance) {
+            var d = Math.min(Math.max(distance, refDistance), maxDistance);
+            gain *= 1.0 - rolloffFactor * (d - refDistance) / (maxDistance - refDistance);
+          }
+          break;
+        case 'inverse':
+          gain *= refDistance / (refDistance + rolloffFactor * (Math.max(distance, refDistance) - refDistance));
+          break;
+        case 'exponential':
+          gain *= Math.pow(Math.max(distance, refDistance) / refDistance, -rolloffFactor);
+          break;
+        }
+
+        if (distance > 0.0) {
+          sX /= distance;
+          sY /= distance;
+          sZ /= distance;
+
+          var oX = panner.orientation[0];
+          var oY = panner.orientation[1];
+          var oZ = panner.orientation[2];
+          var oLength = Math.sqrt(oX * oX + oY * oY + oZ * oZ);
+          if (oLength > 0.0 && (panner.coneInnerAngle !== 360.0 || panner.coneOuterAngle !== 360.0)) {
+            var cos = -(sX * oX + sY * oY + sZ * oZ) / oLength;
+            var angle = Math.acos(Math.min(Math.max(cos, -1.0), 1.0)) * 180.0 / Math.PI;
+            var innerAngle = panner.coneInnerAngle / 2.0;
+            var outerAngle = panner.coneOuterAngle / 2.0;
+            if (angle >= outerAngle) {
+              gain *= panner.coneOuterGain;
+            } else if (angle > innerAngle) {
+              var x = (angle - innerAngle) / (outerAngle - innerAngle);
+              gain *= 1.0 - x + panner.coneOuterGain * x;
+            }
+          }
+
+          // The listener orientation defaults to looking down -Z with +Y up.
+          var fX = listener.direction[0];
+          var fY = listener.direction[1];
+          var fZ = listener.direction[2];
+          var fLength = Math.sqrt(fX * fX + fY * fY + fZ * fZ);
+          if (fLength > 0.0) {
+            fX /= fLength;
+            fY /= fLength;
+            fZ /= fLength;
+          } else {
+            fZ = -1.0;
+          }
+          var uX = listener.up[0];
+          var uY = listener.up[1];
+          var uZ = listener.up[2];
+          if (uX === 0.0 && uY === 0.0 && uZ === 0.0) {
+            uY = 1.0;
+          }
+
+          var rX = fY * uZ - fZ * uY;
+          var rY = fZ * uX - fX * uZ;
+          var rZ = fX * uY - fY * uX;
+          var rLength = Math.sqrt(rX * rX + rY * rY + rZ * rZ);
+          if (rLength > 0.0) {
+            rX /= rLength;
+            rY /= rLength;
+            rZ /= rLength;
+
+            // Project the direction of the source onto the plane of the
+            // listener's right and forward vectors.
+            uX = rY * fZ - rZ * fY;
+            uY = rZ * fX - rX * fZ;
+            uZ = rX * fY - rY * fX;
+            var up = sX * uX + sY * uY + sZ * uZ;
+            var pX = sX - up * uX;
+            var pY = sY - up * uY;
+            var pZ = sZ - up * uZ;
+            var pLength = Math.sqrt(pX * pX + pY * pY + pZ * pZ);
+            if (pLength > 0.0) {
+              var cos = (pX * rX + pY * rY + pZ * rZ) / pLength;
+              azimuth = Math.acos(Math.min(Math.max(cos, -1.0), 1.0)) * 180.0 / Math.PI;
+              if (pX * fX + pY * fY + pZ * fZ < 0.0) {
+                azimuth = 360.0 - azimuth;
+              }
+              azimuth = azimuth <= 270.0 ? 90.0 - azimuth : 450.0 - azimuth;
+              if (azimuth < -90.0) {
+                azimuth = -180.0 - azimuth;
+              } else if (azimuth > 90.0) {
+                azimuth = 180.0 - azimuth;
+              }
+            }
+          }
+        }
+      }
+
+      // gains[i * 2 + o] is the gain from input channel i to output channel o.
+      var ll, lr, rl, rr;
+      if (!panner) {
+        ll = gain;
+        lr = stereo ? 0.0 : gain;
+        rl = 0.0;
+        rr = stereo ? gain : 0.0;
+      } else if (!stereo) {
+        var x = (azimuth + 90.0) / 180.0 * Math.PI / 2.0;
+        ll = gain * Math.cos(x);
+        lr = gain * Math.sin(x);
+        rl = 0.0;
+        rr = 0.0;
+      } else if (azimuth <= 0.0) {
+        var x = (azimuth + 90.0) / 90.0 * Math.PI / 2.0;
+        ll = gain;
+        lr = 0.0;
+        rl = gain * Math.cos(x);
+        rr = gain * Math.sin(x);
+      } else {
+        var x = azimuth / 90.0 * Math.PI / 2.0;
+        ll = gain * Math.cos(x);
+        lr = gain * Math.sin(x);
+        rl = 0.0;
+        rr = gain;
+      }
+
+      var gains = src.mixerGains;
+      if (gains[0] === ll && gains[1] === lr && gains[2] === rl && gains[3] === rr) {
+        return;
+      }
+      gains[0] = ll;
+      gains[1] = lr;
+      gains[2] = rl;
+      gains[3] = rr;
+      for (var i = 0; i < src.audioQueue.length; i++) {
+        _emscripten_al_mixer_set_voice_gains(src.context.mixer, src.audioQueue[i]._handle, ll, lr, rl, rr);
+      }
+    },
+
+    // Fills the output buffer of a context with the next frames of its mixer.
+    mixContextAudio: function(ctx, outputBuffer) {
+      var frames = outputBuffer.length;
+      var left = ctx.mixerOutput;
+      var right = left + frames * 4;
+      _emscripten_al_mixer_render(ctx.mixer, frames);
+      _emscripten_al_mixer_read(ctx.mixer, left, right, frames);
+      outputBuffer.getChannelData(0).set(HEAPF32.subarray(left >> 2, (left >> 2) + frames));
+      outputBuffer.getChannelData(1).set(HEAPF32.subarray(right >> 2, (right >> 2) + frames));
+    },
+
+#endif
     // ------------------------------------------------------
     // -- Accessor Helpers
     // ------------------------------------------------------
@@ -2233,6 +2552,13 @@ var LibraryOpenAL = {
         }
       }
     };
+#if OPENAL_MIXER
+    ctx.mixer = _emscripten_al_mixer_create(ac.sampleRate);
+    ctx.mixerOutput = _malloc(AL.MIXER_BUFFER_SIZE * 2 * 4);
+    ctx.outputNode = ac.createScriptProcessor(AL.MIXER_BUFFER_SIZE, 0, 2);
+    ctx.outputNode.onaudioprocess = function(e) { AL.mixContextAudio(ctx, e.outputBuffer); };
+    ctx.outputNode.connect(gain);
+#endif
     AL.deviceRefCounts[deviceId]++;
     AL.contexts[ctx.id] = ctx;
 
@@ -2266,6 +2592,12 @@ var LibraryOpenAL = {
     if (AL.contexts[contextId].interval) {
       clearInterval(AL.contexts[contextId].interval);
     }
+#if OPENAL_MIXER
+    ctx.outputNode.disconnect();
+    ctx.outputNode.onaudioprocess = null;
+    _emscripten_al_mixer_destroy(ctx.mixer);
+    _free(ctx.mixerOutput);
+#endif
     AL.deviceRefCounts[ctx.deviceId]--;
     delete AL.contexts[contextId];
     AL.freeIds.push(contextId);
@@ -2822,6 +3154,11 @@ var LibraryOpenAL = {
       }
 
       AL.deviceRefCounts[AL.buffers[bufId].deviceId]--;
+#if OPENAL_MIXER
+      if (AL.buffers[bufId].audioBuf) {
+        _free(AL.buffers[bufId].audioBuf._ptr);
+      }
+#endif
       delete AL.buffers[bufId];
       AL.freeIds.push(bufId);
     }
@@ -2837,8 +3174,12 @@ var LibraryOpenAL = {
       return;
     }
     for (var i = 0; i < count; ++i) {
+#if OPENAL_MIXER
+      var gain = { gain: { value: 1.0 } };
+#else
       var gain = AL.currentCtx.audioCtx.createGain();
       gain.connect(AL.currentCtx.gain);
+#endif
       var src = {
         context: AL.currentCtx,
         id: AL.newId(),
@@ -2868,6 +3209,9 @@ var LibraryOpenAL = {
         coneOuterAngle: 360.0,
         distanceModel: 0xd002 /* AL_INVERSE_DISTANCE_CLAMPED */,
         spatialize: 2 /* AL_AUTO_SOFT */,
+#if OPENAL_MIXER
+        mixerGains: [0.0, 0.0, 0.0, 0.0],
+#endif
 
         get playbackRate() {
           return this.pitch * this.dopplerShift;
@@ -3766,13 +4110,24 @@ var LibraryOpenAL = {
       AL.currentCtx.err = 0xA003 /* AL_INVALID_VALUE */;
       return;
     }
+#if OPENAL_MIXER
+    // Voices of the mixer read the samples of the buffer in place, so they
+    // can't be replaced while sources use them.
+    if (buf.refCount) {
+#if OPENAL_DEBUG
+      err('alBufferData() called with a used buffer');
+#endif
+      AL.currentCtx.err = 0xA004 /* AL_INVALID_OPERATION */;
+      return;
+    }
+#endif
 
     var audioBuf = null;
     try {
       switch (format) {
       case 0x1100 /* AL_FORMAT_MONO8 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(1, size, freq);
+          audioBuf = AL.createBuffer(1, size, freq);
           var channel0 = audioBuf.getChannelData(0);
           for (var i = 0; i < size; ++i) {
             channel0[i] = HEAPU8[pData++] * 0.0078125 /* 1/128 */ - 1.0;
@@ -3784,7 +4139,7 @@ var LibraryOpenAL = {
         break;
       case 0x1101 /* AL_FORMAT_MONO16 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(1, size >> 1, freq);
+          audioBuf = AL.createBuffer(1, size >> 1, freq);
           var channel0 = audioBuf.getChannelData(0);
           pData >>= 1;
           for (var i = 0; i < size >> 1; ++i) {
@@ -3797,7 +4152,7 @@ var LibraryOpenAL = {
         break;
       case 0x1102 /* AL_FORMAT_STEREO8 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(2, size >> 1, freq);
+          audioBuf = AL.createBuffer(2, size >> 1, freq);
           var channel0 = audioBuf.getChannelData(0);
           var channel1 = audioBuf.getChannelData(1);
           for (var i = 0; i < size >> 1; ++i) {
@@ -3811,7 +4166,7 @@ var LibraryOpenAL = {
         break;
       case 0x1103 /* AL_FORMAT_STEREO16 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(2, size >> 2, freq);
+          audioBuf = AL.createBuffer(2, size >> 2, freq);
           var channel0 = audioBuf.getChannelData(0);
           var channel1 = audioBuf.getChannelData(1);
           pData >>= 1;
@@ -3826,7 +4181,7 @@ var LibraryOpenAL = {
         break;
       case 0x10010 /* AL_FORMAT_MONO_FLOAT32 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(1, size >> 2, freq);
+          audioBuf = AL.createBuffer(1, size >> 2, freq);
           var channel0 = audioBuf.getChannelData(0);
           pData >>= 2;
           for (var i = 0; i < size >> 2; ++i) {
@@ -3839,7 +4194,7 @@ var LibraryOpenAL = {
         break;
       case 0x10011 /* AL_FORMAT_STEREO_FLOAT32 */:
         if (size > 0) {
-          audioBuf = AL.currentCtx.audioCtx.createBuffer(2, size >> 3, freq);
+          audioBuf = AL.createBuffer(2, size >> 3, freq);
           var channel0 = audioBuf.getChannelData(0);
           var channel1 = audioBuf.getChannelData(1);
           pData >>= 2;
@@ -3860,6 +4215,11 @@ var LibraryOpenAL = {
         return;
       }
       buf.frequency = freq;
+#if OPENAL_MIXER
+      if (buf.audioBuf) {
+        _free(buf.audioBuf._ptr);
+      }
+#endif
       buf.audioBuf = audioBuf;
     } catch (e) {
 #if OPENAL_DEBUG
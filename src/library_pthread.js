@@ -25,6 +25,11 @@ var LibraryPThread = {
     // Contains all Workers that are currently hosting an active pthread.
     runningWorkers: [],
     tlsInitFunctions: [],
+#if PTHREAD_REUSE_CACHE
+    // Stacks of exited threads, as [stackBase, stackSize] pairs, kept for
+    // reuse by the next thread that needs a stack of the same size.
+    freeStacks: [],
+#endif
     initMainThreadBlock: function() {
 #if ASSERTIONS
       assert(!ENVIRONMENT_IS_PTHREAD);
@@ -45,6 +50,9 @@ var LibraryPThread = {
       // things.
       PThread['receiveObjectTransfer'] = PThread.receiveObjectTransfer;
       PThread['threadInit'] = PThread.threadInit;
+#if PTHREAD_REUSE_CACHE
+      PThread['parkWorker'] = PThread.parkWorker;
+#endif
 #if !MINIMAL_RUNTIME
       PThread['setExitStatus'] = PThread.setExitStatus;
 #endif
@@ -224,6 +232,73 @@ var LibraryPThread = {
         PThread.tlsInitFunctions[i]();
       }
     },
+#if PTHREAD_REUSE_CACHE
+    // Each Worker has a park slot in the heap, shared with the main thread:
+    //   slot[0]: the park state, one of:
+    //     0: running a thread, and will park if the thread exits.
+    //     1: parked, waiting for a new thread.
+    //     2: a new thread has been handed over in slot[1..5].
+    //     3: back in its event loop, needs a 'run' message to start a thread.
+    //   slot[1..5]: threadInfoStruct, start_routine, arg, stackBase, stackSize
+    // Called by worker.js when the thread it was running returns to the event
+    // loop. Returns the 'run' command data of the next thread to run on this
+    // Worker, or null if it should go back to its event loop.
+    parkWorker: function(slot) {
+      var s = slot >> 2;
+      if (_pthread_self()) {
+        // The thread unwound to keep running asynchronously, so this Worker
+        // must go back to its event loop to service it.
+        Atomics.store(HEAP32, s, 3);
+        return null;
+      }
+      // Wait for a new thread, unless the main thread has already handed one
+      // over.
+      if (Atomics.compareExchange(HEAP32, s, 0, 1) == 0) {
+        Atomics.wait(HEAP32, s, 1, 1000);
+        if (Atomics.compareExchange(HEAP32, s, 1, 3) == 1) {
+          // Timed out.
+          return null;
+        }
+      }
+      Atomics.store(HEAP32, s, 0);
+      return {
+        'threadInfoStruct': HEAP32[s + 1],
+        'start_routine': HEAP32[s + 2],
+        'arg': HEAP32[s + 3],
+        'stackBase': HEAP32[s + 4],
+        'stackSize': HEAP32[s + 5],
+        'parkSlot': slot
+      };
+    },
+    // Hands a thread over to a parked Worker. Returns false if the Worker has
+    // already gone back to its event loop.
+    unparkWorker: function(worker, threadParams) {
+      var s = worker.parkSlot >> 2;
+      HEAP32[s + 1] = threadParams.pthread_ptr;
+      HEAP32[s + 2] = threadParams.startRoutine;
+      HEAP32[s + 3] = threadParams.arg;
+      HEAP32[s + 4] = threadParams.stackBase;
+      HEAP32[s + 5] = threadParams.stackSize;
+      var state = Atomics.load(HEAP32, s);
+      while (state != 3) {
+        var prev = Atomics.compareExchange(HEAP32, s, state, 2);
+        if (prev == state) {
+          if (state == 1) Atomics.notify(HEAP32, s);
+          return true;
+        }
+        state = prev;
+      }
+      return false;
+    },
+    takeFreeStack: function(stackSize) {
+      for (var i = PThread.freeStacks.length - 1; i >= 0; --i) {
+        if (PThread.freeStacks[i][1] == stackSize) {
+          return PThread.freeStacks.splice(i, 1)[0][0];
+        }
+      }
+      return 0;
+    },
+#endif
     // Loads the WebAssembly module into the given list of Workers.
     // onFinishedLoading: A callback function that will be called once all of
     //                    the workers have been initialized and are
@@ -441,10 +516,24 @@ var LibraryPThread = {
       {{{ makeSetValue('pthread.threadInfoStruct',  C_STRUCTS.pthread.profilerBlock, 0, 'i32') }}};
       _free(profilerBlock);
 #endif
+#if PTHREAD_REUSE_CACHE
+      __emscripten_thread_free_data(pthread.threadInfoStruct);
+#else
       _free(pthread.threadInfoStruct);
+#endif
     }
     pthread.threadInfoStruct = 0;
-    if (pthread.allocatedOwnStack && pthread.stackBase) _free(pthread.stackBase);
+    if (pthread.allocatedOwnStack && pthread.stackBase) {
+#if PTHREAD_REUSE_CACHE
+      if (PThread.freeStacks.length < {{{ PTHREAD_REUSE_CACHE }}}) {
+        PThread.freeStacks.push([pthread.stackBase, pthread.stackSize]);
+      } else {
+        _free(pthread.stackBase);
+      }
+#else
+      _free(pthread.stackBase);
+#endif
+    }
     pthread.stackBase = 0;
     if (pthread.worker) pthread.worker.pthread = null;
   },
@@ -462,6 +551,9 @@ var LibraryPThread = {
     var pthread = PThread.pthreads[pthread_ptr];
     delete PThread.pthreads[pthread_ptr];
     pthread.worker.terminate();
+#if PTHREAD_REUSE_CACHE
+    if (pthread.worker.parkSlot) _free(pthread.worker.parkSlot);
+#endif
     freeThreadData(pthread);
     // The worker was completely nuked (not just the pthread execution it was hosting), so remove it from running workers
     // but don't put it back to the pool.
@@ -589,13 +681,27 @@ var LibraryPThread = {
 #endif
 
     worker.pthread = pthread;
+#if PTHREAD_REUSE_CACHE
+    // If the Worker is still parked after running its previous thread, start
+    // the new thread on it directly.
+    if (worker.parkSlot && !threadParams.transferList.length && PThread.unparkWorker(worker, threadParams)) {
+      return 0;
+    }
+    if (!worker.parkSlot) {
+      worker.parkSlot = _malloc(24);
+    }
+    Atomics.store(HEAP32, worker.parkSlot >> 2, 0);
+#endif
     var msg = {
         'cmd': 'run',
         'start_routine': threadParams.startRoutine,
         'arg': threadParams.arg,
         'threadInfoStruct': threadParams.pthread_ptr,
         'stackBase': threadParams.stackBase,
-        'stackSize': threadParams.stackSize
+        'stackSize': threadParams.stackSize,
+#if PTHREAD_REUSE_CACHE
+        'parkSlot': worker.parkSlot
+#endif
     };
 #if OFFSCREENCANVAS_SUPPORT
     // Note that we do not need to quote these names because they are only used
@@ -635,7 +741,13 @@ var LibraryPThread = {
     // Pass the thread address to the native code where they stored in wasm
     // globals which act as a form of TLS. Global constructors trying
     // to access this value will read the wrong value, but that is UB anyway.
-    __emscripten_thread_init(tb, /*isMainBrowserThread=*/!ENVIRONMENT_IS_WORKER, /*isMainRuntimeThread=*/1);
+    __emscripten_thread_init(tb, /*isMainBrowserThread=*/!ENVIRONMENT_IS_WORKER, /*isMainRuntimeThread=*/1,
+                             // Atomics.wait (and so memory.atomic.wait32) is
+                             // only disallowed on the main browser thread.
+                             /*canBlock=*/!ENVIRONMENT_IS_WEB);
+#if PTHREAD_REUSE_CACHE
+    HEAP32[__emscripten_thread_reuse_cache_size >> 2] = {{{ PTHREAD_REUSE_CACHE }}};
+#endif
 #if ASSERTIONS
     PThread.mainRuntimeThread = true;
 #endif
@@ -800,7 +912,12 @@ var LibraryPThread = {
     if (allocatedOwnStack) {
       // Allocate a stack if the user doesn't want to place the stack in a
       // custom memory area.
-      stackBase = _memalign({{{ STACK_ALIGN }}}, stackSize);
+#if PTHREAD_REUSE_CACHE
+      stackBase = PThread.takeFreeStack(stackSize);
+#endif
+      if (!stackBase) {
+        stackBase = _memalign({{{ STACK_ALIGN }}}, stackSize);
+      }
     } else {
       // Musl stores the stack base address assuming stack grows downwards, so
       // adjust it to Emscripten convention that the
@@ -868,7 +985,10 @@ var LibraryPThread = {
 #endif
   },
 
-  _emscripten_do_pthread_join__deps: ['$cleanupThread', 'pthread_testcancel', 'emscripten_main_thread_process_queued_calls', 'emscripten_futex_wait', 'pthread_self', 'emscripten_main_browser_thread_id',
+  // Joins |thread| if it has exited, and returns EBUSY otherwise. Blocking
+  // joins wait for the thread in C (see pthread_join.c), so that the wait can
+  // suspend the main browser thread with MAIN_THREAD_ASYNC_WAIT.
+  _emscripten_do_pthread_join__deps: ['$cleanupThread', 'pthread_self', 'emscripten_main_browser_thread_id',
 #if ASSERTIONS || IN_TEST_HARNESS || !MINIMAL_RUNTIME || !ALLOW_BLOCKING_ON_MAIN_THREAD
   'emscripten_check_blocking_allowed'
 #endif
@@ -904,34 +1024,24 @@ var LibraryPThread = {
     }
 #endif
 
-    for (;;) {
-      var threadStatus = Atomics.load(HEAPU32, (thread + {{{ C_STRUCTS.pthread.threadStatus }}} ) >> 2);
-      if (threadStatus == 1) { // Exited?
-        if (status) {
-          var result = Atomics.load(HEAPU32, (thread + {{{ C_STRUCTS.pthread.result }}} ) >> 2);
-          {{{ makeSetValue('status', 0, 'result', 'i32') }}};
-        }
-        // Mark the thread as detached.
-        Atomics.store(HEAPU32, (thread + {{{ C_STRUCTS.pthread.detached }}} ) >> 2, 1);
-        if (!ENVIRONMENT_IS_PTHREAD) cleanupThread(thread);
-        else postMessage({ 'cmd': 'cleanupThread', 'thread': thread });
-        return 0;
-      }
-      if (!block) {
-        return {{{ cDefine('EBUSY') }}};
-      }
-      _pthread_testcancel();
-      // In main runtime thread (the thread that initialized the Emscripten C
-      // runtime and launched main()), assist pthreads in performing operations
-      // that they need to access the Emscripten main runtime for.
-      if (!ENVIRONMENT_IS_PTHREAD) _emscripten_main_thread_process_queued_calls();
-      _emscripten_futex_wait(thread + {{{ C_STRUCTS.pthread.threadStatus }}}, threadStatus, ENVIRONMENT_IS_PTHREAD ? 100 : 1);
+    var threadStatus = Atomics.load(HEAPU32, (thread + {{{ C_STRUCTS.pthread.threadStatus }}} ) >> 2);
+    if (threadStatus != 1) { // Not exited yet?
+      return {{{ cDefine('EBUSY') }}};
+    }
+    if (status) {
+      var result = Atomics.load(HEAPU32, (thread + {{{ C_STRUCTS.pthread.result }}} ) >> 2);
+      {{{ makeSetValue('status', 0, 'result', 'i32') }}};
     }
+    // Mark the thread as detached.
+    Atomics.store(HEAPU32, (thread + {{{ C_STRUCTS.pthread.detached }}} ) >> 2, 1);
+    if (!ENVIRONMENT_IS_PTHREAD) cleanupThread(thread);
+    else postMessage({ 'cmd': 'cleanupThread', 'thread': thread });
+    return 0;
   },
 
   __pthread_join_js__deps: ['_emscripten_do_pthread_join'],
-  __pthread_join_js: function(thread, status) {
-    return __emscripten_do_pthread_join(thread, status, true);
+  __pthread_join_js: function(thread, status, block) {
+    return __emscripten_do_pthread_join(thread, status, block);
   },
 
   pthread_tryjoin_np__deps: ['_emscripten_do_pthread_join'],
@@ -990,179 +1100,6 @@ var LibraryPThread = {
     postMessage({ 'cmd': 'detachedExit' });
   },
 
-  // Returns 0 on success, or one of the values -ETIMEDOUT, -EWOULDBLOCK or -EINVAL on error.
-  emscripten_futex_wait__deps: ['emscripten_main_thread_process_queued_calls'],
-  emscripten_futex_wait: function(addr, val, timeout) {
-    if (addr <= 0 || addr > HEAP8.length || addr&3 != 0) return -{{{ cDefine('EINVAL') }}};
-    // We can do a normal blocking wait anywhere but on the main browser thread.
-    if (!ENVIRONMENT_IS_WEB) {
-#if PTHREADS_PROFILING
-      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
-#endif
-      var ret = Atomics.wait(HEAP32, addr >> 2, val, timeout);
-#if PTHREADS_PROFILING
-      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
-#endif
-      if (ret === 'timed-out') return -{{{ cDefine('ETIMEDOUT') }}};
-      if (ret === 'not-equal') return -{{{ cDefine('EWOULDBLOCK') }}};
-      if (ret === 'ok') return 0;
-      throw 'Atomics.wait returned an unexpected value ' + ret;
-    } else {
-      // First, check if the value is correct for us to wait on.
-      if (Atomics.load(HEAP32, addr >> 2) != val) {
-        return -{{{ cDefine('EWOULDBLOCK') }}};
-      }
-
-      // Atomics.wait is not available in the main browser thread, so simulate it via busy spinning.
-      var tNow = performance.now();
-      var tEnd = tNow + timeout;
-
-#if PTHREADS_PROFILING
-      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
-#endif
-      // Register globally which address the main thread is simulating to be
-      // waiting on. When zero, the main thread is not waiting on anything, and on
-      // nonzero, the contents of the address pointed by __emscripten_main_thread_futex
-      // tell which address the main thread is simulating its wait on.
-      // We need to be careful of recursion here: If we wait on a futex, and
-      // then call _emscripten_main_thread_process_queued_calls() below, that
-      // will call code that takes the proxying mutex - which can once more
-      // reach this code in a nested call. To avoid interference between the
-      // two (there is just a single __emscripten_main_thread_futex at a time), unmark
-      // ourselves before calling the potentially-recursive call. See below for
-      // how we handle the case of our futex being notified during the time in
-      // between when we are not set as the value of __emscripten_main_thread_futex.
-#if ASSERTIONS
-      assert(__emscripten_main_thread_futex > 0);
-#endif
-      var lastAddr = Atomics.exchange(HEAP32, __emscripten_main_thread_futex >> 2, addr);
-#if ASSERTIONS
-      // We must not have already been waiting.
-      assert(lastAddr == 0);
-#endif
-
-      while (1) {
-        // Check for a timeout.
-        tNow = performance.now();
-        if (tNow > tEnd) {
-#if PTHREADS_PROFILING
-          PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
-#endif
-          // We timed out, so stop marking ourselves as waiting.
-          lastAddr = Atomics.exchange(HEAP32, __emscripten_main_thread_futex >> 2, 0);
-#if ASSERTIONS
-          // The current value must have been our address which we set, or
-          // in a race it was set to 0 which means another thread just allowed
-          // us to run, but (tragically) that happened just a bit too late.
-          assert(lastAddr == addr || lastAddr == 0);
-#endif
-          return -{{{ cDefine('ETIMEDOUT') }}};
-        }
-        // We are performing a blocking loop here, so we must handle proxied
-        // events from pthreads, to avoid deadlocks.
-        // Note that we have to do so carefully, as we may take a lock while
-        // doing so, which can recurse into this function; stop marking
-        // ourselves as waiting while we do so.
-        lastAddr = Atomics.exchange(HEAP32, __emscripten_main_thread_futex >> 2, 0);
-#if ASSERTIONS
-        assert(lastAddr == addr || lastAddr == 0);
-#endif
-        if (lastAddr == 0) {
-          // We were told to stop waiting, so stop.
-          break;
-        }
-        _emscripten_main_thread_process_queued_calls();
-
-        // Check the value, as if we were starting the futex all over again.
-        // This handles the following case:
-        //
-        //  * wait on futex A
-        //  * recurse into emscripten_main_thread_process_queued_calls(),
-        //    which waits on futex B. that sets the __emscripten_main_thread_futex address to
-        //    futex B, and there is no longer any mention of futex A.
-        //  * a worker is done with futex A. it checks __emscripten_main_thread_futex but does
-        //    not see A, so it does nothing special for the main thread.
-        //  * a worker is done with futex B. it flips mainThreadMutex from B
-        //    to 0, ending the wait on futex B.
-        //  * we return to the wait on futex A. __emscripten_main_thread_futex is 0, but that
-        //    is because of futex B being done - we can't tell from
-        //    __emscripten_main_thread_futex whether A is done or not. therefore, check the
-        //    memory value of the futex.
-        //
-        // That case motivates the design here. Given that, checking the memory
-        // address is also necessary for other reasons: we unset and re-set our
-        // address in __emscripten_main_thread_futex around calls to
-        // emscripten_main_thread_process_queued_calls(), and a worker could
-        // attempt to wake us up right before/after such times.
-        //
-        // Note that checking the memory value of the futex is valid to do: we
-        // could easily have been delayed (relative to the worker holding on
-        // to futex A), which means we could be starting all of our work at the
-        // later time when there is no need to block. The only "odd" thing is
-        // that we may have caused side effects in that "delay" time. But the
-        // only side effects we can have are to call
-        // emscripten_main_thread_process_queued_calls(). That is always ok to
-        // do on the main thread (it's why it is ok for us to call it in the
-        // middle of this function, and elsewhere). So if we check the value
-        // here and return, it's the same is if what happened on the main thread
-        // was the same as calling emscripten_main_thread_process_queued_calls()
-        // a few times times before calling emscripten_futex_wait().
-        if (Atomics.load(HEAP32, addr >> 2) != val) {
-          return -{{{ cDefine('EWOULDBLOCK') }}};
-        }
-
-        // Mark us as waiting once more, and continue the loop.
-        lastAddr = Atomics.exchange(HEAP32, __emscripten_main_thread_futex >> 2, addr);
-#if ASSERTIONS
-        assert(lastAddr == 0);
-#endif
-      }
-#if PTHREADS_PROFILING
-      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
-#endif
-      return 0;
-    }
-  },
-
-  // Returns the number of threads (>= 0) woken up, or the value -EINVAL on error.
-  // Pass count == INT_MAX to wake up all threads.
-  emscripten_futex_wake: function(addr, count) {
-    if (addr <= 0 || addr > HEAP8.length || addr&3 != 0 || count < 0) return -{{{ cDefine('EINVAL') }}};
-    if (count == 0) return 0;
-    // Waking (at least) INT_MAX waiters is defined to mean wake all callers.
-    // For Atomics.notify() API Infinity is to be passed in that case.
-    if (count >= {{{ cDefine('INT_MAX') }}}) count = Infinity;
-
-    // See if main thread is waiting on this address? If so, wake it up by resetting its wake location to zero.
-    // Note that this is not a fair procedure, since we always wake main thread first before any workers, so
-    // this scheme does not adhere to real queue-based waiting.
-#if ASSERTIONS
-    assert(__emscripten_main_thread_futex > 0);
-#endif
-    var mainThreadWaitAddress = Atomics.load(HEAP32, __emscripten_main_thread_futex >> 2);
-    var mainThreadWoken = 0;
-    if (mainThreadWaitAddress == addr) {
-#if ASSERTIONS
-      // We only use __emscripten_main_thread_futex on the main browser thread, where we
-      // cannot block while we wait. Therefore we should only see it set from
-      // other threads, and not on the main thread itself. In other words, the
-      // main thread must never try to wake itself up!
-      assert(!ENVIRONMENT_IS_WEB);
-#endif
-      var loadedAddr = Atomics.compareExchange(HEAP32, __emscripten_main_thread_futex >> 2, mainThreadWaitAddress, 0);
-      if (loadedAddr == mainThreadWaitAddress) {
-        --count;
-        mainThreadWoken = 1;
-        if (count <= 0) return 1;
-      }
-    }
-
-    // Wake any workers waiting on this address.
-    var ret = Atomics.notify(HEAP32, addr >> 2, count);
-    if (ret >= 0) return ret + mainThreadWoken;
-    throw 'Atomics.notify returned an unexpected value ' + ret;
-  },
-
   __atomic_is_lock_free: function(size, ptr) {
     return size <= 4 && (size & (size-1)) == 0 && (ptr&(size-1)) == 0;
   },
@@ -1192,35 +1129,6 @@ var LibraryPThread = {
 #endif
   },
 
-  emscripten_set_current_thread_status_js: function(newStatus) {
-#if PTHREADS_PROFILING
-    PThread.setThreadStatus(_pthread_self(), newStatus);
-#endif
-  },
-
-  // The profiler setters are defined twice, here in asm.js so that they can be #if'ed out
-  // without having to pay the impact of a FFI transition for a no-op in non-profiling builds.
-  emscripten_conditional_set_current_thread_status__asm: true,
-  emscripten_conditional_set_current_thread_status__sig: 'vii',
-  emscripten_conditional_set_current_thread_status__deps: ['emscripten_conditional_set_current_thread_status_js'],
-  emscripten_conditional_set_current_thread_status: function(expectedStatus, newStatus) {
-#if PTHREADS_PROFILING
-    expectedStatus = expectedStatus|0;
-    newStatus = newStatus|0;
-    _emscripten_conditional_set_current_thread_status_js(expectedStatus|0, newStatus|0);
-#endif
-  },
-
-  emscripten_set_current_thread_status__asm: true,
-  emscripten_set_current_thread_status__sig: 'vi',
-  emscripten_set_current_thread_status__deps: ['emscripten_set_current_thread_status_js'],
-  emscripten_set_current_thread_status: function(newStatus) {
-#if PTHREADS_PROFILING
-    newStatus = newStatus|0;
-    _emscripten_set_current_thread_status_js(newStatus|0);
-#endif
-  },
-
   emscripten_set_thread_name__asm: true,
   emscripten_set_thread_name__sig: 'vii',
   emscripten_set_thread_name: function(threadId, name) {
@@ -1379,6 +1287,53 @@ var LibraryPThread = {
       worker.postMessage({'cmd' : 'processThreadQueue'});
     }
     return 1;
+  },
+
+  // Called on the main browser thread by emscripten_futex_wait() and
+  // emscripten_thread_sleep(). With MAIN_THREAD_ASYNC_WAIT, suspends the
+  // calling code with Asyncify until |addr| is woken or |timeout| msecs have
+  // passed, and returns 0, -EWOULDBLOCK or -ETIMEDOUT like
+  // emscripten_futex_wait(). A zero |addr| just sleeps. Returns 1 if the wait
+  // cannot be done asynchronously, in which case the caller busy-waits.
+#if MAIN_THREAD_ASYNC_WAIT
+  _emscripten_main_thread_wait_async__deps: ['$Asyncify', '$safeSetTimeout', '$callUserCallback'],
+#endif
+  _emscripten_main_thread_wait_async__sig: 'iiid',
+  _emscripten_main_thread_wait_async: function(addr, val, timeout) {
+#if MAIN_THREAD_ASYNC_WAIT
+    // Code that runs while the main thread is already suspended cannot
+    // suspend again, and neither can wasm called from JS called from wasm.
+    if (Asyncify.currData && Asyncify.state === Asyncify.State.Normal) return 1;
+    if (Asyncify.exportCallStack.length > 1) return 1;
+    if (addr && typeof Atomics.waitAsync !== 'function') return 1;
+    return Asyncify.handleSleep(function(wakeUp) {
+      if (!addr) {
+        safeSetTimeout(wakeUp, timeout);
+        return;
+      }
+      var result = Atomics.waitAsync(HEAP32, addr >> 2, val, timeout);
+      if (!result.async) {
+        wakeUp(result.value === 'not-equal' ? -{{{ cDefine('EWOULDBLOCK') }}} : -{{{ cDefine('ETIMEDOUT') }}});
+        return;
+      }
+      {{{ runtimeKeepalivePush() }}}
+#if ENVIRONMENT_MAY_BE_NODE
+      // A pending Atomics.waitAsync() does not keep node running on its own.
+      var keepNodeAlive = ENVIRONMENT_IS_NODE && setInterval(function() {}, 1000);
+#endif
+      result.value.then(function(value) {
+        {{{ runtimeKeepalivePop() }}}
+#if ENVIRONMENT_MAY_BE_NODE
+        if (keepNodeAlive) clearInterval(keepNodeAlive);
+#endif
+        callUserCallback(function() {
+          wakeUp(value === 'ok' ? 0 : -{{{ cDefine('ETIMEDOUT') }}});
+        });
+      });
+    });
+#else
+    return 1;
+#endif
   }
 };
 
@@ -0,0 +1,157 @@
+/**
+ * @license
+ * Copyright 2021 The Emscripten Authors
+ * SPDX-License-Identifier: MIT
+ */
+
+// Support for -s SNAPSHOT. At link time emcc runs the program in node until it
+// calls emscripten_snapshot_point(), which records memory and the files the
+// program created (see take_snapshot() in tools/building.py). emcc then makes
+// that the initial contents of memory in the wasm, so that when the program
+// runs it skips its global constructors, recreates the files, and calls main()
+// on the state that main() set up during the snapshot run.
+
+var LibrarySnapshot = {
+  $Snapshot__deps: [
+#if FILESYSTEM && !WASMFS
+    '$FS', '$MEMFS', '$PATH',
+#endif
+  ],
+  $Snapshot: {
+    // The size of the table before the global constructors run. Functions that
+    // are added to it later cannot be recorded in a snapshot.
+    tableSize: 0,
+
+    // Runs in place of the global constructors.
+    init: function() {
+      var state = __emscripten_snapshot_state();
+      if (HEAPU32[state >> 2]) {
+#if FILESYSTEM && !WASMFS
+        Snapshot.restoreFiles(HEAPU32[(state >> 2) + 1]);
+#endif
+        return;
+      }
+      Snapshot.tableSize = wasmTable.length;
+      Module['asm']['__wasm_call_ctors']();
+    },
+
+    // Writes the parts of the snapshot to files whose names start with output,
+    // and exits. emcc fills in the state in _emscripten_snapshot_state() when
+    // it copies them into the wasm.
+    take: function(output) {
+      if (wasmTable.length != Snapshot.tableSize) {
+        abort('functions were added to the table before emscripten_snapshot_point(), which a snapshot cannot record');
+      }
+#if FILESYSTEM && !WASMFS
+      FS.streams.forEach(function(stream, fd) {
+        if (stream && fd > 2) {
+          abort('file ' + stream.path + ' is open in emscripten_snapshot_point(), but open files cannot be recorded in a snapshot');
+        }
+      });
+      var files = Snapshot.captureFiles();
+#else
+      var files = new Uint8Array(0);
+#endif
+      var heapEnd = _sbrk(0) >>> 0;
+      var fs = require('fs');
+      fs.writeFileSync(output, HEAPU8.subarray(0, heapEnd));
+      fs.writeFileSync(output + '.files', files);
+      fs.writeFileSync(output + '.json', JSON.stringify({
+        'state': __emscripten_snapshot_state() >>> 0,
+        'heapEnd': heapEnd,
+        'stackPointer': stackSave() >>> 0,
+        'stackBase': _emscripten_stack_get_base() >>> 0,
+        'stackEnd': _emscripten_stack_get_end() >>> 0,
+        'tableSize': wasmTable.length,
+      }));
+      process['exit'](0);
+    },
+
+#if FILESYSTEM && !WASMFS
+    // Returns the directories, files and symlinks in MEMFS. They are stored as
+    // the length of a JSON list of [path, mode, ...] entries, the list itself
+    // with a null terminator, and then the contents of the files.
+    captureFiles: function() {
+      var entries = [];
+      var contents = [];
+      var size = 0;
+      function capture(path) {
+        var node = FS.lookupPath(path).node;
+        if (node.mount.type !== MEMFS || FS.isChrdev(node.mode)) {
+          return;
+        }
+        if (FS.isDir(node.mode)) {
+          if (path !== '/') {
+            entries.push([path, node.mode]);
+          }
+          FS.readdir(path).forEach(function(name) {
+            if (name !== '.' && name !== '..') {
+              capture(PATH.join2(path, name));
+            }
+          });
+        } else if (FS.isLink(node.mode)) {
+          entries.push([path, node.mode, FS.readlink(path)]);
+        } else if (FS.isFile(node.mode)) {
+          var data = FS.readFile(path);
+          entries.push([path, node.mode, size, data.length]);
+          contents.push(data);
+          size += data.length;
+        }
+      }
+      capture('/');
+
+      var json = JSON.stringify(entries);
+      var length = lengthBytesUTF8(json);
+      var files = new Uint8Array(4 + length + 1 + size);
+      new DataView(files.buffer).setUint32(0, length, true);
+      stringToUTF8Array(json, files, 4, length + 1);
+      var offset = 4 + length + 1;
+      contents.forEach(function(data) {
+        files.set(data, offset);
+        offset += data.length;
+      });
+      return files;
+    },
+
+    // Recreates the files that captureFiles() stored at ptr. Directories and
+    // symlinks that the runtime creates by itself already exist.
+    restoreFiles: function(ptr) {
+      var length = HEAPU32[ptr >> 2];
+      var entries = JSON.parse(UTF8ArrayToString(HEAPU8, ptr + 4, length));
+      var data = ptr + 4 + length + 1;
+      entries.forEach(function(entry) {
+        var path = entry[0];
+        var mode = entry[1];
+        if (FS.isDir(mode)) {
+          if (!FS.analyzePath(path).exists) {
+            FS.mkdir(path, mode);
+          }
+        } else if (FS.isLink(mode)) {
+          if (!FS.analyzePath(path, true).exists) {
+            FS.symlink(entry[2], path);
+          }
+        } else {
+          var start = data + entry[2];
+          FS.writeFile(path, HEAPU8.subarray(start, start + entry[3]));
+          FS.chmod(path, mode);
+        }
+      });
+    },
+#endif
+  },
+
+  emscripten_snapshot_point__deps: [
+#if SNAPSHOT
+    '$Snapshot',
+#endif
+  ],
+  emscripten_snapshot_point: function() {
+#if SNAPSHOT && ENVIRONMENT_MAY_BE_NODE
+    if (ENVIRONMENT_IS_NODE && process['env']['EMCC_SNAPSHOT_OUTPUT']) {
+      Snapshot.take(process['env']['EMCC_SNAPSHOT_OUTPUT']);
+    }
+#endif
+  },
+};
+
+mergeInto(LibraryManager.library, LibrarySnapshot);
@@ -232,6 +232,7 @@ var SyscallsLibrary = {
     off <<= 12; // undo pgoffset
     var ptr;
     var allocated = false;
+    var res = {};
 
     // addr argument must be page aligned if MAP_FIXED flag is set.
     if ((flags & {{{ cDefine('MAP_FIXED') }}}) !== 0 && (addr % {{{ WASM_PAGE_SIZE }}}) !== 0) {
@@ -249,7 +250,7 @@ var SyscallsLibrary = {
 #if FILESYSTEM && SYSCALLS_REQUIRE_FILESYSTEM
       var info = FS.getStream(fd);
       if (!info) return -{{{ cDefine('EBADF') }}};
-      var res = FS.mmap(info, addr, len, off, prot, flags);
+      res = FS.mmap(info, addr, len, off, prot, flags);
       ptr = res.ptr;
       allocated = res.allocated;
 #else // no filesystem support; report lack of support
@@ -259,7 +260,10 @@ var SyscallsLibrary = {
 #if CAN_ADDRESS_2GB
     ptr >>>= 0;
 #endif
-    SYSCALLS.mappings[ptr] = { malloc: ptr, len: len, allocated: allocated, fd: fd, prot: prot, flags: flags, offset: off };
+    // Mappings that alias file storage can share an address, so they are kept
+    // in a list, most recent first.
+    SYSCALLS.mappings[ptr] = { malloc: ptr, len: len, allocated: allocated, fd: fd, prot: prot, flags: flags, offset: off,
+                               aliased: res.aliased, sync: res.sync, release: res.release, next: SYSCALLS.mappings[ptr] };
     return ptr;
   },
 
@@ -277,22 +281,36 @@ var SyscallsLibrary = {
     if (len === 0 || !info) {
       return -{{{ cDefine('EINVAL') }}};
     }
+    var prev = null;
+    while (info.next && info.len !== len) {
+      prev = info;
+      info = info.next;
+    }
     if (len === info.len) {
 #if FILESYSTEM && SYSCALLS_REQUIRE_FILESYSTEM
       var stream = FS.getStream(info.fd);
       if (stream) {
-        if (info.prot & {{{ cDefine('PROT_WRITE') }}}) {
+        // Aliased mappings are the file's own storage; they write back, if
+        // they need to, when they are released.
+        if ((info.prot & {{{ cDefine('PROT_WRITE') }}}) && !info.aliased) {
           SYSCALLS.doMsync(addr, stream, len, info.flags, info.offset);
         }
         FS.munmap(stream);
       }
+      if (info.release) {
+        info.release();
+      }
 #else
 #if ASSERTIONS
       // Without FS support, only anonymous mappings are supported.
       assert(SYSCALLS.mappings[addr].flags & {{{ cDefine('MAP_ANONYMOUS') }}});
 #endif
 #endif
-      SYSCALLS.mappings[addr] = null;
+      if (prev) {
+        prev.next = info.next;
+      } else {
+        SYSCALLS.mappings[addr] = info.next || null;
+      }
       if (info.allocated) {
         _free(info.malloc);
       }
@@ -754,6 +772,10 @@ var SyscallsLibrary = {
 #endif
     var info = SYSCALLS.mappings[addr];
     if (!info) return 0;
+    if (info.aliased) {
+      info.sync();
+      return 0;
+    }
     SYSCALLS.doMsync(addr, FS.getStream(info.fd), len, info.flags, 0);
     return 0;
   },
@@ -1,3 +1,60 @@
-var WasmfsLibrary = {}
+/**
+ * @license
+ * Copyright 2021 The Emscripten Authors
+ * SPDX-License-Identifier: MIT
+ */
+
+var WasmfsLibrary = {
+  // Input that was read from the host but not yet returned to stdin.
+  $wasmfsStdinInput: [],
+
+  // Reads more input from the host: a chunk in Node, or a line from a prompt
+  // in the browser or readline() in a shell, as in the TTY of the JS FS.
+  // Returns an array of bytes, which is empty at the end of the input.
+  $wasmfsReadStdin__deps: ['$intArrayFromString'],
+  $wasmfsReadStdin: function() {
+#if ENVIRONMENT_MAY_BE_NODE
+    if (ENVIRONMENT_IS_NODE) {
+      var buf = Buffer.alloc(256);
+      var bytesRead = 0;
+      try {
+        bytesRead = require('fs').readSync(process.stdin.fd, buf, 0, buf.length, null);
+      } catch (e) {
+        // On Windows, reading at the end of the input throws.
+        if (!e.toString().includes('EOF')) throw e;
+      }
+      return Array.from(buf.subarray(0, bytesRead));
+    }
+#endif
+    var result = null;
+    if (typeof window != 'undefined' && typeof window.prompt == 'function') {
+      result = window.prompt('Input: '); // returns null on cancel
+    } else if (typeof readline == 'function') {
+      result = readline();
+    }
+    return result === null ? [] : intArrayFromString(result + '\n', true);
+  },
+
+  // Returns the next byte of stdin (system/lib/wasmfs/streams.cpp), or -1 at
+  // the end of the input. Input comes from Module['stdin'] if it is set, which
+  // returns a byte or null at the end of the input, and from the host
+  // otherwise.
+  _wasmfs_stdin_get_char__sig: 'i',
+  _wasmfs_stdin_get_char__proxy: 'sync',
+  _wasmfs_stdin_get_char__deps: ['$wasmfsStdinInput', '$wasmfsReadStdin'],
+  _wasmfs_stdin_get_char: function() {
+    if (Module['stdin']) {
+      var c = Module['stdin']();
+      return c === null || c === undefined ? -1 : c;
+    }
+    if (!wasmfsStdinInput.length) {
+      wasmfsStdinInput = wasmfsReadStdin();
+      if (!wasmfsStdinInput.length) {
+        return -1;
+      }
+    }
+    return wasmfsStdinInput.shift();
+  },
+}
 
 mergeInto(LibraryManager.library, WasmfsLibrary);
@@ -0,0 +1,172 @@
+/**
+ * @license
+ * Copyright 2021 The Emscripten Authors
+ * SPDX-License-Identifier: MIT
+ */
+
+// Host file system access for the WASMFS Node backend
+// (system/lib/wasmfs/node_backend.cpp). These are called directly from
+// whichever thread is doing the I/O; nothing here is proxied. Functions that
+// return a count or a handle return a negative errno value on failure.
+
+mergeInto(LibraryManager.library, {
+  $wasmfsNodeFS__postset: 'if (ENVIRONMENT_IS_NODE) { wasmfsNodeFS.init(); }',
+  $wasmfsNodeFS__deps: ['$ERRNO_CODES'],
+  $wasmfsNodeFS: {
+    fs: null,
+    flagsForNodeMap: null,
+    init: function() {
+      wasmfsNodeFS.fs = require('fs');
+      var flags = wasmfsNodeFS.fs.constants;
+      wasmfsNodeFS.flagsForNodeMap = {
+        "{{{ cDefine('O_APPEND') }}}": flags["O_APPEND"],
+        "{{{ cDefine('O_CREAT') }}}": flags["O_CREAT"],
+        "{{{ cDefine('O_EXCL') }}}": flags["O_EXCL"],
+        "{{{ cDefine('O_RDONLY') }}}": flags["O_RDONLY"],
+        "{{{ cDefine('O_RDWR') }}}": flags["O_RDWR"],
+        "{{{ cDefine('O_TRUNC') }}}": flags["O_TRUNC"],
+        "{{{ cDefine('O_WRONLY') }}}": flags["O_WRONLY"]
+      };
+    },
+    flagsForNode: function(flags) {
+      var newFlags = 0;
+      for (var k in wasmfsNodeFS.flagsForNodeMap) {
+        if (flags & k) {
+          newFlags |= wasmfsNodeFS.flagsForNodeMap[k];
+        }
+      }
+      return newFlags;
+    },
+    // Runs a Node fs operation, converting a thrown error into -errno.
+    tryCall: function(f) {
+#if ASSERTIONS
+      assert(ENVIRONMENT_IS_NODE, 'the WASMFS Node backend can only be used in Node.js');
+#endif
+      try {
+        return f();
+      } catch (e) {
+        if (!e.code) throw e;
+#if ASSERTIONS
+        assert(e.code in ERRNO_CODES, 'unexpected node error code: ' + e.code + ' (' + e + ')');
+#endif
+        return -ERRNO_CODES[e.code];
+      }
+    },
+    heapBufferView: null,
+    heapBuffer: function() {
+      // Node reads and writes straight into and out of the heap, with no
+      // intermediate copy. The view is re-created after memory growth.
+      if (!wasmfsNodeFS.heapBufferView || wasmfsNodeFS.heapBufferView.buffer !== HEAPU8.buffer) {
+        wasmfsNodeFS.heapBufferView = Buffer.from(HEAPU8.buffer);
+      }
+      return wasmfsNodeFS.heapBufferView;
+    }
+  },
+
+  _wasmfs_node_open__sig: 'iiii',
+  _wasmfs_node_open__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_open: function(path, flags, mode) {
+    return wasmfsNodeFS.tryCall(function() {
+      return wasmfsNodeFS.fs.openSync(UTF8ToString(path), wasmfsNodeFS.flagsForNode(flags), mode);
+    });
+  },
+
+  _wasmfs_node_close__sig: 'ii',
+  _wasmfs_node_close__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_close: function(fd) {
+    return wasmfsNodeFS.tryCall(function() {
+      wasmfsNodeFS.fs.closeSync(fd);
+      return 0;
+    });
+  },
+
+  _wasmfs_node_fstat_size__sig: 'di',
+  _wasmfs_node_fstat_size__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_fstat_size: function(fd) {
+    return wasmfsNodeFS.tryCall(function() {
+      return wasmfsNodeFS.fs.fstatSync(fd).size;
+    });
+  },
+
+  _wasmfs_node_read__sig: 'iiiid',
+  _wasmfs_node_read__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_read: function(fd, buf, len, pos) {
+    return wasmfsNodeFS.tryCall(function() {
+      return wasmfsNodeFS.fs.readSync(fd, wasmfsNodeFS.heapBuffer(), buf, len, pos);
+    });
+  },
+
+  _wasmfs_node_write__sig: 'iiiid',
+  _wasmfs_node_write__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_write: function(fd, buf, len, pos) {
+    return wasmfsNodeFS.tryCall(function() {
+      return wasmfsNodeFS.fs.writeSync(fd, wasmfsNodeFS.heapBuffer(), buf, len, pos);
+    });
+  },
+
+  _wasmfs_node_ftruncate__sig: 'iid',
+  _wasmfs_node_ftruncate__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_ftruncate: function(fd, size) {
+    return wasmfsNodeFS.tryCall(function() {
+      wasmfsNodeFS.fs.ftruncateSync(fd, size);
+      return 0;
+    });
+  },
+
+  // Returns the mode (including the file type bits) of the file at |path|.
+  _wasmfs_node_get_mode__sig: 'ii',
+  _wasmfs_node_get_mode__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_get_mode: function(path) {
+    return wasmfsNodeFS.tryCall(function() {
+      return wasmfsNodeFS.fs.lstatSync(UTF8ToString(path)).mode;
+    });
+  },
+
+  _wasmfs_node_mkdir__sig: 'iii',
+  _wasmfs_node_mkdir__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_mkdir: function(path, mode) {
+    return wasmfsNodeFS.tryCall(function() {
+      wasmfsNodeFS.fs.mkdirSync(UTF8ToString(path), mode);
+      return 0;
+    });
+  },
+
+  _wasmfs_node_rmdir__sig: 'ii',
+  _wasmfs_node_rmdir__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_rmdir: function(path) {
+    return wasmfsNodeFS.tryCall(function() {
+      wasmfsNodeFS.fs.rmdirSync(UTF8ToString(path));
+      return 0;
+    });
+  },
+
+  _wasmfs_node_unlink__sig: 'ii',
+  _wasmfs_node_unlink__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_unlink: function(path) {
+    return wasmfsNodeFS.tryCall(function() {
+      wasmfsNodeFS.fs.unlinkSync(UTF8ToString(path));
+      return 0;
+    });
+  },
+
+  // Writes the names in the directory at |path| into |buf| as consecutive
+  // null-terminated strings, and returns the number of bytes the full listing
+  // needs. If that is more than |size|, the caller should retry with a larger
+  // buffer.
+  _wasmfs_node_readdir__sig: 'iiii',
+  _wasmfs_node_readdir__deps: ['$wasmfsNodeFS'],
+  _wasmfs_node_readdir: function(path, buf, size) {
+    return wasmfsNodeFS.tryCall(function() {
+      var names = wasmfsNodeFS.fs.readdirSync(UTF8ToString(path));
+      var needed = 0;
+      names.forEach(function(name) {
+        var len = lengthBytesUTF8(name) + 1;
+        if (needed + len <= size) {
+          stringToUTF8(name, buf + needed, len);
+        }
+        needed += len;
+      });
+      return needed;
+    });
+  },
+});
@@ -367,6 +367,25 @@ var LibraryGL = {
     },
 #endif
 
+    // WebGL 1 has no upload entry points that take an offset into the heap, so they are given a view of exactly the
+    // data to upload. The views are cached by address, so that uploading from the same memory every frame, as is
+    // usual for uniform arrays and dynamic buffers, does not allocate a new view each time.
+    heapViewCache: {},
+    heapViewCacheSize: 0,
+
+    getHeapView: function getHeapView(heap, ptr, length) {
+      var view = GL.heapViewCache[ptr];
+      if (view && view.length == length && view.buffer === heap.buffer && view.constructor === heap.constructor) {
+        return view;
+      }
+      if (++GL.heapViewCacheSize > 1024) {
+        GL.heapViewCache = {};
+        GL.heapViewCacheSize = 1;
+      }
+      var index = ptr / heap.BYTES_PER_ELEMENT;
+      return GL.heapViewCache[ptr] = heap.subarray(index, index + length);
+    },
+
     getSource: function(shader, count, string, length) {
       var source = '';
       for (var i = 0; i < count; ++i) {
@@ -420,9 +439,141 @@ var LibraryGL = {
 
     usedTempBuffers: [],
 
+#if GL_STREAMING_BUFFER_SIZE
+    // Space that streamClientData() takes in a streaming buffer for HEAPU8[begin, end).
+    streamClientDataSize: function(begin, end) {
+      return (end - (begin & ~15) + 15) & ~15;
+    },
+
+    // Makes room for |size| bytes of streamClientData() uploads at the end of a streaming buffer, which is left bound.
+    // When they do not fit after the previous uploads, the storage of the buffer is orphaned with bufferData() and
+    // writing starts over at its start: the driver hands out fresh memory instead of waiting for the draws that still
+    // read the old one. Everything a draw streams must be reserved at once, as orphaning drops the data written before.
+    // Returns false if |size| is larger than the buffer.
+    reserveStreamSpace: function(stream, size) {
+      if (size > {{{ GL_STREAMING_BUFFER_SIZE }}}) return false;
+      if (!stream.buffer) {
+        stream.buffer = GLctx.createBuffer();
+        stream.offset = {{{ GL_STREAMING_BUFFER_SIZE }}};
+      }
+      GLctx.bindBuffer(stream.target, stream.buffer);
+      if (stream.offset + size > {{{ GL_STREAMING_BUFFER_SIZE }}}) {
+        GLctx.bufferData(stream.target, {{{ GL_STREAMING_BUFFER_SIZE }}}, 0x88E0 /*GL_STREAM_DRAW*/);
+        stream.offset = 0;
+      }
+      return true;
+    },
+
+    // Uploads HEAPU8[begin, end) to a streaming buffer, into space made by reserveStreamSpace(). Returns the offset of
+    // the data in the buffer, which is congruent to begin modulo 16 so that attribute and index offsets keep their
+    // alignment.
+    streamClientData: function streamClientData(stream, begin, end) {
+      var start = begin & ~15;
+      var offset = stream.offset;
+      GLctx.bufferSubData(stream.target, offset, HEAPU8.subarray(start, end));
+      stream.offset += GL.streamClientDataSize(begin, end);
+      return offset + begin - start;
+    },
+
+    hasClientSideVertexAttribs: function hasClientSideVertexAttribs() {
+      for (var i = 0; i < GL.currentContext.maxVertexAttribs; ++i) {
+        var cb = GL.currentContext.clientBuffers[i];
+        if (cb.clientside && cb.enabled) return true;
+      }
+      return false;
+    },
+
+    // Returns how many vertices the client side indices of a glDrawElements() call refer to.
+    calcIndexedVertexCount: function calcIndexedVertexCount(type, indices, count) {
+      var heap = HEAPU8;
+      if (type == 0x1403 /*GL_UNSIGNED_SHORT*/) {
+        heap = HEAPU16;
+        indices >>= 1;
+      } else if (type == 0x1405 /*GL_UNSIGNED_INT*/) {
+        heap = HEAPU32;
+        indices >>= 2;
+      }
+      var max = 0;
+      for (var i = indices; i < indices + count; ++i) {
+        if (heap[i] > max) max = heap[i];
+      }
+      return max + 1;
+    },
+
+    // Indices of the client side attributes of the current draw, sorted by address.
+    streamedAttribs: [],
+    // The groups of attributes of the current draw that are uploaded together, as triples of the address range to
+    // upload and the index in streamedAttribs after the last attribute of the group.
+    streamedGroups: [],
+
+    compareClientBufferPtrs: function(a, b) {
+      return GL.currentContext.clientBuffers[a].ptr - GL.currentContext.clientBuffers[b].ptr;
+    },
+#endif
+
+    bindClientAttribToTempBuffer: function bindClientAttribToTempBuffer(index, cb, size) {
+      var buf = GL.getTempVertexBuffer(size);
+      GLctx.bindBuffer(0x8892 /*GL_ARRAY_BUFFER*/, buf);
+      GLctx.bufferSubData(0x8892 /*GL_ARRAY_BUFFER*/,
+                               0,
+                               HEAPU8.subarray(cb.ptr, cb.ptr + size));
+#if GL_ASSERTIONS
+      GL.validateVertexAttribPointer(cb.size, cb.type, cb.stride, 0);
+#endif
+      cb.vertexAttribPointerAdaptor.call(GLctx, index, cb.size, cb.type, cb.normalized, cb.stride, 0);
+    },
+
     preDrawHandleClientVertexAttribBindings: function preDrawHandleClientVertexAttribBindings(count) {
       GL.resetBufferBinding = false;
 
+#if GL_STREAMING_BUFFER_SIZE
+      var clientBuffers = GL.currentContext.clientBuffers;
+      var attribs = GL.streamedAttribs;
+      attribs.length = 0;
+      for (var i = 0; i < GL.currentContext.maxVertexAttribs; ++i) {
+        var cb = clientBuffers[i];
+        if (!cb.clientside || !cb.enabled) continue;
+        cb.uploadSize = GL.calcBufLength(cb.size, cb.type, cb.stride, count);
+        attribs.push(i);
+      }
+      if (!attribs.length) return;
+      GL.resetBufferBinding = true;
+      attribs.sort(GL.compareClientBufferPtrs);
+
+      // Attributes whose data overlaps or lies close together, like interleaved arrays, are uploaded with one call.
+      var groups = GL.streamedGroups;
+      groups.length = 0;
+      var size = 0;
+      for (var j = 0; j < attribs.length;) {
+        var begin = clientBuffers[attribs[j]].ptr;
+        var end = begin + clientBuffers[attribs[j]].uploadSize;
+        for (++j; j < attribs.length && clientBuffers[attribs[j]].ptr <= end + 256; ++j) {
+          end = Math.max(end, clientBuffers[attribs[j]].ptr + clientBuffers[attribs[j]].uploadSize);
+        }
+        groups.push(begin, end, j);
+        size += GL.streamClientDataSize(begin, end);
+      }
+
+      var stream = GL.currentContext.vertexStream;
+      if (!GL.reserveStreamSpace(stream, size)) {
+        for (var j = 0; j < attribs.length; ++j) {
+          var cb = clientBuffers[attribs[j]];
+          GL.bindClientAttribToTempBuffer(attribs[j], cb, cb.uploadSize);
+        }
+        return;
+      }
+      for (var g = 0, j = 0; g < groups.length; g += 3) {
+        var begin = groups[g];
+        var offset = GL.streamClientData(stream, begin, groups[g + 1]);
+        for (; j < groups[g + 2]; ++j) {
+          var cb = clientBuffers[attribs[j]];
+#if GL_ASSERTIONS
+          GL.validateVertexAttribPointer(cb.size, cb.type, cb.stride, offset + cb.ptr - begin);
+#endif
+          cb.vertexAttribPointerAdaptor.call(GLctx, attribs[j], cb.size, cb.type, cb.normalized, cb.stride, offset + cb.ptr - begin);
+        }
+      }
+#else
       // TODO: initial pass to detect ranges we need to upload, might not need an upload per attrib
       for (var i = 0; i < GL.currentContext.maxVertexAttribs; ++i) {
         var cb = GL.currentContext.clientBuffers[i];
@@ -430,17 +581,9 @@ var LibraryGL = {
 
         GL.resetBufferBinding = true;
 
-        var size = GL.calcBufLength(cb.size, cb.type, cb.stride, count);
-        var buf = GL.getTempVertexBuffer(size);
-        GLctx.bindBuffer(0x8892 /*GL_ARRAY_BUFFER*/, buf);
-        GLctx.bufferSubData(0x8892 /*GL_ARRAY_BUFFER*/,
-                                 0,
-                                 HEAPU8.subarray(cb.ptr, cb.ptr + size));
-#if GL_ASSERTIONS
-        GL.validateVertexAttribPointer(cb.size, cb.type, cb.stride, 0);
-#endif
-        cb.vertexAttribPointerAdaptor.call(GLctx, i, cb.size, cb.type, cb.normalized, cb.stride, 0);
+        GL.bindClientAttribToTempBuffer(i, cb, GL.calcBufLength(cb.size, cb.type, cb.stride, count));
       }
+#endif
     },
 
     postDrawHandleClientVertexAttribBindings: function postDrawHandleClientVertexAttribBindings() {
@@ -1015,6 +1158,11 @@ var LibraryGL = {
       }
 
       GL.generateTempBuffers(false, context);
+#if GL_STREAMING_BUFFER_SIZE
+      // The streaming buffers are created on first use.
+      context.vertexStream = { target: 0x8892 /*GL_ARRAY_BUFFER*/, buffer: null, offset: 0 };
+      context.indexStream = { target: 0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/, buffer: null, offset: 0 };
+#endif
 #endif
 
 #if OFFSCREEN_FRAMEBUFFER
@@ -1776,7 +1924,7 @@ var LibraryGL = {
 #endif
       // N.b. here first form specifies a heap subarray, second form an integer size, so the ?: code here is polymorphic. It is advised to avoid
       // randomly mixing both uses in calling code, to avoid any potential JS engine JIT issues.
-      GLctx.bufferData(target, data ? HEAPU8.subarray(data, data+size) : size, usage);
+      GLctx.bufferData(target, data ? GL.getHeapView(HEAPU8, data, size) : size, usage);
 #if MAX_WEBGL_VERSION >= 2
     }
 #endif
@@ -1790,7 +1938,7 @@ var LibraryGL = {
       return;
     }
 #endif
-    GLctx.bufferSubData(target, offset, HEAPU8.subarray(data, data+size));
+    GLctx.bufferSubData(target, offset, GL.getHeapView(HEAPU8, data, size));
   },
 
   // Queries EXT
@@ -2371,7 +2519,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('32', 'value', 'value+count*4') }}};
+      var view = GL.getHeapView(HEAP32, value, count);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Int32Array(view);
 #endif
@@ -2417,7 +2565,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('32', 'value', 'value+count*8') }}};
+      var view = GL.getHeapView(HEAP32, value, count*2);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Int32Array(view);
 #endif
@@ -2464,7 +2612,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('32', 'value', 'value+count*12') }}};
+      var view = GL.getHeapView(HEAP32, value, count*3);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Int32Array(view);
 #endif
@@ -2512,7 +2660,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('32', 'value', 'value+count*16') }}};
+      var view = GL.getHeapView(HEAP32, value, count*4);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Int32Array(view);
 #endif
@@ -2557,7 +2705,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*4') }}};
+      var view = GL.getHeapView(HEAPF32, value, count);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2603,7 +2751,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*8') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*2);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2650,7 +2798,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*12') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*3);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2702,7 +2850,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*16') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*4);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2750,7 +2898,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*16') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*4);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2803,7 +2951,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*36') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*9);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -2867,7 +3015,7 @@ var LibraryGL = {
     } else
 #endif
     {
-      var view = {{{ makeHEAPView('F32', 'value', 'value+count*64') }}};
+      var view = GL.getHeapView(HEAPF32, value, count*16);
 #if WORKAROUND_OLD_WEBGL_UNIFORM_UPLOAD_IGNORED_OFFSET_BUG
       if (GL.currentContext.cannotHandleOffsetsInUniformArrayViews) view = new Float32Array(view);
 #endif
@@ -3775,19 +3923,35 @@ var LibraryGL = {
   glDrawElements: function(mode, count, type, indices) {
 #if FULL_ES2
     var buf;
+    var vertexCount = count;
     if (!GLctx.currentElementArrayBufferBinding) {
       var size = GL.calcBufLength(1, type, 0, count);
-      buf = GL.getTempIndexBuffer(size);
-      GLctx.bindBuffer(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/, buf);
-      GLctx.bufferSubData(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/,
-                               0,
-                               HEAPU8.subarray(indices, indices + size));
-      // the index is now 0
-      indices = 0;
+#if GL_STREAMING_BUFFER_SIZE
+      // Only upload the vertices that the indices refer to. Scanning the indices is only needed when there are
+      // client side vertex arrays to upload.
+      if (GL.hasClientSideVertexAttribs()) {
+        vertexCount = GL.calcIndexedVertexCount(type, indices, count);
+      }
+      var stream = GL.currentContext.indexStream;
+      var offset = GL.reserveStreamSpace(stream, GL.streamClientDataSize(indices, indices + size)) ? GL.streamClientData(stream, indices, indices + size) : -1;
+#else
+      var offset = -1;
+#endif
+      if (offset >= 0) {
+        indices = offset;
+      } else {
+        buf = GL.getTempIndexBuffer(size);
+        GLctx.bindBuffer(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/, buf);
+        GLctx.bufferSubData(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/,
+                                 0,
+                                 HEAPU8.subarray(indices, indices + size));
+        // the index is now 0
+        indices = 0;
+      }
     }
 
     // bind any client-side buffers
-    GL.preDrawHandleClientVertexAttribBindings(count);
+    GL.preDrawHandleClientVertexAttribBindings(vertexCount);
 #endif
 
     GLctx.drawElements(mode, count, type, indices);
@@ -68,6 +68,7 @@ var LibraryManager = {
       'library_int53.js',
       'library_dylink.js',
       'library_eventloop.js',
+      'library_snapshot.js',
     ];
 
     if (LINK_AS_CXX && !EXCEPTION_HANDLING) {
@@ -112,7 +113,12 @@ var LibraryManager = {
         libraries.push('library_noderawfs.js');
       }
     } 
-    // TODO: populate with libraries.push('library_wasmfs.js') later
+    if (WASMFS) {
+      // Host file system access for the WASMFS Node backend is only linked in
+      // if wasmfs_create_node_backend() is used.
+      libraries.push('library_wasmfs.js');
+      libraries.push('library_wasmfs_node.js');
+    }
 
     // Additional JS libraries (without AUTO_JS_LIBRARIES, link to these explicitly via -lxxx.js)
     if (AUTO_JS_LIBRARIES) {
@@ -194,7 +200,7 @@ var LibraryManager = {
       }
       var processed = undefined;
       try {
-        processed = processMacros(preprocess(src, filename));
+        processed = compilerCache.preprocessLibrary(src, filename);
         eval(processed);
       } catch(e) {
         var details = [e, e.lineNumber ? 'line number: ' + e.lineNumber : ''];
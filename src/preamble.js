@@ -1019,8 +1019,12 @@ function createWasm() {
 #endif
 
 #if hasExportedFunction('___wasm_call_ctors')
+#if SNAPSHOT
+    addOnInit(Snapshot.init);
+#else
     addOnInit(Module['asm']['__wasm_call_ctors']);
 #endif
+#endif
 
 #if ABORT_ON_WASM_EXCEPTIONS
     instrumentWasmTableWithAbort();
@@ -112,6 +112,61 @@ function UTF8ArrayToString(heap, idx, maxBytesToRead) {
 #endif // TEXTDECODER == 2
 }
 
+#if WASM_STRING_CONVERSION
+// The capacity, in UTF-16 code units, of the per-thread scratch buffer that the
+// transcoding functions in system/lib/libc/emscripten_utf8.c exchange strings
+// through. Its header holds the bytes, units and done fields, followed by the
+// code units at offset 16.
+var UTF_SCRATCH_UNITS = 4096;
+
+// Decodes with _emscripten_utf8_decode(), one scratch buffer at a time.
+/**
+ * @param {number} ptr
+ * @param {number=} maxBytesToRead
+ * @return {string}
+ */
+function UTF8ToStringWasm(ptr, maxBytesToRead) {
+  var maxBytes = maxBytesToRead === undefined ? -1 : maxBytesToRead;
+  var str = '';
+  while (1) {
+    var scratch = __emscripten_utf8_decode(ptr, maxBytes) >>> 0;
+    var units = HEAPU32[(scratch >> 2) + 1];
+    var data = (scratch + 16) >> 1;
+    if (units > 16) {
+      str += String.fromCharCode.apply(null, HEAPU16.subarray(data, data + units));
+    } else {
+      for (var i = 0; i < units; ++i) str += String.fromCharCode(HEAPU16[data + i]);
+    }
+    if (HEAPU32[(scratch >> 2) + 2]) return str;
+    var bytes = HEAPU32[scratch >> 2];
+    ptr += bytes;
+    if (maxBytes >= 0) maxBytes -= bytes;
+  }
+}
+
+// Encodes with _emscripten_utf8_encode(), one scratch buffer at a time, and
+// returns the number of bytes written, excluding the null terminator.
+function stringToUTF8Wasm(str, outPtr, maxBytesToWrite) {
+  var startPtr = outPtr;
+  var endPtr = outPtr + maxBytesToWrite - 1; // -1 for string null terminator.
+  var scratch = __emscripten_utf_scratch() >>> 0;
+  var data = (scratch + 16) >> 1;
+  for (var i = 0; i < str.length;) {
+    var units = Math.min(str.length - i, UTF_SCRATCH_UNITS);
+    // Don't split a surrogate pair between two calls.
+    if (units == UTF_SCRATCH_UNITS && (str.charCodeAt(i + units - 1) & 0xFC00) == 0xD800) --units;
+    for (var j = 0; j < units; ++j) HEAPU16[data + j] = str.charCodeAt(i + j);
+    outPtr += __emscripten_utf8_encode(outPtr, endPtr - outPtr, units);
+    var written = HEAPU32[(scratch >> 2) + 1];
+    i += written;
+    if (written < units) break;
+  }
+  // Null-terminate the pointer to the buffer.
+  HEAPU8[outPtr] = 0;
+  return outPtr - startPtr;
+}
+#endif
+
 // Given a pointer 'ptr' to a null-terminated UTF8-encoded string in the emscripten HEAP, returns a
 // copy of that string as a Javascript String object.
 // maxBytesToRead: an optional length that specifies the maximum number of bytes to read. You can omit
@@ -131,6 +186,16 @@ function UTF8ToString(ptr, maxBytesToRead) {
 #if CAN_ADDRESS_2GB
   ptr >>>= 0;
 #endif
+#if WASM_STRING_CONVERSION
+  // Strings of up to 16 bytes are cheaper to decode here than to copy out of
+  // the scratch buffer, and the wasm transcoder can't be called before the wasm
+  // module is ready.
+  if (ptr && runtimeInitialized && !(maxBytesToRead <= 16)) {
+    var end = ptr;
+    while (HEAPU8[end] && end - ptr < 16) ++end;
+    if (HEAPU8[end]) return UTF8ToStringWasm(ptr, maxBytesToRead);
+  }
+#endif
 #if TEXTDECODER == 2
   if (!ptr) return '';
   var maxPtr = ptr + maxBytesToRead;
@@ -161,6 +226,11 @@ function stringToUTF8Array(str, heap, outIdx, maxBytesToWrite) {
   if (!(maxBytesToWrite > 0)) // Parameter maxBytesToWrite is not optional. Negative values, 0, null, undefined and false each don't write out any bytes.
     return 0;
 
+#if WASM_STRING_CONVERSION
+  // Short strings are cheaper to write out here than to copy into the scratch
+  // buffer.
+  if (heap === HEAPU8 && str.length > 16 && runtimeInitialized) return stringToUTF8Wasm(str, outIdx, maxBytesToWrite);
+#endif
   var startIdx = outIdx;
   var endIdx = outIdx + maxBytesToWrite - 1; // -1 for string null terminator.
   for (var i = 0; i < str.length; ++i) {
@@ -395,6 +395,16 @@ var WEBSOCKET_SUBPROTOCOL = 'binary';
 // [link]
 var OPENAL_DEBUG = 0;
 
+// If 1, OpenAL sources are mixed in wasm instead of being played through Web
+// Audio nodes of their own. All sources of a context are resampled, panned and
+// mixed by a software mixer (system/lib/al_mixer.c), and the result is played
+// through a single output node per context. This avoids the cost of a Web
+// Audio node graph per playing buffer when there are many sources. Panning is
+// always equal-power (HRTF is not supported in this mode), and buffers that are
+// attached to sources can't be refilled with alBufferData.
+// [link]
+var OPENAL_MIXER = 0;
+
 // If 1, prints out debugging related to calls from emscripten_web_socket_* functions
 // in emscripten/websocket.h.
 // If 2, additionally traces bytes communicated via the sockets.
@@ -432,6 +442,15 @@ var GL_UNSAFE_OPTS = 1;
 // [link]
 var FULL_ES2 = 0;
 
+// With FULL_ES2, the size in bytes of the buffers that client side vertex
+// arrays and indices are streamed into. Each draw appends its data at the end
+// of the previous one, uploading the attributes it reads in one call where
+// they are close to each other in memory, and the buffer is orphaned when it
+// is full. When 0, client side data is instead uploaded to a pool of
+// temporary buffers, once per attribute.
+// [link]
+var GL_STREAMING_BUFFER_SIZE = 0;
+
 // If true, glGetString() for GL_VERSION and GL_SHADING_LANGUAGE_VERSION will
 // return strings OpenGL ES format "Open GL ES ... (WebGL ...)" rather than the
 // WebGL format. If false, the direct WebGL format strings are returned. Set
@@ -551,6 +570,16 @@ var LEGACY_GL_EMULATION = 0;
 // [link]
 var GL_FFP_ONLY = 0;
 
+// If you specified LEGACY_GL_EMULATION = 1, set this to 1 to merge consecutive
+// glBegin/glEnd blocks of GL_POINTS, GL_LINES, GL_TRIANGLES or GL_QUADS into a
+// single draw call, as long as no other GL state changes between them. The
+// merged blocks are drawn before the next GL call that is not part of
+// immediate mode vertex submission, or at the latest at the end of the current
+// event handler. This makes every WebGL call go through a wrapper, so it is
+// only worth it for code that draws many small glBegin/glEnd blocks.
+// [link]
+var GL_BATCH_IMMEDIATE_MODE = 0;
+
 // If you want to create the WebGL context up front in JS code, set this to 1
 // and set Module['preinitializedWebGLContext'] to a precreated WebGL context.
 // WebGL initialization afterwards will use this GL context to render.
@@ -648,6 +677,21 @@ var ENVIRONMENT = 'web,webview,worker,node';
 // [link]
 var LZ4 = 0;
 
+// The maximum size in bytes of the cache of decompressed LZ4 chunks, per
+// package. Chunks are 2048 bytes; the least recently used chunk is evicted
+// when the cache is full.
+// [link]
+var LZ4_CACHE_SIZE = 4096;
+
+// If nonzero, this many web workers (worker_threads in node) decompress LZ4
+// chunks ahead of use: the start of each package as it is loaded, and the
+// chunks following each cache miss. Decompressed chunks go into the cache
+// described above, so a larger LZ4_CACHE_SIZE should be used as well.
+// Reads never wait for the workers; a chunk that is not ready yet is
+// decompressed on the spot.
+// [link]
+var LZ4_WORKERS = 0;
+
 // Emscripten exception handling options.
 // These options only pertain to Emscripten exception handling and do not
 // control the experimental native wasm exception handling option.
@@ -885,6 +929,15 @@ var FORCE_FILESYSTEM = 0;
 // [link]
 var NODERAWFS = 0;
 
+// If set to 1, MEMFS keeps file contents in the wasm heap (allocated with
+// malloc) rather than in JS typed arrays. Reads and writes from C then copy
+// within the heap, with no intermediate JS arrays, and read-only mmap() of a
+// file costs nothing. The downside is that file data counts towards the heap
+// size, so large data files may need more INITIAL_MEMORY or
+// ALLOW_MEMORY_GROWTH.
+// [link]
+var MEMFS_HEAP_STORAGE = 0;
+
 // This saves the compiled wasm module in a file with name
 //   $WASM_BINARY_NAME.$V8_VERSION.cached
 // and loads it on subsequent runs. This caches the compiled wasm code from
@@ -973,6 +1026,15 @@ var MAIN_MODULE = 0;
 // [compile+link]
 var SIDE_MODULE = 0;
 
+// If set to 1, side modules get a custom section that lists their imports and
+// the symbols they add to the GOT, with a hash of that layout. The dynamic
+// loader then binds them in bulk instead of resolving each symbol through a
+// proxy, and it reuses the resolved imports when it loads another module with
+// the same layout. Side modules without the section are loaded as before.
+// Only valid with SIDE_MODULE.
+// [link]
+var PRELINK_SIDE_MODULE = 0;
+
 // Deprecated, list shared libraries directly on the command line instead.
 // [link]
 var RUNTIME_LINKED_LIBS = [];
@@ -1507,6 +1569,15 @@ var PTHREAD_POOL_SIZE_STRICT = 1;
 // [link] - affects generated JS runtime code at link time
 var PTHREAD_POOL_DELAY_LOAD = 0;
 
+// The number of exited threads whose resources are kept for reuse by the next
+// pthread_create(). The thread block, thread-specific data array, TLS block
+// and stack of an exited thread are cached instead of being freed, and its
+// Worker stays parked for a short while, so that a new thread can start on it
+// without a postMessage() round trip through the event loop. This makes
+// creating short-lived threads in bursts much cheaper. 0 disables the cache.
+// [link]
+var PTHREAD_REUSE_CACHE = 0;
+
 // If not explicitly specified, this is the stack size to use for newly created
 // pthreads.  According to
 // http://man7.org/linux/man-pages/man3/pthread_create.3.html, default stack
@@ -1533,6 +1604,22 @@ var PTHREADS_PROFILING = 0;
 // [link]
 var ALLOW_BLOCKING_ON_MAIN_THREAD = 1;
 
+// When the main browser thread blocks in a futex wait (for example in
+// pthread_join, pthread_mutex_lock or pthread_cond_wait) or sleeps, suspend it
+// with Asyncify and return to the browser event loop instead of busy-waiting.
+// Futex waits are resumed by Atomics.waitAsync as soon as another thread wakes
+// the futex, and calls proxied to the main thread keep running from the event
+// loop meanwhile. Where Atomics.waitAsync is not available, futex waits still
+// busy-wait but sleeps are still done asynchronously. Waits that happen while
+// the main thread is already suspended (for example in event handlers) or
+// while it runs proxied calls also busy-wait.
+// As with any use of Asyncify, other event handlers can run while the main
+// thread is suspended, and every function that may wait on a futex (which
+// includes malloc) gets instrumented, which increases code size. Requires
+// ASYNCIFY and USE_PTHREADS.
+// [link]
+var MAIN_THREAD_ASYNC_WAIT = 0;
+
 // If true, add in debug traces for diagnosing pthreads related issues.
 // [link]
 var PTHREADS_DEBUG = 0;
@@ -1574,6 +1661,30 @@ var PTHREADS_DEBUG = 0;
 // [link]
 var EVAL_CTORS = 0;
 
+// Takes a snapshot of the program at link time, which it then starts from.
+// emcc runs the program in node until it calls emscripten_snapshot_point(),
+// and records memory and the files that were created in the file system at
+// that point. The snapshot becomes the initial contents of memory in the
+// wasm, so that when the program runs, its global constructors are skipped and
+// main() is called on the state it set up before the snapshot point. Unlike
+// EVAL_CTORS this works for code that calls into JS, but any other JS state
+// that such code creates is not recorded, and it must all be done with files
+// closed and without adding functions to the table. main() starts over after
+// the snapshot, so it has to check for the state it set up, for example:
+//
+//   int main() {
+//     if (!app) {
+//       app = create_app();
+//       emscripten_snapshot_point();
+//     }
+//     run_app(app);
+//   }
+//
+// Output that is printed before the snapshot point is only printed at link
+// time. Not compatible with MEMFS_HEAP_STORAGE.
+// [link]
+var SNAPSHOT = 0;
+
 // Is enabled, use the JavaScript TextDecoder API for string marshalling.
 // Enabled by default, set this to 0 to disable.
 // If set to 2, we assume TextDecoder is present and usable, and do not emit
@@ -1582,11 +1693,30 @@ var EVAL_CTORS = 0;
 // [link]
 var TEXTDECODER = 1;
 
+// If enabled, UTF8ToString() and stringToUTF8() transcode strings of more than a
+// few characters in wasm (system/lib/libc/emscripten_utf8.c), which is faster
+// than doing it in JS, in particular for strings that are mostly ASCII or that
+// contain invalid UTF-8. Shorter strings, and all strings before the runtime is
+// initialized, are still transcoded in JS. This takes precedence over
+// TEXTDECODER for the longer strings in UTF8ToString(). Not supported with
+// MINIMAL_RUNTIME.
+// [link]
+var WASM_STRING_CONVERSION = 0;
+
 // Embind specific: If enabled, assume UTF-8 encoded data in std::string binding.
 // Disable this to support binary data transfer.
 // [link]
 var EMBIND_STD_STRING_IS_UTF8 = 1;
 
+// Embind specific: If enabled, returning the same raw pointer to JS again
+// returns the same handle object, as long as that handle has not been deleted,
+// instead of a new handle each time. Such a handle must only be deleted once,
+// however many times it was returned. The cache holds handles through WeakRef
+// where available; without it, a handle that is never deleted stays cached,
+// and so is never garbage collected.
+// [link]
+var EMBIND_HANDLE_CACHE = 0;
+
 // If set to 1, enables support for transferring canvases to pthreads and
 // creating WebGL contexts in them, as well as explicit swap control for GL
 // contexts. This needs browser support for the OffscreenCanvas specification.
@@ -1637,7 +1767,11 @@ var ASMFS = 0;
 
 // ATTENTION [WIP]: Experimental feature. Please use at your own risk.
 // This will eventually replace the current JS file system implementation.
-// If set to 1, uses new filesystem implementation.
+// If set to 1, uses new filesystem implementation. File contents are stored in
+// linear memory and all syscalls are implemented in wasm, so pthreads can do
+// file I/O without proxying to the main thread. Other storage (such as the host
+// file system under Node.js) can be mounted using the backends declared in
+// emscripten/wasmfs.h.
 // [link]
 var WASMFS = 0;
 
@@ -1890,6 +2024,18 @@ var SEPARATE_DWARF_URL = '';
 // [link]
 var ERROR_ON_WASM_CHANGES_AFTER_LINK = 0;
 
+// Speed up relinking in -O0 and -O1 development builds. Emscripten saves the
+// metadata of each link in a .link-state file next to the wasm output, and
+// when a later link of the same target only changed the code of functions
+// (and not the imports, exports, memory layout, data or anything else the JS
+// depends on) the post-link steps only process the wasm: the JS compiler and
+// the JS passes do not run, and the JS output files from the previous link are
+// kept. Anything else falls back to a full link. wasm-ld itself always runs.
+// This is ignored in -O2 and above, and in builds with outputs that depend on
+// the code, such as wasm2js, SINGLE_FILE, source maps and EVAL_CTORS.
+// [link]
+var INCREMENTAL_LINK = 0;
+
 // Whether the program should abort when an unhandled WASM exception is encountered.
 // This makes the Emscripten program behave more like a native program where the OS
 // would terminate the process and no further code can be executed when an unhandled
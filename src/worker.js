@@ -99,6 +99,106 @@ Module['instantiateWasm'] = function(info, receiveInstance) {
 };
 #endif
 
+// Runs a pthread on this Worker, given the data of a 'run' command.
+function runPthread(data) {
+  // Pass the thread address inside the asm.js scope to store it for fast access that avoids the need for a FFI out.
+  Module['__emscripten_thread_init'](data.threadInfoStruct, /*isMainBrowserThread=*/0, /*isMainRuntimeThread=*/0, /*canBlock=*/1);
+
+  // Establish the stack frame for this thread in global scope
+  // The stack grows downwards
+  var max = data.stackBase;
+  var top = data.stackBase + data.stackSize;
+#if ASSERTIONS
+  assert(data.threadInfoStruct);
+  assert(top != 0);
+  assert(max != 0);
+  assert(top > max);
+#endif
+  // Also call inside JS module to set up the stack frame for this pthread in JS module scope
+  Module['establishStackSpace'](top, max);
+  Module['PThread'].receiveObjectTransfer(data);
+  Module['PThread'].threadInit();
+
+#if EMBIND
+  // Embind must initialize itself on all threads, as it generates support JS.
+  // We only do this once per worker since they get reused
+  if (!initializedJS) {
+    Module['___embind_register_native_and_builtin_types']();
+    initializedJS = true;
+  }
+#endif // EMBIND
+
+  try {
+    // pthread entry points are always of signature 'void *ThreadMain(void *arg)'
+    // Native codebases sometimes spawn threads with other thread entry point signatures,
+    // such as void ThreadMain(void *arg), void *ThreadMain(), or void ThreadMain().
+    // That is not acceptable per C/C++ specification, but x86 compiler ABI extensions
+    // enable that to work. If you find the following line to crash, either change the signature
+    // to "proper" void *ThreadMain(void *arg) form, or try linking with the Emscripten linker
+    // flag -s EMULATE_FUNCTION_POINTER_CASTS=1 to add in emulation for this x86 ABI extension.
+    var result = Module['invokeEntryPoint'](data.start_routine, data.arg);
+
+#if STACK_OVERFLOW_CHECK
+    Module['checkStackCookie']();
+#endif
+#if MINIMAL_RUNTIME
+    // In MINIMAL_RUNTIME the noExitRuntime concept does not apply to
+    // pthreads. To exit a pthread with live runtime, use the function
+    // emscripten_unwind_to_js_event_loop() in the pthread body.
+    // The thread might have finished without calling pthread_exit(). If so,
+    // then perform the exit operation ourselves.
+    // (This is a no-op if explicit pthread_exit() had been called prior.)
+    Module['__emscripten_thread_exit'](result);
+#else
+    if (Module['keepRuntimeAlive']()) {
+      Module['PThread'].setExitStatus(result);
+    } else {
+      Module['__emscripten_thread_exit'](result);
+    }
+#endif
+  } catch(ex) {
+    if (ex != 'unwind') {
+#if ASSERTIONS
+      // FIXME(sbc): Figure out if this is still needed or useful.  Its not
+      // clear to me how this check could ever fail.  In order to get into
+      // this try/catch block at all we have already called bunch of
+      // functions on `Module`.. why is this one special?
+      if (typeof(Module['_emscripten_futex_wake']) !== 'function') {
+        err("Thread Initialisation failed.");
+        throw ex;
+      }
+#endif
+      // ExitStatus not present in MINIMAL_RUNTIME
+#if !MINIMAL_RUNTIME
+      if (ex instanceof Module['ExitStatus']) {
+        if (Module['keepRuntimeAlive']()) {
+#if ASSERTIONS
+          err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' called exit(), staying alive due to noExitRuntime.');
+#endif
+        } else {
+#if ASSERTIONS
+          err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' called exit(), calling _emscripten_thread_exit.');
+#endif
+          Module['__emscripten_thread_exit'](ex.status);
+        }
+      }
+      else
+#endif // !MINIMAL_RUNTIME
+      {
+        // The pthread "crashed".  Do not call `_emscripten_thread_exit` (which
+        // would make this thread joinable.  Instead, re-throw the exception
+        // and let the top level handler propagate it back to the main thread.
+        throw ex;
+      }
+#if ASSERTIONS
+    } else {
+      // else e == 'unwind', and we should fall through here and keep the pthread alive for asynchronous events.
+      err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' completed its main entry point with an `unwind`, keeping the worker alive for asynchronous operation.');
+#endif
+    }
+  }
+}
+
 self.onmessage = function(e) {
   try {
     if (e.data.cmd === 'load') { // Preload command that is called once per worker to parse and load the Emscripten code.
@@ -187,102 +287,17 @@ self.onmessage = function(e) {
       // (+/- 0.1msecs in testing).
       Module['__performance_now_clock_drift'] = performance.now() - e.data.time;
 
-      // Pass the thread address inside the asm.js scope to store it for fast access that avoids the need for a FFI out.
-      Module['__emscripten_thread_init'](e.data.threadInfoStruct, /*isMainBrowserThread=*/0, /*isMainRuntimeThread=*/0);
-
-      // Establish the stack frame for this thread in global scope
-      // The stack grows downwards
-      var max = e.data.stackBase;
-      var top = e.data.stackBase + e.data.stackSize;
-#if ASSERTIONS
-      assert(e.data.threadInfoStruct);
-      assert(top != 0);
-      assert(max != 0);
-      assert(top > max);
-#endif
-      // Also call inside JS module to set up the stack frame for this pthread in JS module scope
-      Module['establishStackSpace'](top, max);
-      Module['PThread'].receiveObjectTransfer(e.data);
-      Module['PThread'].threadInit();
-
-#if EMBIND
-      // Embind must initialize itself on all threads, as it generates support JS.
-      // We only do this once per worker since they get reused
-      if (!initializedJS) {
-        Module['___embind_register_native_and_builtin_types']();
-        initializedJS = true;
-      }
-#endif // EMBIND
-
-      try {
-        // pthread entry points are always of signature 'void *ThreadMain(void *arg)'
-        // Native codebases sometimes spawn threads with other thread entry point signatures,
-        // such as void ThreadMain(void *arg), void *ThreadMain(), or void ThreadMain().
-        // That is not acceptable per C/C++ specification, but x86 compiler ABI extensions
-        // enable that to work. If you find the following line to crash, either change the signature
-        // to "proper" void *ThreadMain(void *arg) form, or try linking with the Emscripten linker
-        // flag -s EMULATE_FUNCTION_POINTER_CASTS=1 to add in emulation for this x86 ABI extension.
-        var result = Module['invokeEntryPoint'](e.data.start_routine, e.data.arg);
-
-#if STACK_OVERFLOW_CHECK
-        Module['checkStackCookie']();
-#endif
-#if MINIMAL_RUNTIME
-        // In MINIMAL_RUNTIME the noExitRuntime concept does not apply to
-        // pthreads. To exit a pthread with live runtime, use the function
-        // emscripten_unwind_to_js_event_loop() in the pthread body.
-        // The thread might have finished without calling pthread_exit(). If so,
-        // then perform the exit operation ourselves.
-        // (This is a no-op if explicit pthread_exit() had been called prior.)
-        Module['__emscripten_thread_exit'](result);
+#if PTHREAD_REUSE_CACHE
+      // When the thread exits, this Worker parks for a while so that the main
+      // thread can hand it the next thread without going through postMessage.
+      var data = e.data;
+      do {
+        runPthread(data);
+        data = Module['PThread'].parkWorker(data.parkSlot);
+      } while (data);
 #else
-        if (Module['keepRuntimeAlive']()) {
-          Module['PThread'].setExitStatus(result);
-        } else {
-          Module['__emscripten_thread_exit'](result);
-        }
-#endif
-      } catch(ex) {
-        if (ex != 'unwind') {
-#if ASSERTIONS
-          // FIXME(sbc): Figure out if this is still needed or useful.  Its not
-          // clear to me how this check could ever fail.  In order to get into
-          // this try/catch block at all we have already called bunch of
-          // functions on `Module`.. why is this one special?
-          if (typeof(Module['_emscripten_futex_wake']) !== 'function') {
-            err("Thread Initialisation failed.");
-            throw ex;
-          }
-#endif
-          // ExitStatus not present in MINIMAL_RUNTIME
-#if !MINIMAL_RUNTIME
-          if (ex instanceof Module['ExitStatus']) {
-            if (Module['keepRuntimeAlive']()) {
-#if ASSERTIONS
-              err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' called exit(), staying alive due to noExitRuntime.');
+      runPthread(e.data);
 #endif
-            } else {
-#if ASSERTIONS
-              err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' called exit(), calling _emscripten_thread_exit.');
-#endif
-              Module['__emscripten_thread_exit'](ex.status);
-            }
-          }
-          else
-#endif // !MINIMAL_RUNTIME
-          {
-            // The pthread "crashed".  Do not call `_emscripten_thread_exit` (which
-            // would make this thread joinable.  Instead, re-throw the exception
-            // and let the top level handler propagate it back to the main thread.
-            throw ex;
-          }
-#if ASSERTIONS
-        } else {
-          // else e == 'unwind', and we should fall through here and keep the pthread alive for asynchronous events.
-          err('Pthread 0x' + Module['_pthread_self']().toString(16) + ' completed its main entry point with an `unwind`, keeping the worker alive for asynchronous operation.');
-#endif
-        }
-      }
     } else if (e.data.cmd === 'cancel') { // Main thread is asking for a pthread_cancel() on this thread.
       if (Module['_pthread_self']()) {
         Module['__emscripten_thread_exit'](-1/*PTHREAD_CANCELED*/);
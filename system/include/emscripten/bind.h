@@ -146,6 +146,19 @@ void _embind_register_value_object_field(
 
 void _embind_finalize_value_object(TYPEID structType);
 
+void _embind_register_flat_view(
+    TYPEID flatArrayType,
+    const char* name,
+    size_t stride);
+
+void _embind_register_flat_view_field(
+    TYPEID flatArrayType,
+    const char* fieldName,
+    unsigned typedArrayIndex,
+    size_t offset);
+
+void _embind_finalize_flat_view(TYPEID flatArrayType);
+
 void _embind_register_class(
     TYPEID classType,
     TYPEID pointerType,
@@ -1011,6 +1024,52 @@ public:
     }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// FLAT VIEWS
+////////////////////////////////////////////////////////////////////////////////
+
+// Registers a JavaScript view over arrays of ClassType, which C++ passes to
+// JavaScript as flat_array<ClassType>. The view reads and writes the fields
+// in place, so only plain data members of arithmetic types are supported.
+template<typename ClassType>
+class flat_view : public internal::noncopyable {
+public:
+    typedef ClassType class_type;
+
+    flat_view(const char* name) {
+        using namespace internal;
+
+        _embind_register_flat_view(
+            TypeID<flat_array<ClassType>>::get(),
+            name,
+            sizeof(ClassType));
+    }
+
+    ~flat_view() {
+        using namespace internal;
+        _embind_finalize_flat_view(TypeID<flat_array<ClassType>>::get());
+    }
+
+    template<typename InstanceType, typename FieldType>
+    flat_view& field(const char* fieldName, FieldType InstanceType::*field) {
+        using namespace internal;
+        static_assert(typeSupportsMemoryView<FieldType>(),
+            "flat_view fields must be integers of up to 32 bits, floats or doubles");
+
+        typename std::aligned_storage<sizeof(ClassType), alignof(ClassType)>::type storage;
+        const ClassType* instance = reinterpret_cast<const ClassType*>(&storage);
+        size_t offset = reinterpret_cast<const char*>(&(instance->*field)) -
+                        reinterpret_cast<const char*>(instance);
+
+        _embind_register_flat_view_field(
+            TypeID<flat_array<ClassType>>::get(),
+            fieldName,
+            getTypedArrayIndex<FieldType>(),
+            offset);
+        return *this;
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // SMART POINTERS
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +176,8 @@ void emscripten_dlopen(const char *filename, int flags, void* user_data, em_dlop
 void emscripten_throw_number(double number);
 void emscripten_throw_string(const char *utf8String);
 
+void emscripten_snapshot_point(void);
+
 /* ===================================== */
 /* Internal APIs. Be careful with these. */
 /* ===================================== */
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <emscripten/em_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A work-stealing task scheduler running on a fixed set of pthreads.
+//
+// Each worker thread owns a deque of tasks. A thread pushes and pops tasks on
+// its own deque, and idle workers steal from the other end of other workers'
+// deques. Workers that find nothing to do sleep on a futex until new tasks are
+// spawned. Threads that wait for a task group run tasks while they wait, so
+// nested parallelism never deadlocks.
+//
+// Without -pthread the same API is available. Tasks then run synchronously
+// when they are spawned.
+
+// A set of tasks that can be waited for together (fork/join). Initialize it
+// with emscripten_task_group_init(). Its fields are internal.
+typedef struct em_task_group {
+  int pending;
+} em_task_group;
+
+// Called with a subrange [begin, end) of the range given to
+// emscripten_parallel_for().
+typedef void (*em_task_range_func)(int begin, int end, void* arg);
+
+// Starts the scheduler with |num_workers| worker threads. Pass 0 to use one
+// worker per logical core, minus one for the calling thread, which
+// participates whenever it waits for tasks. Returns the number of workers
+// started. If the scheduler is already running this does nothing and
+// returns its current number of workers.
+//
+// Calling this is optional: the scheduler starts with the default number of
+// workers on first use. Worker threads come from the pthread pool, so
+// -sPTHREAD_POOL_SIZE should be large enough if tasks are spawned from the
+// main browser thread, which cannot wait for a new Worker to start.
+int emscripten_task_scheduler_init(int num_workers);
+
+// Stops and joins all worker threads. There must be no unfinished tasks.
+void emscripten_task_scheduler_shutdown(void);
+
+// Returns the number of worker threads, not counting the threads that run
+// tasks while waiting for a task group.
+int emscripten_task_scheduler_num_workers(void);
+
+void emscripten_task_group_init(em_task_group* group);
+
+// Runs func(arg) asynchronously as part of |group|. |group| may be NULL for a
+// task that is never waited for.
+void emscripten_task_spawn(em_task_group* group,
+                           em_arg_callback_func func,
+                           void* arg);
+
+// Returns once every task spawned into |group| has finished, including tasks
+// spawned by those tasks. The calling thread runs pending tasks meanwhile.
+void emscripten_task_group_wait(em_task_group* group);
+
+// Calls func on subranges of [begin, end) in parallel and returns when the
+// whole range is done. The range is split recursively in halves until
+// subranges are at most |grain| long, so idle workers steal large pieces
+// first. Pass a |grain| of 0 to pick one from the range and worker count.
+void emscripten_parallel_for(int begin,
+                             int end,
+                             int grain,
+                             em_task_range_func func,
+                             void* arg);
+
+#ifdef __cplusplus
+}
+#endif
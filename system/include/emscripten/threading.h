@@ -333,6 +333,35 @@ void emscripten_conditional_set_current_thread_status(EM_THREAD_STATUS expectedS
 // this is a no-op.
 void emscripten_set_thread_name(pthread_t threadId, const char *name);
 
+// Thread timeline: when started, each thread records its status changes (see
+// EM_THREAD_STATUS above) and user scope markers, with timestamps, into a
+// lock-free ring buffer of its own. Any thread can collect the events of all
+// threads in the Chrome trace event format (chrome://tracing, Perfetto). When
+// the timeline is not started, recording an event costs a single load.
+
+// Starts recording. Each thread records up to |max_events_per_thread| events
+// between two calls to emscripten_thread_timeline_export(); later events are
+// dropped and counted. Pass 0 for a default of 16384.
+void emscripten_thread_timeline_start(int max_events_per_thread);
+
+// Stops recording. Events recorded so far can still be exported.
+void emscripten_thread_timeline_stop(void);
+
+// Marks the beginning and the end of a named scope on the calling thread.
+// Scopes must be properly nested on each thread. |name| is stored by pointer,
+// so it must stay valid until the timeline has been exported, which is the
+// case for string literals.
+void emscripten_thread_timeline_begin(const char *name);
+void emscripten_thread_timeline_end(void);
+
+// Records a named instant event on the calling thread.
+void emscripten_thread_timeline_mark(const char *name);
+
+// Removes all recorded events from the per-thread buffers and returns them as
+// a JSON string in the Chrome trace event format. The returned string must be
+// released with free(). Returns NULL if nothing has been recorded.
+char *emscripten_thread_timeline_export(void);
+
 // Gets the stored pointer to a string representing the canvases to transfer to
 // the created thread.
 int emscripten_pthread_attr_gettransferredcanvases(const pthread_attr_t *a, const char **str);
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+// Backends of the new file system (-s WASMFS). A backend provides the storage
+// for a tree of files; a directory of a backend is mounted at a path with
+// wasmfs_create_directory(), and everything created beneath it uses the same
+// backend.
+
+#ifdef __cplusplus
+namespace wasmfs {
+class Backend;
+}
+typedef wasmfs::Backend* backend_t;
+extern "C" {
+#else
+typedef struct Backend* backend_t;
+#endif
+
+// Creates a directory at |path| whose contents are stored by |backend|.
+// Returns 0 on success, or a negative errno value.
+int wasmfs_create_directory(const char* path, mode_t mode, backend_t backend);
+
+// Returns the backend of the file or directory open at |fd|, or NULL.
+backend_t wasmfs_get_backend_by_fd(int fd);
+
+// The default backend, which keeps file contents in linear memory.
+backend_t wasmfs_get_memory_backend(void);
+
+// A backend that stores files in the host file system under the directory
+// |root|, using Node's fs module. Only usable when running in Node.js. Small
+// reads are served from a read-ahead buffer and small sequential writes are
+// gathered and written out together, on close() or fsync() at the latest.
+backend_t wasmfs_create_node_backend(const char* root);
+
+#ifdef __cplusplus
+}
+#endif
@@ -402,6 +402,29 @@ namespace emscripten {
                     (std::is_integral<T>::value &&
                         (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4));
         }
+
+        // matches typeMapping in embind.js
+        enum TypedArrayIndex {
+            Int8Array,
+            Uint8Array,
+            Int16Array,
+            Uint16Array,
+            Int32Array,
+            Uint32Array,
+            Float32Array,
+            Float64Array,
+        };
+
+        template<typename T>
+        constexpr TypedArrayIndex getTypedArrayIndex() {
+            static_assert(typeSupportsMemoryView<T>(), "type does not map to a typed array");
+            return std::is_floating_point<T>::value
+                ? (sizeof(T) == 4 ? Float32Array : Float64Array)
+                : (sizeof(T) == 1
+                    ? (std::is_signed<T>::value ? Int8Array : Uint8Array)
+                    : (sizeof(T) == 2 ? (std::is_signed<T>::value ? Int16Array : Uint16Array)
+                                      : (std::is_signed<T>::value ? Int32Array : Uint32Array)));
+        }
     }
 
     template<typename ElementType>
@@ -443,4 +466,35 @@ namespace emscripten {
             }
         };
     }
+
+    // An array of structs that JavaScript accesses in place through the view
+    // registered for ElementType with flat_view<ElementType>.
+    template<typename ElementType>
+    struct flat_array {
+        flat_array() = delete;
+        explicit flat_array(size_t size, const ElementType* data)
+            : size(size)
+            , data(data)
+        {}
+
+        const size_t size; // in elements, not bytes
+        const void* const data;
+    };
+
+    template<typename T>
+    inline flat_array<T> flat_array_view(size_t size, const T* data) {
+        return flat_array<T>(size, data);
+    }
+
+    namespace internal {
+        template<typename ElementType>
+        struct BindingType<flat_array<ElementType>> {
+            // Like memory_view, this is only ever passed from C++ to
+            // JavaScript.
+            typedef flat_array<ElementType> WireType;
+            static WireType toWireType(const flat_array<ElementType>& fa) {
+                return fa;
+            }
+        };
+    }
 }
@@ -0,0 +1,356 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Software mixer for the OpenAL implementation in library_openal.js, used when
+// building with -sOPENAL_MIXER. Every buffer that a source plays is a voice
+// here. Voices are resampled, panned and mixed into a ring buffer of stereo
+// frames, which a single Web Audio node of the context plays back.
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+// Frames that are mixed at a time.
+#define BLOCK_FRAMES 128
+// Frames that the ring buffer holds. A multiple of BLOCK_FRAMES, so that
+// blocks never wrap around the end of the ring.
+#define RING_FRAMES 16384
+#define MAX_VOICES 1024
+
+typedef struct Voice {
+  // The samples of each channel, one after the other.
+  const float* data;
+  uint32_t frames;
+  uint32_t channels;
+  // Where the voice starts on the timeline of the mixer, in output frames.
+  double start;
+  // The read position in data, in source frames, and how much it advances
+  // per output frame.
+  double position;
+  double step;
+  int loop;
+  uint32_t loop_start;
+  uint32_t loop_end;
+  // The gain from input channel i to output channel o is gains[i * 2 + o].
+  float gains[4];
+  uint16_t generation;
+  uint8_t active;
+  uint8_t started;
+} Voice;
+
+typedef struct Mixer {
+  double sample_rate;
+  // Frames mixed so far.
+  uint64_t rendered;
+  // The ring buffer holds interleaved stereo frames. Only the mixer writes
+  // write_pos, and only the output node writes read_pos, so the output could
+  // be read from another thread.
+  _Atomic uint32_t write_pos;
+  _Atomic uint32_t read_pos;
+  float ring[RING_FRAMES * 2];
+  float mix[2][BLOCK_FRAMES];
+  float resampled[2][BLOCK_FRAMES];
+  // Voices above this index have never been used.
+  uint32_t num_voices;
+  Voice voices[MAX_VOICES];
+} Mixer;
+
+Mixer* emscripten_al_mixer_create(double sample_rate) {
+  Mixer* mixer = calloc(1, sizeof(Mixer));
+  if (mixer) {
+    mixer->sample_rate = sample_rate;
+  }
+  return mixer;
+}
+
+void emscripten_al_mixer_destroy(Mixer* mixer) {
+  free(mixer);
+}
+
+// Voice handles hold the index of the voice and its generation, so that
+// handles of voices that ended and were reused are ignored.
+static Voice* get_voice(Mixer* mixer, int handle) {
+  uint32_t index = (handle & 0xffff) - 1;
+  if (index >= mixer->num_voices) {
+    return NULL;
+  }
+  Voice* voice = &mixer->voices[index];
+  if (!voice->active || voice->generation != (uint32_t)handle >> 16) {
+    return NULL;
+  }
+  return voice;
+}
+
+// Plays frames of planar data, starting at offset (in source frames) at the
+// given time on the timeline of the mixer. Returns the handle of the voice, or
+// 0 if there is nothing to play or all voices are in use.
+int emscripten_al_mixer_play(Mixer* mixer,
+                             const float* data,
+                             uint32_t frames,
+                             uint32_t channels,
+                             double start,
+                             double offset,
+                             double step,
+                             int loop,
+                             double loop_start,
+                             double loop_end) {
+  if (!frames) {
+    return 0;
+  }
+  uint32_t index = 0;
+  while (index < mixer->num_voices && mixer->voices[index].active) {
+    index++;
+  }
+  if (index == MAX_VOICES) {
+    return 0;
+  }
+  if (index == mixer->num_voices) {
+    mixer->num_voices++;
+  }
+
+  Voice* voice = &mixer->voices[index];
+  voice->data = data;
+  voice->frames = frames;
+  voice->channels = channels;
+  voice->start = start;
+  voice->position = offset;
+  voice->step = step;
+  voice->loop = loop;
+  // Like AudioBufferSourceNode, loop over the whole buffer unless the loop
+  // points describe a part of it.
+  voice->loop_start = 0;
+  voice->loop_end = frames;
+  if (loop_start >= 0 && loop_start < loop_end && loop_end <= frames) {
+    voice->loop_start = (uint32_t)loop_start;
+    voice->loop_end = (uint32_t)loop_end;
+  }
+  memset(voice->gains, 0, sizeof(voice->gains));
+  voice->generation = (voice->generation + 1) & 0x7fff;
+  voice->active = 1;
+  voice->started = 0;
+  return (voice->generation << 16) | (index + 1);
+}
+
+void emscripten_al_mixer_stop(Mixer* mixer, int handle) {
+  Voice* voice = get_voice(mixer, handle);
+  if (voice) {
+    voice->active = 0;
+  }
+}
+
+void emscripten_al_mixer_set_voice_rate(Mixer* mixer, int handle, double step) {
+  Voice* voice = get_voice(mixer, handle);
+  if (voice) {
+    voice->step = step;
+  }
+}
+
+void emscripten_al_mixer_set_voice_loop(Mixer* mixer, int handle, int loop) {
+  Voice* voice = get_voice(mixer, handle);
+  if (voice) {
+    voice->loop = loop;
+  }
+}
+
+void emscripten_al_mixer_set_voice_gains(Mixer* mixer, int handle, float ll, float lr, float rl, float rr) {
+  Voice* voice = get_voice(mixer, handle);
+  if (voice) {
+    voice->gains[0] = ll;
+    voice->gains[1] = lr;
+    voice->gains[2] = rl;
+    voice->gains[3] = rr;
+  }
+}
+
+// Wraps the position of a looping voice back into the loop. Returns whether
+// the voice has anything left to play.
+static int wrap_position(Voice* voice) {
+  if (!voice->loop) {
+    return voice->position < voice->frames;
+  }
+  if (voice->position >= voice->loop_end) {
+    double length = voice->loop_end - voice->loop_start;
+    voice->position = voice->loop_start + fmod(voice->position - voice->loop_start, length);
+  }
+  return 1;
+}
+
+// Resamples up to count frames of a voice into mixer->resampled with linear
+// interpolation. Returns the number of frames produced, which is less than
+// count when a voice that does not loop ends.
+static uint32_t resample(Mixer* mixer, Voice* voice, uint32_t count) {
+  uint32_t end = voice->loop ? voice->loop_end : voice->frames;
+  double position = voice->position;
+  uint32_t i = 0;
+  while (i < count) {
+    if (position >= end) {
+      if (!voice->loop) {
+        break;
+      }
+      position = voice->loop_start + fmod(position - voice->loop_start, end - voice->loop_start);
+    }
+    uint32_t index = (uint32_t)position;
+    if (voice->step == 1.0 && position == index) {
+      // Nothing to interpolate, so copy until the end of the data or the loop.
+      uint32_t n = end - index;
+      if (n > count - i) {
+        n = count - i;
+      }
+      for (uint32_t c = 0; c < voice->channels; c++) {
+        memcpy(&mixer->resampled[c][i], voice->data + c * voice->frames + index, n * sizeof(float));
+      }
+      i += n;
+      position += n;
+      continue;
+    }
+    uint32_t next = index + 1;
+    if (next >= end) {
+      next = voice->loop ? voice->loop_start : index;
+    }
+    float frac = (float)(position - index);
+    for (uint32_t c = 0; c < voice->channels; c++) {
+      const float* data = voice->data + c * voice->frames;
+      mixer->resampled[c][i] = data[index] + (data[next] - data[index]) * frac;
+    }
+    i++;
+    position += voice->step;
+  }
+  voice->position = position;
+  return i;
+}
+
+// Adds count resampled frames of a voice to the mix, starting at frame first.
+static void accumulate(Mixer* mixer, Voice* voice, uint32_t first, uint32_t count) {
+  float* left = &mixer->mix[0][first];
+  float* right = &mixer->mix[1][first];
+  const float* in0 = mixer->resampled[0];
+  const float* in1 = mixer->resampled[voice->channels > 1 ? 1 : 0];
+  // A mono voice only uses the gains of its first channel.
+  float ll = voice->gains[0];
+  float lr = voice->gains[1];
+  float rl = voice->channels > 1 ? voice->gains[2] : 0.0f;
+  float rr = voice->channels > 1 ? voice->gains[3] : 0.0f;
+  uint32_t i = 0;
+#ifdef __wasm_simd128__
+  v128_t ll4 = wasm_f32x4_splat(ll);
+  v128_t lr4 = wasm_f32x4_splat(lr);
+  v128_t rl4 = wasm_f32x4_splat(rl);
+  v128_t rr4 = wasm_f32x4_splat(rr);
+  for (; i + 4 <= count; i += 4) {
+    v128_t a = wasm_v128_load(in0 + i);
+    v128_t b = wasm_v128_load(in1 + i);
+    v128_t l = wasm_v128_load(left + i);
+    v128_t r = wasm_v128_load(right + i);
+    l = wasm_f32x4_add(l, wasm_f32x4_add(wasm_f32x4_mul(a, ll4), wasm_f32x4_mul(b, rl4)));
+    r = wasm_f32x4_add(r, wasm_f32x4_add(wasm_f32x4_mul(a, lr4), wasm_f32x4_mul(b, rr4)));
+    wasm_v128_store(left + i, l);
+    wasm_v128_store(right + i, r);
+  }
+#endif
+  for (; i < count; i++) {
+    left[i] += in0[i] * ll + in1[i] * rl;
+    right[i] += in0[i] * lr + in1[i] * rr;
+  }
+}
+
+static void mix_voice(Mixer* mixer, Voice* voice) {
+  uint32_t first = 0;
+  if (!voice->started) {
+    double offset = voice->start - (double)mixer->rendered;
+    if (offset > 0) {
+      if (offset > BLOCK_FRAMES - 1) {
+        return;
+      }
+      first = (uint32_t)ceil(offset);
+      // Start at the first whole frame after the start time.
+      voice->position += (first - offset) * voice->step;
+    } else {
+      // The voice was scheduled before the current block, so skip what would
+      // have played already.
+      voice->position -= offset * voice->step;
+    }
+    voice->started = 1;
+    if (!wrap_position(voice)) {
+      voice->active = 0;
+      return;
+    }
+  }
+  uint32_t count = resample(mixer, voice, BLOCK_FRAMES - first);
+  accumulate(mixer, voice, first, count);
+  if (count < BLOCK_FRAMES - first) {
+    voice->active = 0;
+  }
+}
+
+static void mix_block(Mixer* mixer, float* out) {
+  memset(mixer->mix, 0, sizeof(mixer->mix));
+  for (uint32_t i = 0; i < mixer->num_voices; i++) {
+    if (mixer->voices[i].active) {
+      mix_voice(mixer, &mixer->voices[i]);
+    }
+  }
+  while (mixer->num_voices && !mixer->voices[mixer->num_voices - 1].active) {
+    mixer->num_voices--;
+  }
+  mixer->rendered += BLOCK_FRAMES;
+
+  uint32_t i = 0;
+#ifdef __wasm_simd128__
+  for (; i < BLOCK_FRAMES; i += 4) {
+    v128_t l = wasm_v128_load(&mixer->mix[0][i]);
+    v128_t r = wasm_v128_load(&mixer->mix[1][i]);
+    wasm_v128_store(out + i * 2, wasm_i32x4_shuffle(l, r, 0, 4, 1, 5));
+    wasm_v128_store(out + i * 2 + 4, wasm_i32x4_shuffle(l, r, 2, 6, 3, 7));
+  }
+#endif
+  for (; i < BLOCK_FRAMES; i++) {
+    out[i * 2] = mixer->mix[0][i];
+    out[i * 2 + 1] = mixer->mix[1][i];
+  }
+}
+
+// Mixes blocks until the ring buffer holds at least the given number of
+// frames, or is full. Returns the number of frames in the ring buffer.
+uint32_t emscripten_al_mixer_render(Mixer* mixer, uint32_t frames) {
+  uint32_t write_pos = atomic_load_explicit(&mixer->write_pos, memory_order_relaxed);
+  uint32_t read_pos = atomic_load_explicit(&mixer->read_pos, memory_order_acquire);
+  while (write_pos - read_pos < frames && write_pos - read_pos <= RING_FRAMES - BLOCK_FRAMES) {
+    mix_block(mixer, &mixer->ring[(write_pos % RING_FRAMES) * 2]);
+    write_pos += BLOCK_FRAMES;
+    atomic_store_explicit(&mixer->write_pos, write_pos, memory_order_release);
+  }
+  return write_pos - read_pos;
+}
+
+// Reads frames from the ring buffer into separate left and right outputs, and
+// fills what is missing with silence. Returns the number of frames read.
+uint32_t emscripten_al_mixer_read(Mixer* mixer, float* left, float* right, uint32_t frames) {
+  uint32_t read_pos = atomic_load_explicit(&mixer->read_pos, memory_order_relaxed);
+  uint32_t write_pos = atomic_load_explicit(&mixer->write_pos, memory_order_acquire);
+  uint32_t available = write_pos - read_pos;
+  uint32_t n = frames < available ? frames : available;
+  for (uint32_t i = 0; i < n; i++) {
+    const float* frame = &mixer->ring[((read_pos + i) % RING_FRAMES) * 2];
+    left[i] = frame[0];
+    right[i] = frame[1];
+  }
+  memset(left + n, 0, (frames - n) * sizeof(float));
+  memset(right + n, 0, (frames - n) * sizeof(float));
+  atomic_store_explicit(&mixer->read_pos, read_pos + n, memory_order_release);
+  return n;
+}
+
+// The time on the timeline of the mixer, which is where the next block is
+// mixed. Voices are scheduled relative to this.
+double emscripten_al_mixer_get_time(Mixer* mixer) {
+  return mixer->rendered / mixer->sample_rate;
+}
@@ -67,28 +67,6 @@ template <typename T> static void register_float(const char* name) {
   _embind_register_float(TypeID<T>::get(), name, sizeof(T));
 }
 
-// matches typeMapping in embind.js
-enum TypedArrayIndex {
-  Int8Array,
-  Uint8Array,
-  Int16Array,
-  Uint16Array,
-  Int32Array,
-  Uint32Array,
-  Float32Array,
-  Float64Array,
-};
-
-template <typename T> constexpr TypedArrayIndex getTypedArrayIndex() {
-  static_assert(internal::typeSupportsMemoryView<T>(), "type does not map to a typed array");
-  return std::is_floating_point<T>::value
-           ? (sizeof(T) == 4 ? Float32Array : Float64Array)
-           : (sizeof(T) == 1
-                 ? (std::is_signed<T>::value ? Int8Array : Uint8Array)
-                 : (sizeof(T) == 2 ? (std::is_signed<T>::value ? Int16Array : Uint16Array)
-                                   : (std::is_signed<T>::value ? Int32Array : Uint32Array)));
-}
-
 template <typename T> static void register_memory_view(const char* name) {
   using namespace internal;
   _embind_register_memory_view(TypeID<memory_view<T>>::get(), getTypedArrayIndex<T>(), name);
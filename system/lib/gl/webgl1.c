@@ -1,5 +1,7 @@
 #include <emscripten/threading.h>
 #include <emscripten/console.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -21,12 +23,16 @@ extern void _emscripten_proxied_gl_context_activated_from_main_browser_thread(EM
 
 pthread_key_t currentActiveWebGLContext;
 pthread_key_t currentThreadOwnsItsWebGLContext;
+static pthread_key_t stagingArenaKey;
 static pthread_once_t tlsInit = PTHREAD_ONCE_INIT;
 
+static void FreeStagingArena(void *arena);
+
 static void InitWebGLTls()
 {
   pthread_key_create(&currentActiveWebGLContext, NULL);
   pthread_key_create(&currentThreadOwnsItsWebGLContext, NULL);
+  pthread_key_create(&stagingArenaKey, FreeStagingArena);
 }
 
 EMSCRIPTEN_WEBGL_CONTEXT_HANDLE emscripten_webgl_create_context(const char *target, const EmscriptenWebGLContextAttributes *attributes)
@@ -104,6 +110,104 @@ static void *memdup(const void *ptr, size_t sz)
   return dup;
 }
 
+// The data of uploads that are proxied to the thread that owns the context is
+// copied to a staging arena, so that the calling thread can continue without
+// waiting for the call to run, and without a malloc() and free() per call.
+// Each calling thread has one arena per thread it proxies to, which it fills as
+// a ring buffer, and the owning thread releases the data of each call after
+// running it. Calls to one thread run in the order they were queued, so the
+// data of an arena is released in the order it was staged. Uploads that do not
+// fit fall back to a malloc()ed copy.
+#define STAGING_ARENA_SIZE (4*1024*1024) // must be a power of two
+
+// Set in the tail of an arena once the calling thread has exited. Allocations
+// are 16-byte aligned, so the tail never uses this bit otherwise.
+#define STAGING_ARENA_ABANDONED 1
+
+typedef struct StagingArena
+{
+  size_t head; // Bytes staged so far, only written by the calling thread.
+  _Atomic size_t tail; // Bytes released so far, only written by the owning thread.
+  void *owningThread; // The thread that runs the calls.
+  struct StagingArena *next; // The next arena of the calling thread.
+  uint8_t memory[STAGING_ARENA_SIZE] __attribute__((aligned(16)));
+} StagingArena;
+
+typedef struct StagingHeader
+{
+  StagingArena *arena;
+  size_t end; // The head of the arena after this allocation.
+  size_t padding[2]; // Keep the data 16-byte aligned.
+} StagingHeader;
+
+// Called when the calling thread exits. An arena with calls that are still
+// queued is freed by unstage() after the last of them has run.
+static void FreeStagingArena(void *ptr)
+{
+  StagingArena *arena = (StagingArena*)ptr;
+  while (arena)
+  {
+    // Once the flag is set the arena may be freed by unstage(), so read it before.
+    StagingArena *next = arena->next;
+    size_t head = arena->head;
+    if (atomic_fetch_or(&arena->tail, STAGING_ARENA_ABANDONED) == head) free(arena);
+    arena = next;
+  }
+}
+
+// Copies the data to the staging arena of the calling thread for the thread
+// that owns the current context. Returns 0 if the data does not fit.
+static void *stage(const void *ptr, size_t sz)
+{
+  if (!ptr) return 0;
+  size_t need = sizeof(StagingHeader) + ((sz + 15) & ~15);
+  if (sz > STAGING_ARENA_SIZE || need > STAGING_ARENA_SIZE) return 0;
+  pthread_once(&tlsInit, InitWebGLTls);
+  void *owningThread = *(void**)(pthread_getspecific(currentActiveWebGLContext) + 4);
+  StagingArena *first = (StagingArena*)pthread_getspecific(stagingArenaKey);
+  StagingArena *arena = first;
+  while (arena && arena->owningThread != owningThread) arena = arena->next;
+  if (!arena)
+  {
+    arena = (StagingArena*)aligned_alloc(16, sizeof(StagingArena));
+    if (!arena) return 0;
+    arena->head = 0;
+    atomic_init(&arena->tail, 0);
+    arena->owningThread = owningThread;
+    arena->next = first;
+    pthread_setspecific(stagingArenaKey, arena);
+  }
+  // Allocations do not wrap around the end of the arena, skip to its start instead.
+  size_t pos = arena->head & (STAGING_ARENA_SIZE - 1);
+  size_t skip = pos + need > STAGING_ARENA_SIZE ? STAGING_ARENA_SIZE - pos : 0;
+  if (arena->head + skip + need - atomic_load(&arena->tail) > STAGING_ARENA_SIZE) return 0;
+  StagingHeader *header = (StagingHeader*)(arena->memory + ((pos + skip) & (STAGING_ARENA_SIZE - 1)));
+  arena->head += skip + need;
+  header->arena = arena;
+  header->end = arena->head;
+  memcpy(header + 1, ptr, sz);
+  return header + 1;
+}
+
+// Releases data returned by stage(), once the call that uses it has run.
+static void unstage(const void *ptr)
+{
+  const StagingHeader *header = (const StagingHeader*)ptr - 1;
+  StagingArena *arena = header->arena;
+  size_t end = header->end;
+  size_t tail = atomic_load(&arena->tail);
+  while (!atomic_compare_exchange_weak(&arena->tail, &tail, end | (tail & STAGING_ARENA_ABANDONED)))
+    ;
+  // The calling thread stages nothing more once it has exited.
+  if ((tail & STAGING_ARENA_ABANDONED) && end == arena->head) free(arena);
+}
+
+// Runs a GL call whose last argument is staged data on the owning thread, and
+// releases the data.
+#define STAGED_GL_FUNCTION_3(functionName, t0, t1, t2) static void staged_##functionName(t0 p0, t1 p1, t2 p2) { emscripten_##functionName(p0, p1, p2); unstage(p2); }
+#define STAGED_GL_FUNCTION_4(functionName, t0, t1, t2, t3) static void staged_##functionName(t0 p0, t1 p1, t2 p2, t3 p3) { emscripten_##functionName(p0, p1, p2, p3); unstage(p3); }
+#define STAGED_GL_FUNCTION_9(functionName, t0, t1, t2, t3, t4, t5, t6, t7, t8) static void staged_##functionName(t0 p0, t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8) { emscripten_##functionName(p0, p1, p2, p3, p4, p5, p6, p7, p8); unstage(p8); }
+
 ASYNC_GL_FUNCTION_1(EM_FUNC_SIG_VI, void, glActiveTexture, GLenum);
 ASYNC_GL_FUNCTION_2(EM_FUNC_SIG_VII, void, glAttachShader, GLuint, GLuint);
 VOID_SYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIII, void, glBindAttribLocation, GLuint, GLuint, const GLchar*);
@@ -117,6 +221,12 @@ ASYNC_GL_FUNCTION_2(EM_FUNC_SIG_VII, void, glBlendEquationSeparate, GLenum, GLen
 ASYNC_GL_FUNCTION_2(EM_FUNC_SIG_VII, void, glBlendFunc, GLenum, GLenum);
 ASYNC_GL_FUNCTION_4(EM_FUNC_SIG_VIIII, void, glBlendFuncSeparate, GLenum, GLenum, GLenum, GLenum);
 
+static void staged_glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+  emscripten_glBufferData(target, size, data, usage);
+  unstage(data);
+}
+
 void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -124,6 +234,12 @@ void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage
     emscripten_glBufferData(target, size, data, usage);
   else
   {
+    void *staged = stage(data, size);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIII, &staged_glBufferData, 0, target, size, staged, usage);
+      return;
+    }
     if (size < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(data, size);
@@ -139,6 +255,8 @@ void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage
   }
 }
 
+STAGED_GL_FUNCTION_4(glBufferSubData, GLenum, GLintptr, GLsizeiptr, const void *);
+
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -146,6 +264,12 @@ void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void
     emscripten_glBufferSubData(target, offset, size, data);
   else
   {
+    void *staged = stage(data, size);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIII, &staged_glBufferSubData, 0, target, offset, size, staged);
+      return;
+    }
     if (size < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(data, size);
@@ -280,6 +404,8 @@ static ssize_t ImageSize(int width, int height, GLenum format, GLenum type)
   return width*height*sizePerPixel;
 }
 
+STAGED_GL_FUNCTION_9(glTexImage2D, GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *);
+
 void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -288,6 +414,12 @@ void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei widt
   else
   {
     ssize_t sz = ImageSize(width, height, format, type);
+    void *staged = stage(pixels, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIIIIIIII, &staged_glTexImage2D, 0, target, level, internalformat, width, height, border, format, type, staged);
+      return;
+    }
     if (!pixels || (sz >= 0 && sz < 256*1024)) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(pixels, sz);
@@ -308,6 +440,8 @@ VOID_SYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIII, void, glTexParameterfv, GLenum, GLenum
 ASYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIII, void, glTexParameteri, GLenum, GLenum, GLint);
 VOID_SYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIII, void, glTexParameteriv, GLenum, GLenum, const GLint *);
 
+STAGED_GL_FUNCTION_9(glTexSubImage2D, GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *);
+
 void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -316,6 +450,12 @@ void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, G
   else
   {
     ssize_t sz = ImageSize(width, height, format, type);
+    void *staged = stage(pixels, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIIIIIIII, &staged_glTexSubImage2D, 0, target, level, xoffset, yoffset, width, height, format, type, staged);
+      return;
+    }
     if (!pixels || (sz >= 0 && sz < 256*1024)) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(pixels, sz);
@@ -333,6 +473,8 @@ void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, G
 
 ASYNC_GL_FUNCTION_2(EM_FUNC_SIG_VIF, void, glUniform1f, GLint, GLfloat);
 
+STAGED_GL_FUNCTION_3(glUniform1fv, GLint, GLsizei, const GLfloat *);
+
 void glUniform1fv(GLint location, GLsizei count, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -341,6 +483,12 @@ void glUniform1fv(GLint location, GLsizei count, const GLfloat *value)
   else
   {
     size_t sz = sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform1fv, 0, location, count, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -358,6 +506,8 @@ void glUniform1fv(GLint location, GLsizei count, const GLfloat *value)
 
 ASYNC_GL_FUNCTION_2(EM_FUNC_SIG_VII, void, glUniform1i, GLint, GLint);
 
+STAGED_GL_FUNCTION_3(glUniform1iv, GLint, GLsizei, const GLint *);
+
 void glUniform1iv(GLint location, GLsizei count, const GLint *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -366,6 +516,12 @@ void glUniform1iv(GLint location, GLsizei count, const GLint *value)
   else
   {
     size_t sz = sizeof(GLint)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform1iv, 0, location, count, (GLint*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -382,6 +538,8 @@ void glUniform1iv(GLint location, GLsizei count, const GLint *value)
 }
 ASYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIFF, void, glUniform2f, GLint, GLfloat, GLfloat);
 
+STAGED_GL_FUNCTION_3(glUniform2fv, GLint, GLsizei, const GLfloat *);
+
 void glUniform2fv(GLint location, GLsizei count, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -390,6 +548,12 @@ void glUniform2fv(GLint location, GLsizei count, const GLfloat *value)
   else
   {
     size_t sz = 2*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform2fv, 0, location, count, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -407,6 +571,8 @@ void glUniform2fv(GLint location, GLsizei count, const GLfloat *value)
 
 ASYNC_GL_FUNCTION_3(EM_FUNC_SIG_VIII, void, glUniform2i, GLint, GLint, GLint);
 
+STAGED_GL_FUNCTION_3(glUniform2iv, GLint, GLsizei, const GLint *);
+
 void glUniform2iv(GLint location, GLsizei count, const GLint *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -415,6 +581,12 @@ void glUniform2iv(GLint location, GLsizei count, const GLint *value)
   else
   {
     size_t sz = 2*sizeof(GLint)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform2iv, 0, location, count, (GLint*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -431,6 +603,8 @@ void glUniform2iv(GLint location, GLsizei count, const GLint *value)
 }
 ASYNC_GL_FUNCTION_4(EM_FUNC_SIG_VIFFF, void, glUniform3f, GLint, GLfloat, GLfloat, GLfloat);
 
+STAGED_GL_FUNCTION_3(glUniform3fv, GLint, GLsizei, const GLfloat *);
+
 void glUniform3fv(GLint location, GLsizei count, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -439,6 +613,12 @@ void glUniform3fv(GLint location, GLsizei count, const GLfloat *value)
   else
   {
     size_t sz = 3*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform3fv, 0, location, count, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -456,6 +636,8 @@ void glUniform3fv(GLint location, GLsizei count, const GLfloat *value)
 
 ASYNC_GL_FUNCTION_4(EM_FUNC_SIG_VIIII, void, glUniform3i, GLint, GLint, GLint, GLint);
 
+STAGED_GL_FUNCTION_3(glUniform3iv, GLint, GLsizei, const GLint *);
+
 void glUniform3iv(GLint location, GLsizei count, const GLint *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -464,6 +646,12 @@ void glUniform3iv(GLint location, GLsizei count, const GLint *value)
   else
   {
     size_t sz = 3*sizeof(GLint)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform3iv, 0, location, count, (GLint*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -480,6 +668,8 @@ void glUniform3iv(GLint location, GLsizei count, const GLint *value)
 }
 ASYNC_GL_FUNCTION_5(EM_FUNC_SIG_VIFFFF, void, glUniform4f, GLint, GLfloat, GLfloat, GLfloat, GLfloat);
 
+STAGED_GL_FUNCTION_3(glUniform4fv, GLint, GLsizei, const GLfloat *);
+
 void glUniform4fv(GLint location, GLsizei count, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -488,6 +678,12 @@ void glUniform4fv(GLint location, GLsizei count, const GLfloat *value)
   else
   {
     size_t sz = 4*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform4fv, 0, location, count, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -505,6 +701,8 @@ void glUniform4fv(GLint location, GLsizei count, const GLfloat *value)
 
 ASYNC_GL_FUNCTION_5(EM_FUNC_SIG_VIIIII, void, glUniform4i, GLint, GLint, GLint, GLint, GLint);
 
+STAGED_GL_FUNCTION_3(glUniform4iv, GLint, GLsizei, const GLint *);
+
 void glUniform4iv(GLint location, GLsizei count, const GLint *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -513,6 +711,12 @@ void glUniform4iv(GLint location, GLsizei count, const GLint *value)
   else
   {
     size_t sz = 4*sizeof(GLint)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIII, &staged_glUniform4iv, 0, location, count, (GLint*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -528,6 +732,8 @@ void glUniform4iv(GLint location, GLsizei count, const GLint *value)
   }
 }
 
+STAGED_GL_FUNCTION_4(glUniformMatrix2fv, GLint, GLsizei, GLboolean, const GLfloat *);
+
 void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -536,6 +742,12 @@ void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, cons
   else
   {
     size_t sz = 2*2*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIII, &staged_glUniformMatrix2fv, 0, location, count, transpose, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -551,6 +763,8 @@ void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, cons
   }
 }
 
+STAGED_GL_FUNCTION_4(glUniformMatrix3fv, GLint, GLsizei, GLboolean, const GLfloat *);
+
 void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -559,6 +773,12 @@ void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, cons
   else
   {
     size_t sz = 3*3*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIII, &staged_glUniformMatrix3fv, 0, location, count, transpose, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -574,6 +794,8 @@ void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, cons
   }
 }
 
+STAGED_GL_FUNCTION_4(glUniformMatrix4fv, GLint, GLsizei, GLboolean, const GLfloat *);
+
 void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
 {
   GL_FUNCTION_TRACE(__func__);
@@ -582,6 +804,12 @@ void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, cons
   else
   {
     size_t sz = 4*4*sizeof(GLfloat)*count;
+    void *staged = stage(value, sz);
+    if (staged)
+    {
+      emscripten_dispatch_to_thread(*(void**)(pthread_getspecific(currentActiveWebGLContext) + 4), EM_FUNC_SIG_VIIII, &staged_glUniformMatrix4fv, 0, location, count, transpose, (GLfloat*)staged);
+      return;
+    }
     if (sz < 256*1024) // run small buffer sizes asynchronously by copying - large buffers run synchronously
     {
       void *ptr = memdup(value, sz);
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// State that library_snapshot.js reads at startup, for -sSNAPSHOT. emcc fills it
+// in when it copies the snapshot into the wasm, so that the program can tell
+// that it is starting from a snapshot.
+
+#include <stdint.h>
+
+typedef struct snapshot_state {
+  // Whether memory holds a snapshot, rather than its initial contents.
+  uint32_t restored;
+  // The files in the snapshot, which are stored after the end of the heap.
+  uint8_t* files;
+} snapshot_state;
+
+static snapshot_state state;
+
+snapshot_state* _emscripten_snapshot_state(void) {
+  return &state;
+}
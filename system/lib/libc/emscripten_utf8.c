@@ -0,0 +1,219 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// UTF-8 <-> UTF-16 transcoding for UTF8ToString() and stringToUTF8() in
+// runtime_strings.js, used when building with -sWASM_STRING_CONVERSION. JS
+// strings are made of UTF-16 code units, which JS exchanges with these
+// functions through a per-thread scratch buffer.
+
+#include <stdint.h>
+#include <string.h>
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+// Matches UTF_SCRATCH_UNITS in runtime_strings.js.
+#define SCRATCH_UNITS 4096
+
+typedef struct utf_scratch {
+  // The number of UTF-8 bytes that were read or written.
+  uint32_t bytes;
+  // The number of UTF-16 code units that were written or read.
+  uint32_t units;
+  // Whether decoding reached the end of the string.
+  uint32_t done;
+  uint32_t padding;
+  uint16_t data[SCRATCH_UNITS];
+} utf_scratch;
+
+static _Thread_local utf_scratch scratch;
+
+utf_scratch* _emscripten_utf_scratch(void) {
+  return &scratch;
+}
+
+// Decodes the UTF-8 string at src, which ends at a null byte or after
+// max_bytes, into scratch.data. Stops early when scratch.data is full, in
+// which case scratch.done is 0 and decoding continues at src + scratch.bytes.
+// Invalid sequences decode to U+FFFD, like they do in TextDecoder.
+utf_scratch* _emscripten_utf8_decode(const uint8_t* src, size_t max_bytes) {
+  const uint8_t* p = src;
+  uintptr_t end = max_bytes > UINTPTR_MAX - (uintptr_t)src ? UINTPTR_MAX : (uintptr_t)src + max_bytes;
+  uint16_t* out = scratch.data;
+  // Leave room for a surrogate pair.
+  uint16_t* out_end = scratch.data + SCRATCH_UNITS - 1;
+  scratch.done = 0;
+  while (out < out_end) {
+    // Copy runs of ASCII characters a block at a time. The loads are aligned,
+    // so they never cross into a page after the end of the string.
+#ifdef __wasm_simd128__
+    while (((uintptr_t)p & 15) == 0 && end - (uintptr_t)p >= 16 && out_end - out >= 16) {
+      v128_t v = wasm_v128_load(p);
+      if (wasm_i8x16_bitmask(v) | wasm_i8x16_bitmask(wasm_i8x16_eq(v, wasm_i8x16_splat(0)))) {
+        break;
+      }
+      wasm_v128_store(out, wasm_u16x8_extend_low_u8x16(v));
+      wasm_v128_store(out + 8, wasm_u16x8_extend_high_u8x16(v));
+      p += 16;
+      out += 16;
+    }
+#else
+    while (((uintptr_t)p & 7) == 0 && end - (uintptr_t)p >= 8 && out_end - out >= 8) {
+      uint64_t w;
+      memcpy(&w, p, sizeof(w));
+      // Stop at bytes that are zero or have their high bit set.
+      if ((w | (w - 0x0101010101010101ull)) & 0x8080808080808080ull) {
+        break;
+      }
+      for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(w >> (i * 8));
+      }
+      p += 8;
+      out += 8;
+    }
+#endif
+
+    if ((uintptr_t)p >= end || !*p) {
+      scratch.done = 1;
+      break;
+    }
+    uint32_t c = *p++;
+    if (c < 0x80) {
+      *out++ = c;
+      continue;
+    }
+
+    // See the UTF-8 decoder in the WHATWG Encoding Standard.
+    uint32_t needed;
+    uint32_t lower = 0x80;
+    uint32_t upper = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+      needed = 1;
+      c &= 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+      if (c == 0xE0) {
+        lower = 0xA0;
+      } else if (c == 0xED) {
+        upper = 0x9F;
+      }
+      needed = 2;
+      c &= 0xF;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+      if (c == 0xF0) {
+        lower = 0x90;
+      } else if (c == 0xF4) {
+        upper = 0x8F;
+      }
+      needed = 3;
+      c &= 0x7;
+    } else {
+      *out++ = 0xFFFD;
+      continue;
+    }
+    for (; needed; needed--) {
+      if ((uintptr_t)p >= end || *p < lower || *p > upper) {
+        break;
+      }
+      c = (c << 6) | (*p++ & 0x3F);
+      lower = 0x80;
+      upper = 0xBF;
+    }
+    if (needed) {
+      // The byte that broke the sequence is decoded on its own.
+      *out++ = 0xFFFD;
+    } else if (c >= 0x10000) {
+      c -= 0x10000;
+      *out++ = 0xD800 | (c >> 10);
+      *out++ = 0xDC00 | (c & 0x3FF);
+    } else {
+      *out++ = c;
+    }
+  }
+  scratch.bytes = p - src;
+  scratch.units = out - scratch.data;
+  return &scratch;
+}
+
+// Encodes the first units code units of scratch.data to UTF-8 at dst, writing
+// at most max_bytes bytes and no null terminator. Characters that don't fit
+// are not written, and scratch.units is set to the number of code units that
+// were. Unpaired surrogates encode to U+FFFD, like they do in TextEncoder.
+// Returns the number of bytes written.
+size_t _emscripten_utf8_encode(uint8_t* dst, size_t max_bytes, size_t units) {
+  const uint16_t* in = scratch.data;
+  const uint16_t* in_end = scratch.data + units;
+  uint8_t* out = dst;
+  uint8_t* out_end = dst + max_bytes;
+  while (in < in_end) {
+#ifdef __wasm_simd128__
+    while (in_end - in >= 16 && out_end - out >= 16) {
+      v128_t a = wasm_v128_load(in);
+      v128_t b = wasm_v128_load(in + 8);
+      if (wasm_v128_any_true(wasm_v128_and(wasm_v128_or(a, b), wasm_i16x8_splat(0xFF80)))) {
+        break;
+      }
+      wasm_v128_store(out, wasm_u8x16_narrow_i16x8(a, b));
+      in += 16;
+      out += 16;
+    }
+#else
+    while (in_end - in >= 4 && out_end - out >= 4) {
+      uint64_t w;
+      memcpy(&w, in, sizeof(w));
+      if (w & 0xFF80FF80FF80FF80ull) {
+        break;
+      }
+      for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(w >> (i * 16));
+      }
+      in += 4;
+      out += 4;
+    }
+#endif
+    if (in == in_end) {
+      break;
+    }
+
+    const uint16_t* start = in;
+    uint32_t c = *in++;
+    if (c >= 0xD800 && c <= 0xDFFF) {
+      if (c <= 0xDBFF && in < in_end && *in >= 0xDC00 && *in <= 0xDFFF) {
+        c = 0x10000 + ((c & 0x3FF) << 10) + (*in++ & 0x3FF);
+      } else {
+        c = 0xFFFD;
+      }
+    }
+    size_t length = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+    if ((size_t)(out_end - out) < length) {
+      in = start;
+      break;
+    }
+    switch (length) {
+      case 1:
+        *out++ = c;
+        break;
+      case 2:
+        *out++ = 0xC0 | (c >> 6);
+        *out++ = 0x80 | (c & 0x3F);
+        break;
+      case 3:
+        *out++ = 0xE0 | (c >> 12);
+        *out++ = 0x80 | ((c >> 6) & 0x3F);
+        *out++ = 0x80 | (c & 0x3F);
+        break;
+      default:
+        *out++ = 0xF0 | (c >> 18);
+        *out++ = 0x80 | ((c >> 12) & 0x3F);
+        *out++ = 0x80 | ((c >> 6) & 0x3F);
+        *out++ = 0x80 | (c & 0x3F);
+        break;
+    }
+  }
+  scratch.bytes = out - dst;
+  scratch.units = in - scratch.data;
+  return out - dst;
+}
@@ -76,6 +76,10 @@ struct pthread {
 	void *stdio_locks;
 	uintptr_t canary_at_end;
 	void **dtv_copy;
+#ifdef __EMSCRIPTEN__
+	// Timeline event buffer of this thread, see emscripten_thread_timeline.c.
+	struct thread_timeline *timeline;
+#endif
 };
 
 struct __timer {
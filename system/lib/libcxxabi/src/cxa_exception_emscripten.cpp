@@ -0,0 +1,197 @@
+//===------------------- cxa_exception_emscripten.cpp ---------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+//  This file implements the catch clause matching of emscripten-style
+//  exception handling (see src/library_exceptions.js).
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "abort_message.h"
+#include "cxa_exception.h"
+#include "private_typeinfo.h"
+
+// Landing pads that are lowered by the emscripten EH pass call
+// __cxa_find_matching_catch_N with the N - 2 types of their catch clauses
+// (0 for a catch-all clause). They return a catch info (see CatchInfo in
+// library_exceptions.js), and set tempRet0 to the type of the selected clause.
+// Landing pads with more clauses than the ones below are handled by the JS
+// version of __cxa_find_matching_catch.
+
+extern "C" {
+// Defined in library_exceptions.js and library.js.
+void* _emscripten_get_exception_last(void);
+void setTempRet0(uint32_t value);
+int __cxa_can_catch(__cxxabiv1::__shim_type_info* catchType,
+                    __cxxabiv1::__shim_type_info* excpType, void** thrown);
+}
+
+namespace __cxxabiv1 {
+
+namespace {
+
+// Mirrors CatchInfo in library_exceptions.js.
+struct catch_info {
+  void* base_ptr;
+  void* adjusted_ptr;
+};
+
+// Whether a type can catch another, and how the thrown pointer has to be
+// adjusted, only depends on the two types when the thrown object is of class
+// type: the exception object is then a complete object of the thrown type. For
+// thrown pointers the adjustment depends on the object that is pointed to, so
+// those are not cached.
+enum match_result : uint8_t { MATCH_UNKNOWN, MATCH_NONE, MATCH_FOUND, MATCH_UNCACHEABLE };
+
+struct match_cache_entry {
+  const __shim_type_info* thrown_type;
+  const __shim_type_info* catch_type;
+  match_result result;
+  ptrdiff_t adjustment;
+};
+
+const size_t MATCH_CACHE_SIZE = 64;
+
+thread_local match_cache_entry match_cache[MATCH_CACHE_SIZE];
+
+match_cache_entry* get_cache_entry(const __shim_type_info* thrown_type,
+                                   const __shim_type_info* catch_type) {
+  uintptr_t hash = reinterpret_cast<uintptr_t>(thrown_type) * 31 +
+                   reinterpret_cast<uintptr_t>(catch_type);
+  return &match_cache[(hash >> 2) % MATCH_CACHE_SIZE];
+}
+
+bool can_catch(__shim_type_info* catch_type, __shim_type_info* thrown_type,
+               void** adjusted_ptr) {
+  match_cache_entry* entry = get_cache_entry(thrown_type, catch_type);
+  if (entry->thrown_type != thrown_type || entry->catch_type != catch_type) {
+    entry->thrown_type = thrown_type;
+    entry->catch_type = catch_type;
+    entry->result = MATCH_UNKNOWN;
+  }
+  switch (entry->result) {
+    case MATCH_NONE:
+      return false;
+    case MATCH_FOUND:
+      *adjusted_ptr = static_cast<char*>(*adjusted_ptr) + entry->adjustment;
+      return true;
+    case MATCH_UNCACHEABLE:
+      return __cxa_can_catch(catch_type, thrown_type, adjusted_ptr);
+    case MATCH_UNKNOWN:
+      break;
+  }
+  if (!dynamic_cast<__class_type_info*>(thrown_type)) {
+    entry->result = MATCH_UNCACHEABLE;
+    return __cxa_can_catch(catch_type, thrown_type, adjusted_ptr);
+  }
+  char* original = static_cast<char*>(*adjusted_ptr);
+  if (!__cxa_can_catch(catch_type, thrown_type, adjusted_ptr)) {
+    entry->result = MATCH_NONE;
+    return false;
+  }
+  entry->result = MATCH_FOUND;
+  entry->adjustment = static_cast<char*>(*adjusted_ptr) - original;
+  return true;
+}
+
+void* find_matching_catch(__shim_type_info* const* catch_types,
+                          size_t num_catch_types) {
+  void* thrown = _emscripten_get_exception_last();
+  if (!thrown) {
+    // Just pass through the null pointer.
+    setTempRet0(0);
+    return nullptr;
+  }
+  catch_info* info = static_cast<catch_info*>(malloc(sizeof(catch_info)));
+  if (!info) {
+    abort_message("failed to allocate the catch info of an exception");
+  }
+  info->base_ptr = thrown;
+  info->adjusted_ptr = thrown;
+  __cxa_exception* header = static_cast<__cxa_exception*>(thrown) - 1;
+  __shim_type_info* thrown_type =
+      static_cast<__shim_type_info*>(header->exceptionType);
+  if (!thrown_type) {
+    // Just pass through the thrown pointer.
+    setTempRet0(0);
+    return info;
+  }
+  for (size_t i = 0; i < num_catch_types; i++) {
+    __shim_type_info* catch_type = catch_types[i];
+    if (!catch_type || catch_type == thrown_type) {
+      // A catch-all clause, or exactly the thrown type.
+      break;
+    }
+    if (can_catch(catch_type, thrown_type, &info->adjusted_ptr)) {
+      setTempRet0(reinterpret_cast<uintptr_t>(catch_type));
+      return info;
+    }
+  }
+  setTempRet0(reinterpret_cast<uintptr_t>(thrown_type));
+  return info;
+}
+
+} // namespace
+
+} // __cxxabiv1
+
+using __cxxabiv1::__shim_type_info;
+using __cxxabiv1::find_matching_catch;
+
+extern "C" {
+
+void* __cxa_find_matching_catch_2() {
+  return find_matching_catch(nullptr, 0);
+}
+
+void* __cxa_find_matching_catch_3(__shim_type_info* t0) {
+  __shim_type_info* types[] = {t0};
+  return find_matching_catch(types, 1);
+}
+
+void* __cxa_find_matching_catch_4(__shim_type_info* t0, __shim_type_info* t1) {
+  __shim_type_info* types[] = {t0, t1};
+  return find_matching_catch(types, 2);
+}
+
+void* __cxa_find_matching_catch_5(__shim_type_info* t0, __shim_type_info* t1,
+                                  __shim_type_info* t2) {
+  __shim_type_info* types[] = {t0, t1, t2};
+  return find_matching_catch(types, 3);
+}
+
+void* __cxa_find_matching_catch_6(__shim_type_info* t0, __shim_type_info* t1,
+                                  __shim_type_info* t2, __shim_type_info* t3) {
+  __shim_type_info* types[] = {t0, t1, t2, t3};
+  return find_matching_catch(types, 4);
+}
+
+void* __cxa_find_matching_catch_7(__shim_type_info* t0, __shim_type_info* t1,
+                                  __shim_type_info* t2, __shim_type_info* t3,
+                                  __shim_type_info* t4) {
+  __shim_type_info* types[] = {t0, t1, t2, t3, t4};
+  return find_matching_catch(types, 5);
+}
+
+void* __cxa_find_matching_catch_8(__shim_type_info* t0, __shim_type_info* t1,
+                                  __shim_type_info* t2, __shim_type_info* t3,
+                                  __shim_type_info* t4, __shim_type_info* t5) {
+  __shim_type_info* types[] = {t0, t1, t2, t3, t4, t5};
+  return find_matching_catch(types, 6);
+}
+
+void* __cxa_find_matching_catch_9(__shim_type_info* t0, __shim_type_info* t1,
+                                  __shim_type_info* t2, __shim_type_info* t3,
+                                  __shim_type_info* t4, __shim_type_info* t5,
+                                  __shim_type_info* t6) {
+  __shim_type_info* types[] = {t0, t1, t2, t3, t4, t5, t6};
+  return find_matching_catch(types, 7);
+}
+
+} // extern "C"
@@ -0,0 +1,431 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Work-stealing task scheduler. See emscripten/task.h.
+//
+// Each worker owns a fixed-size Chase-Lev deque ("Dynamic Circular
+// Work-Stealing Deque", Chase and Lev, SPAA 2005, with the memory orderings
+// from Le et al., PPoPP 2013). The thread that starts the scheduler gets a
+// deque too. Other threads push their tasks onto a mutex-protected injection
+// queue that workers check after failing to steal.
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <emscripten/task.h>
+#include <emscripten/threading.h>
+
+// Must be a power of two. When a deque is full the task runs immediately.
+#define DEQUE_SIZE 1024
+
+// How many times an idle worker looks for work before going to sleep.
+#define SPIN_ROUNDS 64
+
+typedef struct task {
+  em_arg_callback_func func;
+  void* arg;
+  em_task_group* group;
+} task;
+
+// Slots are read by thieves while the owner may be writing them; such a read
+// is always followed by a failing CAS on |top|, but the fields are still
+// atomic so that the race is well defined.
+typedef struct slot {
+  _Atomic(em_arg_callback_func) func;
+  _Atomic(void*) arg;
+  _Atomic(em_task_group*) group;
+} slot;
+
+typedef struct deque {
+  _Atomic long top;
+  // Keep thieves (top) and the owner (bottom) on separate cache lines.
+  char padding[60];
+  _Atomic long bottom;
+  slot slots[DEQUE_SIZE];
+} deque;
+
+typedef struct worker {
+  deque queue;
+  pthread_t thread;
+} worker;
+
+static struct {
+  pthread_mutex_t init_lock;
+  _Atomic bool running;
+  _Atomic bool stop;
+  // workers[0] belongs to the thread that started the scheduler; the rest
+  // have their own thread.
+  worker* workers;
+  int num_deques;
+  int num_threads;
+  // Idle workers sleep on |epoch|, which is bumped to wake them.
+  _Atomic uint32_t epoch;
+  _Atomic int sleepers;
+  // Tasks spawned by threads without a deque.
+  pthread_mutex_t inject_lock;
+  task* inject;
+  int inject_head;
+  int inject_tail;
+  int inject_capacity;
+  _Atomic int inject_count;
+} sched = {
+  .init_lock = PTHREAD_MUTEX_INITIALIZER,
+  .inject_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static _Thread_local deque* current_deque;
+static _Thread_local uint32_t rng_state;
+
+static void slot_store(slot* s, const task* t) {
+  atomic_store_explicit(&s->func, t->func, memory_order_relaxed);
+  atomic_store_explicit(&s->arg, t->arg, memory_order_relaxed);
+  atomic_store_explicit(&s->group, t->group, memory_order_relaxed);
+}
+
+static void slot_load(slot* s, task* t) {
+  t->func = atomic_load_explicit(&s->func, memory_order_relaxed);
+  t->arg = atomic_load_explicit(&s->arg, memory_order_relaxed);
+  t->group = atomic_load_explicit(&s->group, memory_order_relaxed);
+}
+
+// Owner only. Returns false if the deque is full.
+static bool deque_push(deque* q, const task* t) {
+  long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+  long top = atomic_load_explicit(&q->top, memory_order_acquire);
+  if (b - top >= DEQUE_SIZE) {
+    return false;
+  }
+  slot_store(&q->slots[b & (DEQUE_SIZE - 1)], t);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+  return true;
+}
+
+// Owner only. Takes the most recently pushed task.
+static bool deque_pop(deque* q, task* t) {
+  long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  long top = atomic_load_explicit(&q->top, memory_order_relaxed);
+  if (top > b) {
+    // Empty.
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return false;
+  }
+  slot_load(&q->slots[b & (DEQUE_SIZE - 1)], t);
+  if (top == b) {
+    // Last task: race against thieves for it.
+    bool won = atomic_compare_exchange_strong_explicit(
+      &q->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+// Any thread. Takes the oldest task.
+static bool deque_steal(deque* q, task* t) {
+  long top = atomic_load_explicit(&q->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+  if (top >= b) {
+    return false;
+  }
+  slot_load(&q->slots[top & (DEQUE_SIZE - 1)], t);
+  return atomic_compare_exchange_strong_explicit(
+    &q->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+static bool deque_empty(deque* q) {
+  return atomic_load(&q->top) >= atomic_load(&q->bottom);
+}
+
+static void inject_push(const task* t) {
+  pthread_mutex_lock(&sched.inject_lock);
+  if (sched.inject_tail == sched.inject_capacity) {
+    if (sched.inject_head > 0) {
+      memmove(sched.inject,
+              sched.inject + sched.inject_head,
+              (sched.inject_tail - sched.inject_head) * sizeof(task));
+      sched.inject_tail -= sched.inject_head;
+      sched.inject_head = 0;
+    } else {
+      sched.inject_capacity = sched.inject_capacity ? sched.inject_capacity * 2 : 64;
+      sched.inject = realloc(sched.inject, sched.inject_capacity * sizeof(task));
+      assert(sched.inject);
+    }
+  }
+  sched.inject[sched.inject_tail++] = *t;
+  atomic_fetch_add(&sched.inject_count, 1);
+  pthread_mutex_unlock(&sched.inject_lock);
+}
+
+static bool inject_pop(task* t) {
+  if (!atomic_load(&sched.inject_count)) {
+    return false;
+  }
+  bool found = false;
+  pthread_mutex_lock(&sched.inject_lock);
+  if (sched.inject_head < sched.inject_tail) {
+    *t = sched.inject[sched.inject_head++];
+    if (sched.inject_head == sched.inject_tail) {
+      sched.inject_head = sched.inject_tail = 0;
+    }
+    atomic_fetch_sub(&sched.inject_count, 1);
+    found = true;
+  }
+  pthread_mutex_unlock(&sched.inject_lock);
+  return found;
+}
+
+static uint32_t next_random() {
+  // xorshift32; the seed only needs to differ between threads.
+  uint32_t x = rng_state;
+  if (!x) {
+    x = (uint32_t)(uintptr_t)&rng_state | 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rng_state = x;
+  return x;
+}
+
+static bool find_task(task* t) {
+  if (current_deque && deque_pop(current_deque, t)) {
+    return true;
+  }
+  // Steal, starting from a random victim so thieves spread out.
+  int n = sched.num_deques;
+  int start = next_random() % n;
+  for (int i = 0; i < n; i++) {
+    deque* victim = &sched.workers[(start + i) % n].queue;
+    if (victim != current_deque && deque_steal(victim, t)) {
+      return true;
+    }
+  }
+  return inject_pop(t);
+}
+
+static bool has_work() {
+  for (int i = 0; i < sched.num_deques; i++) {
+    if (!deque_empty(&sched.workers[i].queue)) {
+      return true;
+    }
+  }
+  return atomic_load(&sched.inject_count) > 0;
+}
+
+static void run_task(const task* t) {
+  t->func(t->arg);
+  if (t->group &&
+      __atomic_sub_fetch(&t->group->pending, 1, __ATOMIC_SEQ_CST) == 0) {
+    emscripten_futex_wake(&t->group->pending, INT_MAX);
+  }
+}
+
+static void wake_one_sleeper() {
+  if (atomic_load(&sched.sleepers)) {
+    atomic_fetch_add(&sched.epoch, 1);
+    emscripten_futex_wake(&sched.epoch, 1);
+  }
+}
+
+static void* worker_main(void* arg) {
+  current_deque = &((worker*)arg)->queue;
+  int idle_rounds = 0;
+  while (!atomic_load(&sched.stop)) {
+    task t;
+    if (find_task(&t)) {
+      run_task(&t);
+      idle_rounds = 0;
+      continue;
+    }
+    if (++idle_rounds < SPIN_ROUNDS) {
+      continue;
+    }
+    // Park. Registering as a sleeper before the final check for work means a
+    // task spawned after that check will see us and bump the epoch, so the
+    // wait below returns immediately.
+    uint32_t epoch = atomic_load(&sched.epoch);
+    atomic_fetch_add(&sched.sleepers, 1);
+    if (!has_work() && !atomic_load(&sched.stop)) {
+      emscripten_futex_wait(&sched.epoch, epoch, INFINITY);
+    }
+    atomic_fetch_sub(&sched.sleepers, 1);
+    idle_rounds = 0;
+  }
+  return NULL;
+}
+
+int emscripten_task_scheduler_init(int num_workers) {
+  pthread_mutex_lock(&sched.init_lock);
+  if (atomic_load(&sched.running)) {
+    pthread_mutex_unlock(&sched.init_lock);
+    return sched.num_threads;
+  }
+  if (num_workers <= 0) {
+    num_workers = emscripten_num_logical_cores() - 1;
+    if (num_workers < 0) {
+      num_workers = 0;
+    }
+  }
+  sched.workers = calloc(num_workers + 1, sizeof(worker));
+  assert(sched.workers);
+  atomic_store(&sched.stop, false);
+  // All deques exist before any worker starts stealing. If a thread fails to
+  // start, its deque just stays empty.
+  sched.num_deques = num_workers + 1;
+  sched.num_threads = 0;
+  current_deque = &sched.workers[0].queue;
+  for (int i = 1; i <= num_workers; i++) {
+    if (pthread_create(&sched.workers[i].thread, NULL, worker_main, &sched.workers[i])) {
+      break;
+    }
+    sched.num_threads++;
+  }
+  if (!sched.num_threads) {
+    sched.num_deques = 1;
+  }
+  atomic_store(&sched.running, true);
+  pthread_mutex_unlock(&sched.init_lock);
+  return sched.num_threads;
+}
+
+void emscripten_task_scheduler_shutdown(void) {
+  pthread_mutex_lock(&sched.init_lock);
+  if (!atomic_load(&sched.running)) {
+    pthread_mutex_unlock(&sched.init_lock);
+    return;
+  }
+  atomic_store(&sched.stop, true);
+  atomic_fetch_add(&sched.epoch, 1);
+  emscripten_futex_wake(&sched.epoch, INT_MAX);
+  for (int i = 1; i <= sched.num_threads; i++) {
+    pthread_join(sched.workers[i].thread, NULL);
+  }
+  assert(!has_work() && "tasks still pending at scheduler shutdown");
+  free(sched.workers);
+  sched.workers = NULL;
+  sched.num_deques = 0;
+  sched.num_threads = 0;
+  current_deque = NULL;
+  atomic_store(&sched.running, false);
+  pthread_mutex_unlock(&sched.init_lock);
+}
+
+int emscripten_task_scheduler_num_workers(void) {
+  return atomic_load(&sched.running) ? sched.num_threads : 0;
+}
+
+void emscripten_task_group_init(em_task_group* group) {
+  group->pending = 0;
+}
+
+void emscripten_task_spawn(em_task_group* group,
+                           em_arg_callback_func func,
+                           void* arg) {
+  if (!atomic_load(&sched.running)) {
+    emscripten_task_scheduler_init(0);
+  }
+  task t = {func, arg, group};
+  if (group) {
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_SEQ_CST);
+  }
+  if (sched.num_deques == 1) {
+    // No workers: nothing could run the task sooner than we can.
+    run_task(&t);
+    return;
+  }
+  if (current_deque) {
+    if (!deque_push(current_deque, &t)) {
+      run_task(&t);
+      return;
+    }
+  } else {
+    inject_push(&t);
+  }
+  wake_one_sleeper();
+}
+
+void emscripten_task_group_wait(em_task_group* group) {
+  int pending;
+  while ((pending = __atomic_load_n(&group->pending, __ATOMIC_SEQ_CST))) {
+    task t;
+    if (find_task(&t)) {
+      run_task(&t);
+      continue;
+    }
+    // The remaining tasks are running elsewhere. The last one to finish wakes
+    // us; the timeout lets us pick up tasks they spawn in the meantime.
+    emscripten_futex_wait(&group->pending, pending, 1);
+  }
+}
+
+typedef struct range_task {
+  em_task_range_func func;
+  void* arg;
+  int begin;
+  int end;
+  int grain;
+  em_task_group* group;
+} range_task;
+
+static void run_range(void* arg) {
+  range_task* r = arg;
+  // Hand the upper halves to other workers until what is left is small
+  // enough to run here.
+  while (r->end - r->begin > r->grain) {
+    int mid = r->begin + (r->end - r->begin) / 2;
+    range_task* upper = malloc(sizeof(range_task));
+    assert(upper);
+    *upper = *r;
+    upper->begin = mid;
+    emscripten_task_spawn(r->group, run_range, upper);
+    r->end = mid;
+  }
+  r->func(r->begin, r->end, r->arg);
+  free(r);
+}
+
+void emscripten_parallel_for(int begin,
+                             int end,
+                             int grain,
+                             em_task_range_func func,
+                             void* arg) {
+  if (end <= begin) {
+    return;
+  }
+  if (!atomic_load(&sched.running)) {
+    emscripten_task_scheduler_init(0);
+  }
+  if (grain <= 0) {
+    // About eight pieces per thread, so that stealing can even out the load.
+    grain = (end - begin) / (8 * sched.num_deques);
+    if (grain < 1) {
+      grain = 1;
+    }
+  }
+  if (end - begin <= grain) {
+    func(begin, end, arg);
+    return;
+  }
+  em_task_group group;
+  emscripten_task_group_init(&group);
+  range_task* r = malloc(sizeof(range_task));
+  assert(r);
+  *r = (range_task){func, arg, begin, end, grain, &group};
+  run_range(r);
+  emscripten_task_group_wait(&group);
+}
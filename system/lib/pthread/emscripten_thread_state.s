@@ -9,6 +9,9 @@ is_main_thread:
 .globaltype is_runtime_thread, i32
 is_runtime_thread:
 
+.globaltype supports_wait, i32
+supports_wait:
+
 .globl __pthread_self
 __pthread_self:
   .functype __pthread_self () -> (i32)
@@ -17,13 +20,15 @@ __pthread_self:
 
 .globl _emscripten_thread_init
 _emscripten_thread_init:
-  .functype _emscripten_thread_init (i32, i32, i32) -> ()
+  .functype _emscripten_thread_init (i32, i32, i32, i32) -> ()
   local.get 0
   global.set thread_id
   local.get 1
   global.set is_main_thread
   local.get 2
   global.set is_runtime_thread
+  local.get 3
+  global.set supports_wait
   end_function
 
 # Accessor for `__tls_base` symbol which is a wasm global an not directly
@@ -41,6 +46,14 @@ emscripten_is_main_runtime_thread:
   global.get is_runtime_thread
   end_function
 
+# Whether this thread can block in memory.atomic.wait32. Everything but the
+# main browser thread can.
+.globl _emscripten_thread_supports_atomics_wait
+_emscripten_thread_supports_atomics_wait:
+  .functype _emscripten_thread_supports_atomics_wait () -> (i32)
+  global.get supports_wait
+  end_function
+
 # Semantically the same as testing "!ENVIRONMENT_IS_WORKER" in JS
 .globl emscripten_is_main_browser_thread
 emscripten_is_main_browser_thread:
@@ -0,0 +1,342 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/threading.h>
+#include "pthread_impl.h"
+
+// Thread status and timeline recording.
+//
+// Each thread that records an event gets a thread_timeline, a single-producer
+// single-consumer ring buffer: the thread appends events at `head`, and
+// emscripten_thread_timeline_export() consumes them at `tail`. Timelines are
+// pushed onto a global list without locking; only the exporter removes them,
+// once their thread has exited and all of their events have been exported.
+
+#define DEFAULT_CAPACITY 16384
+
+#define EVENT_STATUS 0
+#define EVENT_BEGIN 1
+#define EVENT_END 2
+#define EVENT_MARK 3
+
+// Values of pthread::timeline other than a timeline.
+#define TIMELINE_CREATING ((thread_timeline*)1)
+#define TIMELINE_EXITED ((thread_timeline*)2)
+
+typedef struct timeline_event {
+  // emscripten_get_now(), which is synchronized across threads.
+  double time;
+  uint32_t type;
+  // An EM_THREAD_STATUS for EVENT_STATUS, otherwise the event name.
+  uintptr_t data;
+} timeline_event;
+
+typedef struct thread_timeline {
+  struct thread_timeline* next;
+  pid_t tid;
+  int is_main_thread;
+  // Owned by the thread.
+  int status;
+  _Atomic uint32_t head;
+  // Owned by the exporter.
+  _Atomic uint32_t tail;
+  int exported_status;
+  double exported_status_time;
+  // Set by the thread once it will no longer record events.
+  _Atomic int exited;
+  _Atomic uint32_t dropped;
+  uint32_t mask;
+  timeline_event events[];
+} thread_timeline;
+
+// The per-thread event capacity. Zero when not recording.
+static _Atomic uint32_t capacity;
+static thread_timeline* _Atomic timelines;
+static volatile int export_lock[1];
+
+extern void emscripten_conditional_set_current_thread_status_js(EM_THREAD_STATUS expectedStatus, EM_THREAD_STATUS newStatus);
+
+static thread_timeline* create_timeline(pthread_t self, uint32_t size) {
+  // malloc may wait on a futex, which records a status change.
+  self->timeline = TIMELINE_CREATING;
+  thread_timeline* t = malloc(sizeof(thread_timeline) + size * sizeof(timeline_event));
+  if (!t) {
+    // Do not try again on every event.
+    self->timeline = TIMELINE_EXITED;
+    return NULL;
+  }
+  t->tid = self->tid;
+  t->is_main_thread = self == emscripten_main_browser_thread_id();
+  t->status = EM_THREAD_STATUS_RUNNING;
+  t->head = 0;
+  t->tail = 0;
+  t->exported_status = EM_THREAD_STATUS_RUNNING;
+  t->exported_status_time = emscripten_get_now();
+  t->exited = 0;
+  t->dropped = 0;
+  t->mask = size - 1;
+  t->next = atomic_load(&timelines);
+  while (!atomic_compare_exchange_weak(&timelines, &t->next, t)) {
+  }
+  self->timeline = t;
+  return t;
+}
+
+static thread_timeline* get_timeline() {
+  pthread_t self = __pthread_self();
+  if (!self) {
+    return NULL;
+  }
+  thread_timeline* t = self->timeline;
+  if (t == TIMELINE_CREATING || t == TIMELINE_EXITED) {
+    return NULL;
+  }
+  if (!t) {
+    uint32_t size = atomic_load_explicit(&capacity, memory_order_relaxed);
+    return size ? create_timeline(self, size) : NULL;
+  }
+  return t;
+}
+
+static void append(thread_timeline* t, uint32_t type, uintptr_t data) {
+  uint32_t head = atomic_load_explicit(&t->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&t->tail, memory_order_acquire);
+  if (head - tail > t->mask) {
+    atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+    return;
+  }
+  timeline_event* e = &t->events[head & t->mask];
+  e->time = emscripten_get_now();
+  e->type = type;
+  e->data = data;
+  atomic_store_explicit(&t->head, head + 1, memory_order_release);
+}
+
+static void record(uint32_t type, uintptr_t data) {
+  if (!atomic_load_explicit(&capacity, memory_order_relaxed)) {
+    return;
+  }
+  thread_timeline* t = get_timeline();
+  if (t) {
+    append(t, type, data);
+  }
+}
+
+static void record_status(EM_THREAD_STATUS expectedStatus, EM_THREAD_STATUS newStatus) {
+  thread_timeline* t = get_timeline();
+  if (!t || t->status == newStatus || (expectedStatus != -1 && t->status != expectedStatus)) {
+    return;
+  }
+  t->status = newStatus;
+  append(t, EVENT_STATUS, newStatus);
+}
+
+static void set_status(EM_THREAD_STATUS expectedStatus, EM_THREAD_STATUS newStatus) {
+  if (atomic_load_explicit(&capacity, memory_order_relaxed)) {
+    record_status(expectedStatus, newStatus);
+  }
+  pthread_t self = __pthread_self();
+  if (!self) {
+    return;
+  }
+  if (newStatus == EM_THREAD_STATUS_FINISHED) {
+    // Called from _emscripten_thread_exit. Hand the timeline over to the
+    // exporter: after this the thread must not touch it anymore.
+    thread_timeline* t = self->timeline;
+    self->timeline = TIMELINE_EXITED;
+    if (t && t != TIMELINE_CREATING && t != TIMELINE_EXITED) {
+      atomic_store_explicit(&t->exited, 1, memory_order_release);
+    }
+  }
+  // The --threadprofiler status is kept in JS. Only call out to JS when it is
+  // enabled, which is the case when the thread has a profiler block.
+  if (self->profilerBlock) {
+    emscripten_conditional_set_current_thread_status_js(expectedStatus, newStatus);
+  }
+}
+
+void emscripten_set_current_thread_status(EM_THREAD_STATUS newStatus) {
+  set_status(-1, newStatus);
+}
+
+void emscripten_conditional_set_current_thread_status(EM_THREAD_STATUS expectedStatus, EM_THREAD_STATUS newStatus) {
+  set_status(expectedStatus, newStatus);
+}
+
+void emscripten_thread_timeline_start(int max_events_per_thread) {
+  uint32_t size = 1;
+  uint32_t wanted = max_events_per_thread > 0 ? max_events_per_thread : DEFAULT_CAPACITY;
+  while (size < wanted) {
+    size *= 2;
+  }
+  atomic_store(&capacity, size);
+}
+
+void emscripten_thread_timeline_stop(void) {
+  atomic_store(&capacity, 0);
+}
+
+void emscripten_thread_timeline_begin(const char* name) {
+  record(EVENT_BEGIN, (uintptr_t)name);
+}
+
+void emscripten_thread_timeline_end(void) {
+  record(EVENT_END, 0);
+}
+
+void emscripten_thread_timeline_mark(const char* name) {
+  record(EVENT_MARK, (uintptr_t)name);
+}
+
+static const char* status_name(int status) {
+  switch (status) {
+    case EM_THREAD_STATUS_RUNNING: return "running";
+    case EM_THREAD_STATUS_SLEEPING: return "sleeping";
+    case EM_THREAD_STATUS_WAITFUTEX: return "waiting for a futex";
+    case EM_THREAD_STATUS_WAITMUTEX: return "waiting for a mutex";
+    case EM_THREAD_STATUS_WAITPROXY: return "waiting for a proxied operation";
+    default: return "unknown";
+  }
+}
+
+static void write_string(FILE* f, const char* str) {
+  fputc('"', f);
+  for (; *str; str++) {
+    unsigned char c = *str;
+    if (c == '"' || c == '\\') {
+      fprintf(f, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+// Chrome trace events use microseconds. Each thread is shown as a process
+// with two tracks: its status (tid 1) and its scopes and marks (tid 2).
+static void write_event(FILE* f, thread_timeline* t, int* first, const char* name, const char* phase, double time, int tid) {
+  fprintf(f, "%s\n{\"name\":", *first ? "" : ",");
+  *first = 0;
+  write_string(f, name);
+  fprintf(f, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d", phase, time * 1000, t->tid, tid);
+}
+
+static void write_status_interval(FILE* f, thread_timeline* t, int* first, double end) {
+  write_event(f, t, first, status_name(t->exported_status), "X", t->exported_status_time, 1);
+  fprintf(f, ",\"dur\":%.3f}", (end - t->exported_status_time) * 1000);
+  t->exported_status_time = end;
+}
+
+static void write_timeline(FILE* f, thread_timeline* t, int* first, double now) {
+  char name[32];
+  if (t->is_main_thread) {
+    snprintf(name, sizeof(name), "Main thread");
+  } else {
+    snprintf(name, sizeof(name), "Thread %d", t->tid);
+  }
+  write_event(f, t, first, "process_name", "M", 0, 0);
+  fprintf(f, ",\"args\":{\"name\":");
+  write_string(f, name);
+  fprintf(f, "}}");
+  write_event(f, t, first, "thread_name", "M", 0, 1);
+  fprintf(f, ",\"args\":{\"name\":\"status\"}}");
+  write_event(f, t, first, "thread_name", "M", 0, 2);
+  fprintf(f, ",\"args\":{\"name\":\"scopes\"}}");
+
+  uint32_t head = atomic_load_explicit(&t->head, memory_order_acquire);
+  uint32_t tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+  for (; tail != head; tail++) {
+    timeline_event* e = &t->events[tail & t->mask];
+    switch (e->type) {
+      case EVENT_STATUS:
+        write_status_interval(f, t, first, e->time);
+        t->exported_status = e->data;
+        t->exported_status_time = e->time;
+        break;
+      case EVENT_BEGIN:
+        write_event(f, t, first, (const char*)e->data, "B", e->time, 2);
+        fputc('}', f);
+        break;
+      case EVENT_END:
+        write_event(f, t, first, "", "E", e->time, 2);
+        fputc('}', f);
+        break;
+      case EVENT_MARK:
+        write_event(f, t, first, (const char*)e->data, "i", e->time, 2);
+        fprintf(f, ",\"s\":\"t\"}");
+        break;
+    }
+  }
+  atomic_store_explicit(&t->tail, tail, memory_order_release);
+
+  // Close the status interval in progress. It continues in the next export
+  // unless the thread has exited.
+  if (t->exported_status != EM_THREAD_STATUS_FINISHED) {
+    write_status_interval(f, t, first, now);
+  }
+  uint32_t dropped = atomic_exchange_explicit(&t->dropped, 0, memory_order_relaxed);
+  if (dropped) {
+    write_event(f, t, first, "dropped events", "i", now, 2);
+    fprintf(f, ",\"s\":\"t\",\"args\":{\"count\":%u}}", dropped);
+  }
+}
+
+char* emscripten_thread_timeline_export(void) {
+  if (!atomic_load(&timelines)) {
+    return NULL;
+  }
+  __lock(export_lock);
+  char* buf = NULL;
+  size_t len = 0;
+  FILE* f = open_memstream(&buf, &len);
+  if (!f) {
+    __unlock(export_lock);
+    return NULL;
+  }
+  fprintf(f, "{\"traceEvents\":[");
+  int first = 1;
+  double now = emscripten_get_now();
+  thread_timeline* prev = NULL;
+  thread_timeline* t = atomic_load(&timelines);
+  while (t) {
+    // Check for exit before draining, so that no event recorded before the
+    // exit is missed.
+    int exited = atomic_load_explicit(&t->exited, memory_order_acquire);
+    write_timeline(f, t, &first, now);
+    thread_timeline* next = t->next;
+    if (exited) {
+      // Threads only ever push new timelines at the head of the list, so
+      // unlinking any other timeline does not race with them.
+      thread_timeline* expected = t;
+      if (prev || !atomic_compare_exchange_strong(&timelines, &expected, next)) {
+        if (!prev) {
+          // New timelines were pushed since we started.
+          prev = atomic_load(&timelines);
+          while (prev->next != t) {
+            prev = prev->next;
+          }
+        }
+        prev->next = next;
+      }
+      free(t);
+    } else {
+      prev = t;
+    }
+    t = next;
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  __unlock(export_lock);
+  return buf;
+}
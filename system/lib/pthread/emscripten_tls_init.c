@@ -21,13 +21,27 @@ extern void __wasm_init_tls(void *memory);
 
 extern int __dso_handle;
 
+#ifndef __PIC__
+// Defined in pthread_create.c. Returns the TLS block kept by the calling
+// thread's block when it was taken from the thread reuse cache, if any.
+extern void* _emscripten_thread_take_tls_block(size_t size);
+#endif
+
 void* emscripten_tls_init(void) {
   size_t tls_size = __builtin_wasm_tls_size();
   size_t tls_align = __builtin_wasm_tls_align();
   if (!tls_size) {
     return NULL;
   }
-  void *tls_block = emscripten_builtin_memalign(tls_align, tls_size);
+  void *tls_block = NULL;
+#ifndef __PIC__
+  // With dynamic linking each module has its own TLS block, so blocks are only
+  // reused in static builds.
+  tls_block = _emscripten_thread_take_tls_block(tls_size);
+#endif
+  if (!tls_block) {
+    tls_block = emscripten_builtin_memalign(tls_align, tls_size);
+  }
 #ifdef DEBUG_TLS
   printf("tls init: thread[%p] dso[%p] -> %p\n", pthread_self(), &__dso_handle, tls_block);
 #endif
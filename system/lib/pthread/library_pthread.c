@@ -83,6 +83,22 @@ int pthread_mutexattr_setprioceiling(pthread_mutexattr_t *attr, int prioceiling)
 
 static uint32_t dummyZeroAddress = 0;
 
+extern int _emscripten_main_thread_wait_async(volatile void* addr, uint32_t val, double timeout);
+
+// Set while the calling thread runs its queued calls.
+static thread_local bool thread_is_processing_queued_calls = false;
+
+// Waits on the main browser thread by suspending with Asyncify (see
+// MAIN_THREAD_ASYNC_WAIT). Returns 1 if that is not possible, otherwise the
+// result of the wait. Queued calls are run from the event loop while the main
+// thread is suspended, which cannot happen if it suspended in one of them.
+int _emscripten_main_thread_try_wait_async(volatile void* addr, uint32_t val, double timeout) {
+  if (thread_is_processing_queued_calls) {
+    return 1;
+  }
+  return _emscripten_main_thread_wait_async(addr, val, timeout);
+}
+
 void emscripten_thread_sleep(double msecs) {
   double now = emscripten_get_now();
   double target = now + msecs;
@@ -91,6 +107,17 @@ void emscripten_thread_sleep(double msecs) {
                           // thread is cancelled during the sleep.
   emscripten_current_thread_process_queued_calls();
 
+  if (emscripten_is_main_browser_thread()) {
+    emscripten_conditional_set_current_thread_status(
+      EM_THREAD_STATUS_RUNNING, EM_THREAD_STATUS_SLEEPING);
+    int ret = _emscripten_main_thread_try_wait_async(0, 0, msecs);
+    emscripten_conditional_set_current_thread_status(
+      EM_THREAD_STATUS_SLEEPING, EM_THREAD_STATUS_RUNNING);
+    if (ret != 1) {
+      return;
+    }
+  }
+
   // If we have less than this many msecs left to wait, busy spin that instead.
   const double minimumTimeSliceToSleep = 0.1;
 
@@ -560,8 +587,6 @@ void emscripten_current_thread_process_queued_calls() {
   //emscripten_current_thread_process_queued_calls(), ' + new Error().stack));
   // #endif
 
-  static thread_local bool thread_is_processing_queued_calls = false;
-
   // It is possible that when processing a queued call, the control flow leads back to calling this
   // function in a nested fashion! Therefore this scenario must explicitly be detected, and
   // processing the queue must be avoided if we are nesting, or otherwise the same queued calls
@@ -821,10 +846,6 @@ int _emscripten_call_on_thread(int forceAsync, pthread_t targetThread, EM_FUNC_S
   }
 }
 
-// Stores the memory address that the main thread is waiting on, if any. If
-// the main thread is waiting, we wake it up before waking up any workers.
-EMSCRIPTEN_KEEPALIVE void* _emscripten_main_thread_futex;
-
 void __emscripten_init_main_thread_js(void* tb);
 
 // See system/lib/README.md for static constructor ordering.
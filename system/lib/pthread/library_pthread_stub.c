@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include "pthread_impl.h"
 #include <emscripten/stack.h>
+#include <emscripten/task.h>
 #include <emscripten/threading.h>
 #include <emscripten/emscripten.h>
 
@@ -385,6 +386,39 @@ int sem_destroy(sem_t *sem) {
 
 void __wait(volatile int *addr, volatile int *waiters, int val, int priv) {}
 
+// Without threads, tasks run synchronously when spawned.
+int emscripten_task_scheduler_init(int num_workers) {
+  return 0;
+}
+
+void emscripten_task_scheduler_shutdown(void) {}
+
+int emscripten_task_scheduler_num_workers(void) {
+  return 0;
+}
+
+void emscripten_task_group_init(em_task_group* group) {
+  group->pending = 0;
+}
+
+void emscripten_task_spawn(em_task_group* group,
+                           em_arg_callback_func func,
+                           void* arg) {
+  func(arg);
+}
+
+void emscripten_task_group_wait(em_task_group* group) {}
+
+void emscripten_parallel_for(int begin,
+                             int end,
+                             int grain,
+                             em_task_range_func func,
+                             void* arg) {
+  if (begin < end) {
+    func(begin, end, arg);
+  }
+}
+
 static struct pthread __main_pthread;
 
 pthread_t __pthread_self(void) {
@@ -395,3 +429,18 @@ __attribute__((constructor))
 static void init_pthread_self(void) {
   __pthread_self()->locale = &libc.global_locale;
 }
+
+// The thread timeline is not available without threads.
+void emscripten_thread_timeline_start(int max_events_per_thread) {}
+
+void emscripten_thread_timeline_stop(void) {}
+
+void emscripten_thread_timeline_begin(const char* name) {}
+
+void emscripten_thread_timeline_end(void) {}
+
+void emscripten_thread_timeline_mark(const char* name) {}
+
+char* emscripten_thread_timeline_export(void) {
+  return NULL;
+}
@@ -20,7 +20,7 @@
 // See musl's pthread_create.c
 
 extern int __pthread_create_js(struct pthread *thread, const pthread_attr_t *attr, void *(*start_routine) (void *), void *arg);
-extern void _emscripten_thread_init(int, int, int);
+extern void _emscripten_thread_init(int, int, int, int);
 extern void __pthread_detached_exit();
 extern void* _emscripten_tls_base();
 extern int8_t __dso_handle;
@@ -62,6 +62,59 @@ static void init_file_lock(FILE *f) {
 // The main thread is tid 1, and the first created thread gets tid 2.
 static pid_t next_tid = 2;
 
+// The maximum number of exited thread blocks kept for reuse by the next
+// pthread_create. Set from JS at startup to the value of
+// -sPTHREAD_REUSE_CACHE. When non-zero, exiting threads also keep their tsd
+// array and TLS block, which then get reused along with the thread block.
+int _emscripten_thread_reuse_cache_size;
+
+// Thread blocks of exited threads, chained through their (otherwise unused)
+// `unused1` field.
+static struct pthread* free_threads;
+static int num_free_threads;
+static volatile int free_threads_lock[1];
+
+static struct pthread* get_free_thread() {
+  if (!_emscripten_thread_reuse_cache_size) {
+    return NULL;
+  }
+  __lock(free_threads_lock);
+  struct pthread* t = free_threads;
+  if (t) {
+    free_threads = t->unused1;
+    num_free_threads--;
+  }
+  __unlock(free_threads_lock);
+  return t;
+}
+
+// Called from JS on the main thread once a thread has been joined (or has
+// exited while detached) and its thread block is no longer referenced.
+void _emscripten_thread_free_data(struct pthread* t) {
+  if (_emscripten_thread_reuse_cache_size) {
+    __lock(free_threads_lock);
+    if (num_free_threads < _emscripten_thread_reuse_cache_size) {
+      t->unused1 = free_threads;
+      free_threads = t;
+      num_free_threads++;
+      t = NULL;
+    }
+    __unlock(free_threads_lock);
+    if (!t) {
+      return;
+    }
+  }
+  // These are only still allocated here when the thread exited while the
+  // reuse cache was enabled.
+  if (t->tsd) {
+    emscripten_builtin_free(t->tsd);
+  }
+  if (t->map_base) {
+    emscripten_builtin_free(t->map_base);
+  }
+  free(t);
+}
+
 int __pthread_create(pthread_t *restrict res, const pthread_attr_t *restrict attrp, void *(*entry)(void *), void *restrict arg) {
   // Note on LSAN: lsan intercepts/wraps calls to pthread_create so any
   // allocation we we do here should be considered leaks.
@@ -80,10 +133,23 @@ int __pthread_create(pthread_t *restrict res, const pthread_attr_t *restrict att
     libc.threaded = 1;
   }
 
-  // Allocate thread block (pthread_t structure).
-  struct pthread *new = malloc(sizeof(struct pthread));
+  // Allocate thread block (pthread_t structure), or take the block of a thread
+  // that has exited. A reused block keeps its tsd array and TLS block.
+  void **tsd = NULL;
+  unsigned char *tls_block = NULL;
+  size_t tls_size = 0;
+  struct pthread *new = get_free_thread();
+  if (new) {
+    tsd = new->tsd;
+    tls_block = new->map_base;
+    tls_size = new->map_size;
+  } else {
+    new = malloc(sizeof(struct pthread));
+  }
   // zero-initialize thread structure.
   memset(new, 0, sizeof(struct pthread));
+  new->map_base = tls_block;
+  new->map_size = tls_size;
 
   // The pthread struct has a field that points to itself - this is used as a
   // magic ID to detect whether the pthread_t structure is 'alive'.
@@ -96,16 +162,42 @@ int __pthread_create(pthread_t *restrict res, const pthread_attr_t *restrict att
   new->locale = &libc.global_locale;
 
   // Allocate memory for thread-local storage and initialize it to zero.
-  new->tsd = malloc(PTHREAD_KEYS_MAX * sizeof(void*));
+  new->tsd = tsd ? tsd : malloc(PTHREAD_KEYS_MAX * sizeof(void*));
   memset(new->tsd, 0, PTHREAD_KEYS_MAX * sizeof(void*));
 
   *res = new;
   return __pthread_create_js(new, attrp, entry, arg);
 }
 
+void* _emscripten_thread_take_tls_block(size_t size) {
+  struct pthread *self = __pthread_self();
+  void* tls_block = NULL;
+  if (self && self->map_base) {
+    if (self->map_size == size) {
+      tls_block = self->map_base;
+    } else {
+      emscripten_builtin_free(self->map_base);
+    }
+    self->map_base = NULL;
+    self->map_size = 0;
+  }
+  return tls_block;
+}
+
 static void free_tls_data() {
   void* tls_block = _emscripten_tls_base();
   if (tls_block) {
+#ifndef __PIC__
+    // Keep the block around for the next thread that reuses this thread
+    // block (see emscripten_tls_init). With dynamic linking each module has
+    // its own TLS block, so this is only done for static linking.
+    if (_emscripten_thread_reuse_cache_size) {
+      struct pthread *self = __pthread_self();
+      self->map_base = tls_block;
+      self->map_size = __builtin_wasm_tls_size();
+      return;
+    }
+#endif
 #ifdef DEBUG_TLS
     printf("tls free: thread[%p] dso[%p] <- %p\n", pthread_self(), &__dso_handle, tls_block);
 #endif
@@ -136,13 +228,19 @@ void _emscripten_thread_exit(void* result) {
     return;
   }
 
+  // This is the last status change recorded for this thread.
+  emscripten_set_current_thread_status(EM_THREAD_STATUS_FINISHED);
+
   // We have the call the buildin free here since lsan handling for this thread
-  // gets shut down during __pthread_tsd_run_dtors.
-  emscripten_builtin_free(self->tsd);
-  self->tsd = NULL;
+  // gets shut down during __pthread_tsd_run_dtors. When the thread block may
+  // be reused, _emscripten_thread_free_data takes care of this instead.
+  if (!_emscripten_thread_reuse_cache_size) {
+    emscripten_builtin_free(self->tsd);
+    self->tsd = NULL;
+  }
 
   // Not hosting a pthread anymore in this worker set __pthread_self to NULL
-  _emscripten_thread_init(0, 0, 0);
+  _emscripten_thread_init(0, 0, 0, 1);
 
   // Cache deteched state since once we set threadStatus to 1, the `self` struct
   // could be freed and reused.
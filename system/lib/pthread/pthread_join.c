@@ -7,10 +7,26 @@
 
 #include "pthread_impl.h"
 #include <pthread.h>
+#include <emscripten/threading.h>
 
-extern int __pthread_join_js(pthread_t thread, void **retval);
+extern int __pthread_join_js(pthread_t thread, void **retval, int block);
 int __pthread_join(pthread_t thread, void **retval) {
-  return __pthread_join_js(thread, retval);
+  int ret = __pthread_join_js(thread, retval, 1);
+  // Wait from wasm rather than from JS, so that on the main browser thread
+  // emscripten_futex_wait() can suspend with MAIN_THREAD_ASYNC_WAIT instead of
+  // spinning. A busy-wait there already runs queued calls while it spins.
+  while (ret == EBUSY) {
+    pthread_testcancel();
+    if (emscripten_is_main_runtime_thread()) {
+      emscripten_main_thread_process_queued_calls();
+    }
+    int status = thread->threadStatus;
+    if (status != 1) {
+      emscripten_futex_wait(&thread->threadStatus, status, 100);
+    }
+    ret = __pthread_join_js(thread, retval, 0);
+  }
+  return ret;
 }
 weak_alias(__pthread_join, emscripten_builtin_pthread_join);
 weak_alias(__pthread_join, pthread_join);
@@ -0,0 +1,35 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the backend interface of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include "file.h"
+
+namespace wasmfs {
+
+// A backend provides the storage for a tree of files. A directory created by
+// a backend is mounted into the file system with wasmfs_create_directory(),
+// and every file and directory created beneath it belongs to the same
+// backend (see Directory::insertDataFile and Directory::insertDirectory).
+class Backend {
+public:
+  // Creates the root directory of a new tree of this backend.
+  virtual std::shared_ptr<Directory> createDirectory(mode_t mode) = 0;
+
+  virtual ~Backend() = default;
+};
+
+// The default backend, which stores files in linear memory.
+backend_t getMemoryBackend();
+
+// Backends live as long as the program, so the file system keeps ownership
+// of them here.
+backend_t addBackend(std::unique_ptr<Backend> backend);
+
+} // namespace wasmfs
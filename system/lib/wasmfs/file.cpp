@@ -0,0 +1,94 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the file object of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "file.h"
+
+namespace wasmfs {
+
+//
+// File
+//
+void File::Handle::setParent(std::shared_ptr<File> parent) {
+  if (parent) {
+    file->parent = parent->cast<Directory>();
+  } else {
+    file->parent.reset();
+  }
+}
+
+mode_t getFileTypeBits(File& file) {
+  switch (file.kind) {
+    case File::DataFileKind:
+      return static_cast<DataFile&>(file).isCharacterDevice() ? S_IFCHR
+                                                              : S_IFREG;
+    case File::DirectoryKind:
+      return S_IFDIR;
+    default:
+      return 0;
+  }
+}
+
+//
+// Directory
+//
+template<class T>
+std::shared_ptr<T> Directory::Handle::adopt(std::shared_ptr<T> child) {
+  // Parent directories are always locked before their children, so taking
+  // the child's lock here cannot deadlock.
+  if (child) {
+    child->locked().setParent(file);
+  }
+  return child;
+}
+
+std::shared_ptr<File> Directory::Handle::getEntry(const std::string& pathName) {
+  return getDir()->getChild(pathName);
+}
+
+bool Directory::Handle::setEntry(const std::string& pathName,
+                                 std::shared_ptr<File> inserted) {
+  if (!getDir()->insertChild(pathName, inserted)) {
+    return false;
+  }
+  adopt(inserted);
+  mtime() = time(NULL);
+  return true;
+}
+
+std::shared_ptr<DataFile>
+Directory::Handle::insertDataFile(const std::string& pathName, mode_t mode) {
+  auto child = adopt(getDir()->insertDataFile(pathName, mode));
+  if (child) {
+    mtime() = time(NULL);
+  }
+  return child;
+}
+
+std::shared_ptr<Directory>
+Directory::Handle::insertDirectory(const std::string& pathName, mode_t mode) {
+  auto child = adopt(getDir()->insertDirectory(pathName, mode));
+  if (child) {
+    mtime() = time(NULL);
+  }
+  return child;
+}
+
+__wasi_errno_t Directory::Handle::unlinkEntry(const std::string& pathName) {
+  auto result = getDir()->removeChild(pathName);
+  if (result == __WASI_ERRNO_SUCCESS) {
+    mtime() = time(NULL);
+  }
+  return result;
+}
+
+std::vector<Directory::Entry> Directory::Handle::getEntries() {
+  return getDir()->getEntries();
+}
+
+} // namespace wasmfs
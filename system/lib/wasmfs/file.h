@@ -0,0 +1,239 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the file object of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include <assert.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <vector>
+#include <wasi/api.h>
+
+namespace wasmfs {
+
+class Backend;
+class Directory;
+
+// Backends are owned by the file system and live for the rest of the program.
+using backend_t = Backend*;
+
+// Every file in the file system has its own lock, so that threads operating
+// on different files never contend with each other. To avoid deadlocks, locks
+// are always acquired in the following order:
+//   FileTable -> OpenFileState -> Directory (parent before child) -> File
+// and the FileTable lock is never held while a file is locked.
+class File : public std::enable_shared_from_this<File> {
+public:
+  enum FileKind { UnknownKind = 0, DataFileKind = 1, DirectoryKind = 2 };
+
+  const FileKind kind;
+
+  template<class T> bool is() const {
+    static_assert(std::is_base_of<File, T>::value,
+                  "File is not a base of destination type T");
+    return int(kind) == int(T::expectedKind);
+  }
+
+  template<class T> std::shared_ptr<T> dynCast() {
+    static_assert(std::is_base_of<File, T>::value,
+                  "File is not a base of destination type T");
+    if (int(kind) == int(T::expectedKind)) {
+      return std::static_pointer_cast<T>(shared_from_this());
+    } else {
+      return nullptr;
+    }
+  }
+
+  template<class T> std::shared_ptr<T> cast() {
+    static_assert(std::is_base_of<File, T>::value,
+                  "File is not a base of destination type T");
+    assert(int(kind) == int(T::expectedKind));
+    return std::static_pointer_cast<T>(shared_from_this());
+  }
+
+  // A unique (for the lifetime of the file) number used as the inode.
+  ino_t getIno() { return ino_t(reinterpret_cast<uintptr_t>(this)); }
+
+  class Handle {
+    std::unique_lock<std::mutex> lock;
+
+  protected:
+    std::shared_ptr<File> file;
+
+  public:
+    Handle(std::shared_ptr<File> file) : lock(file->mutex), file(file) {}
+    size_t getSize() { return file->getSize(); }
+    mode_t& mode() { return file->mode; }
+    time_t& ctime() { return file->ctime; }
+    time_t& mtime() { return file->mtime; }
+    time_t& atime() { return file->atime; }
+
+    // Note: parent.lock() creates a new shared_ptr to the same Directory
+    // specified by the parent weak_ptr.
+    std::shared_ptr<Directory> getParent() { return file->parent.lock(); }
+    void setParent(std::shared_ptr<File> parent);
+  };
+
+  Handle locked() { return Handle(shared_from_this()); }
+
+  virtual ~File() = default;
+
+protected:
+  File(FileKind kind, mode_t mode) : kind(kind), mode(mode) {
+    time_t now = time(NULL);
+    ctime = mtime = atime = now;
+  }
+
+  // A mutex is needed for multiple accesses to the same file.
+  std::mutex mutex;
+
+  virtual size_t getSize() = 0;
+
+  // Only the permission bits; the file type bits are derived from the kind.
+  mode_t mode = 0;
+
+  time_t ctime;
+  time_t mtime;
+  time_t atime;
+
+  // Reference to parent of current file node. This can be used to
+  // traverse up the directory tree. A weak_ptr ensures that the ref
+  // count is not incremented. This also ensures that there are no cyclic
+  // dependencies where the parent and child have shared_ptrs that reference
+  // each other. This prevents the case in which an uncollectable cycle occurs.
+  std::weak_ptr<Directory> parent;
+};
+
+class DataFile : public File {
+protected:
+  // Notice that the data file base class does not hold its own data. Backends
+  // store file contents in whatever representation suits them.
+  virtual __wasi_errno_t read(uint8_t* buf, size_t len, off_t offset) = 0;
+  virtual __wasi_errno_t
+  write(const uint8_t* buf, size_t len, off_t offset) = 0;
+  // Truncates or extends (with zeros) the file to the given size.
+  virtual __wasi_errno_t setSize(size_t size) = 0;
+  // Writes out any data the backend has buffered.
+  virtual __wasi_errno_t flush() { return __WASI_ERRNO_SUCCESS; }
+  // Character devices have no size or offsets, and are read with this
+  // instead of read(). It may read fewer than len bytes, and reads none at the
+  // end of the input.
+  virtual __wasi_errno_t readStream(uint8_t* buf, size_t len, size_t* nread) {
+    return __WASI_ERRNO_INVAL;
+  }
+
+public:
+  static constexpr FileKind expectedKind = File::DataFileKind;
+  DataFile(mode_t mode) : File(File::DataFileKind, mode) {}
+  virtual ~DataFile() = default;
+
+  // Character devices (the standard streams) are reported as terminals and
+  // are not seekable.
+  virtual bool isCharacterDevice() { return false; }
+
+  class Handle : public File::Handle {
+
+    std::shared_ptr<DataFile> getFile() { return file->cast<DataFile>(); }
+
+  public:
+    Handle(std::shared_ptr<File> dataFile) : File::Handle(dataFile) {}
+
+    __wasi_errno_t read(uint8_t* buf, size_t len, off_t offset) {
+      return getFile()->read(buf, len, offset);
+    }
+    __wasi_errno_t write(const uint8_t* buf, size_t len, off_t offset) {
+      return getFile()->write(buf, len, offset);
+    }
+    __wasi_errno_t setSize(size_t size) { return getFile()->setSize(size); }
+    __wasi_errno_t flush() { return getFile()->flush(); }
+    __wasi_errno_t readStream(uint8_t* buf, size_t len, size_t* nread) {
+      return getFile()->readStream(buf, len, nread);
+    }
+  };
+
+  Handle locked() { return Handle(shared_from_this()); }
+};
+
+class Directory : public File {
+public:
+  struct Entry {
+    std::string name;
+    std::shared_ptr<File> file;
+  };
+
+protected:
+  // The backend that owns this directory, and with which new children are
+  // created.
+  backend_t backend;
+
+  // The interface that backends implement. All of these are called with the
+  // directory locked. Children returned by getChild must already have their
+  // parent set; the handle sets it for newly inserted ones.
+  virtual std::shared_ptr<File> getChild(const std::string& name) = 0;
+  // Adds an existing file (possibly from another backend) as a child. Returns
+  // false if the backend cannot hold foreign files.
+  virtual bool insertChild(const std::string& name,
+                           std::shared_ptr<File> file) = 0;
+  // Create new children. Return nullptr on failure.
+  virtual std::shared_ptr<DataFile> insertDataFile(const std::string& name,
+                                                   mode_t mode) = 0;
+  virtual std::shared_ptr<Directory> insertDirectory(const std::string& name,
+                                                     mode_t mode) = 0;
+  virtual __wasi_errno_t removeChild(const std::string& name) = 0;
+  virtual std::vector<Entry> getEntries() = 0;
+  virtual size_t getNumEntries() = 0;
+
+  size_t getSize() override { return getNumEntries(); }
+
+public:
+  static constexpr FileKind expectedKind = File::DirectoryKind;
+  Directory(mode_t mode, backend_t backend)
+    : File(File::DirectoryKind, mode), backend(backend) {}
+
+  backend_t getBackend() { return backend; }
+
+  class Handle : public File::Handle {
+    std::shared_ptr<Directory> getDir() { return file->cast<Directory>(); }
+
+    // Sets the parent of a child that was just created or looked up.
+    template<class T> std::shared_ptr<T> adopt(std::shared_ptr<T> child);
+
+  public:
+    Handle(std::shared_ptr<File> directory) : File::Handle(directory) {}
+
+    std::shared_ptr<File> getEntry(const std::string& pathName);
+
+    // Adds the entry and updates its parent pointer. The child must not be
+    // locked by the caller.
+    bool setEntry(const std::string& pathName, std::shared_ptr<File> inserted);
+
+    std::shared_ptr<DataFile> insertDataFile(const std::string& pathName,
+                                             mode_t mode);
+
+    std::shared_ptr<Directory> insertDirectory(const std::string& pathName,
+                                               mode_t mode);
+
+    __wasi_errno_t unlinkEntry(const std::string& pathName);
+
+    size_t getNumEntries() { return getDir()->getNumEntries(); }
+
+    std::vector<Entry> getEntries();
+  };
+
+  Handle locked() { return Handle(shared_from_this()); }
+};
+
+// Returns the file type bits (S_IFREG, S_IFDIR, ...) for a file.
+mode_t getFileTypeBits(File& file);
+
+} // namespace wasmfs
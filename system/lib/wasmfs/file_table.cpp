@@ -0,0 +1,66 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the open file table of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "file_table.h"
+#include "streams.h"
+#include <fcntl.h>
+
+namespace wasmfs {
+
+FileTable::FileTable() {
+  entries.push_back(
+    std::make_shared<OpenFileState>(0, O_RDONLY, StdinFile::getSingleton()));
+  entries.push_back(
+    std::make_shared<OpenFileState>(0, O_WRONLY, StdoutFile::getSingleton()));
+  entries.push_back(
+    std::make_shared<OpenFileState>(0, O_WRONLY, StderrFile::getSingleton()));
+}
+
+std::shared_ptr<OpenFileState> FileTable::Handle::getEntry(__wasi_fd_t fd) {
+  if (fd >= fileTable.entries.size()) {
+    return nullptr;
+  }
+  return fileTable.entries[fd];
+}
+
+void FileTable::Handle::setEntry(__wasi_fd_t fd,
+                                 std::shared_ptr<OpenFileState> openFile) {
+  for (__wasi_fd_t i = fileTable.entries.size(); i < fd; i++) {
+    fileTable.freeEntries.insert(i);
+  }
+  if (fd >= fileTable.entries.size()) {
+    fileTable.entries.resize(fd + 1);
+  }
+  if (openFile) {
+    fileTable.freeEntries.erase(fd);
+  } else {
+    fileTable.freeEntries.insert(fd);
+  }
+  fileTable.entries[fd] = openFile;
+}
+
+std::shared_ptr<OpenFileState> FileTable::Handle::releaseEntry(__wasi_fd_t fd) {
+  if (fd >= fileTable.entries.size()) {
+    return nullptr;
+  }
+  auto released = std::move(fileTable.entries[fd]);
+  fileTable.entries[fd] = nullptr;
+  fileTable.freeEntries.insert(fd);
+  return released;
+}
+
+__wasi_fd_t FileTable::Handle::add(std::shared_ptr<OpenFileState> openFileState) {
+  __wasi_fd_t fd = fileTable.freeEntries.empty()
+                     ? fileTable.entries.size()
+                     : *fileTable.freeEntries.begin();
+  setEntry(fd, openFileState);
+  return fd;
+}
+
+} // namespace wasmfs
@@ -0,0 +1,96 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the open file table of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include "file.h"
+#include <assert.h>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <wasi/api.h>
+
+namespace wasmfs {
+
+// The state of an open file description. Several file descriptors may refer
+// to the same OpenFileState (e.g. after dup()), in which case they share the
+// seek position and status flags.
+class OpenFileState : public std::enable_shared_from_this<OpenFileState> {
+  std::shared_ptr<File> file;
+  off_t position;
+  uint32_t flags; // RDONLY, WRONLY, RDWR, APPEND, ...
+  // Offset used by getdents64 to iterate a directory, in entries.
+  size_t dirPosition = 0;
+  std::mutex mutex;
+
+public:
+  OpenFileState(size_t position, uint32_t flags, std::shared_ptr<File> file)
+    : file(file), position(position), flags(flags) {}
+
+  class Handle {
+    std::shared_ptr<OpenFileState> openFileState;
+    std::unique_lock<std::mutex> lock;
+
+  public:
+    Handle(std::shared_ptr<OpenFileState> openFileState)
+      : openFileState(openFileState), lock(openFileState->mutex) {}
+
+    std::shared_ptr<File>& getFile() { return openFileState->file; };
+
+    off_t& position() { return openFileState->position; };
+
+    uint32_t& flags() { return openFileState->flags; };
+
+    size_t& dirPosition() { return openFileState->dirPosition; };
+  };
+
+  Handle get() { return Handle(shared_from_this()); }
+};
+
+class FileTable {
+  std::vector<std::shared_ptr<OpenFileState>> entries;
+  // The descriptors below entries.size() that are not in use, so that the
+  // lowest one can be found without a scan.
+  std::set<__wasi_fd_t> freeEntries;
+  std::mutex mutex;
+
+public:
+  // Initially creates the table with the standard streams.
+  FileTable();
+
+  // Holding a handle locks the table. Callers should copy out the
+  // OpenFileState they need and drop the handle before doing any I/O, so
+  // that threads working on different descriptors run in parallel.
+  class Handle {
+    FileTable& fileTable;
+    std::unique_lock<std::mutex> lock;
+
+  public:
+    Handle(FileTable& fileTable)
+      : fileTable(fileTable), lock(fileTable.mutex) {}
+
+    // Returns the open file for a descriptor, or nullptr if the descriptor
+    // is not open.
+    std::shared_ptr<OpenFileState> getEntry(__wasi_fd_t fd);
+
+    // Places the open file at the given descriptor, replacing (and thereby
+    // closing) any file that was there before.
+    void setEntry(__wasi_fd_t fd, std::shared_ptr<OpenFileState> openFile);
+
+    // Removes the descriptor; returns the open file that was there, if any.
+    std::shared_ptr<OpenFileState> releaseEntry(__wasi_fd_t fd);
+
+    // Returns the lowest free descriptor after placing the open file in it.
+    __wasi_fd_t add(std::shared_ptr<OpenFileState> openFileState);
+  };
+
+  Handle locked() { return Handle(*this); }
+};
+
+} // namespace wasmfs
@@ -0,0 +1,84 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the memory directory class and the memory backend of the
+// new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "memory_directory.h"
+#include "memory_file.h"
+#include <mutex>
+#include <vector>
+
+namespace wasmfs {
+
+std::shared_ptr<File> MemoryDirectory::getChild(const std::string& name) {
+  auto it = entries.find(name);
+  if (it == entries.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+bool MemoryDirectory::insertChild(const std::string& name,
+                                  std::shared_ptr<File> file) {
+  entries[name] = file;
+  return true;
+}
+
+std::shared_ptr<DataFile>
+MemoryDirectory::insertDataFile(const std::string& name, mode_t mode) {
+  auto child = std::make_shared<MemoryFile>(mode);
+  entries[name] = child;
+  return child;
+}
+
+std::shared_ptr<Directory>
+MemoryDirectory::insertDirectory(const std::string& name, mode_t mode) {
+  auto child = backend->createDirectory(mode);
+  entries[name] = child;
+  return child;
+}
+
+__wasi_errno_t MemoryDirectory::removeChild(const std::string& name) {
+  entries.erase(name);
+  return __WASI_ERRNO_SUCCESS;
+}
+
+std::vector<Directory::Entry> MemoryDirectory::getEntries() {
+  std::vector<Directory::Entry> result;
+  result.reserve(entries.size());
+  for (auto& entry : entries) {
+    result.push_back({entry.first, entry.second});
+  }
+  return result;
+}
+
+namespace {
+
+class MemoryBackend : public Backend {
+public:
+  std::shared_ptr<Directory> createDirectory(mode_t mode) override {
+    return std::make_shared<MemoryDirectory>(mode, this);
+  }
+};
+
+} // anonymous namespace
+
+backend_t getMemoryBackend() {
+  static MemoryBackend memoryBackend;
+  return &memoryBackend;
+}
+
+backend_t addBackend(std::unique_ptr<Backend> backend) {
+  static std::mutex mutex;
+  static std::vector<std::unique_ptr<Backend>> backends;
+  std::lock_guard<std::mutex> lock(mutex);
+  backends.push_back(std::move(backend));
+  return backends.back().get();
+}
+
+} // namespace wasmfs
@@ -0,0 +1,39 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the memory directory class of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include "backend.h"
+#include "file.h"
+#include <map>
+
+namespace wasmfs {
+
+// A directory whose entries are kept in memory. Besides being the directory
+// type of the memory backend, it can hold files of any backend, which is how
+// other backends are mounted into the tree.
+class MemoryDirectory : public Directory {
+  std::map<std::string, std::shared_ptr<File>> entries;
+
+  std::shared_ptr<File> getChild(const std::string& name) override;
+  bool insertChild(const std::string& name,
+                   std::shared_ptr<File> file) override;
+  std::shared_ptr<DataFile> insertDataFile(const std::string& name,
+                                           mode_t mode) override;
+  std::shared_ptr<Directory> insertDirectory(const std::string& name,
+                                             mode_t mode) override;
+  __wasi_errno_t removeChild(const std::string& name) override;
+  std::vector<Directory::Entry> getEntries() override;
+  size_t getNumEntries() override { return entries.size(); }
+
+public:
+  MemoryDirectory(mode_t mode, backend_t backend) : Directory(mode, backend) {}
+};
+
+} // namespace wasmfs
@@ -0,0 +1,48 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the memory file class of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "memory_file.h"
+#include <algorithm>
+#include <string.h>
+
+namespace wasmfs {
+
+__wasi_errno_t MemoryFile::write(const uint8_t* buf, size_t len, off_t offset) {
+  if (offset < 0) {
+    return __WASI_ERRNO_INVAL;
+  }
+  size_t end = offset + len;
+  if (end > buffer.size()) {
+    // Grow geometrically so that a series of appends is linear overall. The
+    // vector's resize() zero-fills any gap left by writing past the end.
+    if (end > buffer.capacity()) {
+      buffer.reserve(std::max(end, buffer.capacity() * 2));
+    }
+    buffer.resize(end);
+  }
+  memcpy(buffer.data() + offset, buf, len);
+  return __WASI_ERRNO_SUCCESS;
+}
+
+__wasi_errno_t MemoryFile::read(uint8_t* buf, size_t len, off_t offset) {
+  if (offset < 0) {
+    return __WASI_ERRNO_INVAL;
+  }
+  // The caller is expected to clamp the length to the file size.
+  assert(offset + len <= buffer.size());
+  memcpy(buf, buffer.data() + offset, len);
+  return __WASI_ERRNO_SUCCESS;
+}
+
+__wasi_errno_t MemoryFile::setSize(size_t size) {
+  buffer.resize(size);
+  return __WASI_ERRNO_SUCCESS;
+}
+
+} // namespace wasmfs
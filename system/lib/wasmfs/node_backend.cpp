@@ -0,0 +1,426 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the Node backend of the new file system, which stores
+// files in the host file system through the JS imports in
+// src/library_wasmfs_node.js.
+// Crossing into JS is the dominant cost of small reads and writes, so this
+// backend reads ahead and gathers sequential writes, and moves data to and from
+// the host in large blocks.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "backend.h"
+#include "file.h"
+#include <algorithm>
+#include <emscripten/wasmfs.h>
+#include <fcntl.h>
+#include <map>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+int _wasmfs_node_open(const char* path, int flags, mode_t mode);
+int _wasmfs_node_close(int fd);
+double _wasmfs_node_fstat_size(int fd);
+int _wasmfs_node_read(int fd, void* buf, size_t len, double pos);
+int _wasmfs_node_write(int fd, const void* buf, size_t len, double pos);
+int _wasmfs_node_ftruncate(int fd, double size);
+int _wasmfs_node_get_mode(const char* path);
+int _wasmfs_node_mkdir(const char* path, mode_t mode);
+int _wasmfs_node_rmdir(const char* path);
+int _wasmfs_node_unlink(const char* path);
+int _wasmfs_node_readdir(const char* path, char* buf, size_t size);
+}
+
+namespace wasmfs {
+
+namespace {
+
+// Reads smaller than this are served from a buffer filled with one host read
+// of this size; larger reads go straight to the host.
+constexpr size_t kReadAheadSize = 64 * 1024;
+
+// Sequential writes are gathered up to this size before being written to the
+// host in one call.
+constexpr size_t kWriteBehindSize = 64 * 1024;
+
+class NodeFile : public DataFile {
+  std::string path;
+
+  // The host file is opened on first access and stays open for the life of
+  // this object, however many times it is opened and closed in wasm. The
+  // object lives as long as something uses it, such as an open descriptor,
+  // since its directory only keeps a weak reference to it.
+  int hostFd = -1;
+
+  // Size of the file on the host, not counting buffered writes.
+  size_t hostSize = 0;
+
+  std::vector<uint8_t> readBuffer;
+  off_t readBufferOffset = 0;
+
+  std::vector<uint8_t> writeBuffer;
+  off_t writeBufferOffset = 0;
+
+  __wasi_errno_t ensureOpen() {
+    if (hostFd >= 0) {
+      return __WASI_ERRNO_SUCCESS;
+    }
+    int fd = _wasmfs_node_open(path.c_str(), O_RDWR, 0);
+    if (fd == -EACCES || fd == -EROFS || fd == -EPERM) {
+      fd = _wasmfs_node_open(path.c_str(), O_RDONLY, 0);
+    }
+    if (fd < 0) {
+      return -fd;
+    }
+    double size = _wasmfs_node_fstat_size(fd);
+    if (size < 0) {
+      _wasmfs_node_close(fd);
+      return -size;
+    }
+    hostFd = fd;
+    hostSize = size;
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t hostRead(uint8_t* buf, size_t len, off_t offset, size_t& num) {
+    num = 0;
+    while (num < len) {
+      int result = _wasmfs_node_read(hostFd, buf + num, len - num, offset + num);
+      if (result < 0) {
+        return -result;
+      }
+      if (result == 0) {
+        break;
+      }
+      num += result;
+    }
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t hostWrite(const uint8_t* buf, size_t len, off_t offset) {
+    size_t num = 0;
+    while (num < len) {
+      int result = _wasmfs_node_write(hostFd, buf + num, len - num, offset + num);
+      if (result < 0) {
+        return -result;
+      }
+      num += result;
+    }
+    hostSize = std::max(hostSize, size_t(offset + len));
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t flushWrites() {
+    if (writeBuffer.empty()) {
+      return __WASI_ERRNO_SUCCESS;
+    }
+    auto result =
+      hostWrite(writeBuffer.data(), writeBuffer.size(), writeBufferOffset);
+    writeBuffer.clear();
+    return result;
+  }
+
+  void invalidateReadBuffer(off_t offset, size_t len) {
+    off_t end = readBufferOffset + readBuffer.size();
+    if (offset < end && off_t(offset + len) > readBufferOffset) {
+      readBuffer.clear();
+    }
+  }
+
+  __wasi_errno_t read(uint8_t* buf, size_t len, off_t offset) override {
+    auto result = ensureOpen();
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    // Buffered writes must reach the host before we read around them.
+    result = flushWrites();
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+
+    size_t num = 0;
+    while (num < len) {
+      off_t pos = offset + num;
+      off_t bufferEnd = readBufferOffset + readBuffer.size();
+      if (pos >= readBufferOffset && pos < bufferEnd) {
+        size_t chunk = std::min(len - num, size_t(bufferEnd - pos));
+        memcpy(buf + num, readBuffer.data() + (pos - readBufferOffset), chunk);
+        num += chunk;
+        continue;
+      }
+
+      size_t read = 0;
+      if (len - num >= kReadAheadSize) {
+        // Large reads gain nothing from buffering; read straight into place.
+        result = hostRead(buf + num, len - num, pos, read);
+        if (result != __WASI_ERRNO_SUCCESS) {
+          return result;
+        }
+        num += read;
+      } else {
+        readBuffer.resize(kReadAheadSize);
+        result = hostRead(readBuffer.data(), kReadAheadSize, pos, read);
+        readBuffer.resize(result == __WASI_ERRNO_SUCCESS ? read : 0);
+        readBufferOffset = pos;
+        if (result != __WASI_ERRNO_SUCCESS) {
+          return result;
+        }
+      }
+      if (read == 0) {
+        // The file was truncated on the host behind our back.
+        memset(buf + num, 0, len - num);
+        break;
+      }
+    }
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t write(const uint8_t* buf, size_t len, off_t offset) override {
+    auto result = ensureOpen();
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    invalidateReadBuffer(offset, len);
+
+    // Only strictly sequential writes are gathered.
+    if (!writeBuffer.empty() &&
+        offset != off_t(writeBufferOffset + writeBuffer.size())) {
+      result = flushWrites();
+      if (result != __WASI_ERRNO_SUCCESS) {
+        return result;
+      }
+    }
+
+    if (writeBuffer.size() + len > kWriteBehindSize) {
+      result = flushWrites();
+      if (result != __WASI_ERRNO_SUCCESS) {
+        return result;
+      }
+      if (len >= kWriteBehindSize) {
+        return hostWrite(buf, len, offset);
+      }
+    }
+
+    if (writeBuffer.empty()) {
+      writeBuffer.reserve(kWriteBehindSize);
+      writeBufferOffset = offset;
+    }
+    writeBuffer.insert(writeBuffer.end(), buf, buf + len);
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t setSize(size_t size) override {
+    auto result = ensureOpen();
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    result = flushWrites();
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    readBuffer.clear();
+    int err = _wasmfs_node_ftruncate(hostFd, size);
+    if (err < 0) {
+      return -err;
+    }
+    hostSize = size;
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  __wasi_errno_t flush() override { return flushWrites(); }
+
+  size_t getSize() override {
+    if (ensureOpen() != __WASI_ERRNO_SUCCESS) {
+      return 0;
+    }
+    if (writeBuffer.empty()) {
+      return hostSize;
+    }
+    return std::max(hostSize, size_t(writeBufferOffset + writeBuffer.size()));
+  }
+
+public:
+  NodeFile(mode_t mode, std::string path)
+    : DataFile(mode), path(std::move(path)) {}
+
+  ~NodeFile() {
+    if (hostFd >= 0) {
+      flushWrites();
+      _wasmfs_node_close(hostFd);
+    }
+  }
+};
+
+class NodeDirectory : public Directory {
+  std::string path;
+
+  // Children that are in use, so that each host file is represented by a
+  // single File object (which holds its buffers and host descriptor). The
+  // references are weak, so that files that are no longer used close their
+  // host descriptors, and walking a large tree does not keep them all open.
+  std::map<std::string, std::weak_ptr<File>> children;
+
+  // Expired children are swept out when the map grows to this size.
+  size_t sweepSize = 16;
+
+  std::string childPath(const std::string& name) { return path + '/' + name; }
+
+  void addChild(const std::string& name, std::shared_ptr<File> child) {
+    children[name] = child;
+    if (children.size() < sweepSize) {
+      return;
+    }
+    for (auto it = children.begin(); it != children.end();) {
+      if (it->second.expired()) {
+        it = children.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    sweepSize = std::max(size_t(16), children.size() * 2);
+  }
+
+  std::shared_ptr<File> makeChild(const std::string& name, mode_t mode) {
+    std::shared_ptr<File> child;
+    if (S_ISDIR(mode)) {
+      child = std::make_shared<NodeDirectory>(mode & ~S_IFMT, backend, childPath(name));
+    } else {
+      child = std::make_shared<NodeFile>(mode & ~S_IFMT, childPath(name));
+    }
+    child->locked().setParent(shared_from_this());
+    addChild(name, child);
+    return child;
+  }
+
+  std::shared_ptr<File> getChild(const std::string& name) override {
+    auto it = children.find(name);
+    if (it != children.end()) {
+      if (auto child = it->second.lock()) {
+        return child;
+      }
+    }
+    int mode = _wasmfs_node_get_mode(childPath(name).c_str());
+    if (mode < 0) {
+      return nullptr;
+    }
+    return makeChild(name, mode);
+  }
+
+  bool insertChild(const std::string& name,
+                   std::shared_ptr<File> file) override {
+    // Files of other backends cannot be stored on the host.
+    return false;
+  }
+
+  std::shared_ptr<DataFile> insertDataFile(const std::string& name,
+                                           mode_t mode) override {
+    int fd = _wasmfs_node_open(
+      childPath(name).c_str(), O_CREAT | O_EXCL | O_WRONLY, mode);
+    if (fd < 0) {
+      return nullptr;
+    }
+    _wasmfs_node_close(fd);
+    auto child = std::make_shared<NodeFile>(mode, childPath(name));
+    addChild(name, child);
+    return child;
+  }
+
+  std::shared_ptr<Directory> insertDirectory(const std::string& name,
+                                             mode_t mode) override {
+    if (_wasmfs_node_mkdir(childPath(name).c_str(), mode) < 0) {
+      return nullptr;
+    }
+    auto child = std::make_shared<NodeDirectory>(mode, backend, childPath(name));
+    addChild(name, child);
+    return child;
+  }
+
+  __wasi_errno_t removeChild(const std::string& name) override {
+    auto child = getChild(name);
+    if (!child) {
+      return __WASI_ERRNO_NOENT;
+    }
+    int err = child->is<Directory>() ? _wasmfs_node_rmdir(childPath(name).c_str())
+                                     : _wasmfs_node_unlink(childPath(name).c_str());
+    if (err < 0) {
+      return -err;
+    }
+    children.erase(name);
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  std::vector<std::string> readHostNames() {
+    std::vector<char> buffer(4096);
+    int needed;
+    while (true) {
+      needed = _wasmfs_node_readdir(path.c_str(), buffer.data(), buffer.size());
+      if (needed < 0 || size_t(needed) <= buffer.size()) {
+        break;
+      }
+      buffer.resize(needed);
+    }
+    std::vector<std::string> names;
+    for (int i = 0; i < needed; i += strlen(&buffer[i]) + 1) {
+      names.push_back(&buffer[i]);
+    }
+    return names;
+  }
+
+  std::vector<Directory::Entry> getEntries() override {
+    std::vector<Directory::Entry> entries;
+    auto names = readHostNames();
+    std::sort(names.begin(), names.end());
+    for (auto& name : names) {
+      if (auto child = getChild(name)) {
+        entries.push_back({name, child});
+      }
+    }
+    // Forget about anything that was removed on the host or is not in use.
+    for (auto it = children.begin(); it != children.end();) {
+      if (it->second.expired() ||
+          !std::binary_search(names.begin(), names.end(), it->first)) {
+        it = children.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return entries;
+  }
+
+  size_t getNumEntries() override { return readHostNames().size(); }
+
+public:
+  NodeDirectory(mode_t mode, backend_t backend, std::string path)
+    : Directory(mode, backend), path(std::move(path)) {}
+};
+
+class NodeBackend : public Backend {
+  std::string root;
+
+public:
+  NodeBackend(std::string root) : root(std::move(root)) {}
+
+  std::shared_ptr<Directory> createDirectory(mode_t mode) override {
+    int hostMode = _wasmfs_node_get_mode(root.c_str());
+    if (hostMode == -ENOENT) {
+      if (_wasmfs_node_mkdir(root.c_str(), mode) < 0) {
+        return nullptr;
+      }
+    } else if (hostMode < 0 || !S_ISDIR(hostMode)) {
+      return nullptr;
+    }
+    return std::make_shared<NodeDirectory>(mode, this, root);
+  }
+};
+
+} // anonymous namespace
+
+} // namespace wasmfs
+
+extern "C" backend_t wasmfs_create_node_backend(const char* root) {
+  return wasmfs::addBackend(std::make_unique<wasmfs::NodeBackend>(root));
+}
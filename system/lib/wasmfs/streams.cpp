@@ -0,0 +1,70 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the standard streams of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "streams.h"
+
+extern "C" {
+// Returns the next byte of input, or -1 at the end of the input.
+int _wasmfs_stdin_get_char();
+}
+
+namespace wasmfs {
+
+std::shared_ptr<StdinFile> StdinFile::getSingleton() {
+  static const std::shared_ptr<StdinFile> stdinFile =
+    std::make_shared<StdinFile>(S_IRUGO);
+  return stdinFile;
+}
+
+__wasi_errno_t StdinFile::readStream(uint8_t* buf, size_t len, size_t* nread) {
+  size_t num = 0;
+  // Like a terminal, a read returns at most one line.
+  while (num < len) {
+    int c = _wasmfs_stdin_get_char();
+    if (c < 0) {
+      break;
+    }
+    buf[num++] = c;
+    if (c == '\n') {
+      break;
+    }
+  }
+  *nread = num;
+  return __WASI_ERRNO_SUCCESS;
+}
+
+std::shared_ptr<StdoutFile> StdoutFile::getSingleton() {
+  static const std::shared_ptr<StdoutFile> stdoutFile =
+    std::make_shared<StdoutFile>();
+  return stdoutFile;
+}
+
+std::shared_ptr<StderrFile> StderrFile::getSingleton() {
+  static const std::shared_ptr<StderrFile> stderrFile =
+    std::make_shared<StderrFile>();
+  return stderrFile;
+}
+
+__wasi_errno_t WritingStdFile::writeToJS(const uint8_t* buf,
+                                         size_t len,
+                                         void (*console_write)(const char*)) {
+  for (size_t j = 0; j < len; j++) {
+    uint8_t current = buf[j];
+    if (current == '\0' || current == '\n') {
+      writeBuffer.push_back('\0'); // for null-terminated C strings
+      console_write(writeBuffer.data());
+      writeBuffer.clear();
+    } else {
+      writeBuffer.push_back(current);
+    }
+  }
+  return __WASI_ERRNO_SUCCESS;
+}
+
+} // namespace wasmfs
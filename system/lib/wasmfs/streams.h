@@ -0,0 +1,85 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the standard streams of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include "file.h"
+#include <emscripten/html5.h>
+#include <vector>
+
+namespace wasmfs {
+
+// Stdin reads a line at a time from JS, which gets it from Module['stdin'],
+// the process's stdin in Node, or a prompt in the browser.
+class StdinFile : public DataFile {
+  __wasi_errno_t write(const uint8_t* buf, size_t len, off_t offset) override {
+    return __WASI_ERRNO_INVAL;
+  }
+
+  __wasi_errno_t read(uint8_t* buf, size_t len, off_t offset) override {
+    return __WASI_ERRNO_INVAL;
+  };
+
+  __wasi_errno_t readStream(uint8_t* buf, size_t len, size_t* nread) override;
+
+  __wasi_errno_t setSize(size_t size) override { return __WASI_ERRNO_INVAL; }
+
+  size_t getSize() override { return 0; }
+
+public:
+  StdinFile(mode_t mode) : DataFile(mode) {}
+  bool isCharacterDevice() override { return true; }
+  static std::shared_ptr<StdinFile> getSingleton();
+};
+
+// Stdout and stderr buffer output until a newline, and then print the line
+// to the console.
+class WritingStdFile : public DataFile {
+protected:
+  std::vector<char> writeBuffer;
+
+  __wasi_errno_t read(uint8_t* buf, size_t len, off_t offset) override {
+    return __WASI_ERRNO_INVAL;
+  };
+
+  __wasi_errno_t setSize(size_t size) override { return __WASI_ERRNO_INVAL; }
+
+  size_t getSize() override { return 0; }
+
+  __wasi_errno_t writeToJS(const uint8_t* buf,
+                           size_t len,
+                           void (*console_write)(const char*));
+
+public:
+  WritingStdFile() : DataFile(S_IRUGO | S_IWUGO) {}
+  bool isCharacterDevice() override { return true; }
+};
+
+class StdoutFile : public WritingStdFile {
+  __wasi_errno_t write(const uint8_t* buf, size_t len, off_t offset) override {
+    return writeToJS(buf, len, &emscripten_console_log);
+  }
+
+public:
+  static std::shared_ptr<StdoutFile> getSingleton();
+};
+
+class StderrFile : public WritingStdFile {
+  // TODO: May not want to proxy stderr (fd == 2) to the main thread.
+  // This will not show in HTML - a console.warn in a worker is suffficient.
+  // This would be a change from the current FS.
+  __wasi_errno_t write(const uint8_t* buf, size_t len, off_t offset) override {
+    return writeToJS(buf, len, &emscripten_console_error);
+  }
+
+public:
+  static std::shared_ptr<StderrFile> getSingleton();
+};
+
+} // namespace wasmfs
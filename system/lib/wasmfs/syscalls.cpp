@@ -0,0 +1,786 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the syscalls of the new file system.
+// Syscalls run entirely in wasm: no JS or main thread round trip is needed,
+// so pthreads can do file I/O in parallel.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#include "backend.h"
+#include "file.h"
+#include "file_table.h"
+#include "wasmfs.h"
+#include <dirent.h>
+#include <emscripten/wasmfs.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <wasi/api.h>
+
+using namespace wasmfs;
+
+namespace {
+
+std::shared_ptr<OpenFileState> getOpenFile(__wasi_fd_t fd) {
+  // The table lock is released at the end of this statement; the returned
+  // shared_ptr keeps the open file alive even if another thread closes the fd.
+  return getWasmFS().getFileTable().locked().getEntry(fd);
+}
+
+enum class OffsetHandling { OpenFileState, Argument };
+
+// Internal write function called by __wasi_fd_write and __wasi_fd_pwrite.
+// Receives an open file state offset.
+// Optionally sets open file state offset.
+__wasi_errno_t writeAtOffset(OffsetHandling setOffset,
+                             __wasi_fd_t fd,
+                             const __wasi_ciovec_t* iovs,
+                             size_t iovs_len,
+                             __wasi_size_t* nwritten,
+                             __wasi_filesize_t offset = 0) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return __WASI_ERRNO_BADF;
+  }
+
+  auto lockedOpenFile = openFile->get();
+  if ((lockedOpenFile.flags() & O_ACCMODE) == O_RDONLY) {
+    return __WASI_ERRNO_BADF;
+  }
+  auto file = lockedOpenFile.getFile()->dynCast<DataFile>();
+  if (!file) {
+    return __WASI_ERRNO_ISDIR;
+  }
+
+  auto lockedFile = file->locked();
+
+  off_t currOffset = offset;
+  if (setOffset == OffsetHandling::OpenFileState) {
+    currOffset = (lockedOpenFile.flags() & O_APPEND) ? lockedFile.getSize()
+                                                     : lockedOpenFile.position();
+  }
+
+  size_t num = 0;
+  for (size_t i = 0; i < iovs_len; i++) {
+    const uint8_t* buf = iovs[i].buf;
+    __wasi_size_t len = iovs[i].buf_len;
+
+    auto result = lockedFile.write(buf, len, currOffset + num);
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    num += len;
+  }
+  *nwritten = num;
+
+  if (num) {
+    lockedFile.mtime() = time(NULL);
+  }
+  if (setOffset == OffsetHandling::OpenFileState) {
+    lockedOpenFile.position() = currOffset + num;
+  }
+
+  return __WASI_ERRNO_SUCCESS;
+}
+
+// Internal read function called by __wasi_fd_read and __wasi_fd_pread.
+// Receives an open file state offset.
+// Optionally sets open file state offset.
+__wasi_errno_t readAtOffset(OffsetHandling setOffset,
+                            __wasi_fd_t fd,
+                            const __wasi_iovec_t* iovs,
+                            size_t iovs_len,
+                            __wasi_size_t* nread,
+                            __wasi_filesize_t offset = 0) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return __WASI_ERRNO_BADF;
+  }
+
+  auto lockedOpenFile = openFile->get();
+  if ((lockedOpenFile.flags() & O_ACCMODE) == O_WRONLY) {
+    return __WASI_ERRNO_BADF;
+  }
+  auto file = lockedOpenFile.getFile()->dynCast<DataFile>();
+  if (!file) {
+    return __WASI_ERRNO_ISDIR;
+  }
+
+  auto lockedFile = file->locked();
+
+  if (file->isCharacterDevice()) {
+    // Character devices have no size and ignore the offset. Stop at the first
+    // short read, as there is nothing more to read for now.
+    size_t num = 0;
+    for (size_t i = 0; i < iovs_len; i++) {
+      size_t len = iovs[i].buf_len;
+      size_t bytesRead;
+      auto result = lockedFile.readStream(iovs[i].buf, len, &bytesRead);
+      if (result != __WASI_ERRNO_SUCCESS) {
+        return result;
+      }
+      num += bytesRead;
+      if (bytesRead < len) {
+        break;
+      }
+    }
+    *nread = num;
+    return __WASI_ERRNO_SUCCESS;
+  }
+
+  off_t currOffset = setOffset == OffsetHandling::OpenFileState
+                       ? lockedOpenFile.position()
+                       : offset;
+
+  size_t size = lockedFile.getSize();
+  size_t num = 0;
+  for (size_t i = 0; i < iovs_len; i++) {
+    // Check if curr offset has already exceeded size of file.
+    if (currOffset + num >= size) {
+      break;
+    }
+    uint8_t* buf = iovs[i].buf;
+    size_t len = std::min(size_t(iovs[i].buf_len), size_t(size - (currOffset + num)));
+
+    auto result = lockedFile.read(buf, len, currOffset + num);
+    if (result != __WASI_ERRNO_SUCCESS) {
+      return result;
+    }
+    num += len;
+  }
+  *nread = num;
+
+  if (setOffset == OffsetHandling::OpenFileState) {
+    lockedOpenFile.position() = currOffset + num;
+  }
+
+  return __WASI_ERRNO_SUCCESS;
+}
+
+void fillStat(File& file, struct stat* buffer) {
+  memset(buffer, 0, sizeof(*buffer));
+
+  auto lockedFile = file.locked();
+  buffer->st_dev = 1;
+  buffer->st_mode = getFileTypeBits(file) | lockedFile.mode();
+  buffer->st_ino = file.getIno();
+  buffer->st_nlink = 1;
+  buffer->st_uid = 0;
+  buffer->st_gid = 0;
+  buffer->st_rdev = 0;
+  // Match the JS FS, which reports directories as occupying one block.
+  buffer->st_size = file.is<Directory>() ? 4096 : lockedFile.getSize();
+  buffer->st_blksize = 4096;
+  buffer->st_blocks = (buffer->st_size + 511) / 512;
+  buffer->st_atim.tv_sec = lockedFile.atime();
+  buffer->st_mtim.tv_sec = lockedFile.mtime();
+  buffer->st_ctim.tv_sec = lockedFile.ctime();
+}
+
+// Returns true if the path's last component names the directory itself
+// rather than an entry in its parent ("/", "." or "..").
+bool isSelfReference(const ParsedPath& parsed) {
+  return parsed.baseName.empty() || parsed.baseName == "." ||
+         parsed.baseName == "..";
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+__wasi_errno_t __wasi_fd_write(__wasi_fd_t fd,
+                               const __wasi_ciovec_t* iovs,
+                               size_t iovs_len,
+                               __wasi_size_t* nwritten) {
+  return writeAtOffset(
+    OffsetHandling::OpenFileState, fd, iovs, iovs_len, nwritten);
+}
+
+__wasi_errno_t __wasi_fd_read(__wasi_fd_t fd,
+                              const __wasi_iovec_t* iovs,
+                              size_t iovs_len,
+                              __wasi_size_t* nread) {
+  return readAtOffset(OffsetHandling::OpenFileState, fd, iovs, iovs_len, nread);
+}
+
+__wasi_errno_t __wasi_fd_pwrite(__wasi_fd_t fd,
+                                const __wasi_ciovec_t* iovs,
+                                size_t iovs_len,
+                                __wasi_filesize_t offset,
+                                __wasi_size_t* nwritten) {
+  return writeAtOffset(
+    OffsetHandling::Argument, fd, iovs, iovs_len, nwritten, offset);
+}
+
+__wasi_errno_t __wasi_fd_pread(__wasi_fd_t fd,
+                               const __wasi_iovec_t* iovs,
+                               size_t iovs_len,
+                               __wasi_filesize_t offset,
+                               __wasi_size_t* nread) {
+  return readAtOffset(
+    OffsetHandling::Argument, fd, iovs, iovs_len, nread, offset);
+}
+
+__wasi_errno_t __wasi_fd_seek(__wasi_fd_t fd,
+                              __wasi_filedelta_t offset,
+                              __wasi_whence_t whence,
+                              __wasi_filesize_t* newoffset) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return __WASI_ERRNO_BADF;
+  }
+  auto lockedOpenFile = openFile->get();
+
+  auto dataFile = lockedOpenFile.getFile()->dynCast<DataFile>();
+  if (dataFile && dataFile->isCharacterDevice()) {
+    return __WASI_ERRNO_SPIPE;
+  }
+
+  off_t position;
+  if (whence == SEEK_SET) {
+    position = offset;
+  } else if (whence == SEEK_CUR) {
+    position = lockedOpenFile.position() + offset;
+  } else if (whence == SEEK_END) {
+    position = lockedOpenFile.getFile()->locked().getSize() + offset;
+  } else {
+    return __WASI_ERRNO_INVAL;
+  }
+
+  if (position < 0) {
+    return __WASI_ERRNO_INVAL;
+  }
+
+  lockedOpenFile.position() = position;
+  // Rewinding a directory restarts its getdents64 iteration.
+  if (position == 0) {
+    lockedOpenFile.dirPosition() = 0;
+  }
+
+  if (newoffset) {
+    *newoffset = position;
+  }
+
+  return __WASI_ERRNO_SUCCESS;
+}
+
+__wasi_errno_t __wasi_fd_close(__wasi_fd_t fd) {
+  // The open file is destroyed once the last descriptor (or in-flight
+  // operation on another thread) referring to it goes away.
+  auto released = getWasmFS().getFileTable().locked().releaseEntry(fd);
+  if (!released) {
+    return __WASI_ERRNO_BADF;
+  }
+  // Report errors from writing out buffered data here, as there is no later
+  // point at which the program could see them.
+  std::shared_ptr<File> file = released->get().getFile();
+  if (auto dataFile = file->dynCast<DataFile>()) {
+    return dataFile->locked().flush();
+  }
+  return __WASI_ERRNO_SUCCESS;
+}
+
+__wasi_errno_t __wasi_fd_sync(__wasi_fd_t fd) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return __WASI_ERRNO_BADF;
+  }
+  std::shared_ptr<File> file = openFile->get().getFile();
+  if (auto dataFile = file->dynCast<DataFile>()) {
+    return dataFile->locked().flush();
+  }
+  return __WASI_ERRNO_SUCCESS;
+}
+
+__wasi_errno_t __wasi_fd_fdstat_get(__wasi_fd_t fd, __wasi_fdstat_t* stat) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return __WASI_ERRNO_BADF;
+  }
+  auto lockedOpenFile = openFile->get();
+  auto& file = lockedOpenFile.getFile();
+
+  memset(stat, 0, sizeof(*stat));
+  // All character devices are terminals (other things a Linux system would
+  // assume is a character device, like the mouse, we have special APIs for).
+  if (file->is<Directory>()) {
+    stat->fs_filetype = __WASI_FILETYPE_DIRECTORY;
+  } else if (file->cast<DataFile>()->isCharacterDevice()) {
+    stat->fs_filetype = __WASI_FILETYPE_CHARACTER_DEVICE;
+  } else {
+    stat->fs_filetype = __WASI_FILETYPE_REGULAR_FILE;
+  }
+  if (lockedOpenFile.flags() & O_APPEND) {
+    stat->fs_flags |= __WASI_FDFLAGS_APPEND;
+  }
+  stat->fs_rights_base = ~__wasi_rights_t(0);
+  stat->fs_rights_inheriting = ~__wasi_rights_t(0);
+  return __WASI_ERRNO_SUCCESS;
+}
+
+long __syscall_dup(long fd) {
+  auto fileTable = getWasmFS().getFileTable().locked();
+  auto openFile = fileTable.getEntry(fd);
+  if (!openFile) {
+    return -EBADF;
+  }
+  return fileTable.add(openFile);
+}
+
+long __syscall_dup2(long oldfd, long newfd) {
+  if (newfd < 0) {
+    return -EBADF;
+  }
+  std::shared_ptr<OpenFileState> replaced;
+  {
+    auto fileTable = getWasmFS().getFileTable().locked();
+    auto openFile = fileTable.getEntry(oldfd);
+    if (!openFile) {
+      return -EBADF;
+    }
+    if (oldfd == newfd) {
+      return newfd;
+    }
+    replaced = fileTable.releaseEntry(newfd);
+    fileTable.setEntry(newfd, openFile);
+  }
+  // |replaced| is closed here, after the table lock is dropped.
+  return newfd;
+}
+
+long __syscall_open(long pathname, long flags, ...) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)pathname, parsed);
+  if (err) {
+    return err;
+  }
+  if (!parsed.parent) {
+    return -ENOENT;
+  }
+
+  std::shared_ptr<File> file = parsed.file;
+  if (!file) {
+    if (!(flags & O_CREAT)) {
+      return -ENOENT;
+    }
+    mode_t mode = 0;
+    va_list vl;
+    va_start(vl, flags);
+    mode = va_arg(vl, int);
+    va_end(vl);
+
+    // Another thread may have created the file since we looked; re-check
+    // under the parent's lock.
+    auto lockedParent = parsed.parent->locked();
+    file = lockedParent.getEntry(parsed.baseName);
+    if (!file) {
+      // The new file belongs to the same backend as its parent directory.
+      file = lockedParent.insertDataFile(parsed.baseName,
+                                         mode & (S_IRWXUGO | S_ISVTX));
+      if (!file) {
+        return -EIO;
+      }
+    } else if (flags & O_EXCL) {
+      return -EEXIST;
+    }
+  } else if ((flags & O_CREAT) && (flags & O_EXCL)) {
+    return -EEXIST;
+  }
+
+  if (file->is<Directory>()) {
+    if ((flags & O_ACCMODE) != O_RDONLY) {
+      return -EISDIR;
+    }
+  } else if (flags & O_DIRECTORY) {
+    return -ENOTDIR;
+  }
+
+  if ((flags & O_TRUNC) && (flags & O_ACCMODE) != O_RDONLY) {
+    if (auto dataFile = file->dynCast<DataFile>()) {
+      auto lockedFile = dataFile->locked();
+      lockedFile.setSize(0);
+      lockedFile.mtime() = time(NULL);
+    }
+  }
+
+  auto openFile = std::make_shared<OpenFileState>(
+    0, flags & ~(O_CREAT | O_EXCL | O_TRUNC | O_NOCTTY), file);
+  return getWasmFS().getFileTable().locked().add(openFile);
+}
+
+long __syscall_mkdir(long path, long mode) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)path, parsed);
+  if (err) {
+    return err;
+  }
+  if (parsed.file) {
+    return -EEXIST;
+  }
+  if (!parsed.parent) {
+    return -ENOENT;
+  }
+
+  auto lockedParent = parsed.parent->locked();
+  if (lockedParent.getEntry(parsed.baseName)) {
+    return -EEXIST;
+  }
+  if (!lockedParent.insertDirectory(parsed.baseName,
+                                    mode & (S_IRWXUGO | S_ISVTX))) {
+    return -EIO;
+  }
+  return 0;
+}
+
+long __syscall_rmdir(long path) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)path, parsed);
+  if (err) {
+    return err;
+  }
+  if (!parsed.file) {
+    return -ENOENT;
+  }
+  if (!parsed.file->is<Directory>()) {
+    return -ENOTDIR;
+  }
+  if (isSelfReference(parsed)) {
+    return parsed.baseName == "." ? -EINVAL : -EBUSY;
+  }
+
+  // Parent before child, per the lock ordering.
+  auto lockedParent = parsed.parent->locked();
+  if (lockedParent.getEntry(parsed.baseName) != parsed.file) {
+    return -ENOENT;
+  }
+  auto lockedDir = parsed.file->cast<Directory>()->locked();
+  if (lockedDir.getNumEntries()) {
+    return -ENOTEMPTY;
+  }
+  return -lockedParent.unlinkEntry(parsed.baseName);
+}
+
+long __syscall_unlink(long path) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)path, parsed);
+  if (err) {
+    return err;
+  }
+  if (!parsed.file) {
+    return -ENOENT;
+  }
+  if (parsed.file->is<Directory>()) {
+    return -EISDIR;
+  }
+
+  // Descriptors that still refer to the file keep its contents alive until
+  // they are closed.
+  auto lockedParent = parsed.parent->locked();
+  if (lockedParent.getEntry(parsed.baseName) != parsed.file) {
+    return -ENOENT;
+  }
+  return -lockedParent.unlinkEntry(parsed.baseName);
+}
+
+long __syscall_stat64(long path, long buf) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)path, parsed);
+  if (err) {
+    return err;
+  }
+  if (!parsed.file) {
+    return -ENOENT;
+  }
+  fillStat(*parsed.file, (struct stat*)buf);
+  return 0;
+}
+
+long __syscall_lstat64(long path, long buf) {
+  // There are no symlinks yet, so this is the same as stat.
+  return __syscall_stat64(path, buf);
+}
+
+long __syscall_fstat64(long fd, long buf) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return -EBADF;
+  }
+  std::shared_ptr<File> file = openFile->get().getFile();
+  fillStat(*file, (struct stat*)buf);
+  return 0;
+}
+
+long __syscall_ftruncate64(long fd, long low, long high) {
+  off_t size = (off_t(high) << 32) | uint32_t(low);
+  if (size < 0) {
+    return -EINVAL;
+  }
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return -EBADF;
+  }
+  auto lockedOpenFile = openFile->get();
+  if ((lockedOpenFile.flags() & O_ACCMODE) == O_RDONLY) {
+    return -EINVAL;
+  }
+  auto dataFile = lockedOpenFile.getFile()->dynCast<DataFile>();
+  if (!dataFile) {
+    return -EISDIR;
+  }
+  auto lockedFile = dataFile->locked();
+  auto result = lockedFile.setSize(size);
+  if (result != __WASI_ERRNO_SUCCESS) {
+    return -result;
+  }
+  lockedFile.mtime() = time(NULL);
+  return 0;
+}
+
+long __syscall_getdents64(long fd, long dirp, long count) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return -EBADF;
+  }
+  auto lockedOpenFile = openFile->get();
+  auto directory = lockedOpenFile.getFile()->dynCast<Directory>();
+  if (!directory) {
+    return -ENOTDIR;
+  }
+
+  struct dirent* result = (struct dirent*)dirp;
+  size_t maxEntries = count / sizeof(struct dirent);
+  if (maxEntries == 0) {
+    return -EINVAL;
+  }
+
+  // The listing is ".", ".." and then the directory's entries in name order.
+  // Like the JS FS, the offset is an index into this listing.
+  size_t index = lockedOpenFile.dirPosition();
+  size_t written = 0;
+
+  auto writeEntry = [&](const std::string& name, File& file) {
+    struct dirent* entry = &result[written++];
+    entry->d_ino = file.getIno();
+    entry->d_off = (index + 1) * sizeof(struct dirent);
+    entry->d_reclen = sizeof(struct dirent);
+    entry->d_type = file.is<Directory>() ? DT_DIR
+                    : getFileTypeBits(file) == S_IFCHR ? DT_CHR
+                                                       : DT_REG;
+    strncpy(entry->d_name, name.c_str(), sizeof(entry->d_name) - 1);
+    entry->d_name[sizeof(entry->d_name) - 1] = '\0';
+    index++;
+  };
+
+  std::shared_ptr<Directory> parent;
+  {
+    auto lockedDir = directory->locked();
+    parent = lockedDir.getParent();
+    if (index == 0 && written < maxEntries) {
+      writeEntry(".", *directory);
+    }
+    if (index == 1 && written < maxEntries) {
+      writeEntry("..", parent ? *parent : *directory);
+    }
+    auto entries = lockedDir.getEntries();
+    while (index >= 2 && index - 2 < entries.size() && written < maxEntries) {
+      auto& entry = entries[index - 2];
+      writeEntry(entry.name, *entry.file);
+    }
+  }
+
+  lockedOpenFile.dirPosition() = index;
+  return written * sizeof(struct dirent);
+}
+
+long __syscall_chdir(long path) {
+  ParsedPath parsed;
+  long err = parsePath((const char*)path, parsed);
+  if (err) {
+    return err;
+  }
+  if (!parsed.file) {
+    return -ENOENT;
+  }
+  auto directory = parsed.file->dynCast<Directory>();
+  if (!directory) {
+    return -ENOTDIR;
+  }
+  getWasmFS().setCWD(directory);
+  return 0;
+}
+
+long __syscall_getcwd(long buf, long size) {
+  if (size == 0) {
+    return -EINVAL;
+  }
+
+  // Walk up to the root, finding each directory's name in its parent.
+  auto root = getWasmFS().getRootDirectory();
+  std::shared_ptr<Directory> curr = getWasmFS().getCWD();
+  std::vector<std::string> names;
+  while (curr != root) {
+    auto parent = curr->locked().getParent();
+    if (!parent) {
+      return -ENOENT;
+    }
+    auto entries = parent->locked().getEntries();
+    auto it = entries.begin();
+    while (it != entries.end() && it->file != curr) {
+      ++it;
+    }
+    if (it == entries.end()) {
+      // The working directory has been removed.
+      return -ENOENT;
+    }
+    names.push_back(it->name);
+    curr = parent;
+  }
+
+  std::string cwd;
+  for (auto it = names.rbegin(); it != names.rend(); ++it) {
+    cwd += '/';
+    cwd += *it;
+  }
+  if (cwd.empty()) {
+    cwd = "/";
+  }
+
+  if (size_t(size) < cwd.size() + 1) {
+    return -ERANGE;
+  }
+  memcpy((char*)buf, cwd.c_str(), cwd.size() + 1);
+  return buf;
+}
+
+long __syscall_ioctl(long fd, long request, ...) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return -EBADF;
+  }
+  auto dataFile = openFile->get().getFile()->dynCast<DataFile>();
+  if (!dataFile || !dataFile->isCharacterDevice()) {
+    return -ENOTTY;
+  }
+  switch (request) {
+    case TCGETA:
+    case TCGETS:
+    case TCSETA:
+    case TCSETAW:
+    case TCSETAF:
+    case TCSETS:
+    case TCSETSW:
+    case TCSETSF:
+    case TIOCGWINSZ:
+      // no-op, not actually adjusting terminal settings
+      return 0;
+    default:
+      return -EINVAL;
+  }
+}
+
+long __syscall_fcntl64(long fd, long cmd, ...) {
+  switch (cmd) {
+    case F_DUPFD: {
+      va_list vl;
+      va_start(vl, cmd);
+      long minFd = va_arg(vl, int);
+      va_end(vl);
+      if (minFd < 0) {
+        return -EINVAL;
+      }
+      auto fileTable = getWasmFS().getFileTable().locked();
+      auto openFile = fileTable.getEntry(fd);
+      if (!openFile) {
+        return -EBADF;
+      }
+      while (fileTable.getEntry(minFd)) {
+        minFd++;
+      }
+      fileTable.setEntry(minFd, openFile);
+      return minFd;
+    }
+    case F_GETFD:
+    case F_SETFD:
+      // FD_CLOEXEC makes no sense for a single process.
+      return getOpenFile(fd) ? 0 : -EBADF;
+    case F_GETFL: {
+      auto openFile = getOpenFile(fd);
+      if (!openFile) {
+        return -EBADF;
+      }
+      return openFile->get().flags();
+    }
+    case F_SETFL: {
+      va_list vl;
+      va_start(vl, cmd);
+      long newFlags = va_arg(vl, int);
+      va_end(vl);
+      auto openFile = getOpenFile(fd);
+      if (!openFile) {
+        return -EBADF;
+      }
+      // Only the status flags may be changed; the access mode is fixed.
+      const uint32_t settable = O_APPEND | O_NONBLOCK;
+      auto lockedOpenFile = openFile->get();
+      lockedOpenFile.flags() =
+        (lockedOpenFile.flags() & ~settable) | (newFlags & settable);
+      return 0;
+    }
+    case F_GETLK:
+    case F_SETLK:
+    case F_SETLKW:
+      // Pretend that the locking is successful.
+      return getOpenFile(fd) ? 0 : -EBADF;
+    default:
+      return -EINVAL;
+  }
+}
+
+int wasmfs_create_directory(const char* path, mode_t mode, backend_t backend) {
+  ParsedPath parsed;
+  long err = parsePath(path, parsed);
+  if (err) {
+    return err;
+  }
+  if (parsed.file) {
+    return -EEXIST;
+  }
+
+  auto directory = backend->createDirectory(mode & (S_IRWXUGO | S_ISVTX));
+  if (!directory) {
+    return -EIO;
+  }
+  auto lockedParent = parsed.parent->locked();
+  if (lockedParent.getEntry(parsed.baseName)) {
+    return -EEXIST;
+  }
+  if (!lockedParent.setEntry(parsed.baseName, directory)) {
+    // The parent's backend cannot hold files of other backends.
+    return -EXDEV;
+  }
+  return 0;
+}
+
+backend_t wasmfs_get_backend_by_fd(int fd) {
+  auto openFile = getOpenFile(fd);
+  if (!openFile) {
+    return nullptr;
+  }
+  std::shared_ptr<File> file = openFile->get().getFile();
+  if (auto directory = file->dynCast<Directory>()) {
+    return directory->getBackend();
+  }
+  auto parent = file->locked().getParent();
+  return parent ? parent->getBackend() : nullptr;
+}
+
+backend_t wasmfs_get_memory_backend() { return getMemoryBackend(); }
+}
@@ -6,63 +6,91 @@
 // Current Status: Work in Progress.
 // See https://github.com/emscripten-core/emscripten/issues/15041.
 
-#include <emscripten/emscripten.h>
-#include <emscripten/html5.h>
-#include <stdlib.h>
-#include <vector>
-#include <wasi/api.h>
+#include "wasmfs.h"
+#include "backend.h"
+#include "streams.h"
+#include <errno.h>
+#include <string.h>
 
-extern "C" {
+namespace wasmfs {
 
-static std::vector<char> fd_write_stdstream_buffer;
+WasmFS::WasmFS()
+  : rootDirectory(
+      getMemoryBackend()->createDirectory(S_IRUGO | S_IWUGO | S_IXUGO)) {
+  // The root is its own parent, so that ".." from it resolves to itself.
+  rootDirectory->locked().setParent(rootDirectory);
+  cwd = rootDirectory;
 
-__wasi_errno_t __wasi_fd_write(
-  __wasi_fd_t fd, const __wasi_ciovec_t* iovs, size_t iovs_len, __wasi_size_t* nwritten) {
-  // FD 1 = STDOUT and FD 2 = STDERR.
-  // Temporary hardcoding of filedescriptor values.
-  // TODO: May not want to proxy stderr (fd == 2) to the main thread.
-  // This will not show in HTML - a console.warn in a worker is suffficient.
-  // This would be a change from the current FS.
-  if (fd == 1 || fd == 2) {
-    __wasi_size_t num = 0;
-    for (size_t i = 0; i < iovs_len; i++) {
-      const uint8_t* buf = iovs[i].buf;
-      __wasi_size_t len = iovs[i].buf_len;
-      for (__wasi_size_t j = 0; j < len; j++) {
-        uint8_t current = buf[j];
-        if (current == 0 || current == 10) {
-          fd_write_stdstream_buffer.push_back('\0'); // for null-terminated C strings
-          if (fd == 1) {
-            emscripten_console_log(&fd_write_stdstream_buffer[0]);
-          } else if (fd == 2) {
-            emscripten_console_error(&fd_write_stdstream_buffer[0]);
-          }
-          fd_write_stdstream_buffer.clear();
-        } else {
-          fd_write_stdstream_buffer.push_back(current);
-        }
-      }
-      num += len;
-    }
-    *nwritten = num;
-  }
-  return 0;
-}
+  // Populate /dev with the standard streams.
+  auto devDirectory =
+    rootDirectory->locked().insertDirectory("dev", S_IRUGO | S_IXUGO);
 
-__wasi_errno_t __wasi_fd_seek(
-  __wasi_fd_t fd, __wasi_filedelta_t offset, __wasi_whence_t whence, __wasi_filesize_t* newoffset) {
-  emscripten_console_log("__wasi_fd_seek has been temporarily stubbed and is inert");
-  abort();
+  auto dir = devDirectory->locked();
+  dir.setEntry("stdin", StdinFile::getSingleton());
+  dir.setEntry("stdout", StdoutFile::getSingleton());
+  dir.setEntry("stderr", StderrFile::getSingleton());
 }
 
-__wasi_errno_t __wasi_fd_close(__wasi_fd_t fd) {
-  emscripten_console_log("__wasi_fd_close has been temporarily stubbed and is inert");
-  abort();
+WasmFS& getWasmFS() {
+  // Function-local statics are initialized in a thread-safe manner, and before
+  // any use, including uses from other static constructors.
+  static WasmFS wasmFS;
+  return wasmFS;
 }
 
-__wasi_errno_t __wasi_fd_read(
-  __wasi_fd_t fd, const __wasi_iovec_t* iovs, size_t iovs_len, __wasi_size_t* nread) {
-  emscripten_console_log("__wasi_fd_read has been temporarily stubbed and is inert");
-  abort();
-}
+long parsePath(const char* path, ParsedPath& parsed) {
+  if (!path || !*path) {
+    return -ENOENT;
+  }
+
+  std::shared_ptr<Directory> curr =
+    path[0] == '/' ? getWasmFS().getRootDirectory() : getWasmFS().getCWD();
+
+  // Walk the components. Each directory is locked only for the duration of
+  // its own lookup, so lookups on different threads interleave freely.
+  const char* p = path;
+  std::string name;
+  while (true) {
+    while (*p == '/') {
+      p++;
+    }
+    const char* end = strchrnul(p, '/');
+    name.assign(p, end - p);
+    p = end;
+    while (*p == '/') {
+      p++;
+    }
+    bool last = *p == '\0';
+
+    std::shared_ptr<File> child;
+    if (name.empty() || name == ".") {
+      child = curr;
+    } else if (name == "..") {
+      child = curr->locked().getParent();
+    } else {
+      child = curr->locked().getEntry(name);
+    }
+
+    if (last) {
+      parsed.parent = curr;
+      parsed.baseName = name;
+      parsed.file = child;
+      // For "/", "." and "..", the containing directory is the file's parent.
+      if (child && (name.empty() || name == "." || name == "..")) {
+        auto parent = child->locked().getParent();
+        parsed.parent = parent ? parent : child->dynCast<Directory>();
+      }
+      return 0;
+    }
+
+    if (!child) {
+      return -ENOENT;
+    }
+    curr = child->dynCast<Directory>();
+    if (!curr) {
+      return -ENOTDIR;
+    }
+  }
 }
+
+} // namespace wasmfs
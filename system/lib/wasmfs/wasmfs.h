@@ -0,0 +1,63 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// This file defines the global state of the new file system.
+// Current Status: Work in Progress.
+// See https://github.com/emscripten-core/emscripten/issues/15041.
+
+#pragma once
+
+#include "file.h"
+#include "file_table.h"
+#include <mutex>
+#include <string>
+
+namespace wasmfs {
+
+class WasmFS {
+  FileTable fileTable;
+  std::shared_ptr<Directory> rootDirectory;
+  // The current working directory. Guarded by cwdMutex, since chdir() on one
+  // thread may race with path lookups on another.
+  std::shared_ptr<Directory> cwd;
+  std::mutex cwdMutex;
+
+public:
+  WasmFS();
+
+  FileTable& getFileTable() { return fileTable; }
+
+  std::shared_ptr<Directory> getRootDirectory() { return rootDirectory; }
+
+  std::shared_ptr<Directory> getCWD() {
+    std::lock_guard<std::mutex> lock(cwdMutex);
+    return cwd;
+  }
+
+  void setCWD(std::shared_ptr<Directory> directory) {
+    std::lock_guard<std::mutex> lock(cwdMutex);
+    cwd = directory;
+  }
+};
+
+// The global file system state. It is constructed on first use, so that it is
+// available even to static constructors that do I/O.
+WasmFS& getWasmFS();
+
+// Result of looking up a path: the directory that contains the last path
+// component, the name of that component, and the file itself (nullptr if it
+// does not exist).
+struct ParsedPath {
+  std::shared_ptr<Directory> parent;
+  std::string baseName;
+  std::shared_ptr<File> file;
+};
+
+// Resolves a path relative to the current working directory. Returns 0 on
+// success, or a negative errno if an intermediate component is missing or is
+// not a directory. A missing final component is not an error.
+long parsePath(const char* path, ParsedPath& parsed);
+
+} // namespace wasmfs
@@ -0,0 +1,55 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// dlopen latency: loads a number of plugins, side modules built from
+// benchmark_dlopen_side.c that are embedded as /plugins/plugin<N>.so, and
+// calls into each of them. Only dlopen and dlsym are timed.
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+#include "tick.h"
+
+#define MAX_PLUGINS 50
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  int plugins;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: plugins = 5; break;
+    case 2: plugins = 10; break;
+    case 3: plugins = 25; break;
+    case 4: plugins = 50; break;
+    case 5: plugins = 50; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  typedef int (*run_t)(int);
+  run_t runs[MAX_PLUGINS];
+  double secs = 0;
+  for (int i = 0; i < plugins; i++) {
+    char name[64];
+    snprintf(name, sizeof(name), "/plugins/plugin%d.so", i);
+    tick_t start = tick();
+    void* handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+    runs[i] = handle ? (run_t)dlsym(handle, "plugin_run") : NULL;
+    secs += (double)(tick() - start) / ticks_per_sec();
+    if (!runs[i]) {
+      printf("error: %s\n", dlerror());
+      return 1;
+    }
+  }
+
+  int checksum = 0;
+  for (int i = 0; i < plugins; i++) {
+    checksum += runs[i](i);
+  }
+
+  fprintf(stderr, "%.3f ms per dlopen\n", secs * 1e3 / plugins);
+  printf("plugins: %d, checksum: %d\n", plugins, checksum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
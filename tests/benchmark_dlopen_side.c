@@ -0,0 +1,52 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Side module for benchmark_dlopen.cpp: a plugin that imports a typical set of
+// libc functions from the main module, and exports a few dozen functions and
+// data symbols, some of which are also taken the address of.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFINE_OP(n)                                    \
+  int plugin_data_##n = n;                              \
+  int plugin_op_##n(int x) {                            \
+    char buf[32];                                       \
+    snprintf(buf, sizeof(buf), "%d", x * n);            \
+    return (int)strlen(buf) + atoi(buf) % (n + 1) +     \
+           (int)sqrt((double)plugin_data_##n);          \
+  }
+
+#define DEFINE_OPS(n) \
+  DEFINE_OP(n##0) DEFINE_OP(n##1) DEFINE_OP(n##2) DEFINE_OP(n##3) \
+  DEFINE_OP(n##4) DEFINE_OP(n##5) DEFINE_OP(n##6) DEFINE_OP(n##7)
+
+#define LIST_OPS(n) \
+  plugin_op_##n##0, plugin_op_##n##1, plugin_op_##n##2, plugin_op_##n##3, \
+  plugin_op_##n##4, plugin_op_##n##5, plugin_op_##n##6, plugin_op_##n##7,
+
+DEFINE_OPS(1) DEFINE_OPS(2) DEFINE_OPS(3) DEFINE_OPS(4)
+DEFINE_OPS(5) DEFINE_OPS(6) DEFINE_OPS(7) DEFINE_OPS(8)
+
+typedef int (*op_t)(int);
+
+op_t plugin_ops[] = {
+  LIST_OPS(1) LIST_OPS(2) LIST_OPS(3) LIST_OPS(4)
+  LIST_OPS(5) LIST_OPS(6) LIST_OPS(7) LIST_OPS(8)
+};
+
+int plugin_run(int x) {
+  int n = sizeof(plugin_ops) / sizeof(plugin_ops[0]);
+  char* scratch = malloc(n);
+  memset(scratch, 0, n);
+  int sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += plugin_ops[i](x + scratch[i]);
+  }
+  free(scratch);
+  return sum;
+}
@@ -0,0 +1,90 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Throw/catch latency: exceptions used for control flow, as in error recovery
+// in a recursive descent parser. Each throw unwinds through several frames that
+// have destructors to run, and is caught through a base class after catch
+// clauses that do not match.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "tick.h"
+
+#define DEPTH 8
+
+struct Error {
+  int code;
+  Error(int code) : code(code) {}
+  virtual ~Error() {}
+};
+
+struct SyntaxError : Error {
+  int column;
+  SyntaxError(int code, int column) : Error(code), column(column) {}
+};
+
+struct UnexpectedToken : SyntaxError {
+  UnexpectedToken(int code, int column) : SyntaxError(code, column) {}
+};
+
+struct IOError {
+  int fd;
+};
+
+struct Scope {
+  int* depth;
+  Scope(int* depth) : depth(depth) { (*depth)++; }
+  ~Scope() { (*depth)--; }
+};
+
+static int depth;
+
+static int __attribute__((noinline)) parse(int level, int input) {
+  Scope scope(&depth);
+  if (level == DEPTH) {
+    if (input % 7 == 0) {
+      return input;
+    }
+    throw UnexpectedToken(input, level);
+  }
+  return parse(level + 1, input) + 1;
+}
+
+static int __attribute__((noinline)) parse_with_recovery(int input) {
+  try {
+    return parse(0, input);
+  } catch (IOError& e) {
+    return -e.fd;
+  } catch (Error& e) {
+    return e.code;
+  }
+}
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  int rounds;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: rounds = 20000; break;
+    case 2: rounds = 100000; break;
+    case 3: rounds = 200000; break;
+    case 4: rounds = 500000; break;
+    case 5: rounds = 1000000; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  uint64_t checksum = 0;
+  tick_t start = tick();
+  for (int i = 0; i < rounds; i++) {
+    checksum += parse_with_recovery(i);
+  }
+  double secs = (double)(tick() - start) / ticks_per_sec();
+
+  fprintf(stderr, "%.3f us per throw\n", secs * 1e6 / rounds);
+  printf("depth: %d, checksum: %llu\n", depth, (unsigned long long)checksum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
@@ -0,0 +1,63 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Reads a file with fread() in chunks of CHUNK_SIZE bytes, as a parser
+// would, several times over.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tick.h"
+
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE 1024
+#endif
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  size_t size;
+  int passes;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: size = 1 << 20; passes = 5; break;
+    case 2: size = 4 << 20; passes = 5; break;
+    case 3: size = 8 << 20; passes = 10; break;
+    case 4: size = 16 << 20; passes = 10; break;
+    case 5: size = 32 << 20; passes = 20; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  char* data = (char*)malloc(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = i * 7 + (i >> 10);
+  }
+  FILE* f = fopen("fread_benchmark.dat", "wb");
+  assert(f);
+  assert(fwrite(data, 1, size, f) == size);
+  fclose(f);
+  free(data);
+
+  tick_t start = tick();
+  unsigned sum = 0;
+  char chunk[CHUNK_SIZE];
+  for (int i = 0; i < passes; i++) {
+    f = fopen("fread_benchmark.dat", "rb");
+    assert(f);
+    size_t n;
+    while ((n = fread(chunk, 1, CHUNK_SIZE, f)) > 0) {
+      sum += chunk[0] + chunk[n - 1];
+    }
+    fclose(f);
+  }
+  double secs = (double)(tick() - start) / ticks_per_sec();
+
+  remove("fread_benchmark.dat");
+  printf("read %d MB %d times in %d byte chunks, sum: %u\n", (int)(size >> 20), passes, CHUNK_SIZE, sum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
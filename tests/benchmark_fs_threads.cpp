@@ -0,0 +1,91 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Multithreaded file I/O benchmark. Each thread writes its own file in small
+// chunks, then reads it back and verifies it. With the JS FS every one of these
+// calls is proxied to the main thread; with WASMFS they run on the calling
+// thread in parallel.
+
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tick.h"
+
+#ifndef NUM_THREADS
+#define NUM_THREADS 4
+#endif
+
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE 4096
+#endif
+
+static int numChunks = 256;
+
+static void* worker(void* arg) {
+  long id = (long)arg;
+  char name[64];
+  snprintf(name, sizeof(name), "bench_%ld.dat", id);
+
+  char chunk[CHUNK_SIZE];
+  int fd = open(name, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  assert(fd >= 0);
+  for (int i = 0; i < numChunks; i++) {
+    memset(chunk, (int)(id + i) & 0xff, sizeof(chunk));
+    ssize_t n = write(fd, chunk, sizeof(chunk));
+    assert(n == sizeof(chunk));
+  }
+  close(fd);
+
+  fd = open(name, O_RDONLY);
+  assert(fd >= 0);
+  long errors = 0;
+  for (int i = 0; i < numChunks; i++) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    assert(n == sizeof(chunk));
+    errors += chunk[0] != (char)((id + i) & 0xff);
+    errors += chunk[CHUNK_SIZE - 1] != (char)((id + i) & 0xff);
+  }
+  close(fd);
+  unlink(name);
+  return (void*)errors;
+}
+
+int main(int argc, char** argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 1;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: numChunks = 256; break;
+    case 2: numChunks = 1024; break;
+    case 3: numChunks = 2048; break;
+    case 4: numChunks = 8192; break;
+    case 5: numChunks = 16384; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  tick_t start = tick();
+
+  pthread_t threads[NUM_THREADS];
+  for (long i = 0; i < NUM_THREADS; i++) {
+    int rc = pthread_create(&threads[i], NULL, worker, (void*)i);
+    assert(rc == 0);
+  }
+  long errors = 0;
+  for (int i = 0; i < NUM_THREADS; i++) {
+    void* result;
+    pthread_join(threads[i], &result);
+    errors += (long)result;
+  }
+
+  double secs = (double)(tick() - start) / ticks_per_sec();
+  printf("%d threads x %d chunks of %d bytes\n", NUM_THREADS, numChunks, CHUNK_SIZE);
+  printf("Total time: %f\n", secs);
+  printf("%s\n", errors ? "FAIL." : "OK.");
+  return errors != 0;
+}
@@ -0,0 +1,60 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Maps a large read-only data file over and over, as an app that maps its
+// assets on demand would, and touches one byte per page of each mapping.
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tick.h"
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  size_t size;
+  int reps;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: size = 1 << 20; reps = 50; break;
+    case 2: size = 8 << 20; reps = 50; break;
+    case 3: size = 32 << 20; reps = 100; break;
+    case 4: size = 64 << 20; reps = 100; break;
+    case 5: size = 64 << 20; reps = 500; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  char* data = (char*)malloc(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = i * 31 + (i >> 12);
+  }
+  int fd = open("mmap_benchmark.dat", O_CREAT | O_TRUNC | O_RDWR, 0644);
+  assert(fd >= 0);
+  assert(write(fd, data, size) == (ssize_t)size);
+  free(data);
+
+  tick_t start = tick();
+  unsigned sum = 0;
+  for (int i = 0; i < reps; i++) {
+    char* map = (char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    assert(map != MAP_FAILED);
+    for (size_t j = 0; j < size; j += 4096) {
+      sum += map[j];
+    }
+    munmap(map, size);
+  }
+  double secs = (double)(tick() - start) / ticks_per_sec();
+
+  close(fd);
+  unlink("mmap_benchmark.dat");
+  printf("mapped %d MB %d times, sum: %u\n", (int)(size >> 20), reps, sum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Thread creation latency: creates and joins many short-lived threads, one at
+// a time and in bursts. The threads touch thread-local and thread-specific
+// data so that TLS and tsd setup is part of what is measured. Build with
+// -sPTHREAD_REUSE_CACHE to measure the reuse path rather than the cold path.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "tick.h"
+
+#define BURST 8
+
+static thread_local int tls_counter;
+static pthread_key_t key;
+
+static void* thread_main(void* arg) {
+  uintptr_t value = (uintptr_t)arg;
+  tls_counter += (int)value;
+  pthread_setspecific(key, arg);
+  return (void*)(uintptr_t)(tls_counter + (uintptr_t)pthread_getspecific(key));
+}
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  int rounds;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: rounds = 50; break;
+    case 2: rounds = 200; break;
+    case 3: rounds = 500; break;
+    case 4: rounds = 1000; break;
+    case 5: rounds = 2000; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  pthread_key_create(&key, NULL);
+  uintptr_t checksum = 0;
+
+  // One thread at a time: the full create/run/exit/join round trip.
+  tick_t start = tick();
+  for (int i = 0; i < rounds; i++) {
+    pthread_t thread;
+    int rc = pthread_create(&thread, NULL, thread_main, (void*)(uintptr_t)i);
+    assert(rc == 0);
+    void* result;
+    pthread_join(thread, &result);
+    checksum += (uintptr_t)result;
+  }
+  double serial_secs = (double)(tick() - start) / ticks_per_sec();
+
+  // Bursts of threads that are all started before any is joined.
+  start = tick();
+  for (int i = 0; i < rounds / BURST; i++) {
+    pthread_t threads[BURST];
+    for (int j = 0; j < BURST; j++) {
+      int rc = pthread_create(&threads[j], NULL, thread_main, (void*)(uintptr_t)j);
+      assert(rc == 0);
+    }
+    for (int j = 0; j < BURST; j++) {
+      void* result;
+      pthread_join(threads[j], &result);
+      checksum += (uintptr_t)result;
+    }
+  }
+  double burst_secs = (double)(tick() - start) / ticks_per_sec();
+
+  fprintf(stderr, "serial: %.3f ms per thread\n", serial_secs * 1000 / rounds);
+  fprintf(stderr, "burst: %.3f ms per thread\n", burst_secs * 1000 / (rounds / BURST * BURST));
+  printf("created %d threads, checksum: %lu\n", rounds + rounds / BURST * BURST, (unsigned long)checksum);
+  printf("Total time: %f\n", serial_secs + burst_secs);
+  return 0;
+}
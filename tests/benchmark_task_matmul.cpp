@@ -0,0 +1,85 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Dense matrix multiply with the rows of the result split across workers by
+// emscripten_parallel_for(). Without -pthread it runs serially.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/task.h>
+#else
+#include "benchmark_task_serial.h"
+#endif
+
+#include "tick.h"
+
+struct Matrices {
+  int n;
+  const float* a;
+  const float* bt; // b, transposed
+  float* c;
+};
+
+static void multiply_rows(int begin, int end, void* arg) {
+  Matrices* m = (Matrices*)arg;
+  int n = m->n;
+  for (int i = begin; i < end; i++) {
+    const float* row = m->a + i * n;
+    for (int j = 0; j < n; j++) {
+      const float* col = m->bt + j * n;
+      float sum = 0;
+      for (int k = 0; k < n; k++) {
+        sum += row[k] * col[k];
+      }
+      m->c[i * n + j] = sum;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  int n;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: n = 128; break;
+    case 2: n = 256; break;
+    case 3: n = 384; break;
+    case 4: n = 512; break;
+    case 5: n = 768; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  int workers = emscripten_task_scheduler_init(0);
+  float* a = (float*)malloc(n * n * sizeof(float));
+  float* bt = (float*)malloc(n * n * sizeof(float));
+  float* c = (float*)malloc(n * n * sizeof(float));
+  for (int i = 0; i < n * n; i++) {
+    a[i] = (float)((i * 7) % 13) / 13;
+    bt[i] = (float)((i * 5) % 11) / 11;
+  }
+  Matrices m = {n, a, bt, c};
+
+  tick_t start = tick();
+  emscripten_parallel_for(0, n, 0, multiply_rows, &m);
+  double secs = (double)(tick() - start) / ticks_per_sec();
+
+  double checksum = 0;
+  for (int i = 0; i < n * n; i += n + 1) {
+    checksum += c[i];
+  }
+  free(a);
+  free(bt);
+  free(c);
+  emscripten_task_scheduler_shutdown();
+
+  fprintf(stderr, "workers: %d\n", workers);
+  printf("multiplied %dx%d matrices, trace: %.3f\n", n, n, checksum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
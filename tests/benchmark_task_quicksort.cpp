@@ -0,0 +1,96 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Parallel quicksort on the emscripten/task.h scheduler: after partitioning,
+// the lower part is spawned as a task and the upper part is sorted in place
+// (fork/join). Without -pthread it runs serially.
+
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/task.h>
+#else
+#include "benchmark_task_serial.h"
+#endif
+
+#include "tick.h"
+
+// Below this many elements, sort serially.
+#define CUTOFF 4096
+
+struct Range {
+  uint32_t* begin;
+  uint32_t* end;
+};
+
+static void sort(uint32_t* begin, uint32_t* end);
+
+static void sort_task(void* arg) {
+  Range* range = (Range*)arg;
+  sort(range->begin, range->end);
+}
+
+static void sort(uint32_t* begin, uint32_t* end) {
+  while (end - begin > CUTOFF) {
+    uint32_t a = begin[0], b = begin[(end - begin) / 2], c = end[-1];
+    uint32_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    uint32_t* mid = std::partition(begin, end, [pivot](uint32_t x) { return x < pivot; });
+    uint32_t* upper = std::partition(mid, end, [pivot](uint32_t x) { return x == pivot; });
+    em_task_group group;
+    emscripten_task_group_init(&group);
+    Range lower = {begin, mid};
+    emscripten_task_spawn(&group, sort_task, &lower);
+    sort(upper, end);
+    emscripten_task_group_wait(&group);
+    return;
+  }
+  std::sort(begin, end);
+}
+
+int main(int argc, char **argv) {
+  int arg = argc > 1 ? argv[1][0] - '0' : 3;
+  int size;
+  int passes;
+  switch (arg) {
+    case 0: return 0; break;
+    case 1: size = 1 << 17; passes = 2; break;
+    case 2: size = 1 << 19; passes = 2; break;
+    case 3: size = 1 << 20; passes = 3; break;
+    case 4: size = 1 << 21; passes = 3; break;
+    case 5: size = 1 << 22; passes = 4; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+
+  int workers = emscripten_task_scheduler_init(0);
+  uint32_t* data = (uint32_t*)malloc(size * sizeof(uint32_t));
+  uint32_t checksum = 0;
+  double secs = 0;
+  for (int pass = 0; pass < passes; pass++) {
+    uint32_t x = 12345 + pass;
+    for (int i = 0; i < size; i++) {
+      x = x * 1664525 + 1013904223;
+      data[i] = x >> 8;
+    }
+    tick_t start = tick();
+    sort(data, data + size);
+    secs += (double)(tick() - start) / ticks_per_sec();
+    for (int i = 1; i < size; i++) {
+      assert(data[i - 1] <= data[i]);
+    }
+    checksum += data[size / 3] + data[size - 1];
+  }
+  free(data);
+  emscripten_task_scheduler_shutdown();
+
+  fprintf(stderr, "workers: %d\n", workers);
+  printf("sorted %d elements %d times, checksum: %u\n", size, passes, checksum);
+  printf("Total time: %f\n", secs);
+  return 0;
+}
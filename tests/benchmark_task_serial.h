@@ -0,0 +1,26 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Serial stand-in for emscripten/task.h, so the task benchmarks also build
+// natively. It has the same behavior as the API in a build without -pthread.
+
+#pragma once
+
+typedef void (*em_arg_callback_func)(void*);
+typedef void (*em_task_range_func)(int begin, int end, void* arg);
+
+typedef struct em_task_group {
+  int pending;
+} em_task_group;
+
+static int emscripten_task_scheduler_init(int num_workers) { return 0; }
+static void emscripten_task_scheduler_shutdown(void) {}
+static int emscripten_task_scheduler_num_workers(void) { return 0; }
+static void emscripten_task_group_init(em_task_group* group) { group->pending = 0; }
+static void emscripten_task_spawn(em_task_group* group, em_arg_callback_func func, void* arg) { func(arg); }
+static void emscripten_task_group_wait(em_task_group* group) {}
+static void emscripten_parallel_for(int begin, int end, int grain, em_task_range_func func, void* arg) {
+  if (begin < end) func(begin, end, arg);
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+
+// Catch clause matching caches its results per pair of types. Catch the same
+// types many times, through bases that need pointer adjustments, to check that
+// cached matches adjust the pointer in the same way as uncached ones.
+
+struct Base {
+  int base = 1;
+  virtual ~Base() {}
+};
+
+struct Left : virtual Base {
+  int left = 2;
+};
+
+struct Right : virtual Base {
+  int right = 3;
+};
+
+struct Derived : Left, Right {
+  int derived;
+  Derived(int value) : derived(value) {}
+};
+
+struct Other {
+  int other = 4;
+};
+
+struct Cleanup {
+  int* count;
+  ~Cleanup() { (*count)++; }
+};
+
+int cleanups = 0;
+
+void thrower(int i) {
+  Cleanup c{&cleanups};
+  if (i % 3 == 0) {
+    throw Derived(i);
+  } else if (i % 3 == 1) {
+    throw Other();
+  }
+  // Pointers are matched without the cache. Throw pointers with different
+  // dynamic types.
+  static Derived derived(100);
+  static Right right;
+  if (i % 2) {
+    throw static_cast<Right*>(&derived);
+  }
+  throw &right;
+}
+
+int catch_once(int i) {
+  try {
+    thrower(i);
+  } catch (Other& o) {
+    return o.other;
+  } catch (Right& r) {
+    return r.right + r.base * 10;
+  } catch (Right* r) {
+    return r->right + r->base * 10 + (dynamic_cast<Derived*>(r) ? 1000 : 0);
+  }
+  return -1;
+}
+
+// More catch clauses than libc++abi matches natively.
+int catch_many(int i) {
+  try {
+    thrower(i);
+  } catch (char) {
+  } catch (short) {
+  } catch (int) {
+  } catch (long) {
+  } catch (float) {
+  } catch (double) {
+  } catch (Other& o) {
+    return o.other;
+  } catch (Left& l) {
+    return l.left + l.base * 10;
+  } catch (...) {
+    return 0;
+  }
+  return -1;
+}
+
+int main() {
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 6; i++) {
+      printf("%d:%d:%d ", i, catch_once(i), catch_many(i));
+    }
+    printf("\n");
+  }
+  printf("cleanups: %d\n", cleanups);
+  return 0;
+}
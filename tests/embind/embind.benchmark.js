@@ -283,3 +283,40 @@ function _returns_val_benchmark() {
     var elapsed = _emscripten_get_now() - start;
     out("returns_val " + N + " iters: " + elapsed + " msecs");
 }
+
+// Walks the children of a scene node every frame, which returns a raw pointer
+// for each child. Build with -sEMBIND_HANDLE_CACHE to reuse their handles.
+function _iterate_scene_benchmark_embind_js() {
+    var N = 10000;
+    var FRAMES = 100;
+    var root = Module['create_scene'](N);
+    var start = _emscripten_get_now();
+    for(var frame = 0; frame < FRAMES; ++frame) {
+        var count = root['GetChildCount']();
+        for(var i = 0; i < count; ++i) {
+            var node = root['GetChild'](i);
+            node['SetX'](node['GetX']() + 1);
+        }
+    }
+    var elapsed = _emscripten_get_now() - start;
+    out("JS embind iterate_scene " + N + " nodes, " + FRAMES + " frames: " + elapsed + " msecs. Result: " + root['GetChild'](0)['GetX']());
+}
+
+// Updates an array of C++ structs in place through a flat view.
+function _update_particles_benchmark_embind_js() {
+    var N = 100000;
+    var FRAMES = 100;
+    var view = Module['get_particles'](N);
+    var start = _emscripten_get_now();
+    for(var frame = 0; frame < FRAMES; ++frame) {
+        for(var i = 0; i < view.length; ++i) {
+            var p = view['get'](i);
+            p['x'] += p['vx'];
+            p['y'] += p['vy'];
+            p['z'] += p['vz'];
+        }
+    }
+    var elapsed = _emscripten_get_now() - start;
+    var p = view['get'](N - 1);
+    out("JS embind update_particles " + N + " particles, " + FRAMES + " frames: " + elapsed + " msecs. Result: " + (p['x'] + p['y'] + p['z']));
+}
@@ -1561,6 +1561,19 @@ module({
             });
         });
 
+        test("failed calls free the arguments they converted", function() {
+            var name = new Array(100).join("x");
+            cm.mallinfo();
+            var before = cm.mallinfo().uordblks;
+            for (var i = 0; i < 100; ++i) {
+                assert.throws(cm.BindingError, function() {
+                    cm.emval_test_is_named_shared_ptr_null(name, 105);
+                });
+            }
+            assert.equal(before, cm.mallinfo().uordblks);
+            assert.true(cm.emval_test_is_named_shared_ptr_null(name, null));
+        });
+
         test("raw pointer cannot be given as smart pointer argument", function() {
             var p = new cm.ValHolder({});
             assert.throws(cm.BindingError, function() { cm.emval_test_is_shared_ptr_null(p); });
@@ -2520,6 +2533,42 @@ module({
         });
     });
 
+    BaseFixture.extend("flat view", function() {
+        test("can read and write array elements in place", function() {
+            var view = cm.getFlatParticles();
+            assert.instanceof(view, cm.FlatParticleView);
+            assert.equal(3, view.length);
+
+            var particle = view.get(1);
+            assert.equal(2.5, particle.x);
+            assert.equal(20, particle.id);
+            assert.equal(200, particle.mass);
+            assert.equal(0, particle.alive);
+
+            particle.id = 21;
+            assert.equal(21, cm.getFlatParticleId(1));
+            particle.id = 20;
+        });
+
+        test("get returns the same element object", function() {
+            var view = cm.getFlatParticles();
+            var particle = view.get(0);
+            assert.equal(particle, view.get(2));
+            assert.equal(3.5, particle.x);
+            assert.equal(30, particle.id);
+        });
+
+        test("get throws for indices out of range", function() {
+            var view = cm.getFlatParticles();
+            assert.throws(cm.BindingError, function() {
+                view.get(3);
+            });
+            assert.throws(cm.BindingError, function() {
+                view.get(-1);
+            });
+        });
+    });
+
     BaseFixture.extend("delete pool", function() {
         test("can delete objects later", function() {
             var v = new cm.ValHolder({});
@@ -7,6 +7,7 @@
 #include <emscripten.h>
 #include <emscripten/bind.h>
 #include <memory>
+#include <vector>
 
 int counter = 0;
 
@@ -58,6 +59,9 @@ extern void call_through_interface1();
 extern void call_through_interface2();
 
 extern void returns_val_benchmark();
+
+extern void iterate_scene_benchmark_embind_js();
+extern void update_particles_benchmark_embind_js();
 }
 
 emscripten::val returns_val(emscripten::val value)
@@ -246,6 +250,42 @@ void callInterface3(unsigned N, Interface& o) {
     }
 }
 
+class SceneNode
+{
+public:
+    SceneNode():x(0) {}
+
+    float x;
+    std::vector<SceneNode*> children;
+
+    unsigned __attribute__((noinline)) GetChildCount() const { return children.size(); }
+    SceneNode* __attribute__((noinline)) GetChild(unsigned i) const { return children[i]; }
+    float __attribute__((noinline)) GetX() const { return x; }
+    void __attribute__((noinline)) SetX(float x_) { x = x_; }
+};
+
+SceneNode* create_scene(unsigned N)
+{
+    SceneNode* root = new SceneNode;
+    for (unsigned i = 0; i < N; ++i)
+        root->children.push_back(new SceneNode);
+    return root;
+}
+
+struct Particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+};
+
+std::vector<Particle> particles;
+
+emscripten::flat_array<Particle> get_particles(unsigned N)
+{
+    particles.resize(N, Particle{0, 0, 0, 1, 2, 3});
+    return emscripten::flat_array_view(particles.size(), particles.data());
+}
+
 EMSCRIPTEN_BINDINGS(benchmark)
 {
     using namespace emscripten;
@@ -295,6 +335,22 @@ EMSCRIPTEN_BINDINGS(benchmark)
     function("callInterface3", &callInterface3);
 
     function("returns_val", &returns_val);
+
+    class_<SceneNode>("SceneNode")
+        .function("GetChildCount", &SceneNode::GetChildCount)
+        .function("GetChild", &SceneNode::GetChild, allow_raw_pointers())
+        .function("GetX", &SceneNode::GetX)
+        .function("SetX", &SceneNode::SetX);
+    function("create_scene", &create_scene, allow_raw_pointers());
+
+    flat_view<Particle>("ParticleView")
+        .field("x", &Particle::x)
+        .field("y", &Particle::y)
+        .field("z", &Particle::z)
+        .field("vx", &Particle::vx)
+        .field("vy", &Particle::vy)
+        .field("vz", &Particle::vz);
+    function("get_particles", &get_particles);
 }
 
 void __attribute__((noinline)) emscripten_get_now_benchmark(int N)
@@ -507,4 +563,6 @@ int main()
     call_through_interface1();
     call_through_interface2();
     returns_val_benchmark();
+    iterate_scene_benchmark_embind_js();
+    update_particles_benchmark_embind_js();
 }
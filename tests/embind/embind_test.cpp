@@ -1053,6 +1053,10 @@ bool emval_test_is_shared_ptr_null(std::shared_ptr<ValHolder> p) {
     return !p;
 }
 
+bool emval_test_is_named_shared_ptr_null(std::string name, std::shared_ptr<ValHolder> p) {
+    return !p;
+}
+
 static SmallClass smallClass;
 static BigClass bigClass;
 
@@ -1466,6 +1470,39 @@ EMSCRIPTEN_BINDINGS(memory_view_tests) {
     function("callWithMemoryView", &callWithMemoryView);
 }
 
+struct FlatParticle {
+    float x;
+    int id;
+    double mass;
+    unsigned char alive;
+};
+
+static FlatParticle flatParticles[] = {
+    { 1.5f, 10, 100.0, 1 },
+    { 2.5f, 20, 200.0, 0 },
+    { 3.5f, 30, 300.0, 1 },
+};
+
+static flat_array<FlatParticle> getFlatParticles() {
+    return flat_array_view(getElementCount(flatParticles), flatParticles);
+}
+
+static int getFlatParticleId(int index) {
+    return flatParticles[index].id;
+}
+
+EMSCRIPTEN_BINDINGS(flat_view_tests) {
+    flat_view<FlatParticle>("FlatParticleView")
+        .field("x", &FlatParticle::x)
+        .field("id", &FlatParticle::id)
+        .field("mass", &FlatParticle::mass)
+        .field("alive", &FlatParticle::alive)
+        ;
+
+    function("getFlatParticles", &getFlatParticles);
+    function("getFlatParticleId", &getFlatParticleId);
+}
+
 class HasExternalConstructor {
 public:
     HasExternalConstructor(const std::string& str)
@@ -2224,6 +2261,7 @@ EMSCRIPTEN_BINDINGS(tests) {
     function("emval_test_return_shared_ptr", &emval_test_return_shared_ptr);
     function("emval_test_return_empty_shared_ptr", &emval_test_return_empty_shared_ptr);
     function("emval_test_is_shared_ptr_null", &emval_test_is_shared_ptr_null);
+    function("emval_test_is_named_shared_ptr_null", &emval_test_is_named_shared_ptr_null);
 
     function("emval_test_return_vector", &emval_test_return_vector);
     function("emval_test_return_vector_of_vectors", &emval_test_return_vector_of_vectors);
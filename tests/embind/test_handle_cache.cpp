@@ -0,0 +1,59 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+#include <emscripten.h>
+#include <emscripten/bind.h>
+
+using namespace emscripten;
+
+class Node {
+public:
+  Node(int id) : id(id) {}
+  ~Node() { printf("destroyed %d\n", id); }
+
+  int getId() const { return id; }
+  Node* getChild() { return child; }
+  void setChild(Node* c) { child = c; }
+
+private:
+  int id;
+  Node* child = nullptr;
+};
+
+Node* makeNode(int id) {
+  return new Node(id);
+}
+
+EMSCRIPTEN_BINDINGS(handle_cache) {
+  class_<Node>("Node")
+    .function("getId", &Node::getId)
+    .function("getChild", &Node::getChild, allow_raw_pointers())
+    .function("setChild", &Node::setChild, allow_raw_pointers());
+  function("makeNode", &makeNode, allow_raw_pointers());
+}
+
+int main() {
+  EM_ASM(
+    var root = Module['makeNode'](1);
+    root.setChild(Module['makeNode'](2));
+    var child = root.getChild();
+    out('same child: ' + (child === root.getChild()));
+    out('child id: ' + child.getId());
+
+    // A clone is a separate handle, and deleting it leaves the cached one.
+    child.clone().delete();
+    out('child after clone: ' + (child === root.getChild()));
+
+    // Deleting the cached handle deletes the object, and the next pointer
+    // that is returned gets a new handle.
+    child.delete();
+    root.setChild(Module['makeNode'](3));
+    var next = root.getChild();
+    out('new child: ' + (next !== child) + ' ' + next.getId());
+    next.delete();
+    root.delete();
+  );
+}
@@ -76,8 +76,8 @@ void EMSCRIPTEN_KEEPALIVE finish() {
   EM_ASM((
     assert(!Module['decompressedChunks']);
     Module['compressedData']['debug'] = true;
-    console.log('last cached indexes ' + Module['compressedData']['cachedIndexes']);
-    assert(Module['compressedData']['cachedIndexes'].indexOf(0) < 0); // 0 is not cached
+    console.log('last cached chunks ' + Object.keys(Module['compressedData'].cache.entries));
+    assert(!Module['compressedData'].cache.entries[0]); // 0 is not cached
   ));
   printf("multiple reads of same byte\n");
   for (int i = 0; i < 100; i++) {
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Read-only mappings of MEMFS files alias the file's storage rather than
+// copying it. Check that they still behave like separate mappings.
+
+#define SIZE 10000
+
+static char data[SIZE];
+
+static void check(const char* map, size_t offset, size_t len) {
+  assert(map != MAP_FAILED);
+  for (size_t i = 0; i < len; i++) {
+    assert(map[i] == data[offset + i]);
+  }
+}
+
+int main() {
+  for (int i = 0; i < SIZE; i++) {
+    data[i] = 'a' + i % 26;
+  }
+  int fd = open("data.txt", O_CREAT | O_RDWR, 0644);
+  assert(fd >= 0);
+  assert(write(fd, data, SIZE) == SIZE);
+
+  // Several mappings of the same file, each unmapped on its own.
+  char* private1 = mmap(NULL, SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+  char* private2 = mmap(NULL, SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+  char* shared = mmap(NULL, SIZE - 4096, PROT_READ, MAP_SHARED, fd, 4096);
+  check(private1, 0, SIZE);
+  check(private2, 0, SIZE);
+  check(shared, 4096, SIZE - 4096);
+  assert(munmap(private1, SIZE) == 0);
+  check(private2, 0, SIZE);
+  assert(munmap(private2, SIZE) == 0);
+  printf("multiple mappings ok\n");
+
+  // Writes to the file show up in shared mappings.
+  assert(pwrite(fd, "XYZ", 3, 5000) == 3);
+  memcpy(data + 5000, "XYZ", 3);
+  check(shared, 4096, SIZE - 4096);
+  printf("shared mapping sees writes: %.3s\n", shared + 5000 - 4096);
+
+  // Growing the file moves it out of the mapped storage; the mapping keeps the
+  // old contents and the file is unaffected.
+  static char more[100000];
+  assert(lseek(fd, 0, SEEK_END) == SIZE);
+  assert(write(fd, more, sizeof(more)) == sizeof(more));
+  check(shared, 4096, SIZE - 4096);
+  char buf[3];
+  assert(pread(fd, buf, 3, 5000) == 3 && memcmp(buf, "XYZ", 3) == 0);
+  assert(munmap(shared, SIZE - 4096) == 0);
+  printf("grow while mapped ok\n");
+
+  // A mapping outlives both the descriptor and the file.
+  char* map = mmap(NULL, SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+  int fd2 = open("data.txt", O_RDONLY);
+  assert(close(fd) == 0);
+  assert(unlink("data.txt") == 0);
+  check(map, 0, SIZE);
+  assert(pread(fd2, buf, 3, 5000) == 3 && memcmp(buf, "XYZ", 3) == 0);
+  assert(munmap(map, SIZE) == 0);
+  assert(close(fd2) == 0);
+  printf("unlink while mapped ok\n");
+
+  // Memory growth does not invalidate files whose contents are in the heap.
+  fd = open("data2.txt", O_CREAT | O_RDWR, 0644);
+  assert(write(fd, data, SIZE) == SIZE);
+  map = mmap(NULL, SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+  void* big = malloc(64 * 1024 * 1024);
+  assert(big);
+  check(map, 0, SIZE);
+  assert(pread(fd, buf, 3, 5000) == 3 && memcmp(buf, "XYZ", 3) == 0);
+  assert(munmap(map, SIZE) == 0);
+  free(big);
+  close(fd);
+  printf("memory growth ok\n");
+
+  // A writable shared mapping of a file that is in the heap aliases it too.
+  // Growing the file moves it, but the mapping keeps its storage, and writes
+  // through the mapping still reach the file.
+  fd = open("data3.txt", O_CREAT | O_RDWR, 0644);
+  assert(write(fd, data, SIZE) == SIZE);
+  map = mmap(NULL, SIZE, PROT_READ, MAP_SHARED, fd, 0);
+  assert(munmap(map, SIZE) == 0);
+  map = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  check(map, 0, SIZE);
+  memcpy(map + 100, "abc", 3);
+  assert(pread(fd, buf, 3, 100) == 3 && memcmp(buf, "abc", 3) == 0);
+  assert(lseek(fd, 0, SEEK_END) == SIZE);
+  assert(write(fd, more, sizeof(more)) == sizeof(more));
+  // This would reuse the old storage if it had been freed.
+  char* other = malloc(SIZE);
+  memset(other, 'o', SIZE);
+  memcpy(map + 200, "def", 3);
+  assert(msync(map, SIZE, MS_SYNC) == 0);
+  assert(pread(fd, buf, 3, 200) == 3 && memcmp(buf, "def", 3) == 0);
+  memcpy(map + 300, "ghi", 3);
+  assert(munmap(map, SIZE) == 0);
+  assert(pread(fd, buf, 3, 300) == 3 && memcmp(buf, "ghi", 3) == 0);
+  assert(pread(fd, buf, 3, 100) == 3 && memcmp(buf, "abc", 3) == 0);
+  assert(lseek(fd, 0, SEEK_END) == SIZE + sizeof(more));
+  for (int i = 0; i < SIZE; i++) {
+    assert(other[i] == 'o');
+  }
+  free(other);
+  close(fd);
+  printf("writable shared mapping ok\n");
+  printf("done\n");
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <SDL/SDL.h>
+#include <GLES2/gl2.h>
+#include <emscripten.h>
+
+#define NUM_DRAWS 10000
+
+typedef struct {
+  float pos[3];
+  float uv[2];
+} Vertex;
+
+// Interleaved positions and texture coordinates, and colors in a separate
+// array elsewhere in memory.
+static Vertex vertices[64];
+static unsigned char colors[64][4];
+static unsigned short indices[] = {0, 1, 2, 2, 1, 3};
+
+// Draws from client side vertex arrays and reports how many uploads that took.
+int main() {
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_SetVideoMode(600, 450, 32, SDL_OPENGL);
+
+  GLuint program = glCreateProgram();
+  glUseProgram(program);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), &vertices[0].pos);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &vertices[0].uv);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colors);
+
+  EM_ASM({
+    for (var name in Module.ctx.calls) Module.ctx.calls[name] = 0;
+  });
+  double start = emscripten_get_now();
+  for (int i = 0; i < NUM_DRAWS; i++) {
+    if (i & 1) {
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, indices);
+    } else {
+      glDrawArrays(GL_TRIANGLES, 0, 63);
+    }
+  }
+  glFinish();
+  double time = emscripten_get_now() - start;
+
+  EM_ASM({
+    var calls = Module.ctx.calls;
+    out('draws: ' + (calls.drawArrays + calls.drawElements));
+    out('uploads: ' + calls.bufferSubData);
+  });
+  printf("draws per ms: %.0f\n", NUM_DRAWS / time);
+  return 0;
+}
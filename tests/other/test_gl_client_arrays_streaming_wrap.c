@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <SDL/SDL.h>
+#include <GLES2/gl2.h>
+#include <emscripten.h>
+
+#define NUM_DRAWS 100
+#define NUM_VERTICES 300
+
+// Two client side arrays far enough apart to be uploaded separately.
+static unsigned char data[8192];
+static unsigned char* first = data;
+static unsigned char* second = data + 4096;
+
+// Draws from two client side vertex arrays with a streaming buffer that only
+// fits one draw, and checks that each draw reads the data it was given even
+// though the buffer is orphaned between draws.
+int main() {
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_SetVideoMode(600, 450, 32, SDL_OPENGL);
+
+  // The headless context does not keep buffer contents, so track them here.
+  EM_ASM({
+    var ctx = Module.ctx;
+    var storage = {};
+    var bound = {};
+    var pointers = {};
+    Module.sources = [];
+    Module.sources.push($0, $1);
+    Module.badDraws = 0;
+    function bytes(data) {
+      return new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+    }
+    function wrap(name, func) {
+      var orig = ctx[name];
+      ctx[name] = function() {
+        func.apply(null, arguments);
+        return orig.apply(this, arguments);
+      };
+    }
+    wrap('bindBuffer', function(target, buffer) {
+      bound[target] = buffer;
+    });
+    wrap('bufferData', function(target, data) {
+      storage[bound[target]] = typeof data == 'number' ? new Uint8Array(data) : bytes(data).slice();
+    });
+    wrap('bufferSubData', function(target, offset, data) {
+      storage[bound[target]].set(bytes(data), offset);
+    });
+    wrap('vertexAttribPointer', function(index, size, type, normalized, stride, offset) {
+      pointers[index] = { buffer: bound[0x8892], offset: offset };
+    });
+    wrap('drawArrays', function(mode, first, count) {
+      Module.sources.forEach(function(source, index) {
+        var pointer = pointers[index];
+        var drawn = storage[pointer.buffer].subarray(pointer.offset, pointer.offset + count * 4);
+        if (drawn.join() != HEAPU8.subarray(source, source + count * 4).join()) Module.badDraws++;
+      });
+    });
+  }, first, second);
+
+  GLuint program = glCreateProgram();
+  glUseProgram(program);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(0, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, first);
+  glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, second);
+
+  for (int i = 0; i < NUM_DRAWS; i++) {
+    for (int j = 0; j < NUM_VERTICES * 4; j++) {
+      first[j] = i + j;
+      second[j] = i * 3 + j;
+    }
+    glDrawArrays(GL_TRIANGLES, 0, NUM_VERTICES);
+  }
+  glFinish();
+
+  EM_ASM({
+    out('draws: ' + Module.ctx.calls.drawArrays);
+    out('bad draws: ' + Module.badDraws);
+  });
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_opengl.h>
+#include <emscripten.h>
+
+// Draws many small glBegin/glEnd blocks with fixed function state that needs
+// uniforms (fog), and reports how many WebGL calls that took.
+int main() {
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_SetVideoMode(600, 450, 32, SDL_OPENGL);
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(0, 100, 0, 100, -1, 1);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  glEnable(GL_FOG);
+  glFogf(GL_FOG_DENSITY, 0.5);
+
+  EM_ASM({
+    for (var name in Module.ctx.calls) Module.ctx.calls[name] = 0;
+  });
+
+  for (int frame = 0; frame < 3; frame++) {
+    for (int i = 0; i < 100; i++) {
+      glBegin(GL_QUADS);
+      glColor4f(i / 100.0, 0, 0, 1);
+      glVertex2f(i, 0);
+      glColor4f(i / 100.0, 0, 0, 1);
+      glVertex2f(i + 1, 0);
+      glColor4f(i / 100.0, 0, 0, 1);
+      glVertex2f(i + 1, 1);
+      glColor4f(i / 100.0, 0, 0, 1);
+      glVertex2f(i, 1);
+      glEnd();
+    }
+    // A state change in between must not be merged into the blocks before it.
+    glTranslatef(0, 1, 0);
+    for (int i = 0; i < 100; i++) {
+      glBegin(GL_TRIANGLES);
+      glVertex2f(i, 0);
+      glVertex2f(i + 1, 0);
+      glVertex2f(i, 1);
+      glEnd();
+    }
+    glFinish();
+  }
+
+  EM_ASM({
+    var calls = Module.ctx.calls;
+    out('draws: ' + ((calls.drawArrays || 0) + (calls.drawElements || 0)));
+    out('uniform uploads: ' + ((calls.uniform1f || 0) + (calls.uniform4fv || 0)));
+  });
+  return 0;
+}
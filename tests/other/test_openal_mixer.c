@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <emscripten.h>
+
+// The software mixer of the OpenAL implementation (system/lib/al_mixer.c).
+typedef struct Mixer Mixer;
+Mixer* emscripten_al_mixer_create(double sample_rate);
+void emscripten_al_mixer_destroy(Mixer* mixer);
+int emscripten_al_mixer_play(Mixer* mixer, const float* data, uint32_t frames, uint32_t channels,
+                             double start, double offset, double step,
+                             int loop, double loop_start, double loop_end);
+void emscripten_al_mixer_stop(Mixer* mixer, int voice);
+void emscripten_al_mixer_set_voice_gains(Mixer* mixer, int voice, float ll, float lr, float rl, float rr);
+uint32_t emscripten_al_mixer_render(Mixer* mixer, uint32_t frames);
+uint32_t emscripten_al_mixer_read(Mixer* mixer, float* left, float* right, uint32_t frames);
+
+#define RATE 48000
+#define FRAMES 1024
+#define NUM_VOICES 256
+
+static float mono[RATE];
+static float stereo[2][RATE];
+static float left[FRAMES];
+static float right[FRAMES];
+
+static void mix_frames(Mixer* mixer) {
+  emscripten_al_mixer_render(mixer, FRAMES);
+  uint32_t n = emscripten_al_mixer_read(mixer, left, right, FRAMES);
+  assert(n == FRAMES);
+}
+
+// Checks what the mixer outputs for a few voices, and then reports how fast it
+// mixes many looping voices that need resampling.
+int main() {
+  for (int i = 0; i < RATE; i++) {
+    mono[i] = sinf(i * 0.01f);
+    stereo[0][i] = 0.5f;
+    stereo[1][i] = -0.5f;
+  }
+
+  // A mono voice at the output rate, panned to the left, which starts at frame
+  // 100 and ends after 500 frames.
+  Mixer* mixer = emscripten_al_mixer_create(RATE);
+  int voice = emscripten_al_mixer_play(mixer, mono, 500, 1, 100, 0, 1.0, 0, 0, 0);
+  emscripten_al_mixer_set_voice_gains(mixer, voice, 1, 0, 0, 0);
+  mix_frames(mixer);
+  assert(left[99] == 0 && left[100] == mono[0] && left[599] == mono[499] && left[600] == 0);
+  for (int i = 0; i < FRAMES; i++) {
+    assert(right[i] == 0);
+  }
+  printf("mono ok\n");
+
+  // A stereo voice at half the output rate, with its channels swapped.
+  voice = emscripten_al_mixer_play(mixer, &stereo[0][0], RATE, 2, FRAMES, 0, 0.5, 0, 0, 0);
+  emscripten_al_mixer_set_voice_gains(mixer, voice, 0, 1, 1, 0);
+  mix_frames(mixer);
+  assert(left[0] == -0.5f && right[FRAMES - 1] == 0.5f);
+  emscripten_al_mixer_stop(mixer, voice);
+  mix_frames(mixer);
+  assert(left[0] == 0 && right[0] == 0);
+  printf("stereo ok\n");
+  emscripten_al_mixer_destroy(mixer);
+
+  mixer = emscripten_al_mixer_create(RATE);
+  for (int i = 0; i < NUM_VOICES; i++) {
+    voice = emscripten_al_mixer_play(mixer, mono, RATE, 1, 0, i, 44100.0 / RATE, 1, 0, 0);
+    assert(voice);
+    emscripten_al_mixer_set_voice_gains(mixer, voice, 0.5f / NUM_VOICES, 0.5f / NUM_VOICES, 0, 0);
+  }
+  double start = emscripten_get_now();
+  for (int i = 0; i < RATE / FRAMES; i++) {
+    mix_frames(mixer);
+  }
+  double time = emscripten_get_now() - start;
+  // Milliseconds of voices mixed per millisecond, or how many voices could be
+  // mixed in real time.
+  double mixed = NUM_VOICES * (RATE / FRAMES * FRAMES) * 1000.0 / RATE;
+  printf("voices mixed per ms: %.0f\n", mixed / time);
+  emscripten_al_mixer_destroy(mixer);
+  return 0;
+}
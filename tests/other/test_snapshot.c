@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten.h>
+
+#define TABLE_SIZE 16384
+#define ROUNDS 20000
+
+static int ctor_runs;
+static char* name;
+static uint32_t* table;
+
+__attribute__((constructor)) static void ctor() {
+  ctor_runs++;
+}
+
+// Stands in for the setup that an application does before it can start.
+static void setup() {
+  name = strdup("snapshot");
+  table = malloc(TABLE_SIZE * sizeof(uint32_t));
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    uint32_t x = i;
+    for (int j = 0; j < ROUNDS; j++) {
+      x = x * 1664525 + 1013904223;
+      x ^= x >> 16;
+    }
+    table[i] = x;
+  }
+  FILE* f = fopen("/settings.txt", "w");
+  fputs("from setup", f);
+  fclose(f);
+}
+
+// With -sSNAPSHOT, setup() runs at link time, and the program starts from the
+// state it leaves behind. Without it, emscripten_snapshot_point() does nothing.
+int main() {
+  if (!table) {
+    setup();
+    emscripten_snapshot_point();
+  }
+  printf("ready after %.0f ms\n", emscripten_get_now());
+
+  char settings[32] = {0};
+  FILE* f = fopen("/settings.txt", "r");
+  fread(settings, 1, sizeof(settings) - 1, f);
+  fclose(f);
+  uint32_t sum = 0;
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    sum += table[i];
+  }
+  printf("ctor runs: %d\n", ctor_runs);
+  printf("name: %s\n", name);
+  printf("settings: %s\n", settings);
+  printf("table sum: %u\n", sum);
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Blocks the main browser thread in a futex wait, in pthread_join and in a
+// sleep, and checks that with MAIN_THREAD_ASYNC_WAIT it idles in the event
+// loop instead of spinning, that it wakes up promptly, and that calls proxied
+// to it still run while it waits. Timings go to stderr so that stdout stays
+// deterministic.
+
+#include <assert.h>
+#include <emscripten.h>
+#include <emscripten/threading.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define WAIT_MS 300
+
+static _Atomic uint32_t futex;
+static _Atomic double wake_time;
+static int proxied_call_ran;
+
+// CPU time used by the whole process. The other threads are asleep while the
+// main thread waits, so this is the CPU time of the main thread.
+static double cpu_ms() {
+  return EM_ASM_DOUBLE({
+    var usage = process.cpuUsage();
+    return (usage.user + usage.system) / 1000;
+  });
+}
+
+static void proxied_call() {
+  assert(emscripten_is_main_browser_thread());
+  proxied_call_ran = 1;
+}
+
+static void* thread_main(void* arg) {
+  usleep(WAIT_MS * 1000);
+  // Needs the main thread to run the call while it is blocked below.
+  emscripten_sync_run_in_main_runtime_thread(EM_FUNC_SIG_V, proxied_call);
+  wake_time = emscripten_get_now();
+  futex = 1;
+  emscripten_futex_wake(&futex, 1);
+  usleep(WAIT_MS * 1000);
+  return NULL;
+}
+
+static void report(const char* name, double start, double cpu_start, double latency) {
+  double wall = emscripten_get_now() - start;
+  double cpu = cpu_ms() - cpu_start;
+  fprintf(stderr, "%s: %.1f ms, %.1f ms of CPU time", name, wall, cpu);
+  if (latency >= 0) {
+    fprintf(stderr, ", woken after %.2f ms", latency);
+  }
+  fprintf(stderr, "\n");
+  // A busy-wait uses a full core for the whole wait.
+  printf("%s: %s\n", name, cpu < wall / 2 ? "idle" : "busy");
+}
+
+int main() {
+  assert(emscripten_is_main_browser_thread());
+  pthread_t thread;
+  int rc = pthread_create(&thread, NULL, thread_main, NULL);
+  assert(rc == 0);
+
+  double start = emscripten_get_now();
+  double cpu_start = cpu_ms();
+  while (!futex) {
+    emscripten_futex_wait(&futex, 0, INFINITY);
+  }
+  double latency = emscripten_get_now() - wake_time;
+  assert(latency < 100);
+  report("futex wait", start, cpu_start, latency);
+  printf("proxied call ran: %d\n", proxied_call_ran);
+
+  start = emscripten_get_now();
+  cpu_start = cpu_ms();
+  pthread_join(thread, NULL);
+  report("join", start, cpu_start, -1);
+
+  start = emscripten_get_now();
+  cpu_start = cpu_ms();
+  usleep(WAIT_MS * 1000);
+  assert(emscripten_get_now() - start >= WAIT_MS);
+  report("sleep", start, cpu_start, -1);
+
+  exit(0);
+}
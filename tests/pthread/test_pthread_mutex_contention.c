@@ -0,0 +1,80 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Mutex and condition variable contention microbenchmark. Every lock slow path
+// and every condition variable wait ends up in emscripten_futex_wait/wake, so
+// this measures the cost of those primitives under contention. Timings go to
+// stderr so that stdout stays deterministic.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NUM_THREADS 4
+
+#ifndef ITERATIONS
+#define ITERATIONS 20000
+#endif
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+int counter;
+int turn;
+
+static double now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// All threads hammer on a single mutex.
+void* mutex_main(void* arg) {
+  for (int i = 0; i < ITERATIONS; i++) {
+    pthread_mutex_lock(&mutex);
+    counter++;
+    pthread_mutex_unlock(&mutex);
+  }
+  return NULL;
+}
+
+// The threads take turns in a fixed order, so every step is a condition
+// variable handoff from one thread to the next.
+void* cond_main(void* arg) {
+  int id = (int)(long)arg;
+  for (int i = 0; i < ITERATIONS / NUM_THREADS; i++) {
+    pthread_mutex_lock(&mutex);
+    while (turn != id) {
+      pthread_cond_wait(&cond, &mutex);
+    }
+    counter++;
+    turn = (turn + 1) % NUM_THREADS;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+  }
+  return NULL;
+}
+
+void run(const char* name, void* (*thread_main)(void*)) {
+  pthread_t threads[NUM_THREADS];
+  counter = 0;
+  turn = 0;
+  double start = now_ms();
+  for (long i = 0; i < NUM_THREADS; i++) {
+    int rc = pthread_create(&threads[i], NULL, thread_main, (void*)i);
+    assert(rc == 0);
+  }
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  fprintf(stderr, "%s: %.2f ms\n", name, now_ms() - start);
+  printf("%s: %d\n", name, counter);
+}
+
+int main() {
+  run("mutex", mutex_main);
+  run("condvar", cond_main);
+  return 0;
+}
@@ -0,0 +1,46 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define ROUNDS 20
+#define BURST 4
+
+static _Thread_local int tls_value = 42;
+static _Thread_local int tls_zero;
+static pthread_key_t key;
+
+// Each thread checks that it sees freshly initialized thread local and thread
+// specific data, and then dirties them for whichever thread comes next.
+static void* thread_main(void* arg) {
+  assert(tls_value == 42);
+  assert(tls_zero == 0);
+  assert(pthread_getspecific(key) == NULL);
+  tls_value = -1;
+  tls_zero = -1;
+  pthread_setspecific(key, arg);
+  return arg;
+}
+
+int main() {
+  pthread_key_create(&key, NULL);
+  long sum = 0;
+  for (long i = 0; i < ROUNDS; i++) {
+    pthread_t threads[BURST];
+    for (long j = 0; j < BURST; j++) {
+      int rc = pthread_create(&threads[j], NULL, thread_main, (void*)(i * BURST + j + 1));
+      assert(rc == 0);
+    }
+    for (int j = 0; j < BURST; j++) {
+      void* result;
+      pthread_join(threads[j], &result);
+      sum += (long)result;
+    }
+  }
+  printf("sum: %ld\n", sum);
+  return 0;
+}
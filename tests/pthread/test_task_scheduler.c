@@ -0,0 +1,69 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <stdio.h>
+#include <emscripten/task.h>
+
+_Atomic long long sum;
+
+void add_range(int begin, int end, void* arg) {
+  long long s = 0;
+  for (int i = begin; i < end; i++) {
+    s += i;
+  }
+  sum += s;
+}
+
+typedef struct fib_args {
+  int n;
+  int result;
+} fib_args;
+
+int fib(int n);
+
+void fib_task(void* arg) {
+  fib_args* args = arg;
+  args->result = fib(args->n);
+}
+
+// Nested fork/join: every level waits for a task spawned from a task.
+int fib(int n) {
+  if (n < 12) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+  }
+  em_task_group group;
+  emscripten_task_group_init(&group);
+  fib_args args = {n - 1};
+  emscripten_task_spawn(&group, fib_task, &args);
+  int other = fib(n - 2);
+  emscripten_task_group_wait(&group);
+  return args.result + other;
+}
+
+int main() {
+  int workers = emscripten_task_scheduler_init(3);
+#ifdef __EMSCRIPTEN_PTHREADS__
+  assert(workers == 3);
+  assert(emscripten_task_scheduler_num_workers() == 3);
+#else
+  assert(workers == 0);
+#endif
+
+  for (int grain = 0; grain <= 1000; grain += 250) {
+    sum = 0;
+    emscripten_parallel_for(0, 100000, grain, add_range, NULL);
+    assert(sum == 4999950000LL);
+  }
+  printf("parallel_for: %lld\n", sum);
+
+  printf("fib(25): %d\n", fib(25));
+
+  emscripten_task_scheduler_shutdown();
+  // The scheduler starts again on first use.
+  printf("fib(20): %d\n", fib(20));
+  emscripten_task_scheduler_shutdown();
+  return 0;
+}
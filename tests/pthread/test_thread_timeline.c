@@ -0,0 +1,70 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/threading.h>
+
+#define NUM_THREADS 3
+#define ITERATIONS 10
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+int counter;
+
+void* thread_main(void* arg) {
+  for (int i = 0; i < ITERATIONS; i++) {
+    emscripten_thread_timeline_begin("work");
+    pthread_mutex_lock(&mutex);
+    counter++;
+    pthread_mutex_unlock(&mutex);
+    emscripten_thread_timeline_end();
+  }
+  emscripten_thread_timeline_mark("done");
+  return NULL;
+}
+
+int count(const char* str, const char* needle) {
+  int n = 0;
+  while ((str = strstr(str, needle))) {
+    n++;
+    str++;
+  }
+  return n;
+}
+
+int main() {
+  // Nothing is recorded before the timeline is started.
+  emscripten_thread_timeline_mark("ignored");
+  assert(!emscripten_thread_timeline_export());
+
+  emscripten_thread_timeline_start(0);
+  pthread_t threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_create(&threads[i], NULL, thread_main, NULL);
+  }
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  emscripten_thread_timeline_stop();
+
+  char* trace = emscripten_thread_timeline_export();
+  assert(trace);
+  printf("counter: %d\n", counter);
+  printf("trace events: %d\n", strncmp(trace, "{\"traceEvents\":[", 16) == 0);
+  printf("work scopes: %d\n", count(trace, "{\"name\":\"work\",\"ph\":\"B\""));
+  printf("scope ends: %d\n", count(trace, "\"ph\":\"E\""));
+  printf("done marks: %d\n", count(trace, "{\"name\":\"done\",\"ph\":\"i\""));
+  printf("running: %d\n", count(trace, "{\"name\":\"running\",\"ph\":\"X\"") > 0);
+  free(trace);
+
+  // Exporting removed the events, and the timelines of the exited threads.
+  trace = emscripten_thread_timeline_export();
+  printf("exported again: %d\n", trace && strstr(trace, "\"work\"") != NULL);
+  free(trace);
+  return 0;
+}
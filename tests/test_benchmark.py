@@ -934,6 +934,134 @@ class benchmark(common.RunnerCore):
       return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
     self.do_benchmark('memset_16mb', read_file(test_file('benchmark_memset.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMIN_COPY=1048576', '-DBUILD_FOR_SHELL', '-I' + TEST_ROOT])
 
+  def fread(self, name, chunk_size, emcc_args=[]):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark(name, read_file(test_file('benchmark_fread.cpp')), 'Total time:', output_parser=output_parser, emcc_args=emcc_args, shared_args=['-DCHUNK_SIZE=%d' % chunk_size, '-I' + TEST_ROOT])
+
+  # fread() throughput with file data in JS arrays (the default) and in the heap.
+  @non_core
+  def test_fread_16b(self):
+    self.fread('fread_16b', 16)
+
+  @non_core
+  def test_fread_16b_heap_storage(self):
+    self.fread('fread_16b_heap_storage', 16, ['-sMEMFS_HEAP_STORAGE'])
+
+  @non_core
+  def test_fread_4k(self):
+    self.fread('fread_4k', 4096)
+
+  @non_core
+  def test_fread_4k_heap_storage(self):
+    self.fread('fread_4k_heap_storage', 4096, ['-sMEMFS_HEAP_STORAGE'])
+
+  @non_core
+  def test_fread_64k(self):
+    self.fread('fread_64k', 65536)
+
+  @non_core
+  def test_fread_64k_heap_storage(self):
+    self.fread('fread_64k_heap_storage', 65536, ['-sMEMFS_HEAP_STORAGE'])
+
+  # Repeatedly maps a large read-only file, which should not copy it each time.
+  @non_core
+  def test_mmap_file(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('mmap_file', read_file(test_file('benchmark_mmap_file.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + TEST_ROOT])
+
+  def task_benchmark(self, name, threads):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    emcc_args = []
+    if threads:
+      # Worker threads need the full runtime and a JS engine with Workers,
+      # which means running the benchmark in node rather than a shell.
+      emcc_args = ['-pthread', '-sPTHREAD_POOL_SIZE=8', '-sPROXY_TO_PTHREAD', '-sEXIT_RUNTIME',
+                   '-sMINIMAL_RUNTIME=0', '-sENVIRONMENT=node,worker']
+    src = read_file(test_file('benchmark_task_%s.cpp' % name))
+    self.do_benchmark('task_%s%s' % (name, '_threads' if threads else ''), src, 'Total time:', output_parser=output_parser,
+                      emcc_args=emcc_args, native_args=['-pthread'], shared_args=['-I' + TEST_ROOT])
+
+  # emscripten/task.h scaling: without -pthread tasks run inline, which
+  # measures the overhead of the API over the native serial build.
+  @non_core
+  def test_task_quicksort(self):
+    self.task_benchmark('quicksort', threads=False)
+
+  @non_core
+  def test_task_quicksort_threads(self):
+    self.task_benchmark('quicksort', threads=True)
+
+  @non_core
+  def test_task_matmul(self):
+    self.task_benchmark('matmul', threads=False)
+
+  @non_core
+  def test_task_matmul_threads(self):
+    self.task_benchmark('matmul', threads=True)
+
+  def pthread_create_benchmark(self, name, emcc_args):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    emcc_args = ['-pthread', '-sPTHREAD_POOL_SIZE=8', '-sPROXY_TO_PTHREAD', '-sEXIT_RUNTIME',
+                 '-sMINIMAL_RUNTIME=0', '-sENVIRONMENT=node,worker'] + emcc_args
+    src = read_file(test_file('benchmark_pthread_create.cpp'))
+    self.do_benchmark(name, src, 'Total time:', output_parser=output_parser,
+                      emcc_args=emcc_args, native_args=['-pthread'], shared_args=['-I' + TEST_ROOT])
+
+  # pthread_create/join latency, with every thread allocated from scratch
+  # (cold) and with exited threads reused.
+  @non_core
+  def test_pthread_create(self):
+    self.pthread_create_benchmark('pthread_create', [])
+
+  @non_core
+  def test_pthread_create_reuse(self):
+    self.pthread_create_benchmark('pthread_create_reuse', ['-sPTHREAD_REUSE_CACHE=8'])
+
+  # Exceptions used for control flow: throws unwind through frames with
+  # destructors and are caught through a base class.
+  @non_core
+  def test_exceptions(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    src = read_file(test_file('benchmark_exceptions.cpp'))
+    self.do_benchmark('exceptions', src, 'Total time:', output_parser=output_parser,
+                      emcc_args=['-sDISABLE_EXCEPTION_CATCHING=0'], shared_args=['-I' + TEST_ROOT])
+
+  def dlopen_benchmark(self, name, side_args):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+
+    def lib_builder(name, native, env_init):
+      # The plugins all have the same layout, like the plugins of a real
+      # application that implement the same interface.
+      plugins = os.path.join(self.get_dir(), 'plugins')
+      os.makedirs(plugins, exist_ok=True)
+      first = os.path.join(plugins, 'plugin0.so')
+      run_process([EMCC, test_file('benchmark_dlopen_side.c'), OPTIMIZATIONS, '-sSIDE_MODULE', '-o', first] +
+                  side_args + LLVM_FEATURE_FLAGS, env=env_init)
+      for i in range(1, 50):
+        shutil.copyfile(first, os.path.join(plugins, 'plugin%d.so' % i))
+      return ['--embed-file', plugins + '@/plugins']
+
+    src = read_file(test_file('benchmark_dlopen.cpp'))
+    self.do_benchmark(name, src, 'Total time:', output_parser=output_parser,
+                      emcc_args=['-sMAIN_MODULE', '-sMINIMAL_RUNTIME=0', '-sFILESYSTEM=1', '--closure=0'],
+                      shared_args=['-I' + TEST_ROOT], lib_builder=lib_builder, skip_native=True)
+
+  # dlopen latency of 50 side modules, resolving every symbol through the JS
+  # proxy, and prelinked, with the resolved symbols reused between modules.
+  @non_core
+  def test_dlopen(self):
+    self.dlopen_benchmark('dlopen', [])
+
+  @non_core
+  def test_dlopen_prelink(self):
+    self.dlopen_benchmark('dlopen_prelink', ['-sPRELINK_SIDE_MODULE'])
+
   def test_matrix_multiply(self):
     def output_parser(output):
       return float(re.search(r'Total elapsed: ([\d\.]+)', output).group(1))
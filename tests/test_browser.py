@@ -1371,6 +1371,8 @@ keydown(100);keyup(100); // trigger the end
     assert os.path.getsize('test.data') < (3 * 1024 * 128 * 10) / 2  # over half is gone
     print('    emcc-opts')
     self.btest(Path('fs/test_lz4fs.cpp'), '2', args=['-s', 'LZ4=1', '--preload-file', 'file1.txt', '--preload-file', 'subdir/file2.txt', '--preload-file', 'file3.txt', '-O2'])
+    print('    emcc-workers')
+    self.btest(Path('fs/test_lz4fs.cpp'), '2', args=['-s', 'LZ4=1', '-s', 'LZ4_WORKERS=2', '-s', 'LZ4_CACHE_SIZE=1MB', '--preload-file', 'file1.txt', '--preload-file', 'subdir/file2.txt', '--preload-file', 'file3.txt', '-O2', '--closure=1'])
 
     # compress in the file packager, on the server. the client receives compressed data and can just use it. this is typical usage
     print('normal')
@@ -2207,7 +2209,8 @@ void *getBindBuffer() {
     for args in [
       [],
       ['-lopenal', '-s', 'STRICT'],
-      ['--closure=1']
+      ['--closure=1'],
+      ['-sOPENAL_MIXER']
     ]:
       print(args)
       self.btest('openal_error.c', expected='1', args=args)
@@ -4283,6 +4286,10 @@ window.close = function() {
   def test_utf8_textdecoder(self):
     self.btest_exit('benchmark_utf8.cpp', 0, args=['--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt', '-s', 'EXPORTED_RUNTIME_METHODS=[UTF8ToString]'])
 
+  @also_with_threads
+  def test_utf8_wasm(self):
+    self.btest_exit('benchmark_utf8.cpp', 0, args=['--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt', '-s', 'EXPORTED_RUNTIME_METHODS=[UTF8ToString]', '-s', 'WASM_STRING_CONVERSION'])
+
   @also_with_threads
   def test_utf16_textdecoder(self):
     self.btest_exit('benchmark_utf16.cpp', 0, args=['--embed-file', test_file('utf16_corpus.txt') + '@/utf16_corpus.txt', '-s', 'EXPORTED_RUNTIME_METHODS=[UTF16ToString,stringToUTF16,lengthBytesUTF16]'])
@@ -4403,6 +4410,14 @@ window.close = function() {
         print('with args: %s' % str(args))
         self.btest_exit('webgl_draw_triangle.c', args=args)
 
+  # Tests that uploads proxied to the thread that owns the context are staged
+  # correctly, also when they wrap around the staging arena or come from a
+  # thread that exits before they run.
+  @requires_threads
+  @requires_graphics_hardware
+  def test_webgl_proxied_staged_uploads(self):
+    self.btest_exit('webgl_proxied_staged_uploads.c', args=['-lGL', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD', '-s', 'OFFSCREEN_FRAMEBUFFER'])
+
   # Tests that VAOs can be used even if WebGL enableExtensionsByDefault is set to 0.
   @requires_graphics_hardware
   def test_webgl_vao_without_automatic_extensions(self):
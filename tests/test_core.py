@@ -1389,6 +1389,10 @@ int main(int argc, char **argv)
   def test_exceptions_multiple_inherit_rethrow(self):
     self.do_core_test('test_exceptions_multiple_inherit_rethrow.cpp')
 
+  @with_both_exception_handling
+  def test_exceptions_catch_cache(self):
+    self.do_core_test('test_exceptions_catch_cache.cpp')
+
   @with_both_exception_handling
   def test_exceptions_rethrow_missing(self):
     create_file('main.cpp', 'int main() { throw; }')
@@ -5152,6 +5156,16 @@ main( int argv, char ** argc ) {
       print(str(decoder_mode))
       self.do_runf(test_file('utf8_invalid.cpp'), 'OK.')
 
+  @no_minimal_runtime('WASM_STRING_CONVERSION is not supported in MINIMAL_RUNTIME')
+  def test_utf8_wasm(self):
+    self.set_setting('WASM_STRING_CONVERSION')
+    self.set_setting('EXPORTED_RUNTIME_METHODS',
+                     ['UTF8ToString', 'stringToUTF8', 'AsciiToString', 'stringToAscii'])
+    self.do_runf(test_file('utf8.cpp'), 'OK.')
+    self.do_runf(test_file('utf8_invalid.cpp'), 'OK.')
+    self.emcc_args += ['--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt']
+    self.do_runf(test_file('benchmark_utf8.cpp'), 'OK.')
+
   # Test that invalid character in UTF8 does not cause decoding to crash.
   @no_asan('TODO: ASan support in minimal runtime')
   def test_minimal_runtime_utf8_invalid(self):
@@ -5242,6 +5256,29 @@ main( int argv, char ** argc ) {
   def test_fs_write(self):
     self.do_run_in_out_file_test('fs/test_write.cpp')
 
+  @also_with_wasmfs
+  def test_fs_rw(self):
+    self.do_run_in_out_file_test('wasmfs/wasmfs_rw.c')
+
+  def test_wasmfs_node_backend(self):
+    self.set_setting('WASMFS')
+    self.js_engines = [config.NODE_JS]
+    self.do_run_in_out_file_test('wasmfs/wasmfs_node_backend.c')
+    # The data really is on the host.
+    self.assertExists('node_root/small.txt')
+    self.assertEqual(os.path.getsize('node_root/small.txt'), 108890)
+
+  # Parallel file I/O from pthreads. With WASMFS no syscall is proxied to the
+  # main thread, so this also serves as a comparison between the two.
+  @node_pthreads
+  @also_with_wasmfs
+  def test_fs_threads_benchmark(self):
+    self.set_setting('PROXY_TO_PTHREAD')
+    self.set_setting('EXIT_RUNTIME')
+    # One worker for main() and one for each of its threads.
+    self.set_setting('PTHREAD_POOL_SIZE', 5)
+    self.do_runf(test_file('benchmark_fs_threads.cpp'), 'OK.')
+
   @also_with_noderawfs
   def test_fs_emptyPath(self):
     self.do_run_in_out_file_test('fs/test_emptyPath.c')
@@ -5261,6 +5298,18 @@ main( int argv, char ** argc ) {
         self.emcc_args += ['-lnodefs.js', '-lnoderawfs.js']
       self.do_run_in_out_file_test('fs/test_mmap.c')
 
+  def test_fs_mmap_alias(self):
+    # The test grows memory while a file's contents are mapped.
+    self.set_setting('ALLOW_MEMORY_GROWTH')
+    self.do_run_in_out_file_test('fs/test_mmap_alias.c')
+
+  def test_fs_memfs_heap_storage(self):
+    self.set_setting('MEMFS_HEAP_STORAGE')
+    self.set_setting('ALLOW_MEMORY_GROWTH')
+    self.do_run_in_out_file_test('fs/test_write.cpp')
+    self.do_run_in_out_file_test('wasmfs/wasmfs_rw.c')
+    self.do_run_in_out_file_test('fs/test_mmap_alias.c')
+
   @parameterized({
     '': [],
     'minimal_runtime': ['-s', 'MINIMAL_RUNTIME=1']
@@ -6927,6 +6976,11 @@ someweirdtext
     self.emcc_args += ['--bind']
     self.do_run_in_out_file_test('embind/test_unsigned.cpp')
 
+  def test_embind_handle_cache(self):
+    self.set_setting('EMBIND_HANDLE_CACHE')
+    self.emcc_args += ['--bind']
+    self.do_run_in_out_file_test('embind/test_handle_cache.cpp')
+
   def test_embind_val(self):
     self.emcc_args += ['--bind']
     self.do_run_in_out_file_test('embind/test_val.cpp')
@@ -8449,6 +8503,48 @@ NODEFS is no longer included by default; build with -lnodefs.js
     self.set_setting('USE_PTHREADS')
     self.do_run_in_out_file_test('core/pthread/emscripten_futexes.c')
 
+  @node_pthreads
+  def test_pthread_mutex_contention(self):
+    self.set_setting('PROXY_TO_PTHREAD')
+    self.set_setting('PTHREAD_POOL_SIZE', 5)
+    self.set_setting('EXIT_RUNTIME')
+    self.do_run_in_out_file_test('pthread/test_pthread_mutex_contention.c')
+
+  def test_task_scheduler(self):
+    # Without pthreads, tasks run as they are spawned.
+    self.do_run_in_out_file_test('pthread/test_task_scheduler.c')
+
+  @node_pthreads
+  def test_task_scheduler_pthreads(self):
+    self.set_setting('PROXY_TO_PTHREAD')
+    self.set_setting('PTHREAD_POOL_SIZE', 4)
+    self.set_setting('EXIT_RUNTIME')
+    self.do_run_in_out_file_test('pthread/test_task_scheduler.c')
+
+  @node_pthreads
+  def test_pthread_reuse_cache(self):
+    # Thread blocks, TLS and stacks of exited threads get reused, so thread
+    # local and thread specific data must start out fresh in each thread.
+    self.set_setting('PROXY_TO_PTHREAD')
+    self.set_setting('PTHREAD_POOL_SIZE', 2)
+    self.set_setting('PTHREAD_REUSE_CACHE', 2)
+    self.set_setting('EXIT_RUNTIME')
+    self.do_run_in_out_file_test('pthread/test_pthread_reuse_cache.c')
+
+  @node_pthreads
+  def test_thread_timeline(self):
+    self.set_setting('PTHREAD_POOL_SIZE', 3)
+    self.set_setting('EXIT_RUNTIME')
+    self.do_run_in_out_file_test('pthread/test_thread_timeline.c')
+
+  @node_pthreads
+  def test_pthread_main_thread_async_wait(self):
+    self.set_setting('PTHREAD_POOL_SIZE', 1)
+    self.set_setting('ASYNCIFY')
+    self.set_setting('MAIN_THREAD_ASYNC_WAIT')
+    self.set_setting('EXIT_RUNTIME')
+    self.do_run_in_out_file_test('pthread/test_pthread_main_thread_async_wait.c')
+
   @node_pthreads
   def test_stdio_locking(self):
     self.set_setting('PTHREAD_POOL_SIZE', '2')
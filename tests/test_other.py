@@ -35,7 +35,7 @@ from tools.shared import CLANG_CC, CLANG_CXX, LLVM_AR, LLVM_DWARFDUMP, EMCMAKE,
 from common import RunnerCore, path_from_root, is_slow_test, ensure_dir, disabled, make_executable
 from common import env_modify, no_mac, no_windows, requires_native_clang, with_env_modify
 from common import create_file, parameterized, NON_ZERO, node_pthreads, TEST_ROOT, test_file
-from common import compiler_for, read_file, read_binary, EMBUILDER, require_v8, require_node
+from common import compiler_for, read_file, read_binary, EMBUILDER, require_v8, require_node, WEBIDL_BINDER
 from tools import shared, building, utils, deps_info
 import common
 import jsrun
@@ -1179,6 +1179,8 @@ int f() {
     self.emcc(test_file('module/test_stdin.c'),
               ['-O2', '--closure=1'], output_filename='out.js')
     run_test()
+    self.emcc(test_file('module/test_stdin.c'), ['-sWASMFS'], output_filename='out.js')
+    run_test()
 
   def test_ungetc_fscanf(self):
     create_file('main.cpp', r'''
@@ -2522,6 +2524,102 @@ SDL_Quit called (and ignored)
 done.
 ''' in output, output
 
+  def test_legacy_gl_emulation_batching(self):
+    # Fixed function uniforms are only uploaded when they change, whether or not
+    # glBegin/glEnd blocks are batched.
+    self.run_process([EMCC, test_file('other/test_legacy_gl_batching.c'), '-sHEADLESS', '-sLEGACY_GL_EMULATION'])
+    output = self.run_js('a.out.js')
+    self.assertContained('draws: 600\n', output)
+    uploads = int(re.search(r'uniform uploads: (\d+)', output).group(1))
+    self.assertLess(uploads, 20)
+
+    # With batching, the blocks of each frame are drawn in two calls: the state
+    # change in the middle of the frame and glFinish() end a batch.
+    self.run_process([EMCC, test_file('other/test_legacy_gl_batching.c'), '-sHEADLESS', '-sLEGACY_GL_EMULATION', '-sGL_BATCH_IMMEDIATE_MODE'])
+    output = self.run_js('a.out.js')
+    self.assertContained('draws: 6\n', output)
+    uploads = int(re.search(r'uniform uploads: (\d+)', output).group(1))
+    self.assertLess(uploads, 20)
+
+  def test_gl_client_arrays_streaming(self):
+    # Without a streaming buffer each client side attribute and the indices are
+    # uploaded separately, for 3 uploads per glDrawArrays() and 4 per
+    # glDrawElements().
+    self.run_process([EMCC, test_file('other/test_gl_client_arrays_streaming.c'), '-sHEADLESS', '-sFULL_ES2'])
+    output = self.run_js('a.out.js')
+    self.assertContained('draws: 10000\n', output)
+    self.assertContained('uploads: 35000\n', output)
+
+    # The interleaved attributes are uploaded together. The colors are too if
+    # they happen to be placed next to the vertices.
+    self.run_process([EMCC, test_file('other/test_gl_client_arrays_streaming.c'), '-sHEADLESS', '-sFULL_ES2', '-sGL_STREAMING_BUFFER_SIZE=1048576'])
+    output = self.run_js('a.out.js')
+    self.assertContained('draws: 10000\n', output)
+    uploads = int(re.search(r'uploads: (\d+)', output).group(1))
+    self.assertLessEqual(uploads, 25000)
+
+  def test_gl_client_arrays_streaming_wrap(self):
+    # Each draw uploads two separate client side arrays, which only fit in the
+    # streaming buffer together once it is orphaned.
+    self.run_process([EMCC, test_file('other/test_gl_client_arrays_streaming_wrap.c'), '-sHEADLESS', '-sFULL_ES2', '-sGL_STREAMING_BUFFER_SIZE=4096'])
+    self.assertContained('draws: 100\nbad draws: 0\n', self.run_js('a.out.js'))
+
+  def test_openal_mixer(self):
+    # The software mixer behind -sOPENAL_MIXER is native code in libal, so it
+    # can be checked and benchmarked without Web Audio.
+    self.run_process([EMCC, test_file('other/test_openal_mixer.c'), '-O2'])
+    output = self.run_js('a.out.js')
+    self.assertContained('mono ok\nstereo ok\n', output)
+    self.assertTrue(re.search(r'voices mixed per ms: \d+', output))
+
+  def test_webidl_benchmark(self):
+    # Times calls through the WebIDL bindings, and checks that typed arrays on
+    # the heap are passed to them without being copied.
+    with env_modify({'IDL_CHECKS': 'FAST'}):
+      self.run_process([WEBIDL_BINDER, test_file('webidl/test.idl'), 'glue'])
+    self.run_process([EMCC, test_file('webidl/test.cpp'), '-I.', '-O2', '-sWASM_ASYNC_COMPILATION=0',
+                      '-sEXPORTED_FUNCTIONS=_malloc,_free', '--post-js', 'glue.js',
+                      '--post-js', test_file('webidl/benchmark.js')])
+    output = self.run_js('a.out.js')
+    self.assertContained('heap view ok\n', output)
+    for name in ['number', 'wrapped pointer', 'string', 'array', 'heap view']:
+      self.assertTrue(re.search(name + r' calls per ms: \d+', output))
+
+  def test_snapshot(self):
+    # The setup that main() does before emscripten_snapshot_point() runs at
+    # link time, so the program starts with its results in memory and in the
+    # file system, and without running its constructors again.
+    self.run_process([EMCC, test_file('other/test_snapshot.c'), '-O2', '-o', 'full.js'])
+    full = self.run_js('full.js')
+    self.run_process([EMCC, test_file('other/test_snapshot.c'), '-O2', '-sSNAPSHOT', '-o', 'snapshot.js'])
+    snapshot = self.run_js('snapshot.js')
+    expected = 'ctor runs: 1\nname: snapshot\nsettings: from setup\n'
+    self.assertContained(expected, full)
+    self.assertContained(expected, snapshot)
+    sum = re.search(r'table sum: \d+', full).group(0)
+    self.assertContained(sum, snapshot)
+    full_ms = int(re.search(r'ready after (\d+) ms', full).group(1))
+    snapshot_ms = int(re.search(r'ready after (\d+) ms', snapshot).group(1))
+    print(f'startup: {full_ms} ms, with a snapshot: {snapshot_ms} ms')
+    self.assertLess(snapshot_ms, full_ms)
+
+    # Open files can't be recorded.
+    create_file('open.c', r'''
+      #include <stdio.h>
+      #include <emscripten.h>
+      int main() {
+        FILE* f = fopen("/file.txt", "w");
+        emscripten_snapshot_point();
+        fclose(f);
+      }
+    ''')
+    err = self.expect_fail([EMCC, 'open.c', '-sSNAPSHOT'])
+    self.assertContained('file /file.txt is open in emscripten_snapshot_point()', err)
+
+    # Files kept on the heap can't be restored from the snapshot.
+    err = self.expect_fail([EMCC, test_file('other/test_snapshot.c'), '-sSNAPSHOT', '-sMEMFS_HEAP_STORAGE'])
+    self.assertContained('SNAPSHOT is not compatible with MEMFS_HEAP_STORAGE', err)
+
   def test_preprocess(self):
     # Pass -Werror to prevent regressions such as https://github.com/emscripten-core/emscripten/pull/9661
     out = self.run_process([EMCC, test_file('hello_world.c'), '-E', '-Werror'], stdout=PIPE).stdout
@@ -5794,6 +5892,57 @@ int main(int argc,char** argv) {
     self.set_setting('ASYNCIFY')
     self.do_other_test('test_dlopen_blocking.c')
 
+  def test_prelink_side_module(self):
+    create_file('side.c', r'''
+      #include <stdio.h>
+
+      int side_data = 42;
+
+      static int twice(int x) { return 2 * x; }
+
+      int (*side_func_ptr)(int) = twice;
+
+      int side_func(int x) {
+        printf("side_func %d\n", x);
+        return side_func_ptr(x) + side_data;
+      }
+    ''')
+    create_file('main.c', r'''
+      #include <dlfcn.h>
+      #include <stdio.h>
+
+      int main() {
+        const char* libs[] = {"libside1.so", "libside2.so", "libside3.so"};
+        for (int i = 0; i < 3; i++) {
+          void* handle = dlopen(libs[i], RTLD_NOW);
+          int (*func)(int) = dlsym(handle, "side_func");
+          int* data = dlsym(handle, "side_data");
+          int result = func(i);
+          printf("%s: %d %d\n", libs[i], result, *data);
+        }
+        return 0;
+      }
+    ''')
+    self.run_process([EMCC, 'side.c', '-sSIDE_MODULE', '-sPRELINK_SIDE_MODULE', '-o', 'libside1.so'])
+    self.assertIn(b'emscripten.prelink', read_binary('libside1.so'))
+    self.assertTrue(building.is_wasm_dylib('libside1.so'))
+    # A second module with the same layout, and one that is not prelinked.
+    shutil.copyfile('libside1.so', 'libside2.so')
+    self.run_process([EMCC, 'side.c', '-sSIDE_MODULE', '-o', 'libside3.so'])
+    self.assertNotIn(b'emscripten.prelink', read_binary('libside3.so'))
+
+    self.run_process([EMCC, 'main.c', '-sMAIN_MODULE', '-sDYLINK_DEBUG',
+                      '--embed-file', 'libside1.so', '--embed-file', 'libside2.so', '--embed-file', 'libside3.so'])
+    out = self.run_js('a.out.js')
+    self.assertContained('side_func 0\nlibside1.so: 42 42\n', out)
+    self.assertContained('side_func 1\nlibside2.so: 44 42\n', out)
+    self.assertContained('side_func 2\nlibside3.so: 46 42\n', out)
+    self.assertContained('getPrelinkMetadata: new layout', out)
+    self.assertContained('getPrelinkMetadata: known layout', out)
+
+    err = self.expect_fail([EMCC, 'main.c', '-sPRELINK_SIDE_MODULE'])
+    self.assertContained('PRELINK_SIDE_MODULE requires SIDE_MODULE', err)
+
   def test_dlsym_rtld_default(self):
     create_file('side.c', r'''
     int baz() {
@@ -10317,6 +10466,156 @@ exec "$@"
     self.assertContained('wrapping compiler call: ', stdout)
     self.assertExists('test_hello_world.o')
 
+  def test_compile_cache(self):
+    # Make the source unique so that earlier test runs cannot have cached it.
+    create_file('cached.c', 'const char* id = "%s";\nint foo() { return FOO; }\n' % uuid.uuid4())
+
+    def compile(*args):
+      with env_modify({'EM_COMPILE_CACHE_SIZE': '64', 'EMCC_DEBUG': '1'}):
+        return self.run_process([EMCC, '-c', 'cached.c', '-DFOO=1'] + list(args), stderr=PIPE).stderr
+
+    self.assertContained('compile cache miss: cached.o', compile())
+    first = read_binary('cached.o')
+    os.remove('cached.o')
+    self.assertContained('compile cache hit: cached.o', compile())
+    self.assertEqual(first, read_binary('cached.o'))
+    # The output file name is not part of the key.
+    self.assertContained('compile cache hit: other.o', compile('-o', 'other.o'))
+    # The flags and the preprocessed source are.
+    self.assertContained('compile cache miss: cached.o', compile('-O2'))
+    self.assertContained('compile cache miss: cached.o', compile('-DFOO=2'))
+    # Dependency files are still written on a hit.
+    self.assertContained('compile cache miss: cached.o', compile('-MD'))
+    os.remove('cached.d')
+    self.assertContained('compile cache hit: cached.o', compile('-MD'))
+    self.assertContained('cached.o: ', read_file('cached.d'))
+    # Without the setting the cache is not used.
+    stderr = self.run_process([EMCC, '-c', 'cached.c', '-DFOO=1'], stderr=PIPE, env=dict(os.environ, EMCC_DEBUG='1')).stderr
+    self.assertNotContained('compile cache', stderr)
+
+  def test_js_compiler_cache(self):
+    # Make the JS library unique so that earlier test runs cannot have cached
+    # the output.
+    create_file('lib.js', '''
+mergeInto(LibraryManager.library, {
+  foo: function() { return 1; },
+  assertions: function() {
+#if ASSERTIONS
+    return 7;
+#else
+    return 8;
+#endif
+  },
+});
+// %s
+''' % uuid.uuid4())
+    create_file('main.c', r'''
+      #include <stdio.h>
+      int foo();
+      int assertions();
+      int main() { printf("foo: %d, assertions: %d\\n", foo(), assertions()); }
+    ''')
+
+    def link(*args):
+      with env_modify({'EM_JS_COMPILER_CACHE_SIZE': '64', 'EMCC_DEBUG': '1'}):
+        return self.run_process([EMCC, 'main.c', '--js-library', 'lib.js'] + list(args), stderr=PIPE).stderr
+
+    self.assertContained('JS compiler cache miss', link())
+    self.assertContained('foo: 1, assertions: 7', self.run_js('a.out.js'))
+    first = read_file('a.out.js')
+    self.assertContained('JS compiler cache hit', link())
+    self.assertEqual(first, read_file('a.out.js'))
+    # Settings are part of the key, also of the preprocessed libraries.
+    self.assertContained('JS compiler cache miss', link('-sASSERTIONS=0'))
+    self.assertNotEqual(first, read_file('a.out.js'))
+    self.assertContained('foo: 1, assertions: 8', self.run_js('a.out.js'))
+    # So are the contents of the libraries.
+    create_file('lib.js', read_file('lib.js').replace('return 1', 'return 2'))
+    self.assertContained('JS compiler cache miss: %s has changed' % os.path.abspath('lib.js'), link())
+    self.assertContained('foo: 2', self.run_js('a.out.js'))
+    self.assertContained('JS compiler cache hit', link())
+    # Without the setting the cache is not used.
+    stderr = self.run_process([EMCC, 'main.c', '--js-library', 'lib.js'], stderr=PIPE, env=dict(os.environ, EMCC_DEBUG='1')).stderr
+    self.assertNotContained('JS compiler cache', stderr)
+
+  def test_incremental_link(self):
+    create_file('main.c', r'''
+      #include <stdio.h>
+      int get_value();
+      int main() { printf("value: %d\\n", get_value()); }
+    ''')
+    create_file('value.c', 'int get_value() { return 1; }\n')
+    self.run_process([EMCC, '-c', 'main.c'])
+
+    def relink(value_c):
+      create_file('value.c', value_c)
+      self.run_process([EMCC, '-c', 'value.c'])
+      with env_modify({'EMCC_DEBUG': '1'}):
+        return self.run_process([EMCC, 'main.o', 'value.o', '-sINCREMENTAL_LINK'], stderr=PIPE).stderr
+
+    self.assertContained('full link: post-link took', relink('int get_value() { return 1; }\n'))
+    self.assertContained('value: 1', self.run_js('a.out.js'))
+    self.assertExists('a.out.wasm.link-state')
+    js = read_file('a.out.js')
+
+    # Only the code of a function changed: the JS is kept.
+    stderr = relink('int get_value() { return 2; }\n')
+    self.assertContained('incremental link: keeping the JS from the previous link', stderr)
+    self.assertContained('incremental link: post-link took', stderr)
+    self.assertEqual(js, read_file('a.out.js'))
+    self.assertContained('value: 2', self.run_js('a.out.js'))
+
+    # Data changes need a full link.
+    stderr = relink('static const char* s = "hello"; int get_value() { return s[0]; }\n')
+    self.assertContained('incremental link: wasm layout changed', stderr)
+    self.assertContained('value: 104', self.run_js('a.out.js'))
+
+    # So do new imports.
+    stderr = relink('#include <emscripten.h>\nint get_value() { return (int)emscripten_get_now() * 0 + 3; }\n')
+    self.assertContained('incremental link: wasm layout changed', stderr)
+    self.assertContained('value: 3', self.run_js('a.out.js'))
+
+    # And changes to the JS inputs.
+    create_file('pre.js', 'out("pre");\n')
+    with env_modify({'EMCC_DEBUG': '1'}):
+      stderr = self.run_process([EMCC, 'main.o', 'value.o', '-sINCREMENTAL_LINK', '--pre-js', 'pre.js'], stderr=PIPE).stderr
+    self.assertContained('incremental link: settings or JS inputs changed', stderr)
+    self.assertContained('pre\nvalue: 3', self.run_js('a.out.js'))
+
+    # Optimized builds are not linked incrementally.
+    with env_modify({'EMCC_DEBUG': '1'}):
+      stderr = self.run_process([EMCC, 'main.o', 'value.o', '-sINCREMENTAL_LINK', '-O2'], stderr=PIPE).stderr
+    self.assertContained('INCREMENTAL_LINK is ignored with -O2 and above', stderr)
+
+  def test_js_optimizer_cache(self):
+    # A unique string keeps earlier test runs from having cached the output.
+    create_file('main.c', r'''
+      #include <stdio.h>
+      int main() { puts("hello %s"); }
+    ''' % uuid.uuid4())
+
+    def link(*args):
+      with env_modify({'EM_JS_OPTIMIZER_CACHE_SIZE': '64', 'EMCC_DEBUG': '1'}):
+        return self.run_process([EMCC, 'main.c', '-O2', '-sWASM=0'] + list(args), stderr=PIPE).stderr
+
+    stderr = link()
+    self.assertContained('JS optimizer cache miss', stderr)
+    self.assertContained('hello', self.run_js('a.out.js'))
+    first = read_file('a.out.js')
+    stderr = link()
+    self.assertContained('JS optimizer cache hit', stderr)
+    self.assertNotContained('JS optimizer cache miss', stderr)
+    self.assertEqual(first, read_file('a.out.js'))
+
+  @unittest.skipIf(WINDOWS, 'the JS optimizer daemon is not used on windows')
+  def test_js_optimizer_daemon(self):
+    self.run_process([EMCC, test_file('hello_world.c'), '-O2', '-sWASM=0'])
+    expected = read_file('a.out.js')
+    for _ in range(2):
+      with env_modify({'EM_JS_OPTIMIZER_DAEMON': '5'}):
+        self.run_process([EMCC, test_file('hello_world.c'), '-O2', '-sWASM=0'])
+      self.assertEqual(expected, read_file('a.out.js'))
+
   def test_llvm_option_dash_o(self):
     # emcc used to interpret -mllvm's option value as the output file if it
     # began with -o
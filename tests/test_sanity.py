@@ -705,6 +705,20 @@ fi
     # Unless --force is specified
     self.assertContained('generating system library', self.do([EMBUILDER, 'build', 'libemmalloc', '--force']))
 
+  def test_embuilder_parallel(self):
+    restore_and_set_up()
+    self.clear_cache()
+    # Libraries requested together are compiled in one pool of jobs, and each
+    # one is archived into the cache on its own.
+    output = self.do([EMBUILDER, 'build', 'libemmalloc', 'libemmalloc-debug', 'libstubs'])
+    self.assertContained('building 3 system libraries in parallel', output)
+    for lib in ('libemmalloc.a', 'libemmalloc-debug.a', 'libstubs.a'):
+      self.assertContained('generating system library: ' + os.path.join('sysroot', 'lib', 'wasm32-emscripten', lib), output)
+      self.assertExists(os.path.join(config.CACHE, 'sysroot', 'lib', 'wasm32-emscripten', lib))
+    # The build directories are removed once the libraries are archived.
+    self.assertFalse(os.listdir(os.path.join(config.CACHE, 'build')))
+    self.assertNotContained('generating system library', self.do([EMBUILDER, 'build', 'libemmalloc', 'libstubs']))
+
   def test_embuilder_force_port(self):
     restore_and_set_up()
     self.do([EMBUILDER, 'build', 'zlib'])
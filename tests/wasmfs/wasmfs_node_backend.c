@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <dirent.h>
+#include <emscripten/wasmfs.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Mounts a host directory with the Node backend and does I/O in chunks small
+// and large enough to exercise both the buffered and unbuffered paths.
+
+int main() {
+  backend_t backend = wasmfs_create_node_backend("node_root");
+  assert(backend);
+  assert(wasmfs_create_directory("/host", 0777, backend) == 0);
+  assert(wasmfs_create_directory("/host", 0777, backend) == -EEXIST);
+
+  int fd = open("/host/small.txt", O_CREAT | O_RDWR, 0644);
+  assert(fd >= 0);
+  char buf[256];
+  for (int i = 0; i < 20000; i++) {
+    int len = sprintf(buf, "%d,", i);
+    assert(write(fd, buf, len) == len);
+  }
+  struct stat st;
+  assert(fstat(fd, &st) == 0);
+  printf("size: %lld\n", (long long)st.st_size);
+
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+  memset(buf, 0, sizeof(buf));
+  assert(read(fd, buf, 10) == 10);
+  printf("head: %s\n", buf);
+  assert(lseek(fd, -6, SEEK_END) == st.st_size - 6);
+  memset(buf, 0, sizeof(buf));
+  assert(read(fd, buf, sizeof(buf)) == 6);
+  printf("tail: %s\n", buf);
+
+  // Overwrite in the middle, then read around it.
+  assert(lseek(fd, 4, SEEK_SET) == 4);
+  assert(write(fd, "XX", 2) == 2);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+  memset(buf, 0, sizeof(buf));
+  assert(read(fd, buf, 10) == 10);
+  printf("patched: %s\n", buf);
+  assert(close(fd) == 0);
+
+  // A large write and read go straight through to the host.
+  static char big[256 * 1024];
+  for (int i = 0; i < sizeof(big); i++) {
+    big[i] = i % 251;
+  }
+  fd = open("/host/big.dat", O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  assert(fd >= 0);
+  assert(write(fd, big, sizeof(big)) == sizeof(big));
+  assert(close(fd) == 0);
+  memset(big, 0, sizeof(big));
+  fd = open("/host/big.dat", O_RDONLY);
+  assert(fd >= 0);
+  assert(read(fd, big, sizeof(big)) == sizeof(big));
+  for (int i = 0; i < sizeof(big); i++) {
+    assert(big[i] == (char)(i % 251));
+  }
+  assert(close(fd) == 0);
+
+  assert(mkdir("/host/subdir", 0777) == 0);
+  assert(stat("/host/subdir", &st) == 0 && S_ISDIR(st.st_mode));
+  assert(unlink("/host/big.dat") == 0);
+  assert(stat("/host/big.dat", &st) == -1 && errno == ENOENT);
+
+  DIR* dir = opendir("/host");
+  assert(dir);
+  struct dirent* entry;
+  while ((entry = readdir(dir))) {
+    printf("entry: %s\n", entry->d_name);
+  }
+  closedir(dir);
+
+  // Files that are no longer in use close their host descriptors, so more
+  // files can be used than a process can have open.
+  for (int i = 0; i < 5000; i++) {
+    char path[64];
+    sprintf(path, "/host/subdir/%d", i);
+    fd = open(path, O_CREAT | O_WRONLY, 0644);
+    assert(fd >= 0);
+    assert(write(fd, path, strlen(path)) == strlen(path));
+    assert(close(fd) == 0);
+    assert(stat(path, &st) == 0 && st.st_size == strlen(path));
+  }
+  for (int i = 0; i < 5000; i++) {
+    char path[64];
+    sprintf(path, "/host/subdir/%d", i);
+    assert(unlink(path) == 0);
+  }
+  puts("many files ok");
+
+  // Truncating after a buffered write flushes it, and the size is the new one.
+  fd = open("/host/truncated.txt", O_CREAT | O_RDWR, 0644);
+  assert(fd >= 0);
+  assert(pwrite(fd, "hello", 5, 1000) == 5);
+  assert(ftruncate(fd, 10) == 0);
+  assert(fstat(fd, &st) == 0);
+  printf("truncated size: %lld\n", (long long)st.st_size);
+  assert(close(fd) == 0);
+  assert(unlink("/host/truncated.txt") == 0);
+
+  assert(rmdir("/host/subdir") == 0);
+  puts("done");
+  return 0;
+}
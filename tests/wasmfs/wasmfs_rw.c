@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Exercises the basic file and directory operations. The output must be the
+// same with the JS FS and with WASMFS.
+
+int main() {
+  assert(mkdir("/working", 0777) == 0);
+  assert(mkdir("/working", 0777) == -1 && errno == EEXIST);
+  assert(chdir("/working") == 0);
+
+  char cwd[128];
+  assert(getcwd(cwd, sizeof(cwd)));
+  printf("cwd: %s\n", cwd);
+
+  int fd = open("file.txt", O_CREAT | O_RDWR, 0644);
+  assert(fd >= 0);
+  const char* msg = "Hello, world!";
+  assert(write(fd, msg, strlen(msg)) == strlen(msg));
+
+  assert(lseek(fd, 7, SEEK_SET) == 7);
+  char buf[64] = {0};
+  assert(read(fd, buf, sizeof(buf)) == 6);
+  printf("read: %s\n", buf);
+
+  // Reading at the end of the file returns 0.
+  assert(read(fd, buf, sizeof(buf)) == 0);
+
+  memset(buf, 0, sizeof(buf));
+  assert(pread(fd, buf, 5, 0) == 5);
+  printf("pread: %s\n", buf);
+  assert(pwrite(fd, "W", 1, 7) == 1);
+  assert(lseek(fd, 0, SEEK_END) == strlen(msg));
+
+  // dup'd descriptors share the file position.
+  int fd2 = dup(fd);
+  assert(fd2 >= 0 && fd2 != fd);
+  assert(lseek(fd2, 0, SEEK_SET) == 0);
+  assert(lseek(fd, 0, SEEK_CUR) == 0);
+  memset(buf, 0, sizeof(buf));
+  assert(read(fd, buf, sizeof(buf)) == strlen(msg));
+  printf("read after dup: %s\n", buf);
+  assert(close(fd2) == 0);
+
+  struct stat st;
+  assert(fstat(fd, &st) == 0);
+  printf("size: %d, regular: %d\n", (int)st.st_size, S_ISREG(st.st_mode));
+  assert(ftruncate(fd, 5) == 0);
+  assert(stat("/working/../working/./file.txt", &st) == 0);
+  printf("size after truncate: %d\n", (int)st.st_size);
+  assert(close(fd) == 0);
+  assert(close(fd) == -1 && errno == EBADF);
+
+  assert(open("missing.txt", O_RDONLY) == -1 && errno == ENOENT);
+  assert(open("file.txt", O_CREAT | O_EXCL | O_WRONLY, 0644) == -1 &&
+         errno == EEXIST);
+
+  // Appending always writes at the end.
+  fd = open("file.txt", O_WRONLY | O_APPEND);
+  assert(fd >= 0);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+  assert(write(fd, "!!", 2) == 2);
+  assert(close(fd) == 0);
+
+  FILE* f = fopen("file.txt", "r");
+  assert(f);
+  memset(buf, 0, sizeof(buf));
+  assert(fgets(buf, sizeof(buf), f));
+  printf("fgets: %s\n", buf);
+  fclose(f);
+
+  assert(mkdir("subdir", 0777) == 0);
+  assert(stat("subdir", &st) == 0 && S_ISDIR(st.st_mode));
+  assert(open("subdir", O_WRONLY) == -1 && errno == EISDIR);
+
+  DIR* dir = opendir(".");
+  assert(dir);
+  struct dirent* entry;
+  while ((entry = readdir(dir))) {
+    printf("entry: %s (%s)\n",
+           entry->d_name,
+           entry->d_type == DT_DIR ? "dir" : "file");
+  }
+  closedir(dir);
+
+  assert(rmdir("/working") == -1 && errno == ENOTEMPTY);
+  assert(unlink("subdir") == -1 && errno == EISDIR);
+  assert(rmdir("subdir") == 0);
+  assert(unlink("file.txt") == 0);
+  assert(stat("file.txt", &st) == -1 && errno == ENOENT);
+  assert(chdir("/") == 0);
+  assert(rmdir("/working") == 0);
+
+  printf("done\n");
+  return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Uploads data to a context that is proxied to the main browser thread, which
+// copies it to a staging arena, and checks that the draws see the right data.
+// The uploads overwrite their source right away, go through the arena several
+// times over, and some come from a thread that exits before they run.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/html5.h>
+#include <GLES2/gl2.h>
+
+#define CHUNK_SIZE 65536
+#define NUM_CHUNKS 200
+
+static EMSCRIPTEN_WEBGL_CONTEXT_HANDLE ctx;
+static GLint colorLocation;
+static float chunk[CHUNK_SIZE / sizeof(float)];
+
+static GLuint compile_shader(GLenum shaderType, const char *src)
+{
+  GLuint shader = glCreateShader(shaderType);
+  glShaderSource(shader, 1, &src, NULL);
+  glCompileShader(shader);
+  GLint isCompiled = 0;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+  assert(isCompiled);
+  return shader;
+}
+
+static void check_center_pixel(unsigned char r, unsigned char g, unsigned char b)
+{
+  unsigned char pixel[4];
+  glReadPixels(150, 75, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+  printf("pixel: %d %d %d %d\n", pixel[0], pixel[1], pixel[2], pixel[3]);
+  assert(pixel[0] == r && pixel[1] == g && pixel[2] == b && pixel[3] == 255);
+}
+
+static void *set_color_and_exit(void *arg)
+{
+  emscripten_webgl_make_context_current(ctx);
+  float color[4] = { 0, 0, 1, 1 };
+  glUniform4fv(colorLocation, 1, color);
+  // The uploads of this thread may still be queued when it exits.
+  return NULL;
+}
+
+int main()
+{
+  EmscriptenWebGLContextAttributes attr;
+  emscripten_webgl_init_context_attributes(&attr);
+  attr.proxyContextToMainThread = EMSCRIPTEN_WEBGL_CONTEXT_PROXY_ALWAYS;
+  attr.renderViaOffscreenBackBuffer = EM_TRUE;
+  attr.preserveDrawingBuffer = EM_TRUE;
+  ctx = emscripten_webgl_create_context("#canvas", &attr);
+  assert(ctx);
+  emscripten_webgl_make_context_current(ctx);
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, compile_shader(GL_VERTEX_SHADER,
+    "attribute vec2 apos;"
+    "void main() { gl_Position = vec4(apos, 0.0, 1.0); }"));
+  glAttachShader(program, compile_shader(GL_FRAGMENT_SHADER,
+    "precision mediump float;"
+    "uniform vec4 color;"
+    "uniform sampler2D tex;"
+    "void main() { gl_FragColor = color * texture2D(tex, vec2(0.5)); }"));
+  glBindAttribLocation(program, 0, "apos");
+  glLinkProgram(program);
+  glUseProgram(program);
+  colorLocation = glGetUniformLocation(program, "color");
+
+  unsigned char texel[4] = { 255, 255, 255, 255 };
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+  memset(texel, 0, sizeof(texel));
+  texel[1] = texel[3] = 255;
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+  memset(texel, 0, sizeof(texel));
+
+  float color[4] = { 1, 1, 1, 1 };
+  glUniform4fv(colorLocation, 1, color);
+  memset(color, 0, sizeof(color));
+
+  // A triangle that covers the whole canvas, uploaded last after many chunks
+  // that only hold degenerate triangles.
+  GLuint buffer;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, CHUNK_SIZE, chunk, GL_STATIC_DRAW);
+  for (int i = 0; i < NUM_CHUNKS; i++)
+  {
+    if (i == NUM_CHUNKS - 1)
+    {
+      float triangle[6] = { -1, -1, 3, -1, -1, 3 };
+      memcpy(chunk, triangle, sizeof(triangle));
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, CHUNK_SIZE, chunk);
+    memset(chunk, 0, sizeof(chunk));
+  }
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  glEnableVertexAttribArray(0);
+
+  glClearColor(0, 0, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  check_center_pixel(0, 255, 0);
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, set_color_and_exit, NULL);
+  pthread_join(thread, NULL);
+  texel[0] = texel[1] = texel[2] = texel[3] = 255;
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  check_center_pixel(0, 0, 255);
+
+  printf("Test passed\n");
+  return 0;
+}
@@ -0,0 +1,54 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Times calls through the bindings generated from test.idl, for the common
+// kinds of arguments and return values.
+
+function benchmark(name, iterations, func) {
+  func(); // warm up
+  var start = Date.now();
+  for (var i = 0; i < iterations; i++) {
+    func();
+  }
+  var time = Date.now() - start;
+  console.log(name + ' calls per ms: ' + Math.round(iterations / Math.max(time, 1)));
+}
+
+var parent = new Module.Parent(42);
+benchmark('number', 1000000, function() {
+  parent.getVal();
+});
+
+var refUser = new Module.RefUser(10);
+benchmark('wrapped pointer', 1000000, function() {
+  refUser.getMe();
+});
+
+benchmark('string', 100000, function() {
+  Module.destroy(new Module.StringUser('a string argument', 1));
+});
+
+var N = 1024;
+var storeArray = new Module.StoreArray();
+var array = [];
+for (var i = 0; i < N; i++) {
+  array.push(i);
+}
+benchmark('array', 100000, function() {
+  storeArray.setArray(array);
+});
+
+// A view into the heap is passed without being copied, so the C++ side sees
+// later changes to it.
+var ptr = Module._malloc(N * 4);
+var view = new Int32Array(Module.HEAP32.buffer, ptr, N);
+view.set(array);
+benchmark('heap view', 100000, function() {
+  storeArray.setArray(view);
+});
+view[7] = 1234;
+assert(storeArray.getArrayValue(7) === 1234);
+console.log('heap view ok');
+Module._free(ptr);
@@ -1799,64 +1799,17 @@ function reattachComments(ast, comments) {
 
 // Main
 
-var suffix = '';
-
-var arguments = process['argv'].slice(2);;
-// If enabled, output retains parentheses and comments so that the
-// output can further be passed out to Closure.
-var closureFriendly = arguments.indexOf('--closureFriendly');
-if (closureFriendly > -1) {
-  arguments.splice(closureFriendly, 1);
-  closureFriendly = true;
-} else {
-  closureFriendly = false;
-}
-
-var exportES6 = arguments.indexOf('--exportES6');
-if (exportES6 > -1) {
-  arguments.splice(exportES6, 1);
-  exportES6 = true;
-} else {
-  exportES6 = false;
-}
-
-var infile = arguments[0];
-var passes = arguments.slice(1);
-
-var input = read(infile);
-var extraInfoStart = input.lastIndexOf('// EXTRA_INFO:')
-var extraInfo = null;
-if (extraInfoStart > 0) {
-  extraInfo = JSON.parse(input.substr(extraInfoStart + 14));
-}
+var suffix;
+var closureFriendly;
+var exportES6;
+var extraInfo;
 // Collect all JS code comments to this array so that we can retain them in the outputted code
 // if --closureFriendly was requested.
-var sourceComments = [];
+var sourceComments;
 var ast;
-try {
-  ast = acorn.parse(input, {
-    // Keep in sync with --language_in that we pass to closure in building.py
-    ecmaVersion: 2020,
-    preserveParens: closureFriendly,
-    onComment: closureFriendly ? sourceComments : undefined,
-    sourceType: exportES6 ? "module" : "script",
-  });
-} catch (err) {
-  err.message += (function() {
-    var errorMessage = '\n' + input.split(acorn.lineBreak)[err.loc.line - 1] + '\n';
-    var column = err.loc.column;
-    while (column--) {
-      errorMessage += ' ';
-    }
-    errorMessage += '^\n';
-    return errorMessage;
-  })();
-  throw err;
-}
-
-var minifyWhitespace = false;
-var noPrint = false;
-var verbose = false;
+var minifyWhitespace;
+var noPrint;
+var verbose;
 
 var registry = {
   JSDCE: JSDCE,
@@ -1878,23 +1831,99 @@ var registry = {
   minifyGlobals: minifyGlobals,
 };
 
-passes.forEach(function(pass) {
-  registry[pass](ast);
-});
+// Runs the optimizer with the given command line arguments: the input file
+// followed by the passes to run.
+function runOptimizer(args) {
+  suffix = '';
+  args = args.slice();
+
+  // If enabled, output retains parentheses and comments so that the
+  // output can further be passed out to Closure.
+  closureFriendly = args.indexOf('--closureFriendly');
+  if (closureFriendly > -1) {
+    args.splice(closureFriendly, 1);
+    closureFriendly = true;
+  } else {
+    closureFriendly = false;
+  }
+
+  exportES6 = args.indexOf('--exportES6');
+  if (exportES6 > -1) {
+    args.splice(exportES6, 1);
+    exportES6 = true;
+  } else {
+    exportES6 = false;
+  }
 
-if (!noPrint) {
-  var terserAst = terser.AST_Node.from_mozilla_ast(ast);
+  var infile = args[0];
+  var passes = args.slice(1);
 
-  if (closureFriendly) {
-    reattachComments(terserAst, sourceComments);
+  var input = read(infile);
+  var extraInfoStart = input.lastIndexOf('// EXTRA_INFO:')
+  extraInfo = null;
+  if (extraInfoStart > 0) {
+    extraInfo = JSON.parse(input.substr(extraInfoStart + 14));
   }
+  sourceComments = [];
+  try {
+    ast = acorn.parse(input, {
+      // Keep in sync with --language_in that we pass to closure in building.py
+      ecmaVersion: 2020,
+      preserveParens: closureFriendly,
+      onComment: closureFriendly ? sourceComments : undefined,
+      sourceType: exportES6 ? "module" : "script",
+    });
+  } catch (err) {
+    err.message += (function() {
+      var errorMessage = '\n' + input.split(acorn.lineBreak)[err.loc.line - 1] + '\n';
+      var column = err.loc.column;
+      while (column--) {
+        errorMessage += ' ';
+      }
+      errorMessage += '^\n';
+      return errorMessage;
+    })();
+    throw err;
+  }
+
+  minifyWhitespace = false;
+  noPrint = false;
+  verbose = false;
 
-  var output = terserAst.print_to_string({
-    beautify: !minifyWhitespace,
-    indent_level: minifyWhitespace ? 0 : 1,
-    keep_quoted_props: true, // for closure
-    comments: true // for closure as well
+  passes.forEach(function(pass) {
+    registry[pass](ast);
   });
-  print(output);
-  if (suffix) print(suffix);
+
+  if (!noPrint) {
+    var terserAst = terser.AST_Node.from_mozilla_ast(ast);
+
+    if (closureFriendly) {
+      reattachComments(terserAst, sourceComments);
+    }
+
+    var output = terserAst.print_to_string({
+      beautify: !minifyWhitespace,
+      indent_level: minifyWhitespace ? 0 : 1,
+      keep_quoted_props: true, // for closure
+      comments: true // for closure as well
+    });
+    print(output);
+    if (suffix) print(suffix);
+  }
+  ast = null;
+}
+
+if (require.main === module) {
+  runOptimizer(process['argv'].slice(2));
+} else {
+  // Used by js-optimizer-server.js, which runs many optimizations in one
+  // process.
+  module.exports = {
+    run: function(args, printOut, printError) {
+      print = printOut;
+      printErr = printError;
+      warnOnce.msgs = {};
+      runOptimizer(args);
+    },
+  };
 }
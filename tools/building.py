@@ -11,6 +11,7 @@ import os
 import re
 import shlex
 import shutil
+import struct
 import subprocess
 import sys
 import tempfile
@@ -22,6 +23,7 @@ from . import shared
 from . import webassembly
 from . import config
 from . import utils
+from . import js_optimizer_server
 from .shared import CLANG_CC, CLANG_CXX, PYTHON
 from .shared import LLVM_NM, EMCC, EMAR, EMXX, EMRANLIB, WASM_LD, LLVM_AR
 from .shared import LLVM_LINK, LLVM_OBJCOPY
@@ -616,7 +618,6 @@ def js_optimizer(filename, passes):
 
 # run JS optimizer on some JS, ignoring asm.js contents if any - just run on it all
 def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
-  optimizer = path_from_root('tools/acorn-optimizer.js')
   original_filename = filename
   if extra_info is not None:
     temp_files = configuration.get_temp_files()
@@ -625,23 +626,24 @@ def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
     with open(temp, 'a') as f:
       f.write('// EXTRA_INFO: ' + extra_info)
     filename = temp
-  cmd = config.NODE_JS + [optimizer, filename] + passes
+  args = list(passes)
   # Keep JS code comments intact through the acorn optimization pass so that JSDoc comments
   # will be carried over to a later Closure run.
   if settings.USE_CLOSURE_COMPILER:
-    cmd += ['--closureFriendly']
+    args += ['--closureFriendly']
   if settings.EXPORT_ES6:
-    cmd += ['--exportES6']
+    args += ['--exportES6']
   if settings.VERBOSE:
-    cmd += ['verbose']
+    args += ['verbose']
   if not return_output:
     next = original_filename + '.jso.js'
     configuration.get_temp_files().note(next)
-    check_call(cmd, stdout=open(next, 'w'))
+    js_optimizer_server.run_jobs([(filename, args, next)])
     save_intermediate(next, '%s.js' % passes[0])
     return next
-  output = check_call(cmd, stdout=PIPE).stdout
-  return output
+  with configuration.get_temp_files().get_file('.jso.js') as temp:
+    js_optimizer_server.run_jobs([(filename, args, temp)])
+    return utils.read_file(temp)
 
 
 # evals ctors. if binaryen_bin is provided, it is the dir of the binaryen tool
@@ -656,6 +658,47 @@ def eval_ctors(js_file, binary_file, debug_info=False): # noqa
   # check_call(cmd)
 
 
+def take_snapshot(js_file, wasm_file):
+  """Runs the program in node until it calls emscripten_snapshot_point(), and
+  makes memory at that point the initial memory of the wasm. The files that the
+  program created are stored after the end of the heap. See
+  src/library_snapshot.js."""
+  output = configuration.get_temp_files().get('.snapshot').name
+  configuration.get_temp_files().note(output + '.json')
+  configuration.get_temp_files().note(output + '.files')
+  env = os.environ.copy()
+  env['EMCC_SNAPSHOT_OUTPUT'] = output
+  # Modularized output exports a factory, which has to be called to run the
+  # program.
+  script = 'var m = require(%s); if (typeof m === "function") m();' % json.dumps(os.path.abspath(js_file))
+  logger.debug('taking snapshot: %s' % js_file)
+  proc = run_process(config.NODE_JS + ['-e', script], env=env, stdout=PIPE, stderr=PIPE, check=False)
+  if not os.path.exists(output + '.json'):
+    message = 'SNAPSHOT: the program did not reach emscripten_snapshot_point()'
+    if proc.stdout or proc.stderr:
+      message += ':\n' + proc.stdout + proc.stderr
+    exit_with_error(message)
+  info = json.loads(utils.read_file(output + '.json'))
+  memory = bytearray(utils.read_binary(output))
+  files = utils.read_binary(output + '.files')
+  logger.debug('snapshot: %d bytes of memory, %d bytes of files, stack pointer %d' % (len(memory), len(files), info['stackPointer']))
+
+  # main() starts over when the program runs, so nothing on the stack is live.
+  # The stack grows down from stackBase to stackEnd.
+  stack_base = min(info['stackBase'], len(memory))
+  memory[info['stackEnd']:stack_base] = bytes(stack_base - info['stackEnd'])
+  # Store the files after the heap, which malloc can reuse once they have been
+  # read back at startup.
+  files_ptr = (len(memory) + 15) & -16
+  memory += bytes(files_ptr - len(memory)) + files
+  # Fill in the state in _emscripten_snapshot_state(): restored, files.
+  state = info['state']
+  memory[state:state + 8] = struct.pack('<II', 1, files_ptr)
+
+  save_intermediate(wasm_file, 'pre-snapshot.wasm')
+  webassembly.set_initial_memory(wasm_file, memory)
+
+
 def get_closure_compiler():
   # First check if the user configured a specific CLOSURE_COMPILER in thier settings
   if config.CLOSURE_COMPILER:
@@ -0,0 +1,202 @@
+# Copyright 2021 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""A content addressed cache for the object files that emcc compiles.
+
+This is enabled by setting COMPILE_CACHE_SIZE (in megabytes) in the config file
+or EM_COMPILE_CACHE_SIZE in the environment. The cache key is a hash of the
+preprocessed source, the full clang command line (which includes the flags
+emcc adds itself) and the toolchain version, so that an object file is reused
+whenever compiling would produce the same result. Entries live in the
+`compile_cache` directory of the emscripten cache, and the least recently used
+ones are deleted when it grows larger than COMPILE_CACHE_SIZE.
+
+As with other compiler caches, warnings are only shown when a file is actually
+compiled, and not when its object file comes from the cache.
+"""
+
+import hashlib
+import logging
+import os
+import shutil
+import subprocess
+
+from . import config, shared, utils
+from .toolchain_profiler import ToolchainProfiler
+
+logger = logging.getLogger('compile_cache')
+
+# Entries are spread over this many subdirectories, each of which gets an equal
+# share of the size limit, so that eviction only needs to look at one of them.
+NUM_SUBDIRS = 16
+
+# Flags whose effect on the output depends on files that are not part of the
+# preprocessed source, or that produce extra outputs.
+UNCACHEABLE_FLAG_PREFIXES = (
+  '-gsplit-dwarf',
+  '-save-temps',
+  '--save-temps',
+  '-ftime-trace',
+  '-fmodules',
+  '-include-pch',
+  '-fprofile-use',
+  '-fprofile-instr-use',
+  '-fprofile-sample-use',
+  '-fsanitize-blacklist',
+  '-fsanitize-ignorelist',
+)
+
+
+def get_max_size():
+  """Returns the size limit of the cache in bytes, or 0 if it is disabled."""
+  if not config.COMPILE_CACHE_SIZE or config.FROZEN_CACHE:
+    return 0
+  try:
+    megabytes = int(config.COMPILE_CACHE_SIZE)
+  except ValueError:
+    utils.exit_with_error('COMPILE_CACHE_SIZE must be a number of megabytes, not `%s`', config.COMPILE_CACHE_SIZE)
+  return max(megabytes, 0) * 1024 * 1024
+
+
+def get_cache_dir():
+  return shared.Cache.get_path('compile_cache')
+
+
+def get_toolchain_id(compiler):
+  """Identifies the emscripten and clang versions without running clang."""
+  if not hasattr(get_toolchain_id, 'ids'):
+    get_toolchain_id.ids = {}
+  if compiler not in get_toolchain_id.ids:
+    path = os.path.realpath(shutil.which(compiler) or compiler)
+    stat = os.stat(path)
+    get_toolchain_id.ids[compiler] = f'{shared.EMSCRIPTEN_VERSION}|{path}|{stat.st_size}|{stat.st_mtime_ns}'
+  return get_toolchain_id.ids[compiler]
+
+
+def is_cacheable(cmd, output_file):
+  if config.COMPILER_WRAPPER or output_file in ('-', os.devnull) or '-' in cmd:
+    return False
+  return not any(arg.startswith(UNCACHEABLE_FLAG_PREFIXES) for arg in cmd)
+
+
+def has_debug_info(cmd):
+  debug = False
+  for arg in cmd:
+    if arg.startswith('-g'):
+      debug = arg != '-g0'
+  return debug
+
+
+def get_preprocess_command(cmd, output_file):
+  pp_cmd = cmd + ['-E', '-o', '-', '-Wno-unused-command-line-argument']
+  # Dependency files are written as a side effect of preprocessing too. Make
+  # sure they name the object file as the target, and are written to the same
+  # place as when compiling.
+  if any(arg in ('-MD', '-MMD') for arg in cmd):
+    if not any(arg.startswith(('-MT', '-MQ')) for arg in cmd):
+      pp_cmd += ['-MT', output_file]
+    if not any(arg.startswith('-MF') for arg in cmd):
+      pp_cmd += ['-MF', shared.unsuffixed(output_file) + '.d']
+  return pp_cmd
+
+
+def get_key(cmd, output_file):
+  """Returns the cache key for compiling with `cmd`, or None if preprocessing
+  failed, in which case compiling will report the error."""
+  proc = shared.run_process(get_preprocess_command(cmd, output_file), check=False,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=False)
+  if proc.returncode != 0:
+    return None
+  h = hashlib.sha256()
+  h.update(get_toolchain_id(cmd[0]).encode('utf-8'))
+  for arg in cmd:
+    h.update(b'\0' + arg.encode('utf-8'))
+  # The compilation directory is part of the debug info.
+  if has_debug_info(cmd):
+    h.update(b'\0' + os.getcwd().encode('utf-8'))
+  h.update(b'\0' + proc.stdout)
+  return h.hexdigest()
+
+
+def get_entry_path(key):
+  return os.path.join(get_cache_dir(), key[0], key + '.o')
+
+
+def evict(subdir, max_size, suffix='.o', counter='compile cache evictions'):
+  """Deletes the least recently used entries (the files ending in `suffix`) in
+  `subdir` until it is smaller than `max_size`."""
+  entries = []
+  total = 0
+  with os.scandir(subdir) as it:
+    for entry in it:
+      if entry.name.endswith(suffix):
+        try:
+          stat = entry.stat()
+        except OSError:
+          continue
+        entries.append((stat.st_mtime, stat.st_size, entry.path))
+        total += stat.st_size
+  if total <= max_size:
+    return
+  # Leave some room so that we do not evict on every store.
+  target = max_size * 9 // 10
+  entries.sort()
+  for _, size, path in entries:
+    if total <= target:
+      break
+    try:
+      os.remove(path)
+      total -= size
+      ToolchainProfiler.record_counter(counter, 1)
+    except OSError:
+      pass
+
+
+def store(output_file, entry_path, max_size):
+  subdir = os.path.dirname(entry_path)
+  utils.safe_ensure_dirs(subdir)
+  # Other processes may be reading the entry, so write it to a temporary file
+  # first and move that into place.
+  temp_path = f'{entry_path}.{os.getpid()}.tmp'
+  try:
+    shutil.copyfile(output_file, temp_path)
+    os.replace(temp_path, entry_path)
+  except OSError as e:
+    logger.debug(f'failed to store {output_file} in the compile cache: {e}')
+    try:
+      os.remove(temp_path)
+    except OSError:
+      pass
+    return
+  evict(subdir, max_size // NUM_SUBDIRS)
+
+
+def compile(cmd, output_file):
+  """Runs `cmd -o output_file`, or copies the object file it would produce from
+  the cache."""
+  max_size = get_max_size()
+  key = None
+  if max_size and is_cacheable(cmd, output_file):
+    key = get_key(cmd, output_file)
+  if key:
+    entry_path = get_entry_path(key)
+    try:
+      shutil.copyfile(entry_path, output_file)
+      # Mark the entry as recently used.
+      os.utime(entry_path)
+      logger.debug(f'compile cache hit: {output_file}')
+      ToolchainProfiler.record_counter('compile cache hits', 1)
+      return
+    except FileNotFoundError:
+      pass
+    logger.debug(f'compile cache miss: {output_file}')
+    ToolchainProfiler.record_counter('compile cache misses', 1)
+  elif max_size:
+    ToolchainProfiler.record_counter('compile cache bypasses', 1)
+
+  shared.check_call(cmd + ['-o', output_file])
+  if key:
+    store(output_file, entry_path, max_size)
@@ -35,6 +35,10 @@ FROZEN_CACHE = None
 CACHE = None
 PORTS = None
 COMPILER_WRAPPER = None
+COMPILE_CACHE_SIZE = None
+JS_COMPILER_CACHE_SIZE = None
+JS_OPTIMIZER_CACHE_SIZE = None
+JS_OPTIMIZER_DAEMON = None
 
 
 def listify(x):
@@ -130,6 +134,10 @@ def parse_config_file():
     'CACHE',
     'PORTS',
     'COMPILER_WRAPPER',
+    'COMPILE_CACHE_SIZE',
+    'JS_COMPILER_CACHE_SIZE',
+    'JS_OPTIMIZER_CACHE_SIZE',
+    'JS_OPTIMIZER_DAEMON',
   )
 
   # Only propagate certain settings from the config file.
@@ -173,7 +173,7 @@ _deps_info = {
   'localtime': ['_get_tzname', '_get_daylight', '_get_timezone', 'malloc'],
   'localtime_r': ['_get_tzname', '_get_daylight', '_get_timezone', 'malloc'],
   'mktime': ['_get_tzname', '_get_daylight', '_get_timezone', 'malloc'],
-  'mmap': ['memalign'],
+  'mmap': ['memalign', 'free'],
   'munmap': ['free'],
   'pthread_create': ['malloc', 'free', 'emscripten_main_thread_process_queued_calls'],
   'recv': ['htons'],
@@ -216,4 +216,15 @@ def get_deps_info():
   if settings.USE_PTHREADS:
     _deps_info['emscripten_set_canvas_element_size_calling_thread'] = ['_emscripten_call_on_thread']
     _deps_info['emscripten_set_offscreencanvas_size_on_target_thread'] = ['_emscripten_call_on_thread', 'malloc', 'free']
+  if settings.MEMFS_HEAP_STORAGE:
+    _deps_info['mmap'] = ['memalign', 'malloc', 'realloc', 'free']
+  if settings.OPENAL_MIXER:
+    _deps_info['alcCreateContext'] = [
+      'malloc', 'free',
+      'emscripten_al_mixer_create', 'emscripten_al_mixer_destroy',
+      'emscripten_al_mixer_play', 'emscripten_al_mixer_stop',
+      'emscripten_al_mixer_set_voice_rate', 'emscripten_al_mixer_set_voice_loop',
+      'emscripten_al_mixer_set_voice_gains', 'emscripten_al_mixer_render',
+      'emscripten_al_mixer_read', 'emscripten_al_mixer_get_time',
+    ]
   return _deps_info
@@ -0,0 +1,202 @@
+# Copyright 2021 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""Incremental relinking of -O0 and -O1 builds (-s INCREMENTAL_LINK).
+
+After a full link we save a state file next to the wasm output, which records:
+- a key for everything the JS output depends on besides the wasm: the
+  settings, the command line, pre/post JS, JS libraries, and the emscripten
+  sources.
+- a hash of the parts of the linked wasm that the JS depends on. That is
+  every section except the code section and the debug info, plus the code of
+  main (wasm-emscripten-finalize reports whether main reads argc/argv).
+- the metadata reported by wasm-emscripten-finalize.
+- hashes of the JS output files.
+
+If all of these still match after the next run of wasm-ld, only the bodies of
+functions changed, so the JS from the previous link is still correct, and emcc
+only processes the wasm (see phase_incremental_post_link). In every other case
+it does a full link.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import sys
+
+from . import shared, utils, webassembly
+from .settings import settings
+
+logger = logging.getLogger('incremental_link')
+
+STATE_VERSION = 1
+
+# Custom sections that the JS output does not depend on.
+IGNORED_CUSTOM_SECTIONS = ('.debug', 'name', 'producers', 'sourceMappingURL', 'external_debug_info')
+
+# Exports whose code wasm-emscripten-finalize looks at.
+MAIN_EXPORTS = ('main', '__main_argc_argv')
+
+
+def get_unsupported_reason(options):
+  """Returns why this link cannot be done incrementally, or None if it can.
+  These are the builds where some output other than the wasm depends on the
+  code, or which have outputs that we do not track."""
+  if settings.OPT_LEVEL >= 2:
+    return '-O2 and above'
+  checks = [
+    (settings.WASM2JS, 'WASM2JS'),
+    (settings.WASM2C, 'WASM2C'),
+    (settings.SINGLE_FILE, 'SINGLE_FILE'),
+    (settings.EVAL_CTORS, 'EVAL_CTORS'),
+    (settings.SNAPSHOT, 'SNAPSHOT'),
+    (settings.GENERATE_SOURCE_MAP, 'source maps'),
+    (settings.ASYNCIFY_LAZY_LOAD_CODE, 'ASYNCIFY_LAZY_LOAD_CODE'),
+    (settings.SPLIT_MODULE, 'SPLIT_MODULE'),
+    (settings.RELOCATABLE, 'dynamic linking'),
+    (settings.PROXY_TO_WORKER, 'PROXY_TO_WORKER'),
+    (not settings.MEM_INIT_IN_WASM, 'a memory init file'),
+    (options.use_closure_compiler, 'closure'),
+    (options.preload_files or options.embed_files, 'packaged files'),
+  ]
+  for check, reason in checks:
+    if check:
+      return reason
+  return None
+
+
+def get_state_file(wasm_target):
+  return wasm_target + '.link-state'
+
+
+def hash_file(path):
+  h = hashlib.sha256()
+  with open(path, 'rb') as f:
+    for chunk in iter(lambda: f.read(1024 * 1024), b''):
+      h.update(chunk)
+  return h.hexdigest()
+
+
+def get_js_key(options, target):
+  """Hashes everything the JS output depends on besides the wasm."""
+  h = hashlib.sha256()
+
+  def add(value):
+    h.update(json.dumps(value, sort_keys=True).encode('utf-8') + b'\0')
+
+  add(shared.EMSCRIPTEN_VERSION)
+  add(os.path.abspath(target))
+  add(sys.argv[1:])
+  add(sorted((k, v) for k, v in os.environ.items() if k.startswith(('EMCC_', 'EM_'))))
+  add(settings.dict())
+  add([options.pre_js, options.post_js, options.extern_pre_js, options.extern_post_js, options.js_transform])
+  add(hash_file(options.shell_path))
+  for _, library in settings.JS_LIBRARIES:
+    if os.path.isabs(library):
+      add(hash_file(library))
+  # The code that produces the JS. Sizes and modification times are enough to
+  # notice when it is edited.
+  sources = [utils.path_from_root('emcc.py'), utils.path_from_root('emscripten.py')]
+  for subdir in ('src', 'tools'):
+    for root, dirs, files in os.walk(utils.path_from_root(subdir)):
+      dirs[:] = sorted(d for d in dirs if d not in ('__pycache__', 'node_modules'))
+      sources += [os.path.join(root, f) for f in sorted(files) if not f.endswith('.pyc')]
+  for source in sources:
+    stat = os.stat(source)
+    add([os.path.relpath(source, utils.path_from_root()), stat.st_size, stat.st_mtime_ns])
+  return h.hexdigest()
+
+
+def get_layout_hash(wasm_file):
+  """Hashes all of the wasm file except function bodies and debug info. The
+  bodies of the main function are included."""
+  module = webassembly.Module(wasm_file)
+  exports = module.get_exports()
+  num_imported_funcs = len([i for i in module.get_imports() if i.kind == webassembly.ExternType.FUNC])
+  main_bodies = {e.index - num_imported_funcs for e in exports
+                 if e.kind == webassembly.ExternType.FUNC and e.name in MAIN_EXPORTS}
+
+  h = hashlib.sha256()
+  for section in module.sections():
+    module.seek(section.offset)
+    if section.type == webassembly.SecType.CUSTOM:
+      name = module.readString()
+      if name.startswith(IGNORED_CUSTOM_SECTIONS):
+        continue
+      module.seek(section.offset)
+    h.update(bytes([section.type]))
+    if section.type != webassembly.SecType.CODE:
+      h.update(section.size.to_bytes(8, 'little') + module.buf.read(section.size))
+      continue
+    num_bodies = module.readULEB()
+    h.update(num_bodies.to_bytes(8, 'little'))
+    for i in range(num_bodies):
+      size = module.readULEB()
+      if i in main_bodies:
+        h.update(i.to_bytes(8, 'little') + module.buf.read(size))
+      else:
+        module.skip(size)
+  return h.hexdigest()
+
+
+class IncrementalLink:
+  def __init__(self, options, target, wasm_target, js_outputs):
+    self.state_file = get_state_file(wasm_target)
+    self.js_key = get_js_key(options, target)
+    self.js_outputs = [os.path.abspath(f) for f in js_outputs]
+    self.layout = None
+
+  def load_state(self):
+    try:
+      with open(self.state_file) as f:
+        state = json.load(f)
+    except (OSError, ValueError):
+      return None
+    if state.get('version') != STATE_VERSION:
+      return None
+    return state
+
+  def get_previous_metadata(self, in_wasm):
+    """Returns the finalize metadata of the previous link if only function
+    bodies changed since then, and None if a full link is needed."""
+    self.layout = get_layout_hash(in_wasm)
+    state = self.load_state()
+    if not state:
+      logger.debug('incremental link: no previous link state')
+      return None
+    if state['js_key'] != self.js_key:
+      logger.debug('incremental link: settings or JS inputs changed')
+      return None
+    if state['layout'] != self.layout:
+      logger.debug('incremental link: wasm layout changed')
+      return None
+    for path, digest in state['outputs'].items():
+      if not os.path.exists(path) or hash_file(path) != digest:
+        logger.debug(f'incremental link: {path} was modified')
+        return None
+    return state['metadata']
+
+  def save(self, metadata):
+    """Records a full link."""
+    if self.layout is None or metadata is None:
+      return
+    outputs = {}
+    for path in self.js_outputs:
+      if os.path.exists(path):
+        outputs[path] = hash_file(path)
+    state = {
+      'version': STATE_VERSION,
+      'js_key': self.js_key,
+      'layout': self.layout,
+      'metadata': metadata,
+      'outputs': outputs,
+    }
+    utils.write_file(self.state_file, json.dumps(state))
+
+  def invalidate(self):
+    """Removes the state of the previous link, which no longer describes the
+    outputs once a full link starts."""
+    shared.try_delete(self.state_file)
@@ -0,0 +1,224 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Runs acorn-optimizer.js jobs in a pool of worker threads, so that node, acorn
+// and terser are only loaded once rather than once per chunk and per pass.
+// See tools/js_optimizer_server.py for the driver.
+//
+// Usage:
+//   node js-optimizer-server.js --stdio [--workers N]
+//     Reads jobs from stdin and exits once stdin is closed and all jobs are
+//     done.
+//   node js-optimizer-server.js --socket PATH --idle-timeout SECONDS [--workers N]
+//     Listens on a unix socket (a named pipe on Windows) and exits after being
+//     idle for the given time.
+//
+// Each job is a line of JSON: {"id": ..., "args": [...], "output": "..."},
+// where `args` are the acorn-optimizer.js command line arguments and `output`
+// is the file to write the optimized code to. For each job a line of JSON is
+// sent back once it is done: {"id": ..., "stderr": "...", "error": ...}, with
+// `error` set if the job failed.
+
+'use strict';
+
+var fs = require('fs');
+var os = require('os');
+var readline = require('readline');
+
+var workerThreads = null;
+try {
+  workerThreads = require('worker_threads');
+} catch (e) {
+  // Older versions of node. Jobs are run on the main thread.
+}
+
+function runJob(optimizer, job) {
+  var output = [];
+  var stderr = [];
+  var error = null;
+  try {
+    optimizer.run(job.args, function(x) {
+      output.push(x + '\n');
+    }, function(x) {
+      stderr.push(x + '\n');
+    });
+    fs.writeFileSync(job.output, output.join(''));
+  } catch (e) {
+    error = String(e && e.stack ? e.stack : e);
+  }
+  return {id: job.id, stderr: stderr.join(''), error: error};
+}
+
+if (workerThreads && !workerThreads.isMainThread) {
+  var optimizer = require('./acorn-optimizer.js');
+  workerThreads.parentPort.on('message', function(job) {
+    workerThreads.parentPort.postMessage(runJob(optimizer, job));
+  });
+  return;
+}
+
+// Main thread
+
+function parseArgs(argv) {
+  var options = {stdio: false, socket: null, idleTimeout: 0, workers: os.cpus().length || 1};
+  for (var i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--stdio': options.stdio = true; break;
+      case '--socket': options.socket = argv[++i]; break;
+      case '--idle-timeout': options.idleTimeout = Number(argv[++i]); break;
+      case '--workers': options.workers = Math.max(Number(argv[++i]), 1); break;
+      default: throw new Error('unknown argument: ' + argv[i]);
+    }
+  }
+  if (options.stdio == !!options.socket) {
+    throw new Error('exactly one of --stdio and --socket must be given');
+  }
+  return options;
+}
+
+function Pool(numWorkers) {
+  this.queue = [];
+  this.idle = [];
+  this.busy = 0;
+  this.onIdle = null;
+  if (!workerThreads) {
+    this.optimizer = require('./acorn-optimizer.js');
+    return;
+  }
+  for (var i = 0; i < numWorkers; i++) {
+    var worker = new workerThreads.Worker(__filename);
+    // Do not keep the process alive just for idle workers.
+    worker.unref();
+    worker.on('message', this.onResult.bind(this, worker));
+    worker.on('error', function(e) {
+      process.stderr.write('js optimizer worker failed: ' + (e.stack || e) + '\n');
+      process.exit(1);
+    });
+    this.idle.push(worker);
+  }
+}
+
+Pool.prototype.add = function(job, callback) {
+  this.queue.push({job: job, callback: callback});
+  this.schedule();
+};
+
+Pool.prototype.schedule = function() {
+  if (!workerThreads) {
+    // Run the jobs one at a time, letting I/O happen in between.
+    if (this.busy || !this.queue.length) return;
+    var item = this.queue.shift();
+    this.busy++;
+    setImmediate(function() {
+      var result = runJob(this.optimizer, item.job);
+      this.busy--;
+      item.callback(result);
+      this.schedule();
+      this.checkIdle();
+    }.bind(this));
+    return;
+  }
+  while (this.idle.length && this.queue.length) {
+    var worker = this.idle.pop();
+    var item = this.queue.shift();
+    worker.callback = item.callback;
+    worker.ref();
+    this.busy++;
+    worker.postMessage(item.job);
+  }
+};
+
+Pool.prototype.onResult = function(worker, result) {
+  var callback = worker.callback;
+  worker.callback = null;
+  worker.unref();
+  this.busy--;
+  this.idle.push(worker);
+  callback(result);
+  this.schedule();
+  this.checkIdle();
+};
+
+Pool.prototype.checkIdle = function() {
+  if (!this.busy && !this.queue.length && this.onIdle) {
+    this.onIdle();
+  }
+};
+
+// Reads jobs from a stream and sends the results back on another.
+function serve(pool, input, output) {
+  var lines = readline.createInterface({input: input, crlfDelay: Infinity});
+  lines.on('line', function(line) {
+    if (!line.trim()) return;
+    var job;
+    try {
+      job = JSON.parse(line);
+    } catch (e) {
+      output.write(JSON.stringify({id: null, stderr: '', error: 'invalid job: ' + line}) + '\n');
+      return;
+    }
+    pool.add(job, function(result) {
+      if (!output.destroyed) {
+        output.write(JSON.stringify(result) + '\n');
+      }
+    });
+  });
+  return lines;
+}
+
+function serveStdio(options) {
+  var pool = new Pool(options.workers);
+  // The process exits by itself once stdin is closed and the workers are
+  // unref'd again.
+  serve(pool, process.stdin, process.stdout);
+}
+
+function serveSocket(options) {
+  var net = require('net');
+  var pool = new Pool(options.workers);
+  var connections = 0;
+  var timer = null;
+  var server = net.createServer(function(socket) {
+    connections++;
+    stopTimer();
+    socket.on('error', function() {});
+    socket.on('close', function() {
+      connections--;
+      startTimer();
+    });
+    serve(pool, socket, socket);
+  });
+
+  function stopTimer() {
+    if (timer) {
+      clearTimeout(timer);
+      timer = null;
+    }
+  }
+
+  function startTimer() {
+    stopTimer();
+    if (connections || pool.busy || pool.queue.length) return;
+    timer = setTimeout(function() {
+      server.close();
+      process.exit(0);
+    }, options.idleTimeout * 1000);
+  }
+
+  pool.onIdle = startTimer;
+  server.on('error', function(e) {
+    // Most likely another server started listening on the same socket first.
+    process.stderr.write('js optimizer server: ' + e.message + '\n');
+    process.exit(e.code === 'EADDRINUSE' ? 0 : 1);
+  });
+  server.listen(options.socket, startTimer);
+}
+
+var options = parseArgs(process.argv.slice(2));
+if (options.stdio) {
+  serveStdio(options);
+} else {
+  serveSocket(options);
+}
@@ -0,0 +1,140 @@
+# Copyright 2021 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""A cache for the output of the JS compiler (src/compiler.js).
+
+This is enabled by setting JS_COMPILER_CACHE_SIZE (in megabytes) in the config
+file or EM_JS_COMPILER_CACHE_SIZE in the environment. The JS compiler's output
+is a function of the settings (which include the lists of wasm exports and
+imports) and of the files it reads: its own code, the JS libraries, the shell
+files and so on. Like the direct mode of other compiler caches, entries are
+looked up by a hash of the settings, and each entry lists the files that were
+read to produce it together with hashes of their contents. An entry is only
+used if none of those files have changed.
+
+When an entry cannot be used, the JS compiler itself reuses the preprocessed
+JS library files that have not changed, which it stores in the `libraries`
+subdirectory (see compilerCache in src/compiler.js).
+
+Output that came with warnings is not cached, so that the warnings are shown
+on every link.
+"""
+
+import hashlib
+import json
+import logging
+import os
+
+from . import compile_cache, config, shared, utils
+from .toolchain_profiler import ToolchainProfiler
+
+logger = logging.getLogger('js_compiler_cache')
+
+SUBDIRS = ('glue', 'libraries')
+
+
+def get_max_size():
+  """Returns the size limit of the cache in bytes, or 0 if it is disabled."""
+  if not config.JS_COMPILER_CACHE_SIZE or config.FROZEN_CACHE:
+    return 0
+  try:
+    megabytes = int(config.JS_COMPILER_CACHE_SIZE)
+  except ValueError:
+    utils.exit_with_error('JS_COMPILER_CACHE_SIZE must be a number of megabytes, not `%s`', config.JS_COMPILER_CACHE_SIZE)
+  return max(megabytes, 0) * 1024 * 1024
+
+
+def get_cache_dir():
+  return shared.Cache.get_path('js_compiler_cache')
+
+
+def hash_file(path):
+  with open(path, 'rb') as f:
+    return hashlib.sha256(f.read()).hexdigest()
+
+
+def get_key(settings_json):
+  """Returns the cache key for running the JS compiler with the given
+  settings, or None if the cache is disabled."""
+  if not get_max_size():
+    return None
+  h = hashlib.sha256()
+  h.update(shared.EMSCRIPTEN_VERSION.encode('utf-8'))
+  for arg in config.NODE_JS:
+    h.update(b'\0' + arg.encode('utf-8'))
+  # The other compiler sources are loaded with read() and show up in the
+  # dependencies, but compiler.js is run directly by node.
+  h.update(b'\0' + hash_file(utils.path_from_root('src', 'compiler.js')).encode('utf-8'))
+  h.update(b'\0' + settings_json.encode('utf-8'))
+  return h.hexdigest()
+
+
+def get_entry_path(key):
+  return os.path.join(get_cache_dir(), 'glue', key + '.json')
+
+
+def get_env(deps_file):
+  """Returns the environment variables that enable caching in the JS
+  compiler."""
+  return {
+    'EMCC_JS_COMPILER_CACHE': get_cache_dir(),
+    'EMCC_JS_COMPILER_DEPS': deps_file,
+  }
+
+
+def lookup(key):
+  """Returns the cached output for `key`, or None if there is none or any of
+  the files it was generated from has changed."""
+  entry_path = get_entry_path(key)
+  try:
+    with open(entry_path) as f:
+      entry = json.load(f)
+    for path, digest in entry['deps'].items():
+      if hash_file(path) != digest:
+        logger.debug(f'JS compiler cache miss: {path} has changed')
+        ToolchainProfiler.record_counter('JS compiler cache misses', 1)
+        return None
+    # Mark the entry as recently used.
+    os.utime(entry_path)
+  except (OSError, ValueError, KeyError):
+    logger.debug('JS compiler cache miss')
+    ToolchainProfiler.record_counter('JS compiler cache misses', 1)
+    return None
+  logger.debug('JS compiler cache hit')
+  ToolchainProfiler.record_counter('JS compiler cache hits', 1)
+  return entry['output']
+
+
+def store(key, deps_file, output):
+  """Stores the output of the JS compiler, if it wrote its dependencies to
+  `deps_file`, which it does if the output can be cached."""
+  try:
+    with open(deps_file) as f:
+      deps = json.load(f)
+  except (OSError, ValueError):
+    return
+  entry_path = get_entry_path(key)
+  subdir = os.path.dirname(entry_path)
+  utils.safe_ensure_dirs(subdir)
+  # Other processes may be reading the entry, so write it to a temporary file
+  # first and move that into place.
+  temp_path = f'{entry_path}.{os.getpid()}.tmp'
+  try:
+    with open(temp_path, 'w') as f:
+      json.dump({'deps': deps, 'output': output}, f)
+    os.replace(temp_path, entry_path)
+  except OSError as e:
+    logger.debug(f'failed to store JS compiler output in the cache: {e}')
+    try:
+      os.remove(temp_path)
+    except OSError:
+      pass
+    return
+  max_size = get_max_size()
+  for name in SUBDIRS:
+    subdir = os.path.join(get_cache_dir(), name)
+    if os.path.isdir(subdir):
+      compile_cache.evict(subdir, max_size // len(SUBDIRS), suffix='.json',
+                          counter='JS compiler cache evictions')
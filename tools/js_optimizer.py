@@ -6,16 +6,16 @@
 
 import os
 import sys
-import subprocess
 import re
 import json
 import shutil
+import zlib
 
 __rootpath__ = os.path.abspath(os.path.dirname(os.path.dirname(__file__)))
 sys.path.insert(1, __rootpath__)
 
 from tools.toolchain_profiler import ToolchainProfiler
-from tools import building, config, shared, utils
+from tools import building, js_optimizer_server, shared, utils
 
 configuration = shared.configuration
 temp_files = configuration.get_temp_files()
@@ -25,8 +25,6 @@ def path_from_root(*pathelems):
   return os.path.join(__rootpath__, *pathelems)
 
 
-ACORN_OPTIMIZER = path_from_root('tools/acorn-optimizer.js')
-
 NUM_CHUNKS_PER_CORE = 3
 MIN_CHUNK_SIZE = int(os.environ.get('EMCC_JSOPT_MIN_CHUNK_SIZE') or 512 * 1024) # configuring this is just for debugging purposes
 MAX_CHUNK_SIZE = int(os.environ.get('EMCC_JSOPT_MAX_CHUNK_SIZE') or 5 * 1024 * 1024)
@@ -93,10 +91,12 @@ class Minifier:
         f.write('\n')
         f.write('// EXTRA_INFO:' + json.dumps(self.serialize()))
 
-      cmd = config.NODE_JS + [ACORN_OPTIMIZER, temp_file, 'minifyGlobals']
+      args = ['minifyGlobals']
       if minify_whitespace:
-        cmd.append('minifyWhitespace')
-      output = shared.run_process(cmd, stdout=subprocess.PIPE).stdout
+        args.append('minifyWhitespace')
+      with temp_files.get_file('.minifyglobals.jo.js') as output_file:
+        js_optimizer_server.run_jobs([(temp_file, args, output_file)])
+        output = utils.read_file(output_file)
 
     assert len(output) and not output.startswith('Assertion failed'), 'Error in js optimizer: ' + output
     code, metadata = output.split('// EXTRA_INFO:')
@@ -146,6 +146,33 @@ def chunkify(funcs, chunk_size):
   return [''.join(func[1] for func in chunk) for chunk in chunks] # remove function names
 
 
+# Like chunkify, but chunk boundaries are chosen by the names of the functions
+# rather than by their position, so that a change to a function only changes
+# the chunk it is in (and adding or removing a function only that chunk and
+# possibly the next one). This keeps the other chunks cacheable.
+@ToolchainProfiler.profile_block('chunkify_by_content')
+def chunkify_by_content(funcs, chunk_size):
+  if not funcs:
+    return []
+  average_size = sum(len(func[1]) for func in funcs) / len(funcs)
+  # End a chunk after a function with this probability, so that chunks have
+  # roughly the preferred size on average.
+  threshold = min(average_size / chunk_size, 1) * 0xffffffff
+  chunks = []
+  curr = []
+  total_size = 0
+  for ident, func in funcs:
+    curr.append(func)
+    total_size += len(func)
+    if total_size >= 2 * chunk_size or (total_size >= chunk_size / 4 and zlib.crc32(ident.encode('utf-8')) <= threshold):
+      chunks.append(''.join(curr))
+      curr = []
+      total_size = 0
+  if curr:
+    chunks.append(''.join(curr))
+  return chunks
+
+
 def run_on_js(filename, passes, extra_info=None, just_split=False, just_concat=False):
   with ToolchainProfiler.profile_block('js_optimizer.split_markers'):
     if not isinstance(passes, list):
@@ -261,8 +288,13 @@ EMSCRIPTEN_FUNCS();
 
     if not just_split:
       intended_num_chunks = int(round(cores * NUM_CHUNKS_PER_CORE))
-      chunk_size = min(MAX_CHUNK_SIZE, max(MIN_CHUNK_SIZE, total_size / intended_num_chunks))
-      chunks = chunkify(funcs, chunk_size)
+      if js_optimizer_server.get_max_size():
+        # The chunks must not depend on the number of cores to be found in
+        # the cache when building on another machine.
+        chunks = chunkify_by_content(funcs, MIN_CHUNK_SIZE)
+      else:
+        chunk_size = min(MAX_CHUNK_SIZE, max(MIN_CHUNK_SIZE, total_size / intended_num_chunks))
+        chunks = chunkify(funcs, chunk_size)
     else:
       # keep same chunks as before
       chunks = [f[1] for f in funcs]
@@ -291,8 +323,6 @@ EMSCRIPTEN_FUNCS();
 
   with ToolchainProfiler.profile_block('run_optimizer'):
     if len(filenames):
-      commands = [config.NODE_JS + [ACORN_OPTIMIZER, f] + passes for f in filenames]
-
       if os.environ.get('EMCC_SAVE_OPT_TEMP') and os.environ.get('EMCC_SAVE_OPT_TEMP') != '0':
         for filename in filenames:
           saved = 'save_' + os.path.basename(filename)
@@ -300,7 +330,9 @@ EMSCRIPTEN_FUNCS();
             saved = 'input' + str(int(saved.replace('input', '').replace('.txt', '')) + 1) + '.txt'
           shutil.copyfile(filename, os.path.join(shared.get_emscripten_temp_dir(), saved))
 
-      filenames = shared.run_multiple_processes(commands, route_stdout_to_temp_files_suffix='js_opt.jo.js')
+      jobs = [(f, passes, temp_files.get('js_opt.jo.js').name) for f in filenames]
+      js_optimizer_server.run_jobs(jobs)
+      filenames = [job[2] for job in jobs]
 
     for filename in filenames:
       temp_files.note(filename)
@@ -0,0 +1,304 @@
+# Copyright 2021 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""Runs the JS optimizer (tools/acorn-optimizer.js) on behalf of emcc.
+
+Several jobs are run by a single node process (tools/js-optimizer-server.js),
+which optimizes them in parallel in worker threads, instead of starting node
+and loading acorn and terser once per job.
+
+Setting JS_OPTIMIZER_DAEMON in the config file (or EM_JS_OPTIMIZER_DAEMON in
+the environment) to a number of seconds keeps that process alive between emcc
+invocations, until it has been idle for that long. It listens on a unix socket
+in a directory under the temporary directory that only the user can access.
+The name of the socket depends on the optimizer sources, so that editing them
+starts a new daemon. The daemon is not used on Windows.
+
+Setting JS_OPTIMIZER_CACHE_SIZE (or EM_JS_OPTIMIZER_CACHE_SIZE) to a size in
+megabytes caches the output of each job, keyed by a hash of its input, its
+passes and the optimizer sources. Output that came with warnings is not cached,
+so that the warnings are shown every time.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import socket
+import stat
+import subprocess
+import sys
+import tempfile
+import time
+
+from . import compile_cache, config, shared, utils
+from .toolchain_profiler import ToolchainProfiler
+
+logger = logging.getLogger('js_optimizer_server')
+
+ACORN_OPTIMIZER = utils.path_from_root('tools', 'acorn-optimizer.js')
+SERVER = utils.path_from_root('tools', 'js-optimizer-server.js')
+
+# Entries are spread over this many subdirectories, as in the compile cache.
+NUM_SUBDIRS = 16
+
+# How long to wait for a newly started daemon to accept connections.
+DAEMON_START_TIMEOUT = 10
+
+
+def get_max_size():
+  """Returns the size limit of the cache in bytes, or 0 if it is disabled."""
+  if not config.JS_OPTIMIZER_CACHE_SIZE or config.FROZEN_CACHE:
+    return 0
+  try:
+    megabytes = int(config.JS_OPTIMIZER_CACHE_SIZE)
+  except ValueError:
+    utils.exit_with_error('JS_OPTIMIZER_CACHE_SIZE must be a number of megabytes, not `%s`', config.JS_OPTIMIZER_CACHE_SIZE)
+  return max(megabytes, 0) * 1024 * 1024
+
+
+def get_daemon_idle_timeout():
+  """Returns how many seconds the daemon stays alive while idle, or 0 if it is
+  disabled."""
+  if not config.JS_OPTIMIZER_DAEMON or utils.WINDOWS:
+    return 0
+  try:
+    seconds = int(config.JS_OPTIMIZER_DAEMON)
+  except ValueError:
+    utils.exit_with_error('JS_OPTIMIZER_DAEMON must be a number of seconds, not `%s`', config.JS_OPTIMIZER_DAEMON)
+  return max(seconds, 0)
+
+
+def get_cache_dir():
+  return shared.Cache.get_path('js_optimizer_cache')
+
+
+def get_optimizer_id():
+  """Identifies the optimizer: the sources that are run and how node is run."""
+  if not hasattr(get_optimizer_id, 'id'):
+    h = hashlib.sha256()
+    h.update(shared.EMSCRIPTEN_VERSION.encode('utf-8'))
+    for arg in config.NODE_JS:
+      h.update(b'\0' + arg.encode('utf-8'))
+    for source in (ACORN_OPTIMIZER, SERVER, utils.path_from_root('third_party', 'terser', 'terser.js')):
+      with open(source, 'rb') as f:
+        h.update(b'\0' + f.read())
+    get_optimizer_id.id = h.hexdigest()
+  return get_optimizer_id.id
+
+
+def get_key(filename, args):
+  h = hashlib.sha256()
+  h.update(get_optimizer_id().encode('utf-8'))
+  for arg in args:
+    h.update(b'\0' + arg.encode('utf-8'))
+  with open(filename, 'rb') as f:
+    h.update(b'\0' + f.read())
+  return h.hexdigest()
+
+
+def get_entry_path(key):
+  return os.path.join(get_cache_dir(), key[0], key + '.js')
+
+
+def lookup(key, output_file):
+  entry_path = get_entry_path(key)
+  try:
+    utils.write_binary(output_file, utils.read_binary(entry_path))
+    # Mark the entry as recently used.
+    os.utime(entry_path)
+  except FileNotFoundError:
+    logger.debug(f'JS optimizer cache miss: {output_file}')
+    ToolchainProfiler.record_counter('JS optimizer cache misses', 1)
+    return False
+  logger.debug(f'JS optimizer cache hit: {output_file}')
+  ToolchainProfiler.record_counter('JS optimizer cache hits', 1)
+  return True
+
+
+def store(key, output_file, max_size):
+  entry_path = get_entry_path(key)
+  subdir = os.path.dirname(entry_path)
+  utils.safe_ensure_dirs(subdir)
+  # Other processes may be reading the entry, so write it to a temporary file
+  # first and move that into place.
+  temp_path = f'{entry_path}.{os.getpid()}.tmp'
+  try:
+    utils.write_binary(temp_path, utils.read_binary(output_file))
+    os.replace(temp_path, entry_path)
+  except OSError as e:
+    logger.debug(f'failed to store {output_file} in the JS optimizer cache: {e}')
+    try:
+      os.remove(temp_path)
+    except OSError:
+      pass
+    return
+  compile_cache.evict(subdir, max_size // NUM_SUBDIRS, suffix='.js',
+                      counter='JS optimizer cache evictions')
+
+
+def get_command(job):
+  filename, args, _ = job
+  return config.NODE_JS + [ACORN_OPTIMIZER, filename] + args
+
+
+def get_socket_path():
+  """Returns the path of the daemon socket, in a directory that only the current
+  user can access, or None if there is no such directory. Otherwise another
+  user could create the socket first and answer our jobs."""
+  socket_dir = os.path.join(tempfile.gettempdir(), 'emscripten_jsopt_%s' % os.getuid())
+  try:
+    os.mkdir(socket_dir, 0o700)
+  except FileExistsError:
+    pass
+  except OSError as e:
+    logger.debug(f'failed to create {socket_dir}: {e}')
+    return None
+  info = os.lstat(socket_dir)
+  if not stat.S_ISDIR(info.st_mode) or info.st_uid != os.getuid() or info.st_mode & 0o077:
+    logger.debug(f'not using the JS optimizer daemon: {socket_dir} is not a private directory')
+    return None
+  return os.path.join(socket_dir, get_optimizer_id()[:16] + '.sock')
+
+
+def try_connect(path):
+  sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+  try:
+    sock.connect(path)
+    return sock
+  except OSError as e:
+    sock.close()
+    return e
+
+
+def start_daemon(path):
+  cmd = config.NODE_JS + [SERVER, '--socket', path, '--idle-timeout', str(get_daemon_idle_timeout()),
+                          '--workers', str(shared.get_num_cores())]
+  logger.debug('starting JS optimizer daemon: ' + shared.shlex_join(cmd))
+  subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL, start_new_session=True)
+  deadline = time.time() + DAEMON_START_TIMEOUT
+  while time.time() < deadline:
+    sock = try_connect(path)
+    if isinstance(sock, socket.socket):
+      return sock
+    time.sleep(0.05)
+  return None
+
+
+def connect_to_daemon():
+  """Returns a connection to the daemon, starting it if it is not running, or
+  None if that failed."""
+  path = get_socket_path()
+  if not path:
+    return None
+  sock = try_connect(path)
+  if isinstance(sock, socket.socket):
+    return sock
+  if isinstance(sock, ConnectionRefusedError):
+    # Left behind by a daemon that did not exit cleanly.
+    shared.try_delete(path)
+  return start_daemon(path)
+
+
+def get_requests(jobs):
+  requests = ''
+  for i, (filename, args, output_file) in enumerate(jobs):
+    request = {'id': i, 'args': [filename] + args, 'output': output_file}
+    requests += json.dumps(request) + '\n'
+  return requests.encode('utf-8')
+
+
+def run_on_daemon(sock, jobs):
+  """Returns the responses of the daemon, or None if the connection broke."""
+  responses = []
+  try:
+    with sock:
+      sock.sendall(get_requests(jobs))
+      with sock.makefile('r', encoding='utf-8') as f:
+        while len(responses) < len(jobs):
+          line = f.readline()
+          if not line:
+            return None
+          responses.append(json.loads(line))
+  except (OSError, ValueError) as e:
+    logger.debug(f'lost the connection to the JS optimizer daemon: {e}')
+    return None
+  return responses
+
+
+def run_on_server(jobs):
+  cmd = config.NODE_JS + [SERVER, '--stdio', '--workers', str(min(len(jobs), shared.get_num_cores()))]
+  shared.print_compiler_stage(cmd)
+  proc = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+  stdout, _ = proc.communicate(get_requests(jobs))
+  if proc.returncode != 0:
+    utils.exit_with_error("'%s' failed (%s)", shared.shlex_join(cmd), shared.returncode_to_str(proc.returncode))
+  return [json.loads(line) for line in stdout.decode('utf-8').splitlines() if line.strip()]
+
+
+def run_in_process(job):
+  _, _, output_file = job
+  cmd = get_command(job)
+  shared.print_compiler_stage(cmd)
+  with open(output_file, 'w') as f:
+    proc = shared.run_process(cmd, stdout=f, stderr=subprocess.PIPE, check=False)
+  sys.stderr.write(proc.stderr)
+  if proc.returncode != 0:
+    utils.exit_with_error("'%s' failed (%s)", shared.shlex_join(cmd), shared.returncode_to_str(proc.returncode))
+  return proc.stderr
+
+
+def run_uncached(jobs):
+  """Runs the jobs and returns what each of them wrote to stderr."""
+  responses = None
+  if get_daemon_idle_timeout():
+    sock = connect_to_daemon()
+    if sock:
+      responses = run_on_daemon(sock, jobs)
+    if responses is None:
+      logger.debug('could not use the JS optimizer daemon')
+  if responses is None:
+    if len(jobs) == 1:
+      # Starting a server for a single job is slower than running it directly.
+      return [run_in_process(jobs[0])]
+    responses = run_on_server(jobs)
+
+  results = [None] * len(jobs)
+  for response in responses:
+    i = response['id']
+    sys.stderr.write(response['stderr'])
+    if response['error'] is not None:
+      sys.stderr.write(response['error'] + '\n')
+      utils.exit_with_error("'%s' failed", shared.shlex_join(get_command(jobs[i])))
+    results[i] = response['stderr']
+  if any(r is None for r in results):
+    utils.exit_with_error('JS optimizer did not finish all jobs')
+  return results
+
+
+def run_jobs(jobs):
+  """Runs each of the given jobs, which are tuples of (input file, optimizer
+  arguments, output file)."""
+  jobs = [(os.path.abspath(filename), args, os.path.abspath(output_file))
+          for filename, args, output_file in jobs]
+  max_size = get_max_size()
+  keys = {}
+  uncached = []
+  for i, (filename, args, output_file) in enumerate(jobs):
+    if max_size:
+      key = get_key(filename, args)
+      if lookup(key, output_file):
+        continue
+      keys[i] = key
+    uncached.append(i)
+  if not uncached:
+    return
+
+  with ToolchainProfiler.profile_block('js_optimizer_server.run'):
+    results = run_uncached([jobs[i] for i in uncached])
+  for i, stderr in zip(uncached, results):
+    if i in keys and not stderr:
+      store(keys[i], jobs[i][2], max_size)
@@ -17,6 +17,7 @@ MEM_SIZE_SETTINGS = (
     'MEMORY_GROWTH_LINEAR_STEP',
     'MEMORY_GROWTH_GEOMETRIC_CAP',
     'GL_MAX_TEMP_BUFFER_SIZE',
+    'LZ4_CACHE_SIZE',
     'MAXIMUM_MEMORY',
     'DEFAULT_PTHREAD_STACK_SIZE'
 )
@@ -136,7 +136,9 @@ def returncode_to_str(code):
 # bool 'check': If True (default), raises an exception if any of the subprocesses failed with a nonzero exit code.
 # string 'route_stdout_to_temp_files_suffix': if not None, all stdouts are instead written to files, and an array of filenames is returned.
 # bool 'pipe_stdout': If True, an array of stdouts is returned, for each subprocess.
-def run_multiple_processes(commands, env=os.environ.copy(), route_stdout_to_temp_files_suffix=None, pipe_stdout=False, check=True, cwd=None):
+def run_multiple_processes(commands, env=os.environ.copy(), route_stdout_to_temp_files_suffix=None, pipe_stdout=False, check=True, cwd=None, callback=None):
+  # If given, `callback` is called with the index of each command as soon as it
+  # has completed successfully, while the remaining commands keep running.
   # By default, avoid using Python multiprocessing library due to a large amount of bugs it has on Windows (#8013, #718, #13785, etc.)
   # Use EM_PYTHON_MULTIPROCESSING=1 environment variable to enable it. It can be faster, but may not work on Windows.
   if int(os.getenv('EM_PYTHON_MULTIPROCESSING', '0')):
@@ -144,7 +146,11 @@ def run_multiple_processes(commands, env=os.environ.copy(), route_stdout_to_temp
     global multiprocessing_pool
     if not multiprocessing_pool:
       multiprocessing_pool = multiprocessing.Pool(processes=get_num_cores())
-    return multiprocessing_pool.map(mp_run_process, [(cmd, env, route_stdout_to_temp_files_suffix, pipe_stdout, check, cwd) for cmd in commands], chunksize=1)
+    ret = multiprocessing_pool.map(mp_run_process, [(cmd, env, route_stdout_to_temp_files_suffix, pipe_stdout, check, cwd) for cmd in commands], chunksize=1)
+    if callback:
+      for i in range(len(commands)):
+        callback(i)
+    return ret
 
   std_outs = []
 
@@ -206,6 +212,8 @@ def run_multiple_processes(commands, env=os.environ.copy(), route_stdout_to_temp
 
           raise Exception('Subprocess %d/%d failed (%s)! (cmdline: %s)' % (idx + 1, len(commands), returncode_to_str(finished_process.returncode), shlex_join(commands[idx])))
         num_completed += 1
+        if callback and finished_process.returncode == 0:
+          callback(idx)
 
   # If processes finished out of order, sort the results to the order of the input.
   std_outs.sort(key=lambda x: x[0])
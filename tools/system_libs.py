@@ -9,10 +9,11 @@ import itertools
 import logging
 import os
 import shutil
+import tempfile
 from enum import IntEnum, auto
 from glob import iglob
 
-from . import shared, building, utils
+from . import shared, building, utils, config
 from . import deps_info, tempfiles
 from . import diagnostics
 from tools.shared import mangle_c_symbol_name, demangle_c_symbol_name
@@ -64,12 +65,64 @@ def clean_env():
   return safe_env
 
 
-def run_build_commands(commands):
+def run_build_commands(commands, callback=None):
   # Before running a set of build commands make sure the common sysroot
   # headers are installed.  This prevents each sub-process from attempting
   # to setup the sysroot itself.
   ensure_sysroot()
-  shared.run_multiple_processes(commands, env=clean_env())
+  shared.run_multiple_processes(commands, env=clean_env(), callback=callback)
+
+
+def build_libraries(libraries):
+  """Builds the given libraries, unless they are already in the cache.
+
+  The objects of all of the libraries are compiled in one pool of parallel
+  jobs, so that the cores do not sit idle while the last few files of each
+  library compile. Each library is archived as soon as all of its objects are
+  built. Only archiving into the cache takes the cache lock: if another
+  process has meanwhile put the same library in the cache, that copy is kept.
+  """
+  if config.FROZEN_CACHE:
+    return
+  to_build = []
+  for lib in libraries:
+    if not lib.is_cached() and lib not in to_build:
+      to_build.append(lib)
+  if not to_build:
+    return
+
+  commands = []
+  # For each library, its build directory, object files, and the number of
+  # its commands that are still running.
+  builds = []
+  command_builds = []
+  for lib in to_build:
+    build_dir = lib.get_build_dir()
+    lib_commands, objects = lib.get_build_commands(build_dir)
+    build = [lib, build_dir, objects, len(lib_commands)]
+    builds.append(build)
+    commands += lib_commands
+    command_builds += [build] * len(lib_commands)
+
+  def archive(build):
+    lib, build_dir, objects, _ = build
+    shared.Cache.get_lib(lib.get_filename(), lambda out_filename: create_lib(out_filename, objects))
+    if not shared.DEBUG:
+      tempfiles.try_delete(build_dir)
+
+  def command_done(i):
+    build = command_builds[i]
+    build[3] -= 1
+    if build[3] == 0:
+      archive(build)
+
+  if len(to_build) > 1:
+    logger.info(f'building {len(to_build)} system libraries in parallel: {" ".join(lib.get_filename() for lib in to_build)}')
+  for build in builds:
+    if build[3] == 0:
+      archive(build)
+  with ToolchainProfiler.profile_block('build system libraries'):
+    run_build_commands(commands, callback=command_done)
 
 
 def create_lib(libname, inputs):
@@ -282,12 +335,16 @@ class Library:
   def erase(self):
     shared.Cache.erase_file(shared.Cache.get_lib_name(self.get_filename()))
 
+  def is_cached(self):
+    return os.path.exists(shared.Cache.get_path(shared.Cache.get_lib_name(self.get_filename())))
+
   def get_path(self):
     """
     Gets the cached path of this library.
 
     This will trigger a build if this library is not in the cache.
     """
+    build_libraries([self])
     return shared.Cache.get_lib(self.get_filename(), self.build)
 
   def get_link_flag(self):
@@ -322,9 +379,10 @@ class Library:
 
     raise NotImplementedError()
 
-  def build_objects(self, build_dir):
+  def get_build_commands(self, build_dir):
     """
-    Returns a list of compiled object files for this library.
+    Returns the commands that compile this library, and the list of object
+    files that they produce.
 
     By default, this builds all the source files returned by `self.get_files()`,
     with the `cflags` returned by `self.get_cflags()`.
@@ -361,13 +419,28 @@ class Library:
         cmd += cflags
       commands.append(cmd + ['-c', src, '-o', o])
       objects.append(o)
+    return commands, objects
+
+  def build_objects(self, build_dir):
+    """
+    Returns a list of compiled object files for this library.
+    """
+    commands, objects = self.get_build_commands(build_dir)
     run_build_commands(commands)
     return objects
 
+  def get_build_dir(self):
+    """
+    Returns a new directory to build this library in. Libraries are compiled
+    without holding the cache lock, so each build gets its own directory.
+    """
+    build_root = shared.Cache.get_path('build')
+    utils.safe_ensure_dirs(build_root)
+    return tempfile.mkdtemp(prefix=self.get_base_name() + '.', dir=build_root)
+
   def build(self, out_filename):
     """Builds the library and returns the path to the file."""
-    build_dir = shared.Cache.get_path(os.path.join('build', self.get_base_name()))
-    utils.safe_ensure_dirs(build_dir)
+    build_dir = self.get_build_dir()
     create_lib(out_filename, self.build_objects(build_dir))
     if not shared.DEBUG:
       tempfiles.try_delete(build_dir)
@@ -738,6 +811,10 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
         path='system/lib/pthread',
         filenames=[
           'library_pthread.c',
+          'emscripten_futex_wait.c',
+          'emscripten_futex_wake.c',
+          'emscripten_task.c',
+          'emscripten_thread_timeline.c',
           'pthread_create.c',
           'pthread_join.c',
           'pthread_testcancel.c',
@@ -859,6 +936,8 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
           'sigtimedwait.c',
           'pthread_sigmask.c',
           'emscripten_console.c',
+          'emscripten_utf8.c',
+          'emscripten_snapshot.c',
         ])
 
     libc_files += files_in_path(
@@ -997,6 +1076,8 @@ class libcxxabi(NoExceptLibrary, MTLibrary):
     ]
     if self.eh_mode == Exceptions.NONE:
       filenames += ['cxa_noexception.cpp']
+    elif self.eh_mode == Exceptions.EMSCRIPTEN:
+      filenames += ['cxa_exception_emscripten.cpp']
     elif self.eh_mode == Exceptions.WASM:
       filenames += [
         'cxa_exception_storage.cpp',
@@ -1144,7 +1225,7 @@ class libal(Library):
 
   cflags = ['-Os']
   src_dir = 'system/lib'
-  src_files = ['al.c']
+  src_files = ['al.c', 'al_mixer.c']
 
 
 class libGL(MTLibrary):
@@ -1278,8 +1359,8 @@ class libasmfs(MTLibrary):
 class libwasmfs(MTLibrary):
   name = 'libwasmfs'
 
-  def get_files(self):
-    return [utils.path_from_root('system/lib/wasmfs/wasmfs.cpp')]
+  src_dir = 'system/lib/wasmfs'
+  src_glob = '*.cpp'
 
   def can_build(self):
     return settings.WASMFS
@@ -1593,13 +1674,19 @@ def calculate(input_files, forced):
     logger.debug('including %s (%s)' % (lib.name, lib.get_filename()))
 
     need_whole_archive = lib.name in force_include and lib.get_ext() == '.a'
-    libs_to_link.append((lib.get_link_flag(), need_whole_archive))
+    libs_to_link.append((lib, need_whole_archive))
+
+  def get_link_flags():
+    # Build all missing libraries together, rather than one by one in
+    # get_link_flag().
+    build_libraries([lib for lib, _ in libs_to_link])
+    return [(lib.get_link_flag(), need_whole_archive) for lib, need_whole_archive in libs_to_link]
 
   if settings.USE_PTHREADS:
     add_library('crtbegin')
 
   if settings.SIDE_MODULE:
-    return [l[0] for l in libs_to_link]
+    return [l[0] for l in get_link_flags()]
 
   if settings.STANDALONE_WASM:
     if settings.EXPECT_MAIN:
@@ -1684,17 +1771,19 @@ def calculate(input_files, forced):
     if settings.USE_WEBGPU:
       add_library('libwebgpu_cpp')
 
+  link_flags = get_link_flags()
+
   # When LINKABLE is set the entire link command line is wrapped in --whole-archive by
   # building.link_ldd.  And since --whole-archive/--no-whole-archive processing does not nest we
   # shouldn't add any extra `--no-whole-archive` or we will undo the intent of building.link_ldd.
   if settings.LINKABLE:
-    return [l[0] for l in libs_to_link]
+    return [l[0] for l in link_flags]
 
   # Wrap libraries in --whole-archive, as needed.  We need to do this last
   # since otherwise the abort sorting won't make sense.
   ret = []
   in_group = False
-  for name, need_whole_archive in libs_to_link:
+  for name, need_whole_archive in link_flags:
     if need_whole_archive and not in_group:
       ret.append('--whole-archive')
       in_group = True
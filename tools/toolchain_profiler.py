@@ -195,6 +195,11 @@ if EMPROFILE:
 
       ToolchainProfiler.block_stack.append(block_name)
 
+    @staticmethod
+    def record_counter(counter_name, value):
+      with ToolchainProfiler.log_access() as f:
+        f.write(',\n{"pid":' + ToolchainProfiler.mypid_str + ',"subprocessPid":' + str(os.getpid()) + ',"op":"counter","name":"' + ToolchainProfiler.escape_string(counter_name) + '","value":' + str(value) + ',"time":' + ToolchainProfiler.timestamp() + '}')
+
     @staticmethod
     def remove_last_occurrence_if_exists(lst, item):
       for i in range(len(lst)):
@@ -245,6 +250,10 @@ else:
     def exit_block(block_name):
       pass
 
+    @staticmethod
+    def record_counter(counter_name, value):
+      pass
+
     @staticmethod
     def profile_block(block_name):
       return Logger(block_name)
@@ -8,8 +8,10 @@
 
 from collections import namedtuple
 from enum import IntEnum
+import hashlib
 import logging
 import os
+import re
 import sys
 
 from . import utils
@@ -48,6 +50,30 @@ HEADER_SIZE = 8
 
 LIMITS_HAS_MAX = 0x1
 
+# The custom section that -s PRELINK_SIDE_MODULE adds to side modules. Its
+# layout is read by getPrelinkMetadata in src/library_dylink.js.
+PRELINK_SECTION = 'emscripten.prelink'
+
+PRELINK_VERSION = 1
+
+# Flags of the GOT exports listed in the prelink section.
+PRELINK_FUNC = 0x1
+PRELINK_REPLACE = 0x2
+
+# Exports of side modules that are not added to the GOT. Keep this in sync
+# with isInternalSym in src/library_dylink.js.
+INTERNAL_SYMBOLS = (
+  '__cpp_exception',
+  '__wasm_apply_data_relocs',
+  '__dso_handle',
+  '__tls_size',
+  '__tls_align',
+  '__set_stack_limits',
+  'emscripten_tls_init',
+  '__wasm_init_tls',
+  '__wasm_call_ctors',
+)
+
 
 def toLEB(num):
   return leb128.u.encode(num)
@@ -110,6 +136,122 @@ def add_emscripten_metadata(wasm_file):
     f.write(orig[8:])
 
 
+def toString(s):
+  s = s.encode('utf-8')
+  return toLEB(len(s)) + s
+
+
+def add_prelink_section(wasm_file):
+  """Appends the prelink section to a side module. It lists the imports of
+  the module and the exports that the dynamic loader adds to the GOT, so that
+  the loader can bind them in bulk instead of looking each of them up through
+  a JS Proxy, and a hash of those lists (the layout). The loader caches what
+  the imports resolved to by layout, so loading a module with a layout that it
+  has seen before does not resolve any symbols again."""
+  module = Module(wasm_file)
+  imports = module.get_imports()
+  got_exports = []
+  for e in module.get_exports():
+    if e.kind not in (ExternType.FUNC, ExternType.GLOBAL):
+      continue
+    if e.name in INTERNAL_SYMBOLS or (settings.SPLIT_MODULE and e.name.startswith('%')):
+      continue
+    flags = PRELINK_FUNC if e.kind == ExternType.FUNC else 0
+    sym_name = e.name
+    if sym_name.startswith('orig$'):
+      # Legalized exports replace the GOT entries of their legalized wrappers.
+      sym_name = sym_name.split('$')[1]
+      flags |= PRELINK_REPLACE
+    got_exports.append((e.name, sym_name, flags))
+  del module
+
+  contents = b''
+  for i in imports:
+    contents += toString(i.module) + toString(i.field)
+  contents = toLEB(len(imports)) + contents
+  exports_contents = b''
+  for name, sym_name, flags in got_exports:
+    exports_contents += toString(name) + toString(sym_name) + toLEB(flags)
+  contents += toLEB(len(got_exports)) + exports_contents
+  layout = hashlib.sha256(contents).hexdigest()[:32]
+  logger.debug(f'adding prelink section: {len(imports)} imports, {len(got_exports)} GOT exports, layout {layout}')
+
+  contents = toString(PRELINK_SECTION) + toLEB(PRELINK_VERSION) + toString(layout) + contents
+  # The dylink section has to stay the first section, so this one goes last.
+  with open(wasm_file, 'ab') as f:
+    f.write(b'\0') # user section is code 0
+    f.write(toLEB(len(contents)))
+    f.write(contents)
+
+
+def set_initial_memory(wasm_file, memory):
+  """Replaces the data segments of a wasm file with ones that initialize memory
+  to the given contents, and grows the initial size of memory to fit them if
+  needed. Used by -s SNAPSHOT."""
+  module = Module(wasm_file)
+  sections = list(module.sections())
+  memory_section = next(s for s in sections if s.type == SecType.MEMORY)
+  module.seek(memory_section.offset)
+  assert module.readULEB() == 1
+  limits = module.readLimits()
+  data_section = next((s for s in sections if s.type == SecType.DATA), None)
+  if data_section:
+    module.seek(data_section.offset)
+    for i in range(module.readULEB()):
+      assert module.readULEB() == 0, 'only active data segments can be replaced'
+      assert module.readByte() == OpCode.I32_CONST
+      module.readSLEB()
+      assert module.readByte() == OpCode.END
+      module.skip(module.readULEB())
+  del module
+
+  pages = max(limits.initial, (len(memory) + WASM_PAGE_SIZE - 1) // WASM_PAGE_SIZE)
+  memory_contents = toLEB(1) + bytes([limits.flags]) + toLEB(pages)
+  if limits.flags & LIMITS_HAS_MAX:
+    memory_contents += toLEB(max(limits.maximum, pages))
+
+  # A segment for each run of non-zero bytes. Runs that are separated by fewer
+  # zeros than it takes to start a new segment are merged.
+  runs = []
+  pos = 0
+  for zeros in re.finditer(b'\0{16,}', memory):
+    if zeros.start() > pos:
+      runs.append((pos, zeros.start()))
+    pos = zeros.end()
+  if pos < len(memory):
+    runs.append((pos, len(memory)))
+  data_contents = bytearray(toLEB(len(runs)))
+  for start, end in runs:
+    # The offset is an i32.const, which is signed.
+    offset = start if start < 2**31 else start - 2**32
+    data_contents += b'\0' + bytes([OpCode.I32_CONST]) + leb128.i.encode(offset) + bytes([OpCode.END])
+    data_contents += toLEB(end - start) + memory[start:end]
+  logger.debug('setting initial memory: %d pages, %d data segments' % (pages, len(runs)))
+
+  orig = utils.read_binary(wasm_file)
+  out = bytearray(orig[:HEADER_SIZE])
+
+  def add_section(section_type, contents):
+    out.extend(bytes([section_type]) + toLEB(len(contents)))
+    out.extend(contents)
+
+  start = HEADER_SIZE
+  for section in sections:
+    if section.type == SecType.MEMORY:
+      add_section(SecType.MEMORY, memory_contents)
+    elif section.type == SecType.DATACOUNT:
+      add_section(SecType.DATACOUNT, toLEB(len(runs)))
+    elif section.type == SecType.DATA:
+      add_section(SecType.DATA, data_contents)
+    else:
+      out.extend(orig[start:section.offset + section.size])
+    # The data section comes right after the code section.
+    if section.type == SecType.CODE and not data_section:
+      add_section(SecType.DATA, data_contents)
+    start = section.offset + section.size
+  utils.write_binary(wasm_file, out)
+
+
 class SecType(IntEnum):
   CUSTOM = 0
   TYPE = 1
@@ -127,6 +269,11 @@ class SecType(IntEnum):
   DATA = 11
 
 
+class OpCode(IntEnum):
+  I32_CONST = 0x41
+  END = 0x0b
+
+
 class ExternType(IntEnum):
   FUNC = 0
   TABLE = 1
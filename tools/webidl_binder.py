@@ -117,7 +117,9 @@ Module['getCache'] = getCache;
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant)
     @param {*=} __class__ */
 function wrapPointer(ptr, __class__) {
-  var cache = getCache(__class__);
+  // The cache is keyed by the (integer) pointer. Generated methods always pass
+  // the class, so look its cache up directly rather than through getCache().
+  var cache = (__class__ || WrapperObject).__cache__;
   var ret = cache[ptr];
   if (ret) return ret;
   ret = Object.create((__class__ || WrapperObject).prototype);
@@ -193,9 +195,10 @@ var ensureCache = {
     ensureCache.pos = 0;
   },
   alloc: function(array, view) {
+    return ensureCache.allocBytes(array.length * view.BYTES_PER_ELEMENT);
+  },
+  allocBytes: function(len) {
     assert(ensureCache.buffer);
-    var bytes = view.BYTES_PER_ELEMENT;
-    var len = array.length * bytes;
     len = (len + 7) & -8; // keep things aligned to 8 byte boundaries
     var ret;
     if (ensureCache.pos + len >= ensureCache.size) {
@@ -219,25 +222,31 @@ var ensureCache = {
       case 4: offset >>>= 2; break;
       case 8: offset >>>= 3; break;
     }
-    for (var i = 0; i < array.length; i++) {
-      view[offset + i] = array[i];
-    }
+    view.set(array, offset);
   },
 };
 
+// Strings are encoded straight into the temporary storage, without building an
+// intermediate array.
+
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureString(value) {
   if (typeof value === 'string') {
-    var intArray = intArrayFromString(value);
-    var offset = ensureCache.alloc(intArray, HEAP8);
-    ensureCache.copy(intArray, HEAP8, offset);
+    var len = lengthBytesUTF8(value) + 1;
+    var offset = ensureCache.allocBytes(len);
+    stringToUTF8(value, offset, len);
     return offset;
   }
   return value;
 }
+
+// Typed arrays that are views into the heap are passed as pointers, without
+// copying. Other arrays are copied into the temporary storage.
+
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureInt8(value) {
   if (typeof value === 'object') {
+    if (value.buffer === HEAP8.buffer && (value instanceof Int8Array || value instanceof Uint8Array)) return value.byteOffset;
     var offset = ensureCache.alloc(value, HEAP8);
     ensureCache.copy(value, HEAP8, offset);
     return offset;
@@ -247,6 +256,7 @@ function ensureInt8(value) {
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureInt16(value) {
   if (typeof value === 'object') {
+    if (value.buffer === HEAP8.buffer && (value instanceof Int16Array || value instanceof Uint16Array)) return value.byteOffset;
     var offset = ensureCache.alloc(value, HEAP16);
     ensureCache.copy(value, HEAP16, offset);
     return offset;
@@ -256,6 +266,7 @@ function ensureInt16(value) {
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureInt32(value) {
   if (typeof value === 'object') {
+    if (value.buffer === HEAP8.buffer && (value instanceof Int32Array || value instanceof Uint32Array)) return value.byteOffset;
     var offset = ensureCache.alloc(value, HEAP32);
     ensureCache.copy(value, HEAP32, offset);
     return offset;
@@ -265,6 +276,7 @@ function ensureInt32(value) {
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureFloat32(value) {
   if (typeof value === 'object') {
+    if (value.buffer === HEAP8.buffer && value instanceof Float32Array) return value.byteOffset;
     var offset = ensureCache.alloc(value, HEAPF32);
     ensureCache.copy(value, HEAPF32, offset);
     return offset;
@@ -274,6 +286,7 @@ function ensureFloat32(value) {
 /** @suppress {duplicate} (TODO: avoid emitting this multiple times, it is redundant) */
 function ensureFloat64(value) {
   if (typeof value === 'object') {
+    if (value.buffer === HEAP8.buffer && value instanceof Float64Array) return value.byteOffset;
     var offset = ensureCache.alloc(value, HEAPF64);
     ensureCache.copy(value, HEAPF64, offset);
     return offset;